@@ -0,0 +1,291 @@
+#include <drm_fourcc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wlr/backend/headless.h>
+#include <wlr/interfaces/wlr_buffer.h>
+#include <wlr/render/allocator.h>
+#include <wlr/render/pixman.h>
+#include <wlr/types/wlr_output.h>
+#include <wlr/types/wlr_output_layout.h>
+#include "bench.h"
+#include "log.h"
+#include "sway/server.h"
+#include "sway/tree/root.h"
+
+// These normally live in main.c, which is not linked into the benchmarks
+struct sway_server server = {0};
+struct sway_debug debug = {0};
+
+void sway_terminate(int exit_code) {
+	exit(exit_code);
+}
+
+static uint64_t alloc_count = 0;
+
+// Linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+	++alloc_count;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+	++alloc_count;
+	return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+	++alloc_count;
+	return __real_realloc(ptr, size);
+}
+
+uint64_t bench_alloc_count(void) {
+	return alloc_count;
+}
+
+bool bench_env_init(struct bench_env *env) {
+	*env = (struct bench_env){0};
+	env->display = wl_display_create();
+	env->event_loop = wl_display_get_event_loop(env->display);
+
+	root = root_create(env->display);
+	if (!root) {
+		return false;
+	}
+
+	env->backend = wlr_headless_backend_create(env->event_loop);
+	if (!env->backend) {
+		sway_log(SWAY_ERROR, "Unable to create headless backend");
+		return false;
+	}
+	env->renderer = wlr_pixman_renderer_create();
+	if (!env->renderer) {
+		sway_log(SWAY_ERROR, "Unable to create pixman renderer");
+		return false;
+	}
+	env->allocator = wlr_allocator_autocreate(env->backend, env->renderer);
+	if (!env->allocator) {
+		sway_log(SWAY_ERROR, "Unable to create allocator");
+		return false;
+	}
+	if (!wlr_backend_start(env->backend)) {
+		sway_log(SWAY_ERROR, "Unable to start headless backend");
+		return false;
+	}
+
+	server.wl_display = env->display;
+	server.wl_event_loop = env->event_loop;
+	server.backend = env->backend;
+	server.renderer = env->renderer;
+	server.allocator = env->allocator;
+	wl_signal_init(&server.events.transaction_applied);
+	return true;
+}
+
+void bench_env_finish(struct bench_env *env) {
+	if (root) {
+		root_destroy(root);
+		root = NULL;
+	}
+	if (env->backend) {
+		wlr_backend_destroy(env->backend);
+	}
+	if (env->allocator) {
+		wlr_allocator_destroy(env->allocator);
+	}
+	if (env->renderer) {
+		wlr_renderer_destroy(env->renderer);
+	}
+	if (env->display) {
+		wl_display_destroy(env->display);
+	}
+	server = (struct sway_server){0};
+}
+
+struct wlr_output *bench_env_add_output(struct bench_env *env,
+		int width, int height, int x, int y) {
+	struct wlr_output *output =
+		wlr_headless_add_output(env->backend, width, height);
+	if (!output) {
+		return NULL;
+	}
+	wlr_output_init_render(output, env->allocator, env->renderer);
+
+	struct wlr_output_state state;
+	wlr_output_state_init(&state);
+	wlr_output_state_set_enabled(&state, true);
+	wlr_output_state_set_custom_mode(&state, width, height, 60000);
+	bool ok = wlr_output_commit_state(output, &state);
+	wlr_output_state_finish(&state);
+	if (!ok) {
+		sway_log(SWAY_ERROR, "Unable to enable headless output");
+		wlr_output_destroy(output);
+		return NULL;
+	}
+
+	wlr_output_layout_add(root->output_layout, output, x, y);
+	return output;
+}
+
+struct bench_buffer {
+	struct wlr_buffer base;
+	uint32_t *data;
+	size_t stride;
+};
+
+static void bench_buffer_destroy(struct wlr_buffer *wlr_buffer) {
+	struct bench_buffer *buffer = wl_container_of(wlr_buffer, buffer, base);
+	wlr_buffer_finish(wlr_buffer);
+	free(buffer->data);
+	free(buffer);
+}
+
+static bool bench_buffer_begin_data_ptr_access(struct wlr_buffer *wlr_buffer,
+		uint32_t flags, void **data, uint32_t *format, size_t *stride) {
+	struct bench_buffer *buffer = wl_container_of(wlr_buffer, buffer, base);
+	*data = buffer->data;
+	*format = DRM_FORMAT_ARGB8888;
+	*stride = buffer->stride;
+	return true;
+}
+
+static void bench_buffer_end_data_ptr_access(struct wlr_buffer *wlr_buffer) {
+	// This space is intentionally left blank
+}
+
+static const struct wlr_buffer_impl bench_buffer_impl = {
+	.destroy = bench_buffer_destroy,
+	.begin_data_ptr_access = bench_buffer_begin_data_ptr_access,
+	.end_data_ptr_access = bench_buffer_end_data_ptr_access,
+};
+
+struct wlr_buffer *bench_buffer_create(int width, int height, uint32_t color) {
+	struct bench_buffer *buffer = calloc(1, sizeof(struct bench_buffer));
+	if (!buffer) {
+		return NULL;
+	}
+	buffer->stride = width * sizeof(uint32_t);
+	buffer->data = malloc(buffer->stride * height);
+	if (!buffer->data) {
+		free(buffer);
+		return NULL;
+	}
+	for (int i = 0; i < width * height; ++i) {
+		buffer->data[i] = color;
+	}
+	wlr_buffer_init(&buffer->base, &bench_buffer_impl, width, height);
+	return &buffer->base;
+}
+
+void bench_timer_start(struct bench_timer *timer) {
+	timer->allocs = alloc_count;
+	clock_gettime(CLOCK_MONOTONIC, &timer->start);
+}
+
+void bench_timer_stop(struct bench_timer *timer, struct bench_result *result,
+		uint64_t ops) {
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	result->ns += (int64_t)(end.tv_sec - timer->start.tv_sec) * 1000000000 +
+		(end.tv_nsec - timer->start.tv_nsec);
+	result->allocs += alloc_count - timer->allocs;
+	result->ops += ops;
+}
+
+void bench_print_header(void) {
+	printf("%-40s %12s %14s %12s\n", "benchmark", "ops", "ns/op", "allocs/op");
+}
+
+void bench_print_result(const struct bench_result *result) {
+	double ns_per_op = result->ops ? (double)result->ns / result->ops : 0;
+	double allocs_per_op = result->ops ?
+		(double)result->allocs / result->ops : 0;
+	printf("%-40s %12lu %14.1f %12.2f\n", result->name,
+		(unsigned long)result->ops, ns_per_op, allocs_per_op);
+}
+
+void bench_histogram_add(struct bench_histogram *histogram, int64_t ns) {
+	if (histogram->length == histogram->capacity) {
+		size_t capacity = histogram->capacity ? histogram->capacity * 2 : 64;
+		int64_t *samples = realloc(histogram->samples,
+				capacity * sizeof(int64_t));
+		if (!samples) {
+			sway_log(SWAY_ERROR, "Unable to grow histogram %s",
+					histogram->name);
+			return;
+		}
+		histogram->samples = samples;
+		histogram->capacity = capacity;
+	}
+	histogram->samples[histogram->length++] = ns < 0 ? 0 : ns;
+}
+
+static int cmp_samples(const void *a, const void *b) {
+	int64_t sa = *(const int64_t *)a, sb = *(const int64_t *)b;
+	return (sa > sb) - (sa < sb);
+}
+
+static double percentile_us(struct bench_histogram *histogram, double p) {
+	size_t index = p * (histogram->length - 1) + 0.5;
+	return histogram->samples[index] / 1000.0;
+}
+
+#define HISTOGRAM_BUCKETS 32
+#define HISTOGRAM_WIDTH 40
+
+void bench_histogram_print(struct bench_histogram *histogram) {
+	printf("%s: %zu samples\n", histogram->name, histogram->length);
+	if (histogram->length == 0) {
+		return;
+	}
+	qsort(histogram->samples, histogram->length, sizeof(int64_t),
+			cmp_samples);
+	printf("  min %.1fus  p50 %.1fus  p90 %.1fus  p99 %.1fus  max %.1fus\n",
+			percentile_us(histogram, 0), percentile_us(histogram, 0.5),
+			percentile_us(histogram, 0.9), percentile_us(histogram, 0.99),
+			percentile_us(histogram, 1));
+
+	// Bucket i holds samples in [2^i, 2^(i+1)) microseconds, the first one
+	// everything below 2us
+	size_t buckets[HISTOGRAM_BUCKETS] = {0};
+	size_t max_count = 0;
+	int first = HISTOGRAM_BUCKETS, last = 0;
+	for (size_t i = 0; i < histogram->length; ++i) {
+		int64_t us = histogram->samples[i] / 1000;
+		int bucket = 0;
+		while (us > 1 && bucket < HISTOGRAM_BUCKETS - 1) {
+			us >>= 1;
+			++bucket;
+		}
+		if (++buckets[bucket] > max_count) {
+			max_count = buckets[bucket];
+		}
+		first = bucket < first ? bucket : first;
+		last = bucket > last ? bucket : last;
+	}
+	for (int i = first; i <= last; ++i) {
+		int bar = buckets[i] * HISTOGRAM_WIDTH / max_count;
+		printf("  %9lldus %-*.*s %zu\n", i ? 1LL << i : 0LL,
+				HISTOGRAM_WIDTH, bar,
+				"########################################", buckets[i]);
+	}
+}
+
+void bench_histogram_finish(struct bench_histogram *histogram) {
+	free(histogram->samples);
+	histogram->samples = NULL;
+	histogram->length = histogram->capacity = 0;
+}
+
+uint32_t bench_rand(uint32_t *state) {
+	// xorshift32
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
@@ -0,0 +1,90 @@
+#ifndef _SWAY_BENCH_H
+#define _SWAY_BENCH_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <wayland-server-core.h>
+
+struct wlr_buffer;
+struct wlr_output;
+
+/**
+ * A headless compositor environment: a wl_display, a headless backend and a
+ * pixman renderer, so benchmarks run without a GPU or a seat. The sway root
+ * is created as well, since most of the compositor code expects it.
+ */
+struct bench_env {
+	struct wl_display *display;
+	struct wl_event_loop *event_loop;
+	struct wlr_backend *backend;
+	struct wlr_renderer *renderer;
+	struct wlr_allocator *allocator;
+};
+
+bool bench_env_init(struct bench_env *env);
+void bench_env_finish(struct bench_env *env);
+
+/**
+ * Creates an enabled headless output with a custom mode, placed at (x, y) in
+ * the root output layout and ready to be rendered to.
+ */
+struct wlr_output *bench_env_add_output(struct bench_env *env,
+		int width, int height, int x, int y);
+
+/**
+ * Creates a CPU buffer filled with a solid ARGB8888 color.
+ */
+struct wlr_buffer *bench_buffer_create(int width, int height, uint32_t color);
+
+/**
+ * Number of heap allocations (malloc, calloc, realloc) made by code linked
+ * into the benchmark since it started. Allocations made inside shared
+ * libraries such as wlroots or pixman are not counted.
+ */
+uint64_t bench_alloc_count(void);
+
+struct bench_result {
+	const char *name;
+	uint64_t ops;
+	int64_t ns;
+	uint64_t allocs;
+};
+
+struct bench_timer {
+	struct timespec start;
+	uint64_t allocs;
+};
+
+void bench_timer_start(struct bench_timer *timer);
+/**
+ * Adds the time and allocations since bench_timer_start to result, counting
+ * them as ops operations.
+ */
+void bench_timer_stop(struct bench_timer *timer, struct bench_result *result,
+		uint64_t ops);
+
+void bench_print_header(void);
+void bench_print_result(const struct bench_result *result);
+
+/**
+ * A latency distribution. All samples are kept, so percentiles are exact.
+ */
+struct bench_histogram {
+	const char *name;
+	int64_t *samples; // nanoseconds
+	size_t length, capacity;
+};
+
+void bench_histogram_add(struct bench_histogram *histogram, int64_t ns);
+/**
+ * Prints the sample count, percentiles and a log2 bucket chart.
+ */
+void bench_histogram_print(struct bench_histogram *histogram);
+void bench_histogram_finish(struct bench_histogram *histogram);
+
+/**
+ * A small deterministic PRNG, so runs are reproducible.
+ */
+uint32_t bench_rand(uint32_t *state);
+
+#endif
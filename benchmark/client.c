@@ -0,0 +1,210 @@
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wayland-client.h>
+#include "client.h"
+#include "log.h"
+#include "pool-buffer.h"
+#include "xdg-shell-client-protocol.h"
+
+// Size used when the compositor lets the client pick, e.g. for floating views
+#define DEFAULT_WIDTH 640
+#define DEFAULT_HEIGHT 480
+
+struct fake_client {
+	struct wl_display *display;
+	struct wl_registry *registry;
+	struct wl_compositor *compositor;
+	struct wl_shm *shm;
+	struct xdg_wm_base *wm_base;
+};
+
+struct fake_view {
+	struct fake_client *client;
+	struct wl_surface *surface;
+	struct xdg_surface *xdg_surface;
+	struct xdg_toplevel *toplevel;
+	struct pool_buffer buffers[2];
+	int32_t width, height;
+	bool mapped;
+};
+
+static void wm_base_handle_ping(void *data, struct xdg_wm_base *wm_base,
+		uint32_t serial) {
+	xdg_wm_base_pong(wm_base, serial);
+}
+
+static const struct xdg_wm_base_listener wm_base_listener = {
+	.ping = wm_base_handle_ping,
+};
+
+static void handle_global(void *data, struct wl_registry *registry,
+		uint32_t name, const char *interface, uint32_t version) {
+	struct fake_client *client = data;
+	if (strcmp(interface, wl_compositor_interface.name) == 0) {
+		client->compositor = wl_registry_bind(registry, name,
+				&wl_compositor_interface, version < 4 ? version : 4);
+	} else if (strcmp(interface, wl_shm_interface.name) == 0) {
+		client->shm = wl_registry_bind(registry, name, &wl_shm_interface, 1);
+	} else if (strcmp(interface, xdg_wm_base_interface.name) == 0) {
+		// Version 3 is the last one without new toplevel events
+		client->wm_base = wl_registry_bind(registry, name,
+				&xdg_wm_base_interface, version < 3 ? version : 3);
+		xdg_wm_base_add_listener(client->wm_base, &wm_base_listener, client);
+	}
+}
+
+static void handle_global_remove(void *data, struct wl_registry *registry,
+		uint32_t name) {
+	// This space is intentionally left blank
+}
+
+static const struct wl_registry_listener registry_listener = {
+	.global = handle_global,
+	.global_remove = handle_global_remove,
+};
+
+struct fake_client *fake_client_create(int fd) {
+	struct fake_client *client = calloc(1, sizeof(struct fake_client));
+	if (!client) {
+		return NULL;
+	}
+	client->display = wl_display_connect_to_fd(fd);
+	if (!client->display) {
+		sway_log(SWAY_ERROR, "Unable to connect fake client");
+		free(client);
+		return NULL;
+	}
+	client->registry = wl_display_get_registry(client->display);
+	wl_registry_add_listener(client->registry, &registry_listener, client);
+	return client;
+}
+
+void fake_client_destroy(struct fake_client *client) {
+	if (client->wm_base) {
+		xdg_wm_base_destroy(client->wm_base);
+	}
+	if (client->shm) {
+		wl_shm_destroy(client->shm);
+	}
+	if (client->compositor) {
+		wl_compositor_destroy(client->compositor);
+	}
+	wl_registry_destroy(client->registry);
+	wl_display_disconnect(client->display);
+	free(client);
+}
+
+bool fake_client_dispatch(struct fake_client *client) {
+	if (wl_display_flush(client->display) < 0 && errno != EAGAIN) {
+		return false;
+	}
+	while (wl_display_prepare_read(client->display) != 0) {
+		if (wl_display_dispatch_pending(client->display) < 0) {
+			return false;
+		}
+	}
+	struct pollfd pfd = {
+		.fd = wl_display_get_fd(client->display),
+		.events = POLLIN,
+	};
+	if (poll(&pfd, 1, 0) > 0) {
+		if (wl_display_read_events(client->display) < 0) {
+			return false;
+		}
+	} else {
+		wl_display_cancel_read(client->display);
+	}
+	if (wl_display_dispatch_pending(client->display) < 0) {
+		return false;
+	}
+	// Send the replies to whatever was just dispatched
+	return wl_display_flush(client->display) >= 0 || errno == EAGAIN;
+}
+
+bool fake_client_is_ready(struct fake_client *client) {
+	return client->compositor && client->shm && client->wm_base;
+}
+
+static void xdg_surface_handle_configure(void *data,
+		struct xdg_surface *xdg_surface, uint32_t serial) {
+	struct fake_view *view = data;
+	xdg_surface_ack_configure(xdg_surface, serial);
+
+	struct pool_buffer *buffer = get_next_buffer(view->client->shm,
+			view->buffers, view->width, view->height);
+	if (buffer) {
+		wl_surface_attach(view->surface, buffer->buffer, 0, 0);
+		wl_surface_damage_buffer(view->surface, 0, 0,
+				view->width, view->height);
+	} else {
+		sway_log(SWAY_ERROR, "No free buffer, committing without one");
+	}
+	wl_surface_commit(view->surface);
+	view->mapped = true;
+}
+
+static const struct xdg_surface_listener xdg_surface_listener = {
+	.configure = xdg_surface_handle_configure,
+};
+
+static void toplevel_handle_configure(void *data,
+		struct xdg_toplevel *toplevel, int32_t width, int32_t height,
+		struct wl_array *states) {
+	struct fake_view *view = data;
+	view->width = width > 0 ? width : DEFAULT_WIDTH;
+	view->height = height > 0 ? height : DEFAULT_HEIGHT;
+}
+
+static void toplevel_handle_close(void *data, struct xdg_toplevel *toplevel) {
+	// The replay decides when views go away
+}
+
+static const struct xdg_toplevel_listener toplevel_listener = {
+	.configure = toplevel_handle_configure,
+	.close = toplevel_handle_close,
+};
+
+struct fake_view *fake_view_create(struct fake_client *client,
+		const char *app_id, const char *title) {
+	struct fake_view *view = calloc(1, sizeof(struct fake_view));
+	if (!view) {
+		return NULL;
+	}
+	view->client = client;
+	view->width = DEFAULT_WIDTH;
+	view->height = DEFAULT_HEIGHT;
+	view->surface = wl_compositor_create_surface(client->compositor);
+	view->xdg_surface = xdg_wm_base_get_xdg_surface(client->wm_base,
+			view->surface);
+	xdg_surface_add_listener(view->xdg_surface, &xdg_surface_listener, view);
+	view->toplevel = xdg_surface_get_toplevel(view->xdg_surface);
+	xdg_toplevel_add_listener(view->toplevel, &toplevel_listener, view);
+	if (app_id && *app_id) {
+		xdg_toplevel_set_app_id(view->toplevel, app_id);
+	}
+	if (title && *title) {
+		xdg_toplevel_set_title(view->toplevel, title);
+	}
+	// The initial commit asks the compositor for a configure
+	wl_surface_commit(view->surface);
+	return view;
+}
+
+void fake_view_destroy(struct fake_view *view) {
+	xdg_toplevel_destroy(view->toplevel);
+	xdg_surface_destroy(view->xdg_surface);
+	wl_surface_destroy(view->surface);
+	destroy_buffer(&view->buffers[0]);
+	destroy_buffer(&view->buffers[1]);
+	free(view);
+}
+
+uint32_t fake_view_get_surface_id(struct fake_view *view) {
+	return wl_proxy_get_id((struct wl_proxy *)view->surface);
+}
+
+bool fake_view_is_mapped(struct fake_view *view) {
+	return view->mapped;
+}
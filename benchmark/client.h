@@ -0,0 +1,50 @@
+#ifndef _SWAY_BENCH_CLIENT_H
+#define _SWAY_BENCH_CLIENT_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * A fake Wayland client living in the same process as the compositor. It maps
+ * xdg toplevels and answers every configure immediately with a buffer of the
+ * requested size, so transactions only wait on the compositor itself.
+ *
+ * Nothing here blocks: the caller drives both ends of the connection by
+ * alternating between the compositor event loop and fake_client_dispatch().
+ */
+struct fake_client;
+struct fake_view;
+
+/**
+ * Connects over fd, which must be the client end of a socket whose other end
+ * was handed to wl_client_create().
+ */
+struct fake_client *fake_client_create(int fd);
+void fake_client_destroy(struct fake_client *client);
+
+/**
+ * Flushes pending requests, then reads and dispatches whatever events have
+ * arrived. Returns false once the connection is lost.
+ */
+bool fake_client_dispatch(struct fake_client *client);
+
+/**
+ * Whether the globals the client needs have been bound.
+ */
+bool fake_client_is_ready(struct fake_client *client);
+
+struct fake_view *fake_view_create(struct fake_client *client,
+		const char *app_id, const char *title);
+void fake_view_destroy(struct fake_view *view);
+
+/**
+ * The protocol object id of the view's wl_surface, to find its wl_resource
+ * on the compositor side.
+ */
+uint32_t fake_view_get_surface_id(struct fake_view *view);
+
+/**
+ * Whether the view has answered its first configure, i.e. it is mapped.
+ */
+bool fake_view_is_mapped(struct fake_view *view);
+
+#endif
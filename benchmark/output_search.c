@@ -0,0 +1,250 @@
+/*
+ * Headless benchmark of the search for a working output configuration.
+ *
+ * Runs the compositor on the headless backend with a number of virtual
+ * outputs, each given a list of fixed modes. Backend tests are replaced by a
+ * model of a constrained GPU: the enabled outputs share a scanout bandwidth
+ * budget, 10 bit render formats are rejected and odd outputs cannot do
+ * adaptive sync. The preferred modes do not fit the budget together, so every
+ * test-only apply of the output configs has to search.
+ *
+ * Each run times a cold search, with no known-good layout cached, and a warm
+ * one that reuses the layout the cold search found.
+ */
+#include <drm_fourcc.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wlr/backend.h>
+#include <wlr/config.h>
+#include <wlr/types/wlr_output.h>
+#include <wlr/types/wlr_output_swapchain_manager.h>
+#include <wlr/util/log.h>
+#include "bench.h"
+#include "list.h"
+#include "log.h"
+#include "sway/commands.h"
+#include "sway/config.h"
+#include "sway/desktop/transaction.h"
+#include "sway/output.h"
+#include "sway/server.h"
+#include "sway/tree/root.h"
+
+static const int mode_sizes[][2] = {
+	{ 3840, 2160 }, { 3440, 1440 }, { 2560, 1440 }, { 2560, 1080 },
+	{ 1920, 1200 }, { 1920, 1080 }, { 1680, 1050 }, { 1600, 900 },
+	{ 1440, 900 }, { 1366, 768 }, { 1280, 1024 }, { 1280, 720 },
+};
+static const int mode_refresh[] = { 144000, 120000, 60000 };
+
+// Scanout bandwidth the GPU model allows for each output, in pixels per second
+#define BANDWIDTH_PER_OUTPUT ((int64_t)1920 * 1080 * 60)
+
+static int64_t bandwidth_budget = 0;
+static uint64_t test_count = 0;
+static bool fixed_modes = false;
+
+// Linked with -Wl,--wrap=wlr_output_swapchain_manager_prepare
+bool __real_wlr_output_swapchain_manager_prepare(
+	struct wlr_output_swapchain_manager *manager,
+	const struct wlr_backend_output_state *states, size_t states_len);
+
+static bool gpu_model_test(const struct wlr_backend_output_state *states,
+		size_t states_len) {
+	int64_t bandwidth = 0;
+	for (size_t i = 0; i < states_len; ++i) {
+		const struct wlr_output_state *state = &states[i].base;
+		struct wlr_output *output = states[i].output;
+		bool enabled = (state->committed & WLR_OUTPUT_STATE_ENABLED) ?
+			state->enabled : output->enabled;
+		if (!enabled) {
+			continue;
+		}
+		if ((state->committed & WLR_OUTPUT_STATE_RENDER_FORMAT) &&
+				(state->render_format == DRM_FORMAT_XRGB2101010 ||
+				state->render_format == DRM_FORMAT_XBGR2101010)) {
+			return false;
+		}
+		if ((state->committed & WLR_OUTPUT_STATE_ADAPTIVE_SYNC_ENABLED) &&
+				state->adaptive_sync_enabled && i % 2 == 1) {
+			return false;
+		}
+		int64_t width = output->width, height = output->height;
+		int64_t refresh = output->refresh;
+		if (!(state->committed & WLR_OUTPUT_STATE_MODE)) {
+			// Keeps the current mode
+		} else if (state->mode_type == WLR_OUTPUT_STATE_MODE_CUSTOM) {
+			width = state->custom_mode.width;
+			height = state->custom_mode.height;
+			refresh = state->custom_mode.refresh;
+		} else if (state->mode) {
+			width = state->mode->width;
+			height = state->mode->height;
+			refresh = state->mode->refresh;
+		}
+		bandwidth += width * height * (refresh ? refresh : 60000) / 1000;
+	}
+	return bandwidth <= bandwidth_budget;
+}
+
+bool __wrap_wlr_output_swapchain_manager_prepare(
+		struct wlr_output_swapchain_manager *manager,
+		const struct wlr_backend_output_state *states, size_t states_len) {
+	++test_count;
+	if (!gpu_model_test(states, states_len)) {
+		return false;
+	}
+	// The headless backend only takes custom modes, so once the fixed modes
+	// are added the model has the last word
+	return fixed_modes || __real_wlr_output_swapchain_manager_prepare(
+		manager, states, states_len);
+}
+
+static void add_modes(struct wlr_output *output, int n_modes) {
+	int n = 0;
+	for (size_t s = 0; s < sizeof(mode_sizes) / sizeof(mode_sizes[0]); ++s) {
+		for (size_t r = 0; r < sizeof(mode_refresh) / sizeof(mode_refresh[0]); ++r) {
+			if (n == n_modes) {
+				return;
+			}
+			// Freed by wlroots along with the output
+			struct wlr_output_mode *mode = calloc(1, sizeof(*mode));
+			if (!mode) {
+				sway_abort("Unable to allocate output mode");
+			}
+			mode->width = mode_sizes[s][0];
+			mode->height = mode_sizes[s][1];
+			mode->refresh = mode_refresh[r];
+			mode->preferred = n == 0;
+			wl_list_insert(output->modes.prev, &mode->link);
+			++n;
+		}
+	}
+}
+
+static int64_t apply_configs_ns(uint64_t *tests) {
+	struct timespec start, end;
+	test_count = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (!apply_output_configs((struct output_config **)config->output_configs->items,
+			config->output_configs->length, true, true)) {
+		sway_log(SWAY_ERROR, "No working output configuration found");
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	*tests += test_count;
+	return (int64_t)(end.tv_sec - start.tv_sec) * 1000000000 +
+		(end.tv_nsec - start.tv_nsec);
+}
+
+static const char usage[] =
+	"Usage: scroll-bench-output-search [options]\n"
+	"\n"
+	"  -o <count>   Number of headless outputs (default: 4).\n"
+	"  -m <count>   Modes per output (default: 12).\n"
+	"  -r <count>   Number of runs (default: 20).\n"
+	"  -h           Show help message and quit.\n";
+
+int main(int argc, char **argv) {
+	char *outputs = "4";
+	int n_modes = 12, runs = 20;
+	int c;
+	while ((c = getopt(argc, argv, "o:m:r:h")) != -1) {
+		switch (c) {
+		case 'o':
+			outputs = optarg;
+			break;
+		case 'm':
+			n_modes = atoi(optarg);
+			break;
+		case 'r':
+			runs = atoi(optarg);
+			break;
+		case 'h':
+			printf("%s", usage);
+			return EXIT_SUCCESS;
+		default:
+			fprintf(stderr, "%s", usage);
+			return EXIT_FAILURE;
+		}
+	}
+	int n_outputs = atoi(outputs);
+	int max_modes = sizeof(mode_sizes) / sizeof(mode_sizes[0]) *
+		sizeof(mode_refresh) / sizeof(mode_refresh[0]);
+	if (optind != argc || n_outputs < 1 || n_modes < 1 ||
+			n_modes > max_modes || runs < 1) {
+		fprintf(stderr, "%s", usage);
+		return EXIT_FAILURE;
+	}
+	if (!getenv("XDG_RUNTIME_DIR")) {
+		fprintf(stderr, "XDG_RUNTIME_DIR is not set in the environment.\n");
+		return EXIT_FAILURE;
+	}
+
+	sway_log_init(SWAY_ERROR, sway_terminate);
+	wlr_log_init(WLR_ERROR, NULL);
+
+	setenv("WLR_BACKENDS", "headless", true);
+	setenv("WLR_RENDERER", "pixman", true);
+	setenv("WLR_HEADLESS_OUTPUTS", outputs, true);
+	setenv("WLR_LIBINPUT_NO_DEVICES", "1", true);
+
+	bandwidth_budget = n_outputs * BANDWIDTH_PER_OUTPUT;
+	if (!server_init(&server)) {
+		return EXIT_FAILURE;
+	}
+	if (!load_main_config("/dev/null", false, false)) {
+		return EXIT_FAILURE;
+	}
+#if WLR_HAS_XWAYLAND
+	config->xwayland = XWAYLAND_MODE_DISABLED;
+#endif
+	if (!server_start(&server)) {
+		return EXIT_FAILURE;
+	}
+	config->active = true;
+	force_modeset();
+	run_deferred_commands();
+	transaction_commit_dirty();
+
+	// Ask for what the model cannot do, so the search has to step down
+	list_t *res_list = execute_command(
+		"output * render_bit_depth 10 adaptive_sync on", NULL, NULL);
+	while (res_list->length) {
+		free_cmd_results(res_list->items[0]);
+		list_del(res_list, 0);
+	}
+	list_free(res_list);
+
+	struct sway_output *output;
+	wl_list_for_each(output, &root->all_outputs, link) {
+		if (output != root->fallback_output) {
+			add_modes(output->wlr_output, n_modes);
+			output->wlr_output->adaptive_sync_supported = true;
+		}
+	}
+	fixed_modes = true;
+
+	struct bench_histogram cold = { .name = "cold search (nothing cached)" };
+	struct bench_histogram warm = { .name = "warm search (cached layout)" };
+	uint64_t cold_tests = 0, warm_tests = 0;
+	for (int i = 0; i < runs; ++i) {
+		output_cache_clear();
+		bench_histogram_add(&cold, apply_configs_ns(&cold_tests));
+		bench_histogram_add(&warm, apply_configs_ns(&warm_tests));
+	}
+
+	printf("%d outputs, %d modes each, %d runs\n\n", n_outputs, n_modes, runs);
+	printf("%s: %.1f tests per run\n", cold.name, (double)cold_tests / runs);
+	bench_histogram_print(&cold);
+	printf("\n%s: %.1f tests per run\n", warm.name, (double)warm_tests / runs);
+	bench_histogram_print(&warm);
+	bench_histogram_finish(&cold);
+	bench_histogram_finish(&warm);
+
+	output_cache_clear();
+	server_fini(&server);
+	root_destroy(root);
+	root = NULL;
+	free_config(config);
+	return EXIT_SUCCESS;
+}
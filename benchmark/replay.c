@@ -0,0 +1,571 @@
+/*
+ * Headless replay of a session recorded with -Drecord=<path>.
+ *
+ * Runs the full compositor on the headless backend with the pixman renderer
+ * and an in-process fake client, then feeds it the recorded IPC commands and
+ * view map/unmap events back to back. Fake views answer every configure
+ * immediately, so the reported latencies are the compositor's own: the time
+ * to execute each command, and the commit, wait and apply time of each
+ * transaction (see struct sway_transaction_timings).
+ */
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <wlr/types/wlr_compositor.h>
+#include <wlr/util/log.h>
+#include "bench.h"
+#include "client.h"
+#include "list.h"
+#include "log.h"
+#include "util.h"
+#include "sway/commands.h"
+#include "sway/config.h"
+#include "sway/desktop/transaction.h"
+#include "sway/server.h"
+#include "sway/tree/container.h"
+#include "sway/tree/root.h"
+#include "sway/tree/view.h"
+
+// How long to wait for the compositor to settle after each event
+#define SETTLE_TIMEOUT_MS 5000
+
+static const char usage[] =
+	"Usage: scroll-bench-replay [options] <recording>\n"
+	"\n"
+	"  -c <config>  Config file to load (default: none).\n"
+	"  -o <n>       Number of headless outputs (default: 1).\n"
+	"  -s <WxH>     Output size (default: 1920x1080).\n"
+	"  -a           Keep animations enabled.\n"
+	"  -h           Show this help message and quit.\n"
+	"\n"
+	"Events are replayed back to back, waiting for the layout to settle in\n"
+	"between; the recorded timestamps are ignored.\n";
+
+enum replay_event_type {
+	REPLAY_COMMAND,
+	REPLAY_MAP,
+	REPLAY_UNMAP,
+};
+
+struct replay_event {
+	enum replay_event_type type;
+	size_t con_id; // map and unmap, as recorded
+	char *app_id, *title; // map
+	char *command; // command
+};
+
+struct replay_view {
+	size_t recorded_id;
+	struct fake_view *fake;
+};
+
+struct replay {
+	list_t *events; // struct replay_event
+	list_t *views; // struct replay_view
+
+	struct wl_client *wl_client;
+	struct fake_client *client;
+
+	struct wl_listener transaction_applied;
+	size_t transactions, timeouts;
+
+	struct bench_histogram command;
+	struct bench_histogram map;
+	struct bench_histogram unmap;
+	struct bench_histogram txn_commit;
+	struct bench_histogram txn_wait;
+	struct bench_histogram txn_apply;
+};
+
+static void event_destroy(struct replay_event *event) {
+	free(event->app_id);
+	free(event->title);
+	free(event->command);
+	free(event);
+}
+
+static char *next_field(char **state) {
+	char *field = *state;
+	if (!field) {
+		return NULL;
+	}
+	char *tab = strchr(field, '\t');
+	if (tab) {
+		*tab = '\0';
+		*state = tab + 1;
+	} else {
+		*state = NULL;
+	}
+	return field;
+}
+
+static struct replay_event *parse_event(char *line) {
+	char *state = line;
+	char *time = next_field(&state);
+	char *type = next_field(&state);
+	if (!time || !type) {
+		return NULL;
+	}
+
+	struct replay_event *event = calloc(1, sizeof(struct replay_event));
+	if (!event) {
+		return NULL;
+	}
+	if (strcmp(type, "command") == 0 && state) {
+		event->type = REPLAY_COMMAND;
+		event->command = strdup(state);
+	} else if (strcmp(type, "map") == 0) {
+		char *id = next_field(&state);
+		char *app_id = next_field(&state);
+		char *title = next_field(&state);
+		if (!id) {
+			goto error;
+		}
+		event->type = REPLAY_MAP;
+		event->con_id = strtoul(id, NULL, 10);
+		event->app_id = strdup(app_id ? app_id : "");
+		event->title = strdup(title ? title : "");
+	} else if (strcmp(type, "unmap") == 0) {
+		char *id = next_field(&state);
+		if (!id) {
+			goto error;
+		}
+		event->type = REPLAY_UNMAP;
+		event->con_id = strtoul(id, NULL, 10);
+	} else {
+		goto error;
+	}
+	return event;
+
+error:
+	free(event);
+	return NULL;
+}
+
+static bool load_recording(struct replay *replay, const char *path) {
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		sway_log_errno(SWAY_ERROR, "Unable to open %s", path);
+		return false;
+	}
+	char *line = NULL;
+	size_t line_size = 0;
+	ssize_t nread;
+	int lineno = 0;
+	while ((nread = getline(&line, &line_size, f)) != -1) {
+		++lineno;
+		if (nread > 0 && line[nread - 1] == '\n') {
+			line[nread - 1] = '\0';
+		}
+		if (line[0] == '#' || line[0] == '\0') {
+			continue;
+		}
+		struct replay_event *event = parse_event(line);
+		if (!event) {
+			sway_log(SWAY_ERROR, "%s:%d: invalid event, skipping",
+					path, lineno);
+			continue;
+		}
+		list_add(replay->events, event);
+	}
+	free(line);
+	fclose(f);
+	return true;
+}
+
+static void handle_transaction_applied(struct wl_listener *listener,
+		void *data) {
+	struct replay *replay =
+		wl_container_of(listener, replay, transaction_applied);
+	struct sway_transaction_timings *timings = data;
+	++replay->transactions;
+	if (timings->timed_out) {
+		++replay->timeouts;
+	}
+	bench_histogram_add(&replay->txn_commit, timings->commit_ns);
+	bench_histogram_add(&replay->txn_wait, timings->wait_ns);
+	bench_histogram_add(&replay->txn_apply, timings->apply_ns);
+}
+
+static struct sway_view *replay_view_get_view(struct replay *replay,
+		struct replay_view *view) {
+	struct wl_resource *resource = wl_client_get_object(replay->wl_client,
+			fake_view_get_surface_id(view->fake));
+	if (!resource) {
+		return NULL;
+	}
+	return view_from_wlr_surface(wlr_surface_from_resource(resource));
+}
+
+static struct replay_view *replay_find_view(struct replay *replay,
+		size_t recorded_id) {
+	for (int i = 0; i < replay->views->length; ++i) {
+		struct replay_view *view = replay->views->items[i];
+		if (view->recorded_id == recorded_id) {
+			return view;
+		}
+	}
+	return NULL;
+}
+
+static bool transactions_idle(void) {
+	return !server.queued_transaction && !server.pending_transaction &&
+		server.dirty_nodes->length == 0;
+}
+
+/**
+ * Runs both ends of the connection until the layout settles, and until
+ * view_mapped (if given) has a container.
+ */
+static bool replay_settle(struct replay *replay,
+		struct replay_view *view_mapped) {
+	struct timespec start, now, diff;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while (true) {
+		wl_display_flush_clients(server.wl_display);
+		if (!fake_client_dispatch(replay->client)) {
+			sway_log(SWAY_ERROR, "Fake client disconnected");
+			return false;
+		}
+		// Returns as soon as the fake client has sent something, the timeout
+		// only matters when the compositor is waiting on its own timers
+		wl_event_loop_dispatch(server.wl_event_loop, 1);
+
+		if (transactions_idle()) {
+			if (!view_mapped) {
+				return true;
+			}
+			struct sway_view *view = replay_view_get_view(replay, view_mapped);
+			if (view && view->container) {
+				return true;
+			}
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		timespec_sub(&diff, &now, &start);
+		if (timespec_to_msec(&diff) > SETTLE_TIMEOUT_MS) {
+			sway_log(SWAY_ERROR, "Compositor did not settle within %dms",
+					SETTLE_TIMEOUT_MS);
+			return true;
+		}
+	}
+}
+
+/**
+ * Container ids differ between the recording and the replay, so criteria
+ * such as [con_id=42] are rewritten to the id of the matching replayed view.
+ */
+static char *rewrite_con_ids(struct replay *replay, const char *command) {
+	static const char key[] = "con_id=";
+	size_t size = strlen(command) + 1;
+	char *result = malloc(size);
+	if (!result) {
+		return NULL;
+	}
+	size_t len = 0;
+	const char *p = command;
+	const char *match;
+	while ((match = strstr(p, key))) {
+		match += strlen(key);
+		const char *digits = *match == '"' ? match + 1 : match;
+		char *end;
+		size_t recorded_id = strtoul(digits, &end, 10);
+		struct replay_view *view = end != digits ?
+			replay_find_view(replay, recorded_id) : NULL;
+		struct sway_view *sway_view = view ?
+			replay_view_get_view(replay, view) : NULL;
+
+		// Copy up to the id, then either the new id or the original one
+		size_t prefix = digits - p;
+		char id[32];
+		const char *replacement = digits;
+		size_t replacement_len = end - digits;
+		if (sway_view && sway_view->container) {
+			replacement_len = snprintf(id, sizeof(id), "%zu",
+					sway_view->container->node.id);
+			replacement = id;
+		}
+		size += replacement_len;
+		char *grown = realloc(result, size);
+		if (!grown) {
+			free(result);
+			return NULL;
+		}
+		result = grown;
+		memcpy(result + len, p, prefix);
+		len += prefix;
+		memcpy(result + len, replacement, replacement_len);
+		len += replacement_len;
+		p = end;
+	}
+	strcpy(result + len, p);
+	return result;
+}
+
+static void replay_command(struct replay *replay, const char *command) {
+	char *cmd = rewrite_con_ids(replay, command);
+	if (!cmd) {
+		return;
+	}
+
+	// Mirrors IPC_COMMAND in ipc-server.c
+	struct bench_timer timer;
+	struct bench_result result = {0};
+	bench_timer_start(&timer);
+	list_t *res_list = execute_command(cmd, NULL, NULL);
+	if (modeset_is_pending()) {
+		force_modeset();
+	}
+	transaction_commit_dirty();
+	bench_timer_stop(&timer, &result, 1);
+	bench_histogram_add(&replay->command, result.ns);
+
+	for (int i = 0; i < res_list->length; ++i) {
+		struct cmd_results *results = res_list->items[i];
+		if (results->status != CMD_SUCCESS) {
+			sway_log(SWAY_INFO, "'%s': %s", cmd,
+					results->error ? results->error : "failed");
+		}
+		free_cmd_results(results);
+	}
+	list_free(res_list);
+	free(cmd);
+
+	replay_settle(replay, NULL);
+}
+
+static void replay_map(struct replay *replay, struct replay_event *event) {
+	struct replay_view *view = calloc(1, sizeof(struct replay_view));
+	if (!view) {
+		return;
+	}
+	view->recorded_id = event->con_id;
+
+	struct bench_timer timer;
+	struct bench_result result = {0};
+	bench_timer_start(&timer);
+	view->fake = fake_view_create(replay->client, event->app_id,
+			event->title);
+	if (!view->fake) {
+		free(view);
+		return;
+	}
+	list_add(replay->views, view);
+	replay_settle(replay, view);
+	bench_timer_stop(&timer, &result, 1);
+	bench_histogram_add(&replay->map, result.ns);
+}
+
+static void replay_unmap(struct replay *replay, struct replay_event *event) {
+	struct replay_view *view = replay_find_view(replay, event->con_id);
+	if (!view) {
+		sway_log(SWAY_INFO, "Unmap of unknown view %zu", event->con_id);
+		return;
+	}
+	list_del(replay->views, list_find(replay->views, view));
+
+	struct bench_timer timer;
+	struct bench_result result = {0};
+	bench_timer_start(&timer);
+	fake_view_destroy(view->fake);
+	replay_settle(replay, NULL);
+	bench_timer_stop(&timer, &result, 1);
+	bench_histogram_add(&replay->unmap, result.ns);
+	free(view);
+}
+
+static bool replay_connect(struct replay *replay) {
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+		sway_log_errno(SWAY_ERROR, "socketpair failed");
+		return false;
+	}
+	replay->wl_client = wl_client_create(server.wl_display, fds[0]);
+	if (!replay->wl_client) {
+		sway_log(SWAY_ERROR, "Unable to create wl_client");
+		close(fds[0]);
+		close(fds[1]);
+		return false;
+	}
+	replay->client = fake_client_create(fds[1]);
+	if (!replay->client) {
+		close(fds[1]);
+		return false;
+	}
+
+	struct timespec start, now, diff;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while (!fake_client_is_ready(replay->client)) {
+		wl_display_flush_clients(server.wl_display);
+		if (!fake_client_dispatch(replay->client)) {
+			return false;
+		}
+		wl_event_loop_dispatch(server.wl_event_loop, 1);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		timespec_sub(&diff, &now, &start);
+		if (timespec_to_msec(&diff) > SETTLE_TIMEOUT_MS) {
+			sway_log(SWAY_ERROR, "Fake client is missing globals");
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char **argv) {
+	char *config_path = "/dev/null";
+	char *outputs = "1";
+	int width = 1920, height = 1080;
+	bool animations = false;
+
+	int c;
+	while ((c = getopt(argc, argv, "c:o:s:ah")) != -1) {
+		switch (c) {
+		case 'c':
+			config_path = optarg;
+			break;
+		case 'o':
+			outputs = optarg;
+			break;
+		case 's':
+			if (sscanf(optarg, "%dx%d", &width, &height) != 2) {
+				fprintf(stderr, "%s", usage);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'a':
+			animations = true;
+			break;
+		case 'h':
+			printf("%s", usage);
+			return EXIT_SUCCESS;
+		default:
+			fprintf(stderr, "%s", usage);
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind != argc - 1 || atoi(outputs) < 1 || width < 64 || height < 64) {
+		fprintf(stderr, "%s", usage);
+		return EXIT_FAILURE;
+	}
+	if (!getenv("XDG_RUNTIME_DIR")) {
+		fprintf(stderr, "XDG_RUNTIME_DIR is not set in the environment.\n");
+		return EXIT_FAILURE;
+	}
+
+	sway_log_init(SWAY_ERROR, sway_terminate);
+	wlr_log_init(WLR_ERROR, NULL);
+
+	struct replay replay = {
+		.events = create_list(),
+		.views = create_list(),
+		.command = { .name = "command (execute and commit)" },
+		.map = { .name = "map (until mapped and settled)" },
+		.unmap = { .name = "unmap (until settled)" },
+		.txn_commit = { .name = "transaction commit" },
+		.txn_wait = { .name = "transaction wait" },
+		.txn_apply = { .name = "transaction apply" },
+	};
+	if (!load_recording(&replay, argv[optind])) {
+		return EXIT_FAILURE;
+	}
+
+	setenv("WLR_BACKENDS", "headless", true);
+	setenv("WLR_RENDERER", "pixman", true);
+	setenv("WLR_HEADLESS_OUTPUTS", outputs, true);
+	setenv("WLR_LIBINPUT_NO_DEVICES", "1", true);
+
+	if (!server_init(&server)) {
+		return EXIT_FAILURE;
+	}
+	if (!load_main_config(config_path, false, false)) {
+		return EXIT_FAILURE;
+	}
+#if WLR_HAS_XWAYLAND
+	config->xwayland = XWAYLAND_MODE_DISABLED;
+#endif
+	if (!server_start(&server)) {
+		return EXIT_FAILURE;
+	}
+	config->active = true;
+	force_modeset();
+	run_deferred_commands();
+	run_deferred_bindings();
+	transaction_commit_dirty();
+
+	replay.transaction_applied.notify = handle_transaction_applied;
+	wl_signal_add(&server.events.transaction_applied,
+			&replay.transaction_applied);
+
+	if (!replay_connect(&replay)) {
+		return EXIT_FAILURE;
+	}
+
+	// Set up the environment without counting it
+	char setup[64];
+	snprintf(setup, sizeof(setup), "output * mode --custom %dx%d",
+			width, height);
+	replay_command(&replay, setup);
+	if (!animations) {
+		replay_command(&replay, "animations enabled no");
+	}
+	bench_histogram_finish(&replay.command);
+	bench_histogram_finish(&replay.txn_commit);
+	bench_histogram_finish(&replay.txn_wait);
+	bench_histogram_finish(&replay.txn_apply);
+	replay.transactions = replay.timeouts = 0;
+
+	struct timespec start, end, diff;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < replay.events->length; ++i) {
+		struct replay_event *event = replay.events->items[i];
+		switch (event->type) {
+		case REPLAY_COMMAND:
+			replay_command(&replay, event->command);
+			break;
+		case REPLAY_MAP:
+			replay_map(&replay, event);
+			break;
+		case REPLAY_UNMAP:
+			replay_unmap(&replay, event);
+			break;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespec_sub(&diff, &end, &start);
+
+	printf("%d events, %zu transactions (%zu timed out) in %" PRId64 "ms\n\n",
+			replay.events->length, replay.transactions, replay.timeouts,
+			timespec_to_msec(&diff));
+	struct bench_histogram *histograms[] = {
+		&replay.command, &replay.map, &replay.unmap,
+		&replay.txn_commit, &replay.txn_wait, &replay.txn_apply,
+	};
+	for (size_t i = 0; i < sizeof(histograms) / sizeof(histograms[0]); ++i) {
+		bench_histogram_print(histograms[i]);
+		bench_histogram_finish(histograms[i]);
+		printf("\n");
+	}
+
+	wl_list_remove(&replay.transaction_applied.link);
+	for (int i = 0; i < replay.views->length; ++i) {
+		struct replay_view *view = replay.views->items[i];
+		fake_view_destroy(view->fake);
+		free(view);
+	}
+	list_free(replay.views);
+	fake_client_destroy(replay.client);
+	for (int i = 0; i < replay.events->length; ++i) {
+		event_destroy(replay.events->items[i]);
+	}
+	list_free(replay.events);
+
+	server_fini(&server);
+	root_destroy(root);
+	root = NULL;
+	free_config(config);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,390 @@
+/*
+ * Headless benchmark for the scene graph in sway/tree/scene.
+ *
+ * Builds a synthetic scene of N outputs with M workspaces each, every
+ * workspace holding K containers made of a shadow, four border rects, a title
+ * bar (background, borders and text) and a content buffer, laid out in
+ * columns the way the scrolling layout does. It then measures node position
+ * storms, hit-tests and output state building, reporting ns/op and heap
+ * allocations per operation.
+ */
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wlr/types/wlr_damage_ring.h>
+#include <wlr/types/wlr_output.h>
+#include "bench.h"
+#include "log.h"
+#include "sway/tree/node.h"
+#include "sway/tree/root.h"
+#include "sway/tree/scene.h"
+
+static const int BORDER = 2;
+static const int TITLE_HEIGHT = 24;
+static const int CORNER_RADIUS = 8;
+
+static const float border_color[4] = { 0.2f, 0.4f, 0.8f, 1.0f };
+static const float title_color[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
+static const float shadow_color[4] = { 0.0f, 0.0f, 0.0f, 0.5f };
+
+struct bench_container {
+	struct sway_scene_tree *tree;
+	double x, y;
+};
+
+struct bench_output {
+	struct wlr_output *wlr_output;
+	struct sway_scene_output *scene_output;
+	struct sway_scene_tree *tree;
+	struct sway_scene_tree **workspaces;
+	struct bench_container *containers; // of the visible workspace
+	int x;
+};
+
+struct bench_scene {
+	struct bench_env env;
+	int n_outputs, n_workspaces, n_containers;
+	int width, height;
+	bool shadows;
+	struct bench_output *outputs;
+	struct wlr_buffer *content_buffer;
+	struct wlr_buffer *text_buffer;
+};
+
+static void add_rect(struct sway_scene_tree *parent, int x, int y,
+		int width, int height, const float color[static 4]) {
+	struct sway_scene_rect *rect =
+		sway_scene_rect_create(parent, width, height, color);
+	sway_scene_node_set_position(&rect->node, x, y);
+}
+
+static struct sway_scene_tree *add_container(struct bench_scene *scene,
+		struct sway_scene_tree *parent, int x, int y, int width, int height) {
+	bool failed = false;
+	struct sway_scene_tree *tree = alloc_scene_tree(parent, &failed);
+	if (scene->shadows) {
+		alloc_scene_shadow(tree, width, height, CORNER_RADIUS, 20.0f,
+			shadow_color, &failed);
+	}
+
+	struct sway_scene_tree *border = alloc_scene_tree(tree, &failed);
+	struct sway_scene_tree *title = alloc_scene_tree(tree, &failed);
+	if (failed) {
+		sway_abort("Failed to allocate container scene nodes");
+	}
+
+	// Borders
+	add_rect(border, 0, 0, width, BORDER, border_color);
+	add_rect(border, 0, height - BORDER, width, BORDER, border_color);
+	add_rect(border, 0, BORDER, BORDER, height - 2 * BORDER, border_color);
+	add_rect(border, width - BORDER, BORDER, BORDER, height - 2 * BORDER,
+		border_color);
+
+	// Title bar
+	int inner_width = width - 2 * BORDER;
+	add_rect(title, BORDER, BORDER, inner_width, TITLE_HEIGHT, title_color);
+	add_rect(title, BORDER, BORDER, inner_width, 1, border_color);
+	add_rect(title, BORDER, BORDER + TITLE_HEIGHT - 1, inner_width, 1,
+		border_color);
+	add_rect(title, BORDER, BORDER, 1, TITLE_HEIGHT, border_color);
+	add_rect(title, BORDER + inner_width - 1, BORDER, 1, TITLE_HEIGHT,
+		border_color);
+	struct sway_scene_buffer *text =
+		sway_scene_buffer_create(title, scene->text_buffer);
+	sway_scene_node_set_position(&text->node, BORDER + 8, BORDER + 2);
+
+	// Content
+	struct sway_scene_buffer *content =
+		sway_scene_buffer_create(tree, scene->content_buffer);
+	sway_scene_buffer_set_dest_size(content, inner_width,
+		height - TITLE_HEIGHT - 2 * BORDER);
+	sway_scene_node_set_position(&content->node, BORDER, BORDER + TITLE_HEIGHT);
+
+	sway_scene_node_set_position(&tree->node, x, y);
+	return tree;
+}
+
+static void container_geometry(struct bench_scene *scene, int idx,
+		int *x, int *y, int *width, int *height) {
+	// Columns of half the output width holding two windows each
+	*width = scene->width / 2;
+	*height = scene->height / 2;
+	*x = (idx / 2) * *width;
+	*y = (idx % 2) * *height;
+}
+
+static void build_scene(struct bench_scene *scene) {
+	scene->content_buffer = bench_buffer_create(256, 256, 0xFF303030);
+	scene->text_buffer = bench_buffer_create(200, 20, 0xFFEEEEEE);
+	if (!scene->content_buffer || !scene->text_buffer) {
+		sway_abort("Failed to allocate buffers");
+	}
+
+	scene->outputs = calloc(scene->n_outputs, sizeof(struct bench_output));
+	for (int o = 0; o < scene->n_outputs; ++o) {
+		struct bench_output *output = &scene->outputs[o];
+		output->x = o * scene->width;
+		output->wlr_output = bench_env_add_output(&scene->env,
+			scene->width, scene->height, output->x, 0);
+		if (!output->wlr_output) {
+			sway_abort("Failed to create headless output");
+		}
+		output->scene_output = sway_scene_output_create(root->root_scene,
+			output->wlr_output);
+		sway_scene_output_set_position(output->scene_output, output->x, 0);
+
+		bool failed = false;
+		output->tree = alloc_scene_tree(root->layers.tiling, &failed);
+		if (failed) {
+			sway_abort("Failed to allocate output tree");
+		}
+		output->tree->node.info.wlr_output = output->wlr_output;
+		sway_scene_node_set_position(&output->tree->node, output->x, 0);
+
+		output->workspaces = calloc(scene->n_workspaces,
+			sizeof(struct sway_scene_tree *));
+		output->containers = calloc(scene->n_containers,
+			sizeof(struct bench_container));
+		for (int w = 0; w < scene->n_workspaces; ++w) {
+			struct sway_scene_tree *ws = alloc_scene_tree(output->tree, &failed);
+			if (failed) {
+				sway_abort("Failed to allocate workspace tree");
+			}
+			output->workspaces[w] = ws;
+			for (int c = 0; c < scene->n_containers; ++c) {
+				int x, y, width, height;
+				container_geometry(scene, c, &x, &y, &width, &height);
+				struct sway_scene_tree *con =
+					add_container(scene, ws, x, y, width, height);
+				if (w == 0) {
+					output->containers[c] = (struct bench_container){
+						.tree = con,
+						.x = x,
+						.y = y,
+					};
+				}
+			}
+			// Like sway, only the visible workspace is enabled
+			sway_scene_node_set_enabled(&ws->node, w == 0);
+		}
+	}
+}
+
+static void destroy_scene(struct bench_scene *scene) {
+	for (int o = 0; o < scene->n_outputs; ++o) {
+		struct bench_output *output = &scene->outputs[o];
+		sway_scene_node_destroy(&output->tree->node);
+		sway_scene_output_destroy(output->scene_output);
+		free(output->workspaces);
+		free(output->containers);
+	}
+	free(scene->outputs);
+	wlr_buffer_drop(scene->content_buffer);
+	wlr_buffer_drop(scene->text_buffer);
+}
+
+static void render_output(struct bench_output *output,
+		struct bench_result *result) {
+	struct wlr_output_state state;
+	wlr_output_state_init(&state);
+	struct bench_timer timer;
+	bench_timer_start(&timer);
+	bool ok = sway_scene_output_build_state(output->scene_output, &state, NULL);
+	bench_timer_stop(&timer, result, 1);
+	if (ok) {
+		wlr_output_commit_state(output->wlr_output, &state);
+	}
+	wlr_output_state_finish(&state);
+}
+
+static void bench_position_storm(struct bench_scene *scene, int iterations) {
+	struct bench_result result = { .name = "container set_position" };
+	for (int i = 0; i < iterations; ++i) {
+		double dx = i % 2 == 0 ? 1 : -1;
+		for (int o = 0; o < scene->n_outputs; ++o) {
+			struct bench_output *output = &scene->outputs[o];
+			struct bench_timer timer;
+			bench_timer_start(&timer);
+			for (int c = 0; c < scene->n_containers; ++c) {
+				struct bench_container *con = &output->containers[c];
+				con->x += dx;
+				sway_scene_node_set_position(&con->tree->node, con->x, con->y);
+			}
+			bench_timer_stop(&timer, &result, scene->n_containers);
+		}
+	}
+	bench_print_result(&result);
+}
+
+static void bench_workspace_scroll(struct bench_scene *scene, int iterations) {
+	struct bench_result result = { .name = "workspace set_position" };
+	for (int i = 0; i < iterations; ++i) {
+		// Scroll the visible workspace by a column and back
+		double x = i % 2 == 0 ? -scene->width / 2.0 : 0;
+		for (int o = 0; o < scene->n_outputs; ++o) {
+			struct sway_scene_tree *ws = scene->outputs[o].workspaces[0];
+			struct bench_timer timer;
+			bench_timer_start(&timer);
+			sway_scene_node_set_position(&ws->node, x, 0);
+			bench_timer_stop(&timer, &result, 1);
+		}
+	}
+	bench_print_result(&result);
+}
+
+static void bench_workspace_switch(struct bench_scene *scene, int iterations) {
+	if (scene->n_workspaces < 2) {
+		return;
+	}
+	struct bench_result result = { .name = "workspace switch (enable)" };
+	for (int i = 0; i < iterations; ++i) {
+		for (int o = 0; o < scene->n_outputs; ++o) {
+			struct bench_output *output = &scene->outputs[o];
+			struct bench_timer timer;
+			bench_timer_start(&timer);
+			sway_scene_node_set_enabled(&output->workspaces[0]->node, i % 2 != 0);
+			sway_scene_node_set_enabled(&output->workspaces[1]->node, i % 2 == 0);
+			bench_timer_stop(&timer, &result, 1);
+		}
+	}
+	for (int o = 0; o < scene->n_outputs; ++o) {
+		sway_scene_node_set_enabled(&scene->outputs[o].workspaces[0]->node, true);
+		sway_scene_node_set_enabled(&scene->outputs[o].workspaces[1]->node, false);
+	}
+	bench_print_result(&result);
+}
+
+static void bench_hit_test(struct bench_scene *scene, int iterations) {
+	struct bench_result result = { .name = "node_at hit-test" };
+	uint32_t seed = 0x12345678;
+	int total_width = scene->width * scene->n_outputs;
+	int ops = 1000;
+	for (int i = 0; i < iterations; ++i) {
+		struct bench_timer timer;
+		bench_timer_start(&timer);
+		for (int j = 0; j < ops; ++j) {
+			double lx = bench_rand(&seed) % total_width;
+			double ly = bench_rand(&seed) % scene->height;
+			double nx, ny;
+			sway_scene_node_at(&root->root_scene->tree.node, lx, ly, &nx, &ny);
+		}
+		bench_timer_stop(&timer, &result, ops);
+	}
+	bench_print_result(&result);
+}
+
+static void bench_build_state(struct bench_scene *scene, int iterations) {
+	struct bench_result full = { .name = "build_state (full damage)" };
+	struct bench_result partial = { .name = "build_state (one container)" };
+	struct bench_result none = { .name = "build_state (no damage)" };
+	for (int i = 0; i < iterations; ++i) {
+		for (int o = 0; o < scene->n_outputs; ++o) {
+			struct bench_output *output = &scene->outputs[o];
+
+			wlr_damage_ring_add_whole(&output->scene_output->damage_ring);
+			render_output(output, &full);
+
+			struct bench_container *con = &output->containers[0];
+			con->x += i % 2 == 0 ? 1 : -1;
+			sway_scene_node_set_position(&con->tree->node, con->x, con->y);
+			render_output(output, &partial);
+
+			render_output(output, &none);
+		}
+		// Let the headless backend deliver frame and present events
+		wl_event_loop_dispatch(scene->env.event_loop, 0);
+	}
+	bench_print_result(&full);
+	bench_print_result(&partial);
+	bench_print_result(&none);
+}
+
+static const char usage[] =
+	"Usage: scroll-bench-scene [options...]\n"
+	"\n"
+	"  -o <n>   Number of outputs (default 2)\n"
+	"  -w <n>   Workspaces per output (default 4)\n"
+	"  -c <n>   Containers per workspace (default 50)\n"
+	"  -n <n>   Iterations per benchmark (default 100)\n"
+	"  -s <WxH> Output size (default 1920x1080)\n"
+	"  -S       Do not create shadow nodes\n"
+	"  -h       Show help message and quit\n";
+
+int main(int argc, char **argv) {
+	struct bench_scene scene = {
+		.n_outputs = 2,
+		.n_workspaces = 4,
+		.n_containers = 50,
+		.width = 1920,
+		.height = 1080,
+		.shadows = true,
+	};
+	int iterations = 100;
+
+	int c;
+	while ((c = getopt(argc, argv, "o:w:c:n:s:Sh")) != -1) {
+		switch (c) {
+		case 'o':
+			scene.n_outputs = atoi(optarg);
+			break;
+		case 'w':
+			scene.n_workspaces = atoi(optarg);
+			break;
+		case 'c':
+			scene.n_containers = atoi(optarg);
+			break;
+		case 'n':
+			iterations = atoi(optarg);
+			break;
+		case 's':
+			if (sscanf(optarg, "%dx%d", &scene.width, &scene.height) != 2) {
+				fprintf(stderr, "%s", usage);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'S':
+			scene.shadows = false;
+			break;
+		case 'h':
+			printf("%s", usage);
+			return EXIT_SUCCESS;
+		default:
+			fprintf(stderr, "%s", usage);
+			return EXIT_FAILURE;
+		}
+	}
+	if (scene.n_outputs < 1 || scene.n_workspaces < 1 ||
+			scene.n_containers < 1 || iterations < 1 ||
+			scene.width < 64 || scene.height < 64) {
+		fprintf(stderr, "%s", usage);
+		return EXIT_FAILURE;
+	}
+
+	sway_log_init(SWAY_ERROR, sway_terminate);
+	if (!bench_env_init(&scene.env)) {
+		bench_env_finish(&scene.env);
+		return EXIT_FAILURE;
+	}
+
+	struct bench_result create = { .name = "container create" };
+	struct bench_timer timer;
+	bench_timer_start(&timer);
+	build_scene(&scene);
+	bench_timer_stop(&timer, &create,
+		(uint64_t)scene.n_outputs * scene.n_workspaces * scene.n_containers);
+
+	printf("%d outputs (%dx%d), %d workspaces, %d containers per workspace%s\n\n",
+		scene.n_outputs, scene.width, scene.height, scene.n_workspaces,
+		scene.n_containers, scene.shadows ? ", shadows" : "");
+	bench_print_header();
+	bench_print_result(&create);
+	bench_position_storm(&scene, iterations);
+	bench_workspace_scroll(&scene, iterations);
+	bench_workspace_switch(&scene, iterations);
+	bench_hit_test(&scene, iterations);
+	bench_build_state(&scene, iterations);
+
+	destroy_scene(&scene);
+	bench_env_finish(&scene.env);
+	return EXIT_SUCCESS;
+}
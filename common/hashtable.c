@@ -0,0 +1,155 @@
+#include "hashtable.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "log.h"
+
+#define HASHTABLE_INITIAL_CAPACITY 64
+
+hashtable_t *create_hashtable(hashtable_hash_func_t hash,
+		hashtable_equal_func_t equal) {
+	hashtable_t *table = calloc(1, sizeof(hashtable_t));
+	if (!table) {
+		return NULL;
+	}
+	table->buckets = calloc(HASHTABLE_INITIAL_CAPACITY,
+			sizeof(struct hashtable_entry *));
+	if (!table->buckets) {
+		free(table);
+		return NULL;
+	}
+	table->capacity = HASHTABLE_INITIAL_CAPACITY;
+	table->hash = hash;
+	table->equal = equal;
+	return table;
+}
+
+void hashtable_free(hashtable_t *table) {
+	if (table == NULL) {
+		return;
+	}
+	for (size_t i = 0; i < table->capacity; ++i) {
+		struct hashtable_entry *entry = table->buckets[i];
+		while (entry) {
+			struct hashtable_entry *next = entry->next;
+			free(entry);
+			entry = next;
+		}
+	}
+	free(table->buckets);
+	free(table);
+}
+
+static void hashtable_resize(hashtable_t *table) {
+	if (table->length < table->capacity) {
+		return;
+	}
+	size_t capacity = table->capacity * 2;
+	struct hashtable_entry **buckets =
+		calloc(capacity, sizeof(struct hashtable_entry *));
+	if (!buckets) {
+		// Keep the current buckets: longer chains, still correct
+		sway_log(SWAY_ERROR, "Unable to grow hash table");
+		return;
+	}
+	for (size_t i = 0; i < table->capacity; ++i) {
+		struct hashtable_entry *entry = table->buckets[i];
+		while (entry) {
+			struct hashtable_entry *next = entry->next;
+			size_t index = table->hash(entry->key) & (capacity - 1);
+			entry->next = buckets[index];
+			buckets[index] = entry;
+			entry = next;
+		}
+	}
+	free(table->buckets);
+	table->buckets = buckets;
+	table->capacity = capacity;
+}
+
+void hashtable_insert(hashtable_t *table, const void *key, void *value) {
+	struct hashtable_entry *entry = malloc(sizeof(struct hashtable_entry));
+	if (!entry) {
+		sway_log(SWAY_ERROR, "Unable to allocate hash table entry");
+		return;
+	}
+	hashtable_resize(table);
+	size_t index = table->hash(key) & (table->capacity - 1);
+	// Append, so lookups of a shared key return the oldest entry first
+	struct hashtable_entry **link = &table->buckets[index];
+	while (*link) {
+		link = &(*link)->next;
+	}
+	entry->key = key;
+	entry->value = value;
+	entry->next = NULL;
+	*link = entry;
+	++table->length;
+}
+
+bool hashtable_remove(hashtable_t *table, const void *key, void *value) {
+	size_t index = table->hash(key) & (table->capacity - 1);
+	struct hashtable_entry **link = &table->buckets[index];
+	while (*link) {
+		struct hashtable_entry *entry = *link;
+		if (entry->value == value && table->equal(entry->key, key)) {
+			*link = entry->next;
+			free(entry);
+			--table->length;
+			return true;
+		}
+		link = &entry->next;
+	}
+	return false;
+}
+
+void *hashtable_find(hashtable_t *table, const void *key,
+		bool (*test)(void *value, void *data), void *data) {
+	size_t index = table->hash(key) & (table->capacity - 1);
+	for (struct hashtable_entry *entry = table->buckets[index]; entry;
+			entry = entry->next) {
+		if (table->equal(entry->key, key) &&
+				(!test || test(entry->value, data))) {
+			return entry->value;
+		}
+	}
+	return NULL;
+}
+
+uint32_t hashtable_hash_string(const void *key) {
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (const unsigned char *p = key; *p; ++p) {
+		hash ^= *p;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+bool hashtable_equal_string(const void *a, const void *b) {
+	return strcmp(a, b) == 0;
+}
+
+uint32_t hashtable_hash_string_nocase(const void *key) {
+	uint32_t hash = 2166136261u;
+	for (const unsigned char *p = key; *p; ++p) {
+		hash ^= tolower(*p);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+bool hashtable_equal_string_nocase(const void *a, const void *b) {
+	return strcasecmp(a, b) == 0;
+}
+
+uint32_t hashtable_hash_int(const void *key) {
+	// Fibonacci hashing, ids are sequential
+	uint64_t x = (uintptr_t)key;
+	return (x * 11400714819323198485ull) >> 32;
+}
+
+bool hashtable_equal_int(const void *a, const void *b) {
+	return a == b;
+}
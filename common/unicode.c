@@ -0,0 +1,75 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "unicode.h"
+
+size_t utf8_encode(char *str, uint32_t ch) {
+	size_t len = 0;
+	uint8_t first;
+
+	if (ch < 0x80) {
+		first = 0;
+		len = 1;
+	} else if (ch < 0x800) {
+		first = 0xc0;
+		len = 2;
+	} else if (ch < 0x10000) {
+		first = 0xe0;
+		len = 3;
+	} else {
+		first = 0xf0;
+		len = 4;
+	}
+
+	for (size_t i = len - 1; i > 0; --i) {
+		str[i] = (ch & 0x3f) | 0x80;
+		ch >>= 6;
+	}
+
+	str[0] = ch | first;
+	return len;
+}
+
+static const struct {
+	uint8_t mask;
+	uint8_t result;
+	int octets;
+} sizes[] = {
+	{ 0x80, 0x00, 1 },
+	{ 0xE0, 0xC0, 2 },
+	{ 0xF0, 0xE0, 3 },
+	{ 0xF8, 0xF0, 4 },
+};
+
+int utf8_size(const char *s) {
+	uint8_t c = (uint8_t)*s;
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); ++i) {
+		if ((c & sizes[i].mask) == sizes[i].result) {
+			return sizes[i].octets;
+		}
+	}
+	return -1;
+}
+
+uint32_t utf8_decode(const char **char_str) {
+	const uint8_t *s = (const uint8_t *)*char_str;
+	int size = utf8_size(*char_str);
+	if (size == 1) {
+		++*char_str;
+		return *s;
+	}
+	if (size == -1) {
+		++*char_str;
+		return UTF8_INVALID;
+	}
+	uint32_t cp = *s & (0x7F >> size);
+	for (int i = 1; i < size; ++i) {
+		// Also stops at the terminating NUL of a truncated sequence
+		if ((s[i] & 0xC0) != 0x80) {
+			++*char_str;
+			return UTF8_INVALID;
+		}
+		cp = (cp << 6) | (s[i] & 0x3F);
+	}
+	*char_str += size;
+	return cp;
+}
@@ -1,14 +1,17 @@
 #include <ctype.h>
 #include <fcntl.h>
 #include <math.h>
+#include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <unistd.h>
 #include <assert.h>
 #include <wayland-server-protocol.h>
 #include "log.h"
 #include "list.h"
+#include "stringop.h"
 #include "util.h"
 
 int wrap(int i, int max) {
@@ -311,3 +314,29 @@ int min(int a, int b) {
 double linear_scale(double a, double b, double t) {
 	return a + t * (b - a);
 }
+
+bool write_file_atomic(const char *path, const char *data, size_t len) {
+	char *tmp = format_str("%s.tmp", path);
+	if (!tmp) {
+		return false;
+	}
+	bool ok = false;
+	FILE *file = fopen(tmp, "w");
+	if (!file) {
+		sway_log_errno(SWAY_ERROR, "Unable to open %s", tmp);
+	} else {
+		bool written = fwrite(data, 1, len, file) == len;
+		if (fclose(file) != 0 || !written) {
+			sway_log_errno(SWAY_ERROR, "Unable to write %s", tmp);
+		} else if (rename(tmp, path) < 0) {
+			sway_log_errno(SWAY_ERROR, "Unable to replace %s", path);
+		} else {
+			ok = true;
+		}
+		if (!ok) {
+			unlink(tmp);
+		}
+	}
+	free(tmp);
+	return ok;
+}
@@ -0,0 +1,50 @@
+#ifndef _SWAY_HASHTABLE_H
+#define _SWAY_HASHTABLE_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t (*hashtable_hash_func_t)(const void *key);
+typedef bool (*hashtable_equal_func_t)(const void *a, const void *b);
+
+struct hashtable_entry {
+	const void *key;
+	void *value;
+	struct hashtable_entry *next;
+};
+
+/* A chained hash table. Keys are not copied: they must stay valid while their
+ * entry is in the table, which is simplest when the key lives in the value
+ * (e.g. a name owned by the object it indexes). Several entries may share a
+ * key; they are told apart by their value.
+ */
+typedef struct {
+	size_t length;
+	size_t capacity; // number of buckets, a power of two
+	struct hashtable_entry **buckets;
+	hashtable_hash_func_t hash;
+	hashtable_equal_func_t equal;
+} hashtable_t;
+
+hashtable_t *create_hashtable(hashtable_hash_func_t hash,
+		hashtable_equal_func_t equal);
+void hashtable_free(hashtable_t *table);
+void hashtable_insert(hashtable_t *table, const void *key, void *value);
+// Removes the entry with this key and value. Returns false if there is none.
+bool hashtable_remove(hashtable_t *table, const void *key, void *value);
+// Returns the first value stored under key for which test returns true, or
+// the first value stored under key if test is NULL.
+void *hashtable_find(hashtable_t *table, const void *key,
+		bool (*test)(void *value, void *data), void *data);
+
+// Keys that are NUL terminated strings
+uint32_t hashtable_hash_string(const void *key);
+bool hashtable_equal_string(const void *a, const void *b);
+// Same, ignoring ASCII case like strcasecmp
+uint32_t hashtable_hash_string_nocase(const void *key);
+bool hashtable_equal_string_nocase(const void *a, const void *b);
+// Keys that are integers cast to pointers
+uint32_t hashtable_hash_int(const void *key);
+bool hashtable_equal_int(const void *a, const void *b);
+
+#endif
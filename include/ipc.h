@@ -27,6 +27,7 @@ enum ipc_command_type {
 	IPC_GET_SCROLLER = 120,
 	IPC_GET_TRAILS = 121,
 	IPC_GET_SPACES = 122,
+	IPC_GET_STATS = 123,
 
 	// Events sent from sway to clients. Events have the highest bits set.
 	IPC_EVENT_WORKSPACE = ((1<<31) | 0),
@@ -42,7 +43,9 @@ enum ipc_command_type {
 	IPC_EVENT_BAR_STATE_UPDATE = ((1<<31) | 20),
 	IPC_EVENT_INPUT = ((1<<31) | 21),
 
-	// scroll-specific event types
+	// scroll-specific event types, event_mask() only has room for 32 events
+	IPC_EVENT_CONFIG = ((1<<31) | 28),
+	IPC_EVENT_STATS = ((1<<31) | 29),
 	IPC_EVENT_SCROLLER = ((1<<31) | 30),
 	IPC_EVENT_TRAILS = ((1<<31) | 31),
 };
@@ -19,7 +19,7 @@ PangoLayout *get_pango_layout(cairo_t *cairo, const PangoFontDescription *desc,
 void get_text_size(cairo_t *cairo, const PangoFontDescription *desc, int *width, int *height,
 		int *baseline, double scale, bool markup, const char *fmt, ...) _SWAY_ATTRIB_PRINTF(8, 9);
 void get_text_metrics(const PangoFontDescription *desc, int *height, int *baseline);
-void render_text(cairo_t *cairo, PangoFontDescription *desc,
+void render_text(cairo_t *cairo, const PangoFontDescription *desc,
 		double scale, bool markup, const char *fmt, ...) _SWAY_ATTRIB_PRINTF(5, 6);
 
 #endif
@@ -89,6 +89,12 @@ void free_cmd_results(struct cmd_results *results);
  */
 char *cmd_results_to_json(list_t *res_list);
 
+/**
+ * Waits for the config files of a pending reload to be read, then drops the
+ * reload. Used on shutdown.
+ */
+void reload_cancel(void);
+
 /**
  * Handlers shared by exec and exec_always.
  */
@@ -149,6 +155,8 @@ sway_cmd cmd_fullscreen_movefocus;
 sway_cmd cmd_gaps;
 sway_cmd cmd_gesture_scroll_enable;
 sway_cmd cmd_gesture_scroll_fingers;
+sway_cmd cmd_gesture_scroll_friction;
+sway_cmd cmd_gesture_scroll_kinetic;
 sway_cmd cmd_gesture_scroll_sensitivity;
 sway_cmd cmd_hide_edge_borders;
 sway_cmd cmd_include;
@@ -180,6 +188,7 @@ sway_cmd cmd_new_window;
 sway_cmd cmd_nop;
 sway_cmd cmd_no_focus;
 sway_cmd cmd_output;
+sway_cmd cmd_output_cache_file;
 sway_cmd cmd_permit;
 sway_cmd cmd_pin;
 sway_cmd cmd_popup_during_fullscreen;
@@ -202,6 +211,7 @@ sway_cmd cmd_show_marks;
 sway_cmd cmd_smart_borders;
 sway_cmd cmd_smart_gaps;
 sway_cmd cmd_space;
+sway_cmd cmd_space_file;
 sway_cmd cmd_sticky;
 sway_cmd cmd_swaybg_command;
 sway_cmd cmd_swaynag_command;
@@ -511,11 +511,55 @@ enum xwayland_mode {
 	XWAYLAND_MODE_IMMEDIATE,
 };
 
+/**
+ * Groups of config lines that a reload only applies when they changed, see
+ * config_section_changed().
+ */
+enum config_section {
+	CONFIG_SECTION_VARIABLES, // set
+	CONFIG_SECTION_SCRIPTS, // lua, may run any command
+	CONFIG_SECTION_OUTPUTS,
+	CONFIG_SECTION_INPUTS, // input and seat
+	CONFIG_SECTION_COUNT,
+};
+
+/**
+ * The contents of a config file and of the files it includes, read by a
+ * worker thread ahead of a reload so the compositor does not wait on the
+ * disk. Includes whose paths use config variables are not known until the
+ * config is parsed; they are read from disk as usual.
+ *
+ * Files are read in rounds: the worker reads the pending paths, then the
+ * main thread expands the include patterns found in them, as wordexp()
+ * can't be used from another thread.
+ */
+struct config_snapshot {
+	list_t *files; // struct config_snapshot_file
+	list_t *pending; // struct config_snapshot_path, to be read
+	list_t *includes; // struct config_snapshot_path, to be expanded
+};
+
+struct config_snapshot_path {
+	char *path;
+	int depth; // of include nesting
+};
+
+struct config_snapshot_file {
+	char *path; // as given to the include command or the main config path
+	char *real_path;
+	char *contents;
+	size_t size;
+};
+
 /**
  * The configuration struct. The result of loading a config file.
  */
 struct sway_config {
 	char *swaynag_command;
+	char *space_file; // spaces are written there when saved, NULL to keep them in memory
+	char *output_cache_file; // known-good output layouts, NULL to keep them in memory
+	struct config_snapshot *snapshot; // not owned, NULL to read files from disk
+	list_t *sections[CONFIG_SECTION_COUNT]; // expanded lines of each section
 	struct swaynag_instance swaynag_config_errors;
 	list_t *symbols;
 	list_t *modes;
@@ -527,6 +571,8 @@ struct sway_config {
 	list_t *input_type_configs;
 	list_t *seat_configs;
 	list_t *criteria;
+	int command_criteria_count; // for_window rules, indexed in order
+	uint32_t command_criteria_updates; // enum sway_view_update they match on
 	list_t *no_focus;
 	list_t *active_bar_modifiers;
 	struct sway_mode *current_mode;
@@ -659,6 +705,8 @@ struct sway_config {
 	bool gesture_scroll_enable;
 	uint32_t gesture_scroll_fingers;
 	float gesture_scroll_sentitivity;
+	bool gesture_scroll_kinetic;
+	float gesture_scroll_friction;
 
 	struct sway_animations_config animations;
 
@@ -690,6 +738,12 @@ struct sway_config {
 	} handler_context;
 };
 
+/**
+ * Returns the first config file found in the standard locations, NULL if there
+ * is none.
+ */
+char *get_config_path(void);
+
 /**
  * Loads the main config from the given path. is_active should be true when
  * reloading the config.
@@ -702,6 +756,39 @@ bool load_main_config(const char *path, bool is_active, bool validating);
 void load_include_configs(const char *path, struct sway_config *config,
 		struct swaynag_instance *swaynag);
 
+/**
+ * Whether the lines of a config section differ between two configs, which
+ * tells a reload what it has to apply again. Any difference in variables or
+ * any script counts as a change of every section.
+ */
+bool config_section_changed(struct sway_config *old_config,
+		struct sway_config *new_config, enum config_section section);
+
+/**
+ * Creates a snapshot whose only pending path is the config file at path.
+ */
+struct config_snapshot *config_snapshot_create(const char *path);
+
+/**
+ * Reads the pending files into memory and collects their include patterns.
+ * Safe to call from another thread, while nothing else uses the snapshot.
+ */
+void config_snapshot_read_pending(struct config_snapshot *snapshot);
+
+/**
+ * Expands the collected include patterns into pending paths. Main thread
+ * only. Returns true if there are files left to read.
+ */
+bool config_snapshot_expand_includes(struct config_snapshot *snapshot);
+
+void config_snapshot_destroy(struct config_snapshot *snapshot);
+
+/**
+ * Returns the snapshot of the file at path, or NULL if it was not read ahead.
+ */
+struct config_snapshot_file *config_snapshot_find(
+		struct config_snapshot *snapshot, const char *path);
+
 /**
  * Reads the config from the given FILE.
  */
@@ -779,6 +866,15 @@ bool apply_output_configs(struct output_config **ocs, size_t ocs_len,
 
 void apply_stored_output_configs(void);
 
+/**
+ * Adds the output layouts stored in path to the ones known to work. Layouts
+ * found by a search are kept in memory and, when output_cache_file is set,
+ * written there as well.
+ */
+void output_cache_read_file(const char *path);
+
+void output_cache_clear(void);
+
 /**
  * store_output_config stores a new output config. An output may be matched by
  * three different config types, in order of precedence: Identifier, name and
@@ -31,6 +31,7 @@ struct pattern {
 
 struct criteria {
 	enum criteria_type type;
+	int index; // dense index of CT_COMMAND criteria in the config
 	char *raw; // entire criteria string (for logging)
 	char *cmdlist;
 	char *target; // workspace or output name for `assign` criteria
@@ -40,6 +41,7 @@ struct criteria {
 	struct pattern *app_id;
 	struct pattern *con_mark;
 	uint32_t con_id; // internal ID
+	bool con_id_focused; // con_id was given as __focused__
 #if WLR_HAS_XWAYLAND
 	struct pattern *class;
 	uint32_t id; // X11 window ID
@@ -75,6 +77,14 @@ void criteria_destroy(struct criteria *criteria);
  */
 struct criteria *criteria_parse(char *raw, char **error);
 
+bool criteria_matches_view(struct criteria *criteria, struct sway_view *view);
+
+/**
+ * Returns the view updates (enum sway_view_update) that can change whether
+ * the criteria matches a view.
+ */
+uint32_t criteria_view_updates(struct criteria *criteria);
+
 /**
  * Compile a list of criterias matching the given view.
  *
@@ -2,6 +2,7 @@
 #define _SWAY_ANIMATION_H
 #include <stdint.h>
 #include <stdbool.h>
+#include <wayland-server-core.h>
 #include "list.h"
 
 /**
@@ -16,17 +17,21 @@ enum sway_animation_style {
 // Animation callback
 typedef void (*sway_animation_callback_func_t)(void *data);
 
+// These callbacks script an animation keyed by the next transaction, on top
+// of the layout, whose containers animate on their own timelines.
+//
 // callback_begin is the function used to prepare anything the animation needs.
 //   it will be called before the animation begins, just once, and only if the
 //   animation is enabled. The function and data parameter can be NULL if not
 //   needed.
 //
 // callback_step is the function that will be called at each step of the
-//   animation, or once if the animation is disabled. This function cannot be
-//   NULL, though its data parameter can be if not needed..
+//   animation, or once if the animation is disabled. If it is NULL, there is
+//   no scripted animation and the other callbacks are ignored.
 //
-// callback_end is the function called when the animation ends. The function
-//   and data can be NULL if not needed.
+// callback_end is the function called when the animation ends, also when it
+//   did not run or is replaced by new callbacks. The callbacks are cleared
+//   before it is called. The function and data can be NULL if not needed.
 
 struct sway_animation_callbacks {
 	sway_animation_callback_func_t callback_begin;
@@ -41,6 +46,19 @@ struct sway_animation_callbacks {
 struct sway_animation_curve;
 struct sway_animation_path;
 
+// Animation timeline. Anything that animates owns one, and all of them run
+// independently on a shared clock: starting a running timeline again
+// retargets it from where it is, without touching the others. Each step only
+// calls the step function of the timelines that are running.
+struct sway_animation_timeline {
+	struct sway_animation_curve *curve;
+	int64_t start_ms;
+	bool running;
+	struct wl_list link;
+	sway_animation_callback_func_t step;
+	void *data;
+};
+
 // Animation Path
 struct sway_animation_path *animation_path_create(bool enabled);
 
@@ -54,22 +72,41 @@ void animation_path_add_curve(struct sway_animation_path *path,
 void animation_set_callbacks(struct sway_animation_callbacks *callbacks);
 struct sway_animation_callbacks *animation_get_callbacks();
 
+// Clears the callbacks, only the layout is animated
+void animation_set_default_callbacks();
+
 // Set the active path for the animation
 void animation_set_path(struct sway_animation_path *path);
 
 // Get the current active path for the animation
 struct sway_animation_path *animation_get_path();
 
-// Starts animating using the next key (next curve in the animation path)
+// Called once a transaction is applied and arranged: starts the scripted
+// animation if there is one, and moves on to the next key (next curve in the
+// animation path)
 void animation_next_key();
 
 // Is an animation enabled?
 bool animation_enabled();
 
-// Get the current parameters for the active animation
+// Is any timeline running?
+bool animation_running();
+
+// Get the current parameters for the scripted animation
 void animation_get_values(double *t, double *x, double *y,
 	double *offset_scale);
 
+// Starts the timeline with the curve of the current key, from now. Returns
+// false, and leaves the timeline stopped, if animations are disabled.
+bool animation_timeline_start(struct sway_animation_timeline *timeline,
+	sway_animation_callback_func_t step, void *data);
+
+void animation_timeline_stop(struct sway_animation_timeline *timeline);
+
+// Get the current parameters for the timeline, its end if it is not running
+void animation_timeline_get_values(struct sway_animation_timeline *timeline,
+	double *t, double *x, double *y, double *offset_scale);
+
 
 // Create a 3D animation curve
 struct sway_animation_curve *create_animation_curve(uint32_t duration_ms,
@@ -0,0 +1,92 @@
+#ifndef _SWAY_STATS_H
+#define _SWAY_STATS_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "sway/tree/scene.h"
+
+/**
+ * Always-on frame timing and latency telemetry, exposed through the IPC
+ * GET_STATS request and the "stats" event.
+ *
+ * Each series is a ring buffer over the last STATS_WINDOW samples, so
+ * recording a sample costs a store and summaries are only computed when a
+ * client asks for them.
+ */
+#define STATS_WINDOW 256
+
+// Number of log2 buckets in a summary histogram, the last one is open-ended
+#define STATS_BUCKETS 24
+
+struct sway_stats_series {
+	int64_t samples[STATS_WINDOW]; // nanoseconds
+	uint64_t count; // samples ever added, the window holds the last ones
+};
+
+struct sway_stats_summary {
+	size_t samples; // samples in the window
+	int64_t min, avg, p50, p90, p99, max; // microseconds
+	// buckets[i] counts samples in [2^i, 2^(i+1)) microseconds, with
+	// buckets[0] also holding everything below 1us
+	uint32_t buckets[STATS_BUCKETS];
+};
+
+struct sway_output_stats {
+	struct sway_stats_series build_state; // CPU time building a frame
+	struct sway_stats_series render; // GPU time rendering a frame
+	struct sway_stats_series present; // commit to presentation
+	uint64_t frames; // committed frames
+	uint64_t dropped_frames; // committed but never presented
+	uint64_t missed_vblanks; // vblanks frames were presented after the one they were meant for
+
+	struct sway_scene_timer timer; // for the last committed frame
+	// The renderer was asked once whether it can time frames
+	bool render_timer_checked, render_timer_supported;
+	struct timespec commit_time;
+	bool frame_pending; // committed and not presented yet
+	// The last presentation, to tell which vblank a frame was meant for
+	bool presented;
+	unsigned last_seq;
+	struct timespec last_present;
+};
+
+struct sway_transaction_stats {
+	struct sway_stats_series wait;
+	uint64_t count;
+	uint64_t timed_out;
+};
+
+extern struct sway_transaction_stats transaction_stats;
+
+/**
+ * Starts collecting transaction stats.
+ */
+void stats_init(void);
+
+void stats_series_add(struct sway_stats_series *series, int64_t ns);
+void stats_series_summarize(const struct sway_stats_series *series,
+		struct sway_stats_summary *summary);
+
+struct wlr_output_event_present;
+
+/**
+ * Bookkeeping around an output frame: the time spent building it, the commit
+ * and its presentation.
+ */
+struct wlr_renderer;
+
+/**
+ * The timer for the GPU time of the next frame, or NULL when nobody reads the
+ * stats or the renderer cannot time frames. GPU times are only collected
+ * while a client is subscribed to the "stats" event.
+ */
+struct sway_scene_timer *stats_output_render_timer(struct sway_output_stats *stats,
+		struct wlr_renderer *renderer);
+void stats_output_frame_built(struct sway_output_stats *stats,
+		const struct timespec *start);
+void stats_output_frame_committed(struct sway_output_stats *stats);
+void stats_output_frame_presented(struct sway_output_stats *stats,
+		const struct wlr_output_event_present *event);
+void stats_output_finish(struct sway_output_stats *stats);
+
+#endif
@@ -24,6 +24,19 @@
 struct sway_transaction_instruction;
 struct sway_view;
 
+/**
+ * Emitted through sway_server::events.transaction_applied once a transaction
+ * has been applied to the current state of the tree.
+ */
+struct sway_transaction_timings {
+	size_t instructions;
+	size_t configures;  // views that were sent a configure
+	int64_t commit_ns;  // time spent configuring views and saving buffers
+	int64_t wait_ns;    // time between the commit and the apply
+	int64_t apply_ns;   // time spent applying the new state
+	bool timed_out;     // some views did not respond before the timeout
+};
+
 /**
  * Find all dirty containers, create and commit a transaction containing them,
  * and unmark them as dirty.
@@ -61,9 +74,4 @@ bool transaction_notify_view_ready_by_geometry(struct sway_view *view,
 
 void arrange_popups(struct sway_scene_tree *popups);
 
-/**
- * Sets the default animation callbacks
- **/
-void animation_set_default_callbacks();
-
 #endif
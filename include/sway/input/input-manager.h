@@ -55,6 +55,12 @@ void input_manager_reset_input(struct sway_input_device *input_device);
 
 void input_manager_reset_all_inputs(void);
 
+/**
+ * Translates the bindsym --to-code bindings of the config with the keymap of
+ * the first input config that sets one, like applying that config does.
+ */
+void input_manager_retranslate_keysyms(void);
+
 void input_manager_apply_seat_config(struct seat_config *seat_config);
 
 struct sway_seat *input_manager_get_default_seat(void);
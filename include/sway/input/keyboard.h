@@ -57,6 +57,7 @@ struct sway_keyboard {
 
 	struct xkb_keymap *keymap;
 	xkb_layout_index_t effective_layout;
+	bool xkb_numlock, xkb_capslock; // locked when the keymap was applied
 
 	int32_t repeat_rate;
 	int32_t repeat_delay;
@@ -87,9 +88,15 @@ struct sway_keyboard_group {
 	struct wl_list link; // sway_seat::keyboard_groups
 };
 
+/**
+ * Returns a reference to the keymap for the xkb settings of the input config,
+ * compiling it unless the same settings were compiled recently.
+ */
 struct xkb_keymap *sway_keyboard_compile_keymap(struct input_config *ic,
 		char **error);
 
+void sway_keyboard_keymap_cache_clear(void);
+
 struct sway_keyboard *sway_keyboard_create(struct sway_seat *seat,
 		struct sway_seat_device *device);
 
@@ -24,5 +24,9 @@ void ipc_event_input(const char *change, struct sway_input_device *device);
 void ipc_event_output(void);
 void ipc_event_scroller(const char *change, struct sway_workspace *workspace);
 void ipc_event_trails();
+void ipc_event_stats(void);
+void ipc_event_config_reload(bool success);
+// Is a client subscribed to the stats event?
+bool ipc_stats_subscribed(void);
 
 #endif
@@ -4,29 +4,94 @@
 #include <lua.h>
 #include <lualib.h>
 #include <lauxlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <wayland-server-core.h>
 
 #include "list.h"
 
+struct sway_view;
+struct sway_container;
+struct sway_workspace;
+struct sway_output;
+
 struct sway_lua_script {
 	char *name;
 	int state;
 };
 
+enum sway_lua_event {
+	LUA_EVENT_VIEW_MAP,
+	LUA_EVENT_VIEW_UNMAP,
+	LUA_EVENT_VIEW_URGENT,
+	LUA_EVENT_VIEW_FOCUS,
+	LUA_EVENT_WORKSPACE_CREATE,
+	// The events below mirror the IPC events of the same name
+	LUA_EVENT_WINDOW,
+	LUA_EVENT_WORKSPACE,
+	LUA_EVENT_OUTPUT,
+	LUA_EVENT_MODE,
+	LUA_EVENT_BINDING,
+	LUA_EVENT_INPUT,
+	LUA_EVENT_SCROLLER,
+	LUA_EVENT_SHUTDOWN,
+	LUA_EVENT_COUNT,
+};
+
 struct sway_lua_closure {
+	struct wl_list link; // sway_lua::callbacks[event]
+	uint64_t handle;
 	int cb_function;
 	int cb_data;
+	bool removed; // removed while dispatching, freed when it ends
 };
 
 struct sway_lua {
 	lua_State *state;
 	list_t *scripts;
-	list_t *cbs_view_map;
-	list_t *cbs_view_unmap;
-	list_t *cbs_view_urgent;
-	list_t *cbs_view_focus;
-	list_t *cbs_workspace_create;
+	struct wl_list callbacks[LUA_EVENT_COUNT]; // sway_lua_closure::link
+	int dispatching; // nesting depth of callback dispatch
+	bool sweep; // some callbacks were removed while dispatching
+};
+
+enum sway_lua_handle_type {
+	LUA_HANDLE_VIEW,
+	LUA_HANDLE_CONTAINER,
+	LUA_HANDLE_WORKSPACE,
+	LUA_HANDLE_OUTPUT,
+	LUA_HANDLE_CALLBACK,
 };
 
+/**
+ * Objects are given to Lua scripts as generation-checked handles, validated in
+ * constant time. Every view, container, workspace and output takes a handle
+ * when created and releases it when freed. Handle 0 is never valid.
+ */
+uint64_t sway_lua_handle_create(enum sway_lua_handle_type type, void *object);
+void sway_lua_handle_release(uint64_t handle);
+
+// Push the handle of an object, or nil if it is NULL
+void sway_lua_push_view(lua_State *L, struct sway_view *view);
+void sway_lua_push_container(lua_State *L, struct sway_container *container);
+void sway_lua_push_workspace(lua_State *L, struct sway_workspace *workspace);
+void sway_lua_push_output(lua_State *L, struct sway_output *output);
+
+void sway_lua_callbacks_init(struct sway_lua *lua);
+void sway_lua_callbacks_finish(struct sway_lua *lua);
+
+/**
+ * Run the callbacks registered for an event. Callbacks receive the object the
+ * event is about (a handle, a string, or nil), then change if it is not NULL,
+ * then their data. Each call is a no-op when the event has no callbacks.
+ */
+void sway_lua_event_view(enum sway_lua_event event, struct sway_view *view);
+void sway_lua_event_container(enum sway_lua_event event,
+		struct sway_container *container, const char *change);
+void sway_lua_event_workspace(enum sway_lua_event event,
+		struct sway_workspace *workspace, const char *change);
+void sway_lua_event_string(enum sway_lua_event event, const char *object,
+		const char *change);
+
 int luaopen_scroll(lua_State *L);
 
 #endif
@@ -7,6 +7,7 @@
 #include <wlr/types/wlr_output.h>
 #include "sway/tree/scene.h"
 #include "config.h"
+#include "sway/desktop/stats.h"
 #include "sway/tree/node.h"
 #include "sway/tree/view.h"
 #include "sway/tree/layout.h"
@@ -76,6 +77,8 @@ struct sway_output {
 	struct wl_event_source *repaint_timer;
 	bool allow_tearing;
 
+	struct sway_output_stats stats;
+
 	struct sway_scroller_output_options scroller_options;
 };
 
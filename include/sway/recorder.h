@@ -0,0 +1,28 @@
+#ifndef _SWAY_RECORDER_H
+#define _SWAY_RECORDER_H
+#include <stdbool.h>
+
+struct sway_view;
+
+/**
+ * The recorder writes IPC commands and view map/unmap events to a file, so a
+ * session can be replayed later against fake clients (see
+ * benchmark/replay.c). It is enabled with -Drecord=<path>.
+ *
+ * Each event is one line of tab separated fields, the first being the time in
+ * milliseconds since the recording started:
+ *
+ *   <msec> map <con_id> <app_id> <title>
+ *   <msec> unmap <con_id>
+ *   <msec> command <command>
+ *
+ * Tabs and newlines in the payload are replaced with spaces.
+ */
+bool recorder_init(const char *path);
+void recorder_finish(void);
+
+void recorder_command(const char *command);
+void recorder_view_map(struct sway_view *view);
+void recorder_view_unmap(struct sway_view *view);
+
+#endif
@@ -143,6 +143,10 @@ struct sway_server {
 	list_t *dirty_nodes;
 
 	struct wl_event_source *delayed_modeset;
+
+	struct {
+		struct wl_signal transaction_applied; // struct sway_transaction_timings
+	} events;
 };
 
 extern struct sway_server server;
@@ -151,6 +155,7 @@ struct sway_debug {
 	bool noatomic;         // Ignore atomic layout updates
 	bool txn_timings;      // Log verbose messages about transactions
 	bool txn_wait;         // Always wait for the timeout before applying
+	char *record_path;     // Record IPC commands and views to this file
 };
 
 extern struct sway_debug debug;
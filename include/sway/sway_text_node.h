@@ -27,4 +27,34 @@ void sway_text_node_set_background(struct sway_text_node *node, float background
 
 void sway_text_node_scale(struct sway_text_node *node, double scale);
 
+// Drops the pending renders of text nodes, before the event loop goes away
+void sway_text_node_finish(void);
+
+/**
+ * Jump mode labels. Their glyphs (the characters of jump_labels_keys, in
+ * jump_labels_color) are rasterised once per output scale into an atlas
+ * texture, so creating a label only places textured quads from that atlas.
+ * Sizes are in the same units as sway_text_node, before scaling.
+ */
+struct sway_label_node {
+	int width;
+	int height;
+
+	struct sway_scene_node *node;
+};
+
+struct sway_label_node *sway_label_node_create(struct sway_scene_tree *parent,
+		const char *text, float output_scale);
+
+void sway_label_node_set_text(struct sway_label_node *node, const char *text);
+
+void sway_label_node_scale(struct sway_label_node *node, double scale);
+
+// Renders the atlas for this output scale if there is none yet
+void sway_label_atlas_prepare(float output_scale);
+
+// Drops the atlases after the label keys, colours or font changed, and renders
+// them again for the enabled outputs
+void sway_label_atlas_rebuild(void);
+
 #endif
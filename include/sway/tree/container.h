@@ -4,6 +4,7 @@
 #include <sys/types.h>
 #include <wlr/types/wlr_compositor.h>
 #include "list.h"
+#include "sway/desktop/animation.h"
 #include "sway/tree/scene.h"
 #include "sway/tree/node.h"
 
@@ -94,8 +95,8 @@ struct sway_container {
 	struct {
 		struct sway_scene_tree *tree;
 
-		struct sway_scene_tree *border;
-		struct sway_scene_tree *background;
+		// border and background around the text
+		struct sway_scene_decoration *decoration;
 
 		struct sway_text_node *title_text;
 		struct sway_text_node *marks_text;
@@ -104,16 +105,13 @@ struct sway_container {
 	struct {
 		struct sway_scene_tree *tree;
 
-		struct sway_scene_rect *top;
-		struct sway_scene_rect *bottom;
-		struct sway_scene_rect *left;
-		struct sway_scene_rect *right;
+		struct sway_scene_decoration *decoration;
 	} border;
 
 	struct {
 		struct sway_scene_tree *tree;
 
-		struct sway_text_node *text;
+		struct sway_label_node *label;
 		bool jumping;
 		double x, y;	// original positions for floating windows
 	} jump;
@@ -162,11 +160,19 @@ struct sway_container {
 		double saved_height_fraction;
 	} toggle_size;
 
-	// Animation variables
+	// Animation variables. The container moves on its own timeline from
+	// (x0, y0, w0, h0) to its target, (xt, yt, wt, ht) is where it is now.
 	struct {
 		double x0, y0, w0, h0;
 		double xt, yt, wt, ht;
 		double w1, h1;
+		struct {
+			double x, y, width, height;
+		} target;
+		// How it was last arranged, to step it on its own
+		enum sway_container_layout layout;
+		int gaps;
+		struct sway_animation_timeline timeline;
 	} animation;
 
 	bool selected;	// for selection/cut/move
@@ -261,6 +267,13 @@ void container_set_resizing(struct sway_container *con, bool resizing);
 
 void container_set_floating(struct sway_container *container, bool enable);
 
+/**
+ * Untiles the view of a container which was just made floating, and lets it
+ * draw its own decorations if it uses them. Done by container_set_floating,
+ * needed for containers added straight to the floating list.
+ */
+void container_floating_setup_view(struct sway_container *container);
+
 void container_set_geometry_from_content(struct sway_container *con);
 
 /**
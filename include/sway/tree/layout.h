@@ -93,7 +93,13 @@ struct sway_scroller {
 		double width, height;
 		double scale;
 		struct sway_scene_tree *tree;
-		struct sway_text_node *text;
+		struct sway_label_node *label;
+		// Downscaled rendering of the workspace, drawn instead of its nodes
+		// while it is not the active workspace of its output
+		struct wlr_buffer *thumbnail;
+		struct wlr_texture *thumbnail_texture;
+		bool thumbnail_dirty; // something in the workspace was damaged
+		bool thumbnail_drawn; // already drawn in the frame being rendered
 	} workspaces;
 
 	struct {
@@ -129,6 +135,8 @@ enum sway_layout_overview layout_overview_mode(struct sway_workspace *workspace)
 
 bool layout_overview_workspaces_enabled();
 void layout_overview_workspaces_toggle();
+// Free the cached overview thumbnail of the workspace
+void layout_overview_thumbnail_release(struct sway_workspace *workspace);
 
 void layout_scale_set(struct sway_workspace *workspace, double scale);
 void layout_scale_reset(struct sway_workspace *workspace);
@@ -181,8 +189,17 @@ void layout_jump_trailmark(struct sway_workspace *workspace);
 bool layout_scroll_begin(struct sway_seat *seat);
 // Update scrolling swipe gesture
 void layout_scroll_update(struct sway_seat *seat, double dx, double dy);
-// Finish scrolling swipe and return true if scrolling, else false
+// Finish scrolling swipe and return true if scrolling, else false. With
+// kinetic scrolling, the layout may keep moving until layout_scroll_frame()
+// stops it.
 bool layout_scroll_end(struct sway_seat *seat);
+// Advance kinetic scrolling of the workspaces of output by one frame
+void layout_scroll_frame(struct sway_output *output);
+// Drop the scroll of a gesture across container, which is being detached or
+// destroyed
+void layout_scroll_forget_container(struct sway_container *container);
+// Drop seat from the gestures it started, as it is being destroyed
+void layout_scroll_forget_seat(struct sway_seat *seat);
 
 // Pin
 
@@ -238,8 +255,13 @@ bool layout_trails_trailmarked(struct sway_view *view);
 
 // Space
 struct sway_space;
+struct sway_space_view;
 
 void layout_space_restore(struct sway_space *space, struct sway_workspace *workspace, bool reset);
+// Put the container of a view that just mapped where space_view is in the
+// space, next to the views of the space already restored in workspace
+void layout_space_place_view(struct sway_space *space, struct sway_space_view *space_view,
+		struct sway_workspace *workspace, struct sway_container *container);
 
 // Toggle size
 //
@@ -2,6 +2,7 @@
 #define _SWAY_NODE_H
 #include <wayland-server-core.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "sway/tree/scene.h"
 #include "list.h"
 
@@ -44,6 +45,9 @@ struct sway_node {
 	 */
 	size_t id;
 
+	// Handle given to Lua scripts, see sway/lua.c
+	uint64_t lua_handle;
+
 	struct sway_transaction_instruction *instruction;
 	size_t ntxnrefs;
 	bool destroying;
@@ -8,6 +8,7 @@
 #include "sway/tree/container.h"
 #include "sway/tree/scene.h"
 #include "sway/tree/node.h"
+#include "hashtable.h"
 #include "list.h"
 
 extern struct sway_root *root;
@@ -102,6 +103,17 @@ struct sway_root {
 	bool overview;
 
 	list_t *spaces;
+
+	// Lookup indexes, maintained as containers and workspaces are created,
+	// destroyed, renamed and (un)marked. They may hold entries that are not
+	// in the tree at the moment (detached or being destroyed): the
+	// root_find_*_by_* functions filter those out.
+	struct {
+		hashtable_t *containers_by_id; // node id -> struct sway_container
+		hashtable_t *containers_by_mark; // mark -> struct sway_container
+		hashtable_t *workspaces_by_name; // name (any case) -> struct sway_workspace
+		hashtable_t *workspaces_by_number; // leading digits -> struct sway_workspace
+	} index;
 };
 
 struct sway_root *root_create(struct wl_display *display);
@@ -147,6 +159,28 @@ struct sway_workspace *root_find_workspace(
 struct sway_container *root_find_container(
 		bool (*test)(struct sway_container *con, void *data), void *data);
 
+/**
+ * O(1) equivalents of root_find_container() and root_find_workspace() for the
+ * common lookups: they find the same containers and workspaces, using the
+ * indexes in root.
+ */
+struct sway_container *root_find_container_by_id(size_t id);
+
+struct sway_container *root_find_container_by_mark(const char *mark);
+
+// Case insensitive, like workspace_by_name()
+struct sway_workspace *root_find_workspace_by_name(const char *name);
+
+// Matches the leading digits of name, like workspace_by_number()
+struct sway_workspace *root_find_workspace_by_number(const char *name);
+
+void root_index_add_container(struct sway_container *con);
+void root_index_remove_container(struct sway_container *con);
+void root_index_add_mark(struct sway_container *con, const char *mark);
+void root_index_remove_mark(struct sway_container *con, const char *mark);
+void root_index_add_workspace(struct sway_workspace *ws);
+void root_index_remove_workspace(struct sway_workspace *ws);
+
 void root_get_box(struct sway_root *root, struct wlr_box *box);
 
 void root_set_default_filters(struct sway_root *root);
@@ -55,13 +55,13 @@ enum sway_scene_node_type {
 	SWAY_SCENE_NODE_TREE,
 	SWAY_SCENE_NODE_RECT,
 	SWAY_SCENE_NODE_BUFFER,
+	SWAY_SCENE_NODE_DECORATION,
 };
 
 struct sway_scene_node_info {
 	double scale;			// scale for everything below
 	struct wlr_output *wlr_output;	// wlr_output the node belongs to (if tiled, otherwise NULL)
 	struct sway_workspace *workspace;
-	bool background;	// bakground layer shell, usually the wallpaper
 };
 
 /** A node is an object in the scene. */
@@ -158,6 +158,31 @@ struct sway_scene_rect {
 	bool has_backdrop_blur;
 };
 
+enum sway_scene_decoration_side {
+	SWAY_SCENE_DECORATION_TOP,
+	SWAY_SCENE_DECORATION_BOTTOM,
+	SWAY_SCENE_DECORATION_LEFT,
+	SWAY_SCENE_DECORATION_RIGHT,
+	SWAY_SCENE_DECORATION_SIDES,
+};
+
+/**
+ * A scene-graph node drawing a whole window frame: a border of up to four
+ * solid-colored sides around a width x height box, and a solid background
+ * inside the border with holes left for other nodes (e.g. title text). Only
+ * the painted parts are visible, accept input or occlude what is below.
+ */
+struct sway_scene_decoration {
+	struct sway_scene_node node;
+	double width, height;
+	double border[SWAY_SCENE_DECORATION_SIDES];
+	float border_color[SWAY_SCENE_DECORATION_SIDES][4];
+	float background[4];
+	pixman_region32_t holes; // node-local, cut out of the background
+	int corner_radius;
+	enum corner_location corner_location;
+};
+
 struct sway_scene_outputs_update_event {
 	struct sway_scene_output **active;
 	size_t size;
@@ -207,6 +232,8 @@ struct sway_scene_buffer {
 		struct wlr_linux_dmabuf_feedback_v1_init_options prev_feedback_options;
 
 		bool own_buffer;
+		// The texture belongs to someone else, see sway_scene_buffer_set_texture()
+		bool borrowed_texture;
 		int buffer_width, buffer_height;
 		bool buffer_is_opaque;
 
@@ -425,6 +452,14 @@ struct sway_scene_tree *sway_scene_tree_from_node(struct sway_scene_node *node);
  */
 struct sway_scene_rect *sway_scene_rect_from_node(struct sway_scene_node *node);
 
+/**
+ * If this node represents a sway_scene_decoration, that decoration will be
+ * returned. It is not legal to feed a node that does not represent a
+ * sway_scene_decoration.
+ */
+struct sway_scene_decoration *sway_scene_decoration_from_node(
+	struct sway_scene_node *node);
+
 /**
  * If this buffer is backed by a surface, then the struct sway_scene_surface is
  * returned. If not, NULL will be returned.
@@ -470,6 +505,54 @@ void sway_scene_rect_set_corner_radius(struct sway_scene_rect *rect, int radius,
  */
 void sway_scene_rect_set_backdrop_blur(struct sway_scene_rect *rect, bool enabled);
 
+/**
+ * Add a decoration node to the scene-graph. It starts empty: no border and a
+ * transparent background.
+ */
+struct sway_scene_decoration *sway_scene_decoration_create(
+	struct sway_scene_tree *parent);
+
+/**
+ * Change the outer size of a decoration node.
+ */
+void sway_scene_decoration_set_size(struct sway_scene_decoration *decoration,
+	double width, double height);
+
+/**
+ * Change the width of each side of the border, drawn inside the node size.
+ */
+void sway_scene_decoration_set_border(struct sway_scene_decoration *decoration,
+	double top, double bottom, double left, double right);
+
+/**
+ * Change the color of one side of the border.
+ *
+ * The color argument must be a premultiplied color value.
+ */
+void sway_scene_decoration_set_border_color(struct sway_scene_decoration *decoration,
+	enum sway_scene_decoration_side side, const float color[static 4]);
+
+/**
+ * Change the color filling the inside of the border.
+ *
+ * The color argument must be a premultiplied color value.
+ */
+void sway_scene_decoration_set_background(struct sway_scene_decoration *decoration,
+	const float color[static 4]);
+
+/**
+ * Set the node-local region left out of the background. NULL clears it.
+ */
+void sway_scene_decoration_set_holes(struct sway_scene_decoration *decoration,
+	const pixman_region32_t *holes);
+
+/**
+ * Set the corner radius of a decoration node, like
+ * sway_scene_rect_set_corner_radius().
+ */
+void sway_scene_decoration_set_corner_radius(struct sway_scene_decoration *decoration,
+	int radius, enum corner_location location);
+
 /**
  * Add a node displaying a buffer to the scene-graph.
  *
@@ -517,6 +600,17 @@ struct sway_scene_buffer_set_buffer_options {
 void sway_scene_buffer_set_buffer_with_options(struct sway_scene_buffer *scene_buffer,
 	struct wlr_buffer *buffer, const struct sway_scene_buffer_set_buffer_options *options);
 
+/**
+ * Displays a texture instead of a buffer. The texture is not owned by the
+ * node, so many nodes can sample the same one (e.g. regions of an atlas picked
+ * with sway_scene_buffer_set_source_box()). The caller must keep it alive
+ * until the node is destroyed or given another buffer or texture.
+ *
+ * If the texture is NULL, the buffer node will not be displayed.
+ */
+void sway_scene_buffer_set_texture(struct sway_scene_buffer *scene_buffer,
+	struct wlr_texture *texture);
+
 /**
  * Sets the buffer's opaque region. This is an optimization hint used to
  * determine if buffers which reside under this one need to be rendered or not.
@@ -614,6 +708,18 @@ bool sway_scene_output_commit(struct sway_scene_output *scene_output,
 bool sway_scene_output_build_state(struct sway_scene_output *scene_output,
 	struct wlr_output_state *state, const struct sway_scene_output_state_options *options);
 
+/**
+ * Render what is enabled below the trees, bottom tree first, into a new
+ * buffer the size of the output. Unlike on the output, the nodes are
+ * rendered whole, even where other nodes cover them. The trees themselves
+ * need not be enabled. The buffer is not transformed: it is in the output
+ * orientation, at the output scale.
+ *
+ * The caller owns the returned buffer. Returns NULL on failure.
+ */
+struct wlr_buffer *sway_scene_output_capture(struct sway_scene_output *scene_output,
+	struct sway_scene_tree **trees, size_t trees_len);
+
 /**
  * Retrieve the duration in nanoseconds between the last sway_scene_output_commit() call and the end
  * of its operations, including those on the GPU that may have finished after the call returned.
@@ -727,6 +833,12 @@ struct sway_scene *scene_node_get_root(struct sway_scene_node *node);
 
 void scene_node_get_size(struct sway_scene_node *node, double *width, double *height);
 
+/**
+ * Recompute the visibility of every node, when nodes are drawn elsewhere
+ * without having moved, e.g. on entering or leaving the workspaces overview.
+ */
+void sway_scene_update_visibility(struct sway_scene *scene);
+
 void scene_surface_set_clip(struct sway_scene_surface *surface, struct wlr_box *clip);
 
 /**
@@ -4,14 +4,19 @@
 #include "sway/tree/view.h"
 
 struct sway_space_view {
-    struct sway_view *view;
+    struct sway_view *view; // NULL until a mapped view is matched to it
     struct sway_space_container *container;
 	float content_scale;
+	// Criteria used to match views when the space was read from disk
+	char *app_id;
+	char *class;
+	char *title;
 };
 
 struct sway_space_container {
     list_t *children; // struct sway_space_container
     struct sway_space_view *view;
+	struct sway_space_container *parent; // NULL at the top level
 
     struct sway_space_container *focused_inactive; // focused inactive child
 	// Fraction of the viewport size this container occupies
@@ -24,18 +29,36 @@ struct sway_space_container {
 
 struct sway_space {
     char *name;
+	char *workspace; // workspace it was saved from, or is being restored to
     list_t *tiling; // struct sway_space_container *
     list_t *floating;
     struct sway_space_container *focused;
+	// Some views of the space are not mapped yet, place them as they map
+	// until pending_until (msec)
+	bool pending;
+	int64_t pending_until;
 };
 
-// Save the current workspace configuration into a space with name
+// Save the current workspace configuration into a space with name, and write
+// all the spaces to config->space_file if it is set
 void space_save(struct sway_workspace *workspace, const char *name);
 
 // Load the space with name into the current workspace.
 // If reset is false, add the space data to the workspace. If it is true, close
-// any views not belonging to the space
+// any views not belonging to the space.
+// Views that are not mapped yet are placed in the space layout when they map,
+// for a few seconds after the space is loaded.
 void space_load(struct sway_workspace *workspace, const char *name, bool reset);
 
+// Read the spaces in path, keeping spaces already in memory with the same name
+void space_read_file(const char *path);
+
+// If view matches a pending space, place its container where the space has it
+// and return true. Called when a view maps, instead of the usual insertion.
+bool space_place_view(struct sway_view *view);
+
+// Forget view in every space, it is being unmapped
+void space_view_unmap(struct sway_view *view);
+
 
 #endif // _SWAY_SPACE_H
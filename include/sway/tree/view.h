@@ -14,6 +14,7 @@
 
 struct sway_container;
 struct sway_xdg_decoration;
+struct criteria;
 
 enum sway_view_type {
 	SWAY_VIEW_XDG_SHELL,
@@ -35,6 +36,13 @@ enum sway_view_prop {
 #endif
 };
 
+// Property changes waiting to be applied, see view_queue_update()
+enum sway_view_update {
+	VIEW_UPDATE_TITLE = 1 << 0,
+	VIEW_UPDATE_APP_ID = 1 << 1,
+	VIEW_UPDATE_CRITERIA = 1 << 2,
+};
+
 enum sway_view_tearing_mode {
 	TEARING_OVERRIDE_FALSE,
 	TEARING_OVERRIDE_TRUE,
@@ -76,6 +84,9 @@ struct sway_view {
 	pid_t pid;
 	struct launcher_ctx *ctx;
 
+	// Handle given to Lua scripts, see sway/lua.c
+	uint64_t lua_handle;
+
 	// The size the view would want to be if it weren't tiled.
 	// Used when changing a view from tiled to floating.
 	int natural_width, natural_height;
@@ -86,6 +97,13 @@ struct sway_view {
 	bool allow_request_urgent;
 	struct wl_event_source *urgent_timer;
 
+	uint32_t pending_updates; // enum sway_view_update
+	struct wl_list pending_link;
+
+	// IPC title events are rate limited, a trailing event is sent by the timer
+	int64_t last_title_event; // msec
+	struct wl_event_source *title_event_timer;
+
 	// The geometry for whatever the client is committing, regardless of
 	// transaction state. Updated on every commit.
 	struct wlr_box geometry;
@@ -100,7 +118,9 @@ struct sway_view {
 
 	bool destroying;
 
-	list_t *executed_criteria; // struct criteria *
+	// Bitset of the for_window rules already run, by criteria index
+	uint32_t *executed_criteria;
+	int executed_criteria_words;
 
 	union {
 		struct wlr_xdg_toplevel *wlr_xdg_toplevel;
@@ -325,12 +345,32 @@ void view_update_app_id(struct sway_view *view);
  */
 void view_update_title(struct sway_view *view, bool force);
 
+/**
+ * Schedule the given updates (a mask of enum sway_view_update) for the view.
+ * Clients may change their title many times per second; the changes are
+ * coalesced and applied once, right before the next output frame.
+ */
+void view_queue_update(struct sway_view *view, uint32_t updates);
+
+/**
+ * Apply the queued updates of all views. Called before rendering a frame.
+ */
+void view_flush_pending_updates(void);
+
 /**
  * Run any criteria that match the view and haven't been run on this view
  * before.
  */
 void view_execute_criteria(struct sway_view *view);
 
+bool view_has_executed_criteria(struct sway_view *view,
+		struct criteria *criteria);
+
+void view_set_executed_criteria(struct sway_view *view,
+		struct criteria *criteria);
+
+void view_clear_executed_criteria(struct sway_view *view);
+
 /**
  * Returns true if there's a possibility the view may be rendered on screen.
  * Intended for damage tracking.
@@ -2,6 +2,7 @@
 #define _SWAY_WORKSPACE_H
 
 #include <stdbool.h>
+#include <time.h>
 #include "sway/config.h"
 #include "sway/tree/layout.h"
 #include "sway/tree/container.h"
@@ -47,12 +48,29 @@ struct sway_workspace {
 	list_t *tiling;             // struct sway_container
 	list_t *output_priority;
 	bool urgent;
+	// Switched to with an animation. Until it ends, the workspace is drawn
+	// from a snapshot and its live content is hidden.
+	bool switching;
 
 	struct {
 		bool scrolling;
 		double dx, dy;
 		struct sway_container *pin;
 		enum sway_layout_pin pin_position;
+		// While scrolling, the layout is not touched: the scroll is kept
+		// here and applied as a translation of the tiling layer (offset_x,
+		// offset_y) or of the content of the container scrolled across the
+		// layout (column). It is folded into the layout when the gesture ends.
+		double offset_x, offset_y;
+		struct sway_container *column;
+		double column_offset;
+		// Velocity (pixels per second) estimated from the gesture events.
+		// With kinetic scrolling, it keeps the layout moving after the
+		// gesture ends, decaying every output frame until it stops.
+		bool kinetic;
+		double vx, vy;
+		struct timespec last_event, last_frame;
+		struct sway_seat *seat; // that started the gesture
 	} gesture;
 
 	struct sway_workspace_state current;
@@ -78,6 +96,9 @@ struct sway_workspace *workspace_auto_back_and_forth(
 
 bool workspace_switch(struct sway_workspace *workspace);
 
+// Finish at once an animated workspace switch shown on output
+void workspace_switch_cancel_output(struct sway_output *output);
+
 struct sway_workspace *workspace_by_number(const char* name);
 
 struct sway_workspace *workspace_by_name(const char*);
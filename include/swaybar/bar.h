@@ -79,6 +79,7 @@ struct swaybar_output {
 
 	struct wl_list workspaces; // swaybar_workspace::link
 	struct wl_list hotspots; // swaybar_hotspot::link
+	struct wl_list text_cache; // text_cache_entry::link
 
 	char *name;
 	char *identifier;
@@ -91,6 +92,9 @@ struct swaybar_output {
 	struct pool_buffer *current_buffer;
 	bool dirty;
 	bool frame_scheduled;
+	// if false, only the status blocks which changed are damaged
+	bool damage_full;
+	struct wl_array status_blocks; // struct status_block_state
 
 	uint32_t output_height, output_width, output_x, output_y;
 };
@@ -110,6 +114,11 @@ void bar_run(struct swaybar *bar);
 void bar_teardown(struct swaybar *bar);
 
 void set_bar_dirty(struct swaybar *bar);
+/*
+ * Like set_bar_dirty, but only the status line changed. This lets outputs
+ * limit damage to the status blocks which were actually updated.
+ */
+void set_bar_status_dirty(struct swaybar *bar);
 
 /*
  * Determines whether the bar should be visible and changes it to be so.
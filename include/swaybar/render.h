@@ -1,7 +1,20 @@
 #ifndef _SWAYBAR_RENDER_H
 #define _SWAYBAR_RENDER_H
 
+#include <stdint.h>
+
 struct swaybar_output;
+struct i3bar_block;
+
+/**
+ * Where a status block was drawn in the last committed frame of an output.
+ * Used to only damage the blocks that changed between frames.
+ */
+struct status_block_state {
+	struct i3bar_block *block; // only compared, never dereferenced
+	uint32_t serial;
+	double x, width;
+};
 
 void render_frame(struct swaybar_output *output);
 
@@ -23,6 +23,7 @@ struct status_line {
 	enum status_protocol protocol;
 	const char *text;
 	struct wl_list blocks; // i3bar_block::link
+	uint32_t block_serial;
 
 	int stop_signal;
 	int cont_signal;
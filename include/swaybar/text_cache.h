@@ -0,0 +1,59 @@
+#ifndef _SWAYBAR_TEXT_CACHE_H
+#define _SWAYBAR_TEXT_CACHE_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <cairo.h>
+#include <pango/pangocairo.h>
+#include <wayland-util.h>
+
+struct swaybar_output;
+
+/**
+ * A shaped piece of text. Entries are keyed by (text, markup, font, scale,
+ * font options) and live in swaybar_output::text_cache, so the same string is
+ * only shaped by Pango once for as long as it keeps being drawn on that output.
+ * Text measured and drawn under different antialiasing modes gets one entry
+ * for each.
+ */
+struct text_cache_entry {
+	struct wl_list link; // swaybar_output::text_cache
+	uint32_t hash;
+	char *text;
+	bool markup;
+	PangoFontDescription *font;
+	int32_t scale;
+	cairo_font_options_t *options;
+
+	PangoLayout *layout;
+	guint serial; // layout serial the extents below were computed for
+	int width, height, baseline;
+
+	bool used; // looked up since the last text_cache_prune
+};
+
+/**
+ * Returns the cached layout for text on this output, shaping it if needed.
+ * The layout's context is synced with the cairo transform.
+ */
+struct text_cache_entry *text_cache_get(struct swaybar_output *output,
+		cairo_t *cairo, const PangoFontDescription *desc, bool markup,
+		const char *text);
+
+/**
+ * Cached equivalents of get_text_size() and render_text() from pango.h.
+ */
+void text_cache_get_size(struct swaybar_output *output, cairo_t *cairo,
+		const PangoFontDescription *desc, int *width, int *height,
+		int *baseline, bool markup, const char *text);
+void text_cache_render(struct swaybar_output *output, cairo_t *cairo,
+		const PangoFontDescription *desc, bool markup, const char *text);
+
+/**
+ * Drops every entry that was not used since the previous call. Called once per
+ * rendered frame, so text that is no longer displayed is released.
+ */
+void text_cache_prune(struct swaybar_output *output);
+
+void text_cache_finish(struct swaybar_output *output);
+
+#endif
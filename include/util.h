@@ -148,4 +148,11 @@ int min(int a, int b);
  */
 double linear_scale(double a, double b, double t);
 
+/**
+ * Replaces the file at path with len bytes of data. They are written to a
+ * temporary file first which is then renamed over path, so a crash never
+ * leaves a truncated file. Returns false and logs on failure.
+ */
+bool write_file_atomic(const char *path, const char *data, size_t len);
+
 #endif
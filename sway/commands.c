@@ -140,6 +140,8 @@ static const struct cmd_handler config_handlers[] = {
 	{ "fullscreen_movefocus", cmd_fullscreen_movefocus },
 	{ "gesture_scroll_enable", cmd_gesture_scroll_enable },
 	{ "gesture_scroll_fingers", cmd_gesture_scroll_fingers },
+	{ "gesture_scroll_friction", cmd_gesture_scroll_friction },
+	{ "gesture_scroll_kinetic", cmd_gesture_scroll_kinetic },
 	{ "gesture_scroll_sensitivity", cmd_gesture_scroll_sensitivity },
 	{ "include", cmd_include },
 	{ "jump_labels_background", cmd_jump_labels_background },
@@ -151,8 +153,10 @@ static const struct cmd_handler config_handlers[] = {
 	{ "layout_heights", cmd_layout_heights },
 	{ "layout_widths", cmd_layout_widths },
 	{ "maximize_if_single", cmd_maximize_if_single },
+	{ "output_cache_file", cmd_output_cache_file },
 	{ "primary_selection", cmd_primary_selection },
 	{ "scrollnag_command", cmd_swaynag_command },
+	{ "space_file", cmd_space_file },
 	{ "swaybg_command", cmd_swaybg_command },
 	{ "workspace_layout", cmd_workspace_layout },
 	{ "workspace_next_on_output_create_empty", cmd_workspace_next_on_output_create_empty },
@@ -30,6 +30,8 @@ struct cmd_results *cmd_for_window(int argc, char **argv) {
 		return cmd_results_new(CMD_SUCCESS, NULL);
 	}
 
+	criteria->index = config->command_criteria_count++;
+	config->command_criteria_updates |= criteria_view_updates(criteria);
 	list_add(config->criteria, criteria);
 	sway_log(SWAY_DEBUG, "for_window: '%s' -> '%s' added", criteria->raw, criteria->cmdlist);
 
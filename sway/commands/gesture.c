@@ -205,3 +205,37 @@ struct cmd_results *cmd_gesture_scroll_sensitivity(int argc, char **argv) {
 
 	return cmd_results_new(CMD_SUCCESS, NULL);
 }
+
+/**
+ * Enable or disable kinetic scrolling after a scrolling gesture ends
+ */
+struct cmd_results *cmd_gesture_scroll_kinetic(int argc, char **argv) {
+	struct cmd_results *error = NULL;
+	if ((error = checkarg(argc, "gesture_scroll_kinetic", EXPECTED_AT_LEAST, 1))) {
+		return error;
+	}
+
+	config->gesture_scroll_kinetic = parse_boolean(argv[0], false);
+
+	return cmd_results_new(CMD_SUCCESS, NULL);
+}
+
+/**
+ * Set the friction (deceleration rate per second) of kinetic scrolling
+ */
+struct cmd_results *cmd_gesture_scroll_friction(int argc, char **argv) {
+	struct cmd_results *error = NULL;
+	if ((error = checkarg(argc, "gesture_scroll_friction", EXPECTED_AT_LEAST, 1))) {
+		return error;
+	}
+
+	char *end;
+	float friction = strtof(argv[0], &end);
+	if (*end || friction <= 0.0f) {
+		return cmd_results_new(CMD_INVALID,
+			"Expected a positive number for gesture_scroll_friction");
+	}
+	config->gesture_scroll_friction = friction;
+
+	return cmd_results_new(CMD_SUCCESS, NULL);
+}
@@ -3,6 +3,7 @@
 #include <string.h>
 #include <strings.h>
 #include "sway/commands.h"
+#include "sway/sway_text_node.h"
 #include "sway/tree/workspace.h"
 #include "util.h"
 
@@ -14,6 +15,9 @@ struct cmd_results *cmd_jump_labels_color(int argc, char **argv) {
 	uint32_t color;
 	parse_color(argv[0], &color);
 	color_to_rgba(config->jump_labels_color, color);
+	if (!config->reading) {
+		sway_label_atlas_rebuild();
+	}
 	return cmd_results_new(CMD_SUCCESS, NULL);
 }
 
@@ -45,6 +49,9 @@ struct cmd_results *cmd_jump_labels_keys(int argc, char **argv) {
 	}
 	free(config->jump_labels_keys);
 	config->jump_labels_keys = strdup(argv[0]);
+	if (!config->reading) {
+		sway_label_atlas_rebuild();
+	}
 	return cmd_results_new(CMD_SUCCESS, NULL);
 }
 
@@ -0,0 +1,31 @@
+#include <string.h>
+#include "sway/commands.h"
+#include "sway/config.h"
+#include "log.h"
+#include "stringop.h"
+
+struct cmd_results *cmd_output_cache_file(int argc, char **argv) {
+	struct cmd_results *error = NULL;
+	if ((error = checkarg(argc, "output_cache_file", EXPECTED_AT_LEAST, 1))) {
+		return error;
+	}
+
+	free(config->output_cache_file);
+	config->output_cache_file = NULL;
+
+	char *path = join_args(argv, argc);
+	if (strcmp(path, "none") == 0) {
+		free(path);
+		return cmd_results_new(CMD_SUCCESS, NULL);
+	}
+	if (!expand_path(&path)) {
+		error = cmd_results_new(CMD_INVALID, "Invalid path: %s", path);
+		free(path);
+		return error;
+	}
+	config->output_cache_file = path;
+	sway_log(SWAY_DEBUG, "Using output cache file: %s", config->output_cache_file);
+	output_cache_read_file(config->output_cache_file);
+
+	return cmd_results_new(CMD_SUCCESS, NULL);
+}
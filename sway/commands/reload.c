@@ -1,18 +1,41 @@
+#include <pthread.h>
 #include <string.h>
+#include <unistd.h>
 #include "sway/commands.h"
 #include "sway/config.h"
 #include "sway/ipc-server.h"
 #include "sway/server.h"
+#include "sway/swaynag.h"
 #include "sway/tree/arrange.h"
 #include "sway/tree/view.h"
 #include "list.h"
 #include "log.h"
+#include "util.h"
+
+/**
+ * A reload whose config files are being read by a worker thread. The worker
+ * writes to the pipe when it is done with a round of files; the main thread
+ * then expands their includes and starts another round, or parses and
+ * applies the config from the snapshot, without touching the disk.
+ */
+struct reload_job {
+	char *path; // as passed to load_main_config, NULL for the default
+	char *read_path;
+	struct config_snapshot *snapshot;
+	pthread_t thread;
+	int fd[2];
+	struct wl_event_source *source;
+	bool running; // the worker thread has yet to be joined
+	bool again; // reload requested again while reading, files may be stale
+};
+
+static struct reload_job *reload_job = NULL;
 
 static void title_bar_update_iterator(struct sway_container *con, void *data) {
 	container_update_title_bar(con);
 }
 
-static void do_reload(void *data) {
+static bool reload_apply(void) {
 	// store bar ids to check against new bars for barconfig_update events
 	list_t *bar_ids = create_list();
 	for (int i = 0; i < config->bars->length; ++i) {
@@ -28,7 +51,7 @@ static void do_reload(void *data) {
 	if (!load_main_config(path, true, false)) {
 		sway_log(SWAY_ERROR, "Error(s) reloading config");
 		list_free_items_and_destroy(bar_ids);
-		return;
+		return false;
 	}
 
 	ipc_event_workspace(NULL, NULL, "reload");
@@ -49,6 +72,142 @@ static void do_reload(void *data) {
 	root_for_each_container(title_bar_update_iterator, NULL);
 
 	arrange_root();
+	return true;
+}
+
+static void do_reload(void *data) {
+	ipc_event_config_reload(reload_apply());
+}
+
+// The reload command returned long ago, let the user and clients know
+static void reload_report(bool success) {
+	ipc_event_config_reload(success);
+	struct swaynag_instance *swaynag = &config->swaynag_config_errors;
+	if (!success && !swaynag->client) {
+		swaynag_log(config->swaynag_command, swaynag,
+			"Error(s) reloading config, keeping the current one. "
+			"The lines at fault are in the log.");
+		swaynag_show(swaynag);
+	}
+}
+
+static void *reload_read_thread(void *data) {
+	struct reload_job *job = data;
+	config_snapshot_read_pending(job->snapshot);
+	char done = 0;
+	if (write(job->fd[1], &done, 1) != 1) {
+		sway_log_errno(SWAY_ERROR, "Unable to signal the end of config reading");
+	}
+	return NULL;
+}
+
+static void reload_job_destroy(struct reload_job *job) {
+	if (job->running) {
+		pthread_join(job->thread, NULL);
+	}
+	if (job->source) {
+		wl_event_source_remove(job->source);
+	}
+	close(job->fd[0]);
+	close(job->fd[1]);
+	config_snapshot_destroy(job->snapshot);
+	free(job->path);
+	free(job->read_path);
+	free(job);
+}
+
+static bool reload_job_read(struct reload_job *job) {
+	job->running = pthread_create(&job->thread, NULL,
+		reload_read_thread, job) == 0;
+	return job->running;
+}
+
+static bool reload_start(void);
+
+static int handle_read_done(int fd, uint32_t mask, void *data) {
+	struct reload_job *job = data;
+	char done;
+	if (read(fd, &done, 1) != 1) {
+		sway_log_errno(SWAY_ERROR, "Unable to read the end of config reading");
+	}
+	pthread_join(job->thread, NULL);
+	job->running = false;
+
+	if (!job->again && config_snapshot_expand_includes(job->snapshot)) {
+		if (reload_job_read(job)) {
+			return 0;
+		}
+		sway_log(SWAY_ERROR, "Unable to read included files ahead of reload");
+	}
+	reload_job = NULL;
+
+	if (job->again) {
+		reload_job_destroy(job);
+		if (!reload_start()) {
+			sway_log(SWAY_ERROR, "Unable to read the config ahead of reload");
+		}
+		return 0;
+	}
+
+	if (job->snapshot->files->length == 0) {
+		// The main file couldn't be read, leave it to load_main_config
+		config_snapshot_destroy(job->snapshot);
+		job->snapshot = NULL;
+	}
+
+	// Validate first, so a broken config leaves everything as it is
+	// Parsing still happens here, on the main thread; only reading the files
+	// is done ahead
+	config->snapshot = job->snapshot;
+	bool success = load_main_config(job->path, true, true);
+	if (!success) {
+		sway_log(SWAY_ERROR, "Error(s) reloading config, keeping the current one");
+	} else {
+		success = reload_apply();
+	}
+	// The reload replaced the config, which borrowed the snapshot
+	config->snapshot = NULL;
+	reload_job_destroy(job);
+	reload_report(success);
+	return 0;
+}
+
+static bool reload_start(void) {
+	struct reload_job *job = calloc(1, sizeof(*job));
+	if (!job) {
+		return false;
+	}
+	job->fd[0] = job->fd[1] = -1;
+	if (config->user_config_path) {
+		job->path = strdup(config->current_config_path);
+		job->read_path = strdup(config->current_config_path);
+	} else {
+		job->read_path = get_config_path();
+	}
+	if (job->read_path) {
+		job->snapshot = config_snapshot_create(job->read_path);
+	}
+	if (!job->snapshot || pipe(job->fd) != 0 ||
+			!sway_set_cloexec(job->fd[0], true) ||
+			!sway_set_cloexec(job->fd[1], true)) {
+		reload_job_destroy(job);
+		return false;
+	}
+	job->source = wl_event_loop_add_fd(server.wl_event_loop, job->fd[0],
+		WL_EVENT_READABLE, handle_read_done, job);
+	if (!job->source || !reload_job_read(job)) {
+		reload_job_destroy(job);
+		return false;
+	}
+	reload_job = job;
+	return true;
+}
+
+void reload_cancel(void) {
+	if (reload_job) {
+		reload_job_destroy(reload_job);
+		reload_job = NULL;
+	}
 }
 
 struct cmd_results *cmd_reload(int argc, char **argv) {
@@ -57,12 +216,22 @@ struct cmd_results *cmd_reload(int argc, char **argv) {
 		return error;
 	}
 
+	if (reload_job) {
+		reload_job->again = true;
+		return cmd_results_new(CMD_SUCCESS, NULL);
+	}
+	if (reload_start()) {
+		return cmd_results_new(CMD_SUCCESS, NULL);
+	}
+
+	// Unable to read ahead, read and validate the config right away
 	const char *path = NULL;
 	if (config->user_config_path) {
 		path = config->current_config_path;
 	}
 
 	if (!load_main_config(path, true, true)) {
+		ipc_event_config_reload(false);
 		return cmd_results_new(CMD_FAILURE, "Error(s) reloading config.");
 	}
 
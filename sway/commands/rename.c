@@ -92,8 +92,10 @@ struct cmd_results *cmd_rename(int argc, char **argv) {
 
 	sway_log(SWAY_DEBUG, "renaming workspace '%s' to '%s'", workspace->name, new_name);
 
+	root_index_remove_workspace(workspace);
 	free(workspace->name);
 	workspace->name = new_name;
+	root_index_add_workspace(workspace);
 
 	output_sort_workspaces(workspace->output);
 	ipc_event_workspace(NULL, workspace, "rename");
@@ -0,0 +1,31 @@
+#include <string.h>
+#include "sway/commands.h"
+#include "sway/tree/space.h"
+#include "log.h"
+#include "stringop.h"
+
+struct cmd_results *cmd_space_file(int argc, char **argv) {
+	struct cmd_results *error = NULL;
+	if ((error = checkarg(argc, "space_file", EXPECTED_AT_LEAST, 1))) {
+		return error;
+	}
+
+	free(config->space_file);
+	config->space_file = NULL;
+
+	char *path = join_args(argv, argc);
+	if (strcmp(path, "none") == 0) {
+		free(path);
+		return cmd_results_new(CMD_SUCCESS, NULL);
+	}
+	if (!expand_path(&path)) {
+		error = cmd_results_new(CMD_INVALID, "Invalid path: %s", path);
+		free(path);
+		return error;
+	}
+	config->space_file = path;
+	sway_log(SWAY_DEBUG, "Using space file: %s", config->space_file);
+	space_read_file(config->space_file);
+
+	return cmd_results_new(CMD_SUCCESS, NULL);
+}
@@ -24,9 +24,11 @@
 #include "sway/criteria.h"
 #include "sway/desktop/transaction.h"
 #include "sway/server.h"
+#include "sway/sway_text_node.h"
 #include "sway/swaynag.h"
 #include "sway/tree/arrange.h"
 #include "sway/tree/root.h"
+#include "sway/tree/view.h"
 #include "sway/tree/workspace.h"
 #include "cairo_util.h"
 #include "pango.h"
@@ -198,11 +200,9 @@ void free_config(struct sway_config *config) {
 		animation_path_destroy(config->animations.workspace_switch);
 	}
 
-	list_free_items_and_destroy(config->lua.cbs_view_map);
-	list_free_items_and_destroy(config->lua.cbs_view_unmap);
-	list_free_items_and_destroy(config->lua.cbs_view_urgent);
-	list_free_items_and_destroy(config->lua.cbs_view_focus);
-	list_free_items_and_destroy(config->lua.cbs_workspace_create);
+	if (config->lua.state) {
+		sway_lua_callbacks_finish(&config->lua);
+	}
 	for (int i = 0; i < config->lua.scripts->length; ++i) {
 		struct sway_lua_script *script = config->lua.scripts->items[i];
 		free(script->name);
@@ -216,6 +216,9 @@ void free_config(struct sway_config *config) {
 	list_free(config->no_focus);
 	list_free(config->active_bar_modifiers);
 	list_free_items_and_destroy(config->config_chain);
+	for (int i = 0; i < CONFIG_SECTION_COUNT; ++i) {
+		list_free_items_and_destroy(config->sections[i]);
+	}
 	free(config->floating_scroll_up_cmd);
 	free(config->floating_scroll_down_cmd);
 	free(config->floating_scroll_left_cmd);
@@ -223,6 +226,8 @@ void free_config(struct sway_config *config) {
 	free(config->font);
 	free(config->swaybg_command);
 	free(config->swaynag_command);
+	free(config->space_file);
+	free(config->output_cache_file);
 	free((char *)config->current_config_path);
 	free((char *)config->current_config);
 	keysym_translation_state_destroy(config->keysym_translation_state);
@@ -301,6 +306,8 @@ static void config_defaults(struct sway_config *config) {
 	config->gesture_scroll_enable = true;
 	config->gesture_scroll_fingers = 3;
 	config->gesture_scroll_sentitivity = 1.0f;
+	config->gesture_scroll_kinetic = false;
+	config->gesture_scroll_friction = 4.0f;
 
 	config->animations.frequency_ms = 16; // ~60 Hz
 	config->animations.enabled = true;
@@ -314,7 +321,6 @@ static void config_defaults(struct sway_config *config) {
 	}
 	struct sway_animation_curve *curve = create_animation_curve(300, 3, default_points, 0.0, 0, NULL);
 	config->animations.anim_default = animation_path_create(true);
-	animation_set_default_callbacks();
 	animation_path_add_curve(config->animations.anim_default, curve);
 	animation_set_path(config->animations.anim_default);
 	list_free_items_and_destroy(default_points);
@@ -324,12 +330,8 @@ static void config_defaults(struct sway_config *config) {
 	config->animations.workspace_switch = NULL;
 
 	if (!(config->lua.state = luaL_newstate())) goto cleanup;
+	sway_lua_callbacks_init(&config->lua);
 	if (!(config->lua.scripts = create_list())) goto cleanup;
-	if (!(config->lua.cbs_view_map = create_list())) goto cleanup;
-	if (!(config->lua.cbs_view_unmap = create_list())) goto cleanup;
-	if (!(config->lua.cbs_view_urgent = create_list())) goto cleanup;
-	if (!(config->lua.cbs_view_focus = create_list())) goto cleanup;
-	if (!(config->lua.cbs_workspace_create = create_list())) goto cleanup;
 	luaL_openlibs(config->lua.state);
 	luaL_requiref(config->lua.state, "scroll", luaopen_scroll, 1);
 	lua_pop(config->lua.state, 1);
@@ -431,6 +433,9 @@ static void config_defaults(struct sway_config *config) {
 	if (!(config->swaybg_command = strdup("swaybg"))) goto cleanup;
 
 	if (!(config->config_chain = create_list())) goto cleanup;
+	for (int i = 0; i < CONFIG_SECTION_COUNT; ++i) {
+		if (!(config->sections[i] = create_list())) goto cleanup;
+	}
 	config->current_config_path = NULL;
 	config->current_config = NULL;
 
@@ -529,7 +534,7 @@ static char *config_path(const char *prefix, const char *config_folder) {
 	return format_str("%s/%s/config", prefix, config_folder);
 }
 
-static char *get_config_path(void) {
+char *get_config_path(void) {
 	char *path = NULL;
 	const char *home = getenv("HOME");
 	char *config_home_fallback = NULL;
@@ -586,7 +591,11 @@ static bool load_config(const char *path, struct sway_config *config,
 		return false;
 	}
 
-	FILE *f = fopen(path, "r");
+	// A reload reads the files ahead, off the main thread
+	struct config_snapshot_file *snapshot =
+		config_snapshot_find(config->snapshot, path);
+	FILE *f = snapshot && snapshot->size > 0 ?
+		fmemopen(snapshot->contents, snapshot->size, "r") : fopen(path, "r");
 	if (!f) {
 		sway_log(SWAY_ERROR, "Unable to open %s for reading", path);
 		return false;
@@ -602,6 +611,42 @@ static bool load_config(const char *path, struct sway_config *config,
 	return config->active || !config->validating || config_load_success;
 }
 
+static bool criteria_equal(struct criteria *a, struct criteria *b) {
+	return a->type == b->type && strcmp(a->raw, b->raw) == 0 &&
+		(a->cmdlist == b->cmdlist || (a->cmdlist && b->cmdlist &&
+		strcmp(a->cmdlist, b->cmdlist) == 0));
+}
+
+// Points the criteria a view has run at their counterparts in the new config,
+// so a reload does not run unchanged for_window rules on it again
+static void remap_executed_criteria(struct sway_container *con, void *data) {
+	struct sway_config *old_config = data;
+	if (!con->view) {
+		return;
+	}
+	list_t *executed = create_list();
+	for (int i = 0; i < old_config->criteria->length; ++i) {
+		struct criteria *old = old_config->criteria->items[i];
+		if (old->type == CT_COMMAND &&
+				view_has_executed_criteria(con->view, old)) {
+			list_add(executed, old);
+		}
+	}
+	view_clear_executed_criteria(con->view);
+	for (int i = 0; i < executed->length; ++i) {
+		struct criteria *old = executed->items[i];
+		for (int j = 0; j < config->criteria->length; ++j) {
+			struct criteria *criteria = config->criteria->items[j];
+			if (criteria_equal(old, criteria) &&
+					!view_has_executed_criteria(con->view, criteria)) {
+				view_set_executed_criteria(con->view, criteria);
+				break;
+			}
+		}
+	}
+	list_free(executed);
+}
+
 bool load_main_config(const char *file, bool is_active, bool validating) {
 	char *path;
 	if (file != NULL) {
@@ -645,6 +690,8 @@ bool load_main_config(const char *file, bool is_active, bool validating) {
 				old_config->primary_selection ? "enabled" : "disabled");
 		config->primary_selection = old_config->primary_selection;
 
+		config->snapshot = old_config->snapshot;
+
 		if (!config->validating) {
 			if (old_config->swaybg_client != NULL) {
 				wl_client_destroy(old_config->swaybg_client);
@@ -653,8 +700,6 @@ bool load_main_config(const char *file, bool is_active, bool validating) {
 			if (old_config->swaynag_config_errors.client != NULL) {
 				wl_client_destroy(old_config->swaynag_config_errors.client);
 			}
-
-			input_manager_reset_all_inputs();
 		}
 	}
 
@@ -674,21 +719,33 @@ bool load_main_config(const char *file, bool is_active, bool validating) {
 
 	// Only really necessary if not explicitly `font` is set in the config.
 	config_update_font_height();
+	sway_label_atlas_rebuild();
 
 	if (!validating) {
 		input_manager_verify_fallback_seat();
 
-		for (int i = 0; i < config->input_configs->length; i++) {
-			input_manager_apply_input_config(config->input_configs->items[i]);
-		}
+		// A reload only reconfigures devices and outputs when their part of
+		// the config changed
+		if (config_section_changed(old_config, config, CONFIG_SECTION_INPUTS)) {
+			if (is_active) {
+				input_manager_reset_all_inputs();
+			}
 
-		for (int i = 0; i < config->input_type_configs->length; i++) {
-			input_manager_apply_input_config(
-					config->input_type_configs->items[i]);
-		}
+			for (int i = 0; i < config->input_configs->length; i++) {
+				input_manager_apply_input_config(config->input_configs->items[i]);
+			}
 
-		for (int i = 0; i < config->seat_configs->length; i++) {
-			input_manager_apply_seat_config(config->seat_configs->items[i]);
+			for (int i = 0; i < config->input_type_configs->length; i++) {
+				input_manager_apply_input_config(
+						config->input_type_configs->items[i]);
+			}
+
+			for (int i = 0; i < config->seat_configs->length; i++) {
+				input_manager_apply_seat_config(config->seat_configs->items[i]);
+			}
+		} else {
+			sway_log(SWAY_DEBUG, "Input and seat config unchanged");
+			input_manager_retranslate_keysyms();
 		}
 		sway_switch_retrigger_bindings_for_all();
 
@@ -696,7 +753,12 @@ bool load_main_config(const char *file, bool is_active, bool validating) {
 
 		config->reloading = false;
 		if (is_active) {
-			request_modeset();
+			if (config_section_changed(old_config, config,
+					CONFIG_SECTION_OUTPUTS)) {
+				request_modeset();
+			} else {
+				sway_log(SWAY_DEBUG, "Output config unchanged");
+			}
 			if (config->swaynag_config_errors.client != NULL) {
 				swaynag_show(&config->swaynag_config_errors);
 			}
@@ -704,6 +766,7 @@ bool load_main_config(const char *file, bool is_active, bool validating) {
 	}
 
 	if (old_config) {
+		root_for_each_container(remap_executed_criteria, old_config);
 		destroy_removed_seats(old_config, config);
 		free_config(old_config);
 	}
@@ -888,6 +951,56 @@ static char *expand_line(const char *block, const char *line, bool add_brace) {
 	return expanded;
 }
 
+static void config_section_add_line(struct sway_config *config,
+		const char *line) {
+	static const struct {
+		const char *command;
+		enum config_section section;
+	} sections[] = {
+		{ "set", CONFIG_SECTION_VARIABLES },
+		{ "lua", CONFIG_SECTION_SCRIPTS },
+		{ "output", CONFIG_SECTION_OUTPUTS },
+		{ "input", CONFIG_SECTION_INPUTS },
+		{ "seat", CONFIG_SECTION_INPUTS },
+	};
+	size_t length = strcspn(line, " \t");
+	for (size_t i = 0; i < sizeof(sections) / sizeof(sections[0]); ++i) {
+		if (strlen(sections[i].command) == length &&
+				strncasecmp(line, sections[i].command, length) == 0) {
+			list_add(config->sections[sections[i].section], strdup(line));
+			return;
+		}
+	}
+}
+
+static bool section_lines_equal(list_t *a, list_t *b) {
+	if (a->length != b->length) {
+		return false;
+	}
+	for (int i = 0; i < a->length; ++i) {
+		if (strcmp(a->items[i], b->items[i]) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool config_section_changed(struct sway_config *old_config,
+		struct sway_config *new_config, enum config_section section) {
+	if (!old_config) {
+		return true;
+	}
+	// Scripts may change anything and variables may be used anywhere
+	if (old_config->sections[CONFIG_SECTION_SCRIPTS]->length ||
+			new_config->sections[CONFIG_SECTION_SCRIPTS]->length) {
+		return true;
+	}
+	return !section_lines_equal(old_config->sections[CONFIG_SECTION_VARIABLES],
+			new_config->sections[CONFIG_SECTION_VARIABLES]) ||
+		!section_lines_equal(old_config->sections[section],
+			new_config->sections[section]);
+}
+
 bool read_config(FILE *file, struct sway_config *config,
 		struct swaynag_instance *swaynag) {
 	bool reading_main_config = false;
@@ -957,6 +1070,7 @@ bool read_config(FILE *file, struct sway_config *config,
 			success = false;
 			break;
 		}
+		config_section_add_line(config, expanded);
 		config->current_config_line_number = line_number;
 		config->current_config_line = line;
 		struct cmd_results *res;
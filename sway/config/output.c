@@ -1,6 +1,8 @@
 #include <assert.h>
 #include <drm_fourcc.h>
+#include <json.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/wait.h>
@@ -19,6 +21,7 @@
 #include "sway/lock.h"
 #include "sway/output.h"
 #include "sway/server.h"
+#include "sway/sway_text_node.h"
 #include "sway/tree/arrange.h"
 #include "sway/tree/root.h"
 #include "log.h"
@@ -731,8 +734,87 @@ struct search_context {
 	struct matched_output_config *configs;
 	size_t configs_len;
 	bool degrade_to_off;
+
+	// All outputs disabled but the one being probed, see search_test_alone()
+	struct wlr_backend_output_state *probe_states;
+	list_t *memos; // struct search_memo
+};
+
+/**
+ * The outcome of testing a candidate state of one output with every other
+ * output disabled. Enabling more outputs only adds constraints, so a state
+ * that fails on its own is skipped for every combination of the outputs
+ * around it instead of being tested again at each leaf of the search.
+ */
+struct search_memo {
+	size_t output_idx;
+	uint32_t committed;
+	uint32_t render_format;
+	enum wlr_output_state_mode_type mode_type;
+	struct wlr_output_mode *mode;
+	int32_t width, height, refresh; // custom mode
+	bool adaptive_sync_enabled;
+	bool ok;
 };
 
+#define SEARCH_MEMO_STATE (WLR_OUTPUT_STATE_RENDER_FORMAT | \
+	WLR_OUTPUT_STATE_MODE | WLR_OUTPUT_STATE_ADAPTIVE_SYNC_ENABLED)
+
+static void search_memo_init(struct search_memo *memo, size_t output_idx,
+		const struct wlr_output_state *state) {
+	*memo = (struct search_memo){
+		.output_idx = output_idx,
+		.committed = state->committed & SEARCH_MEMO_STATE,
+	};
+	if (memo->committed & WLR_OUTPUT_STATE_RENDER_FORMAT) {
+		memo->render_format = state->render_format;
+	}
+	if (memo->committed & WLR_OUTPUT_STATE_MODE) {
+		memo->mode_type = state->mode_type;
+		if (state->mode_type == WLR_OUTPUT_STATE_MODE_CUSTOM) {
+			memo->width = state->custom_mode.width;
+			memo->height = state->custom_mode.height;
+			memo->refresh = state->custom_mode.refresh;
+		} else {
+			memo->mode = state->mode;
+		}
+	}
+	if (memo->committed & WLR_OUTPUT_STATE_ADAPTIVE_SYNC_ENABLED) {
+		memo->adaptive_sync_enabled = state->adaptive_sync_enabled;
+	}
+}
+
+static struct search_memo *search_memo_find(struct search_context *ctx,
+		struct search_memo *key) {
+	for (int i = 0; i < ctx->memos->length; i++) {
+		struct search_memo *memo = ctx->memos->items[i];
+		if (memo->output_idx == key->output_idx &&
+				memo->committed == key->committed &&
+				memo->render_format == key->render_format &&
+				memo->mode_type == key->mode_type &&
+				memo->mode == key->mode &&
+				memo->width == key->width &&
+				memo->height == key->height &&
+				memo->refresh == key->refresh &&
+				memo->adaptive_sync_enabled == key->adaptive_sync_enabled) {
+			return memo;
+		}
+	}
+	return NULL;
+}
+
+static void search_memo_add(struct search_context *ctx,
+		struct search_memo *key, bool ok) {
+	struct search_memo *memo = malloc(sizeof(*memo));
+	if (!memo) {
+		sway_log(SWAY_ERROR, "Unable to allocate output search memo");
+		return;
+	}
+	*memo = *key;
+	memo->ok = ok;
+	list_add(ctx->memos, memo);
+}
+
 static void dump_output_state(struct wlr_output *wlr_output, struct wlr_output_state *state) {
 	sway_log(SWAY_DEBUG, "Output state for %s", wlr_output->name);
 	if (state->committed & WLR_OUTPUT_STATE_ENABLED) {
@@ -788,6 +870,19 @@ static void clear_later_output_states(struct wlr_backend_output_state *states,
 	}
 }
 
+static bool search_test_alone(struct search_context *ctx, size_t output_idx) {
+	struct wlr_output_state *probe = &ctx->probe_states[output_idx].base;
+	if (!wlr_output_state_copy(probe, &ctx->states[output_idx].base)) {
+		// Unable to probe, leave it to the full test
+		return true;
+	}
+	bool ok = wlr_output_swapchain_manager_prepare(ctx->swapchain_mgr,
+		ctx->probe_states, ctx->configs_len);
+	reset_output_state(probe);
+	wlr_output_state_set_enabled(probe, false);
+	return ok;
+}
+
 static bool search_finish(struct search_context *ctx, size_t output_idx) {
 	struct wlr_backend_output_state *backend_state = &ctx->states[output_idx];
 	struct wlr_output_state *state = &backend_state->base;
@@ -795,8 +890,35 @@ static bool search_finish(struct search_context *ctx, size_t output_idx) {
 
 	clear_later_output_states(ctx->states, ctx->configs_len, output_idx);
 	dump_output_state(wlr_output, state);
-	return wlr_output_swapchain_manager_prepare(ctx->swapchain_mgr, ctx->states, ctx->configs_len) &&
-		search_valid_config(ctx, output_idx+1);
+
+	struct search_memo key;
+	bool memoize = state->enabled;
+	if (memoize) {
+		search_memo_init(&key, output_idx, state);
+		struct search_memo *memo = search_memo_find(ctx, &key);
+		if (memo && !memo->ok) {
+			sway_log(SWAY_DEBUG, "Skipping state that failed on its own");
+			return false;
+		}
+		if (memo) {
+			memoize = false;
+		} else if (output_idx > 0) {
+			bool ok = search_test_alone(ctx, output_idx);
+			search_memo_add(ctx, &key, ok);
+			if (!ok) {
+				return false;
+			}
+			memoize = false;
+		}
+	}
+
+	bool ok = wlr_output_swapchain_manager_prepare(ctx->swapchain_mgr,
+		ctx->states, ctx->configs_len);
+	if (memoize) {
+		// The later outputs are disabled, so the first one was tested alone
+		search_memo_add(ctx, &key, ok);
+	}
+	return ok && search_valid_config(ctx, output_idx+1);
 }
 
 static bool search_adaptive_sync(struct search_context *ctx, size_t output_idx) {
@@ -964,6 +1086,419 @@ static void sort_output_configs_by_priority(
 	qsort(configs, configs_len, sizeof(*configs), compare_matched_output_config_priority);
 }
 
+/**
+ * Output states that passed the search, keyed by the identifiers (make, model
+ * and serial from the EDID) of the whole set of outputs they were found for.
+ * Reconnecting a known set of outputs tries its cached states first, which
+ * takes a single test instead of a search.
+ */
+struct output_cache_output {
+	char *identifier;
+	bool enabled;
+	uint32_t render_format; // DRM_FORMAT_INVALID if not set
+	int32_t width, height, refresh; // 0 if no mode was set
+	bool adaptive_sync_enabled;
+};
+
+struct output_cache_entry {
+	char *key;
+	size_t outputs_len;
+	struct output_cache_output *outputs;
+};
+
+#define OUTPUT_CACHE_MAX_ENTRIES 16
+
+static list_t *output_cache = NULL; // struct output_cache_entry, most recent first
+
+static int cmp_identifiers(const void *a, const void *b) {
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Sorted identifiers joined by newlines, so the key ignores connector order
+static char *output_cache_key(char **identifiers, size_t len) {
+	char **sorted = calloc(len, sizeof(char *));
+	if (!sorted) {
+		return NULL;
+	}
+	memcpy(sorted, identifiers, len * sizeof(char *));
+	qsort(sorted, len, sizeof(char *), cmp_identifiers);
+	size_t size = 1;
+	for (size_t i = 0; i < len; i++) {
+		size += strlen(sorted[i]) + 1;
+	}
+	char *key = calloc(size, 1);
+	if (key) {
+		for (size_t i = 0; i < len; i++) {
+			strcat(key, sorted[i]);
+			strcat(key, "\n");
+		}
+	}
+	free(sorted);
+	return key;
+}
+
+static void output_cache_entry_destroy(struct output_cache_entry *entry) {
+	for (size_t i = 0; i < entry->outputs_len; i++) {
+		free(entry->outputs[i].identifier);
+	}
+	free(entry->outputs);
+	free(entry->key);
+	free(entry);
+}
+
+static struct output_cache_entry *output_cache_entry_create(size_t outputs_len) {
+	struct output_cache_entry *entry = calloc(1, sizeof(*entry));
+	if (!entry) {
+		return NULL;
+	}
+	entry->outputs = calloc(outputs_len, sizeof(*entry->outputs));
+	if (!entry->outputs) {
+		free(entry);
+		return NULL;
+	}
+	entry->outputs_len = outputs_len;
+	return entry;
+}
+
+// Sets the key from the identifiers of the outputs, false if out of memory
+static bool output_cache_entry_set_key(struct output_cache_entry *entry) {
+	char **identifiers = calloc(entry->outputs_len, sizeof(char *));
+	if (!identifiers) {
+		return false;
+	}
+	for (size_t i = 0; i < entry->outputs_len; i++) {
+		identifiers[i] = entry->outputs[i].identifier;
+	}
+	entry->key = output_cache_key(identifiers, entry->outputs_len);
+	free(identifiers);
+	return entry->key != NULL;
+}
+
+static int output_cache_find(const char *key) {
+	if (!output_cache || !key) {
+		return -1;
+	}
+	for (int i = 0; i < output_cache->length; i++) {
+		struct output_cache_entry *entry = output_cache->items[i];
+		if (strcmp(entry->key, key) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Adds the entry in front, replacing any entry with the same key
+static void output_cache_insert(struct output_cache_entry *entry) {
+	if (!output_cache) {
+		output_cache = create_list();
+	}
+	int idx = output_cache_find(entry->key);
+	if (idx >= 0) {
+		output_cache_entry_destroy(output_cache->items[idx]);
+		list_del(output_cache, idx);
+	}
+	list_insert(output_cache, 0, entry);
+	while (output_cache->length > OUTPUT_CACHE_MAX_ENTRIES) {
+		output_cache_entry_destroy(output_cache->items[output_cache->length - 1]);
+		list_del(output_cache, output_cache->length - 1);
+	}
+}
+
+static void output_cache_write_file(const char *path) {
+	json_object *obj = json_object_new_object();
+	json_object *layouts = json_object_new_array();
+	for (int i = 0; i < output_cache->length; i++) {
+		struct output_cache_entry *entry = output_cache->items[i];
+		json_object *outputs = json_object_new_array();
+		for (size_t j = 0; j < entry->outputs_len; j++) {
+			struct output_cache_output *cached = &entry->outputs[j];
+			json_object *output = json_object_new_object();
+			json_object_object_add(output, "identifier",
+				json_object_new_string(cached->identifier));
+			json_object_object_add(output, "enabled",
+				json_object_new_boolean(cached->enabled));
+			json_object_object_add(output, "render_format",
+				json_object_new_int64(cached->render_format));
+			json_object_object_add(output, "width",
+				json_object_new_int(cached->width));
+			json_object_object_add(output, "height",
+				json_object_new_int(cached->height));
+			json_object_object_add(output, "refresh",
+				json_object_new_int(cached->refresh));
+			json_object_object_add(output, "adaptive_sync",
+				json_object_new_boolean(cached->adaptive_sync_enabled));
+			json_object_array_add(outputs, output);
+		}
+		json_object *layout = json_object_new_object();
+		json_object_object_add(layout, "outputs", outputs);
+		json_object_array_add(layouts, layout);
+	}
+	json_object_object_add(obj, "layouts", layouts);
+
+	size_t len;
+	const char *data = json_object_to_json_string_length(obj,
+		JSON_C_TO_STRING_PLAIN, &len);
+	write_file_atomic(path, data, len);
+	json_object_put(obj);
+}
+
+static int64_t json_get_int(json_object *obj, const char *key) {
+	json_object *value;
+	return json_object_object_get_ex(obj, key, &value) ?
+		json_object_get_int64(value) : 0;
+}
+
+void output_cache_read_file(const char *path) {
+	json_object *obj = json_object_from_file(path);
+	if (!obj) {
+		sway_log(SWAY_DEBUG, "No output layouts read from %s", path);
+		return;
+	}
+	json_object *layouts;
+	if (!json_object_object_get_ex(obj, "layouts", &layouts) ||
+			!json_object_is_type(layouts, json_type_array)) {
+		sway_log(SWAY_ERROR, "Invalid output layout file %s", path);
+		json_object_put(obj);
+		return;
+	}
+	// Insert the oldest first, so the file order is kept
+	for (size_t i = json_object_array_length(layouts); i-- > 0;) {
+		json_object *layout = json_object_array_get_idx(layouts, i);
+		json_object *outputs;
+		if (!json_object_object_get_ex(layout, "outputs", &outputs) ||
+				!json_object_is_type(outputs, json_type_array) ||
+				json_object_array_length(outputs) == 0) {
+			continue;
+		}
+		size_t outputs_len = json_object_array_length(outputs);
+		struct output_cache_entry *entry = output_cache_entry_create(outputs_len);
+		if (!entry) {
+			break;
+		}
+		bool valid = true;
+		for (size_t j = 0; j < outputs_len; j++) {
+			json_object *output = json_object_array_get_idx(outputs, j);
+			struct output_cache_output *cached = &entry->outputs[j];
+			json_object *value;
+			if (!json_object_object_get_ex(output, "identifier", &value) ||
+					!json_object_is_type(value, json_type_string)) {
+				valid = false;
+				break;
+			}
+			cached->identifier = strdup(json_object_get_string(value));
+			cached->enabled = json_object_object_get_ex(output, "enabled", &value) &&
+				json_object_get_boolean(value);
+			cached->render_format = json_get_int(output, "render_format");
+			cached->width = json_get_int(output, "width");
+			cached->height = json_get_int(output, "height");
+			cached->refresh = json_get_int(output, "refresh");
+			cached->adaptive_sync_enabled =
+				json_object_object_get_ex(output, "adaptive_sync", &value) &&
+				json_object_get_boolean(value);
+		}
+		if (!valid || !output_cache_entry_set_key(entry) ||
+				output_cache_find(entry->key) >= 0) {
+			// Layouts found at runtime are newer than the ones on disk
+			output_cache_entry_destroy(entry);
+			continue;
+		}
+		output_cache_insert(entry);
+	}
+	json_object_put(obj);
+}
+
+void output_cache_clear(void) {
+	if (!output_cache) {
+		return;
+	}
+	for (int i = 0; i < output_cache->length; i++) {
+		output_cache_entry_destroy(output_cache->items[i]);
+	}
+	list_free(output_cache);
+	output_cache = NULL;
+}
+
+static char *matched_output_configs_key(struct matched_output_config *configs,
+		size_t configs_len) {
+	char **identifiers = calloc(configs_len, sizeof(char *));
+	if (!identifiers) {
+		return NULL;
+	}
+	char *key = NULL;
+	for (size_t idx = 0; idx < configs_len; idx++) {
+		char identifier[128];
+		output_get_identifier(identifier, sizeof(identifier), configs[idx].output);
+		if (!(identifiers[idx] = strdup(identifier))) {
+			goto out;
+		}
+	}
+	key = output_cache_key(identifiers, configs_len);
+out:
+	for (size_t idx = 0; idx < configs_len; idx++) {
+		free(identifiers[idx]);
+	}
+	free(identifiers);
+	return key;
+}
+
+static void output_cache_store(struct search_context *ctx, const char *key) {
+	struct output_cache_entry *entry = output_cache_entry_create(ctx->configs_len);
+	if (!entry || !(entry->key = strdup(key))) {
+		sway_log(SWAY_ERROR, "Unable to allocate output layout cache entry");
+		if (entry) {
+			output_cache_entry_destroy(entry);
+		}
+		return;
+	}
+	for (size_t idx = 0; idx < ctx->configs_len; idx++) {
+		struct wlr_output_state *state = &ctx->states[idx].base;
+		struct wlr_output *wlr_output = ctx->states[idx].output;
+		struct output_cache_output *cached = &entry->outputs[idx];
+		char identifier[128];
+		output_get_identifier(identifier, sizeof(identifier), ctx->configs[idx].output);
+		cached->identifier = strdup(identifier);
+		cached->enabled = (state->committed & WLR_OUTPUT_STATE_ENABLED) ?
+			state->enabled : wlr_output->enabled;
+		cached->render_format = (state->committed & WLR_OUTPUT_STATE_RENDER_FORMAT) ?
+			state->render_format : DRM_FORMAT_INVALID;
+		if (!(state->committed & WLR_OUTPUT_STATE_MODE)) {
+			// Keep the current mode
+		} else if (state->mode_type == WLR_OUTPUT_STATE_MODE_CUSTOM) {
+			cached->width = state->custom_mode.width;
+			cached->height = state->custom_mode.height;
+			cached->refresh = state->custom_mode.refresh;
+		} else if (state->mode) {
+			cached->width = state->mode->width;
+			cached->height = state->mode->height;
+			cached->refresh = state->mode->refresh;
+		}
+		cached->adaptive_sync_enabled =
+			(state->committed & WLR_OUTPUT_STATE_ADAPTIVE_SYNC_ENABLED) &&
+			state->adaptive_sync_enabled;
+	}
+	output_cache_insert(entry);
+	if (config->output_cache_file) {
+		output_cache_write_file(config->output_cache_file);
+	}
+}
+
+/**
+ * Queues the cached states of this set of outputs, within what the search
+ * itself may change, and tests them.
+ */
+static bool output_cache_restore(struct search_context *ctx, const char *key) {
+	int entry_idx = output_cache_find(key);
+	if (entry_idx < 0) {
+		return false;
+	}
+	struct output_cache_entry *entry = output_cache->items[entry_idx];
+	bool *used = calloc(entry->outputs_len, sizeof(bool));
+	if (!used) {
+		return false;
+	}
+
+	bool ok = true;
+	for (size_t idx = 0; idx < ctx->configs_len && ok; idx++) {
+		struct matched_output_config *cfg = &ctx->configs[idx];
+		struct wlr_output_state *state = &ctx->states[idx].base;
+		struct wlr_output *wlr_output = ctx->states[idx].output;
+		char identifier[128];
+		output_get_identifier(identifier, sizeof(identifier), cfg->output);
+
+		struct output_cache_output *cached = NULL;
+		for (size_t i = 0; i < entry->outputs_len; i++) {
+			if (!used[i] && strcmp(entry->outputs[i].identifier, identifier) == 0) {
+				used[i] = true;
+				cached = &entry->outputs[i];
+				break;
+			}
+		}
+		if (!cached) {
+			ok = false;
+			break;
+		}
+
+		reset_output_state(state);
+		if (output_config_is_disabling(cfg->config)) {
+			wlr_output_state_set_enabled(state, false);
+			continue;
+		}
+		if (!cached->enabled) {
+			ok = ctx->degrade_to_off;
+			wlr_output_state_set_enabled(state, false);
+			continue;
+		}
+		queue_output_config(cfg->config, cfg->output, state);
+		if (cached->render_format != DRM_FORMAT_INVALID) {
+			wlr_output_state_set_render_format(state, cached->render_format);
+		}
+		if (!config_has_manual_mode(cfg->config) && cached->width > 0) {
+			struct wlr_output_mode *mode;
+			wl_list_for_each(mode, &wlr_output->modes, link) {
+				if (mode->width == cached->width && mode->height == cached->height &&
+						mode->refresh == cached->refresh) {
+					wlr_output_state_set_mode(state, mode);
+					break;
+				}
+			}
+		}
+		if (wlr_output->adaptive_sync_supported) {
+			wlr_output_state_set_adaptive_sync_enabled(state,
+				cached->adaptive_sync_enabled && cfg->config &&
+				cfg->config->adaptive_sync == 1);
+		}
+	}
+	free(used);
+
+	if (!ok || !wlr_output_swapchain_manager_prepare(ctx->swapchain_mgr,
+			ctx->states, ctx->configs_len)) {
+		sway_log(SWAY_DEBUG, "Cached output layout no longer works");
+		return false;
+	}
+	// Most recently used first
+	list_del(output_cache, entry_idx);
+	list_insert(output_cache, 0, entry);
+	return true;
+}
+
+static bool search_output_configs(struct search_context *ctx) {
+	char *key = matched_output_configs_key(ctx->configs, ctx->configs_len);
+	if (key && output_cache_restore(ctx, key)) {
+		sway_log(SWAY_DEBUG, "Using cached output layout");
+		free(key);
+		return true;
+	}
+
+	ctx->probe_states = calloc(ctx->configs_len, sizeof(*ctx->probe_states));
+	ctx->memos = create_list();
+	if (!ctx->probe_states || !ctx->memos) {
+		free(ctx->probe_states);
+		list_free(ctx->memos);
+		free(key);
+		return false;
+	}
+	for (size_t idx = 0; idx < ctx->configs_len; idx++) {
+		ctx->probe_states[idx].output = ctx->states[idx].output;
+		wlr_output_state_init(&ctx->probe_states[idx].base);
+		wlr_output_state_set_enabled(&ctx->probe_states[idx].base, false);
+	}
+
+	bool ok = search_valid_config(ctx, 0);
+	if (ok && key) {
+		output_cache_store(ctx, key);
+	}
+	sway_log(SWAY_DEBUG, "Output search done, %d output states memoized",
+		ctx->memos->length);
+
+	for (size_t idx = 0; idx < ctx->configs_len; idx++) {
+		wlr_output_state_finish(&ctx->probe_states[idx].base);
+	}
+	free(ctx->probe_states);
+	list_free_items_and_destroy(ctx->memos);
+	free(key);
+	return ok;
+}
+
 static bool apply_resolved_output_configs(struct matched_output_config *configs,
 		size_t configs_len, bool test_only, bool degrade_to_off) {
 	struct wlr_backend_output_state *states = calloc(configs_len, sizeof(*states));
@@ -996,7 +1531,7 @@ static bool apply_resolved_output_configs(struct matched_output_config *configs,
 			.configs_len = configs_len,
 			.degrade_to_off = degrade_to_off,
 		};
-		if (!search_valid_config(&ctx, 0)) {
+		if (!search_output_configs(&ctx)) {
 			sway_log(SWAY_ERROR, "Search for valid config failed");
 			goto out;
 		}
@@ -1040,6 +1575,9 @@ static bool apply_resolved_output_configs(struct matched_output_config *configs,
 		sway_log(SWAY_DEBUG, "Finalizing config for %s",
 			cfg->output->wlr_output->name);
 		finalize_output_config(cfg->config, cfg->output);
+		if (cfg->output->enabled) {
+			sway_label_atlas_prepare(cfg->output->wlr_output->scale);
+		}
 	}
 
 	// Output layout being applied in finalize_output_config can shift outputs
@@ -0,0 +1,206 @@
+#undef _POSIX_C_SOURCE
+#define _XOPEN_SOURCE 700 // for realpath
+#include <libgen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <wordexp.h>
+#include "sway/config.h"
+#include "list.h"
+#include "log.h"
+#include "stringop.h"
+
+// Deeper include chains are left to the main thread
+#define SNAPSHOT_MAX_DEPTH 16
+
+static char *read_file(const char *path, size_t *size) {
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		return NULL;
+	}
+	char *contents = NULL;
+	if (fseek(f, 0, SEEK_END) == 0) {
+		long length = ftell(f);
+		rewind(f);
+		if (length >= 0 && (contents = malloc(length + 1))) {
+			*size = fread(contents, 1, length, f);
+			contents[*size] = '\0';
+		}
+	}
+	fclose(f);
+	return contents;
+}
+
+static void snapshot_path_add(list_t *list, char *path, int depth) {
+	struct config_snapshot_path *entry = calloc(1, sizeof(*entry));
+	if (!path || !entry) {
+		free(path);
+		free(entry);
+		return;
+	}
+	entry->path = path;
+	entry->depth = depth;
+	list_add(list, entry);
+}
+
+static void snapshot_path_list_clear(list_t *list) {
+	for (int i = 0; i < list->length; ++i) {
+		struct config_snapshot_path *entry = list->items[i];
+		free(entry->path);
+		free(entry);
+	}
+	list->length = 0;
+}
+
+// Collects the include lines of a config file, to be expanded on the main
+// thread. Paths using config variables are skipped, their value is only
+// known once the config is parsed.
+static void snapshot_add_includes(struct config_snapshot *snapshot,
+		const char *contents, const char *parent, int depth) {
+	char *parent_path = strdup(parent);
+	if (!parent_path) {
+		return;
+	}
+	const char *parent_dir = dirname(parent_path);
+	const char *line = contents;
+	while (line && *line) {
+		const char *end = strchr(line, '\n');
+		size_t length = end ? (size_t)(end - line) : strlen(line);
+		char *copy = strndup(line, length);
+		line = end ? end + 1 : NULL;
+		if (!copy) {
+			break;
+		}
+		strip_whitespace(copy);
+		if (strncmp(copy, "include", 7) == 0 && (copy[7] == ' ' ||
+				copy[7] == '\t') && !strchr(copy, '$') &&
+				!strchr(parent_dir, '\'')) {
+			char *arg = copy + 8;
+			while (*arg == ' ' || *arg == '\t') {
+				++arg;
+			}
+			// Relative paths are relative to the including file
+			char *pattern = arg[0] == '/' || arg[0] == '~' ?
+				strdup(arg) : format_str("'%s'/%s", parent_dir, arg);
+			snapshot_path_add(snapshot->includes, pattern, depth + 1);
+		}
+		free(copy);
+	}
+	free(parent_path);
+}
+
+static void snapshot_add(struct config_snapshot *snapshot, const char *path,
+		int depth) {
+	if (depth > SNAPSHOT_MAX_DEPTH) {
+		return;
+	}
+	char *real_path = realpath(path, NULL);
+	if (!real_path) {
+		return;
+	}
+	struct stat sb;
+	if (config_snapshot_find(snapshot, real_path) ||
+			stat(real_path, &sb) != 0 || S_ISDIR(sb.st_mode)) {
+		free(real_path);
+		return;
+	}
+
+	struct config_snapshot_file *file = calloc(1, sizeof(*file));
+	if (!file) {
+		free(real_path);
+		return;
+	}
+	file->path = strdup(path);
+	file->real_path = real_path;
+	file->contents = read_file(real_path, &file->size);
+	if (!file->path || !file->contents) {
+		sway_log(SWAY_DEBUG, "Unable to read %s ahead of reload", path);
+		free(file->path);
+		free(file->real_path);
+		free(file->contents);
+		free(file);
+		return;
+	}
+	list_add(snapshot->files, file);
+
+	// The main config resolves includes against the path it was given,
+	// included files against their real path
+	snapshot_add_includes(snapshot, file->contents,
+		depth == 0 ? path : real_path, depth);
+}
+
+struct config_snapshot *config_snapshot_create(const char *path) {
+	struct config_snapshot *snapshot = calloc(1, sizeof(*snapshot));
+	if (!snapshot) {
+		return NULL;
+	}
+	snapshot->files = create_list();
+	snapshot->pending = create_list();
+	snapshot->includes = create_list();
+	snapshot_path_add(snapshot->pending, strdup(path), 0);
+	if (snapshot->pending->length == 0) {
+		config_snapshot_destroy(snapshot);
+		return NULL;
+	}
+	return snapshot;
+}
+
+void config_snapshot_read_pending(struct config_snapshot *snapshot) {
+	for (int i = 0; i < snapshot->pending->length; ++i) {
+		struct config_snapshot_path *entry = snapshot->pending->items[i];
+		snapshot_add(snapshot, entry->path, entry->depth);
+	}
+	snapshot_path_list_clear(snapshot->pending);
+}
+
+bool config_snapshot_expand_includes(struct config_snapshot *snapshot) {
+	for (int i = 0; i < snapshot->includes->length; ++i) {
+		struct config_snapshot_path *entry = snapshot->includes->items[i];
+		wordexp_t p;
+		if (wordexp(entry->path, &p, WRDE_NOCMD) != 0) {
+			continue;
+		}
+		for (size_t j = 0; j < p.we_wordc; ++j) {
+			snapshot_path_add(snapshot->pending, strdup(p.we_wordv[j]),
+				entry->depth);
+		}
+		wordfree(&p);
+	}
+	snapshot_path_list_clear(snapshot->includes);
+	return snapshot->pending->length > 0;
+}
+
+void config_snapshot_destroy(struct config_snapshot *snapshot) {
+	if (!snapshot) {
+		return;
+	}
+	for (int i = 0; i < snapshot->files->length; ++i) {
+		struct config_snapshot_file *file = snapshot->files->items[i];
+		free(file->path);
+		free(file->real_path);
+		free(file->contents);
+		free(file);
+	}
+	list_free(snapshot->files);
+	snapshot_path_list_clear(snapshot->pending);
+	list_free(snapshot->pending);
+	snapshot_path_list_clear(snapshot->includes);
+	list_free(snapshot->includes);
+	free(snapshot);
+}
+
+struct config_snapshot_file *config_snapshot_find(
+		struct config_snapshot *snapshot, const char *path) {
+	if (!snapshot) {
+		return NULL;
+	}
+	for (int i = 0; i < snapshot->files->length; ++i) {
+		struct config_snapshot_file *file = snapshot->files->items[i];
+		if (strcmp(file->path, path) == 0 ||
+				strcmp(file->real_path, path) == 0) {
+			return file;
+		}
+	}
+	return NULL;
+}
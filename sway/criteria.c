@@ -188,7 +188,7 @@ static bool criteria_matches_container(struct criteria *criteria,
 	return true;
 }
 
-static bool criteria_matches_view(struct criteria *criteria,
+bool criteria_matches_view(struct criteria *criteria,
 		struct sway_view *view) {
 	struct sway_seat *seat = input_manager_current_seat();
 	struct sway_container *focus = seat_get_focused_container(seat);
@@ -454,6 +454,50 @@ static bool criteria_matches_view(struct criteria *criteria,
 	return true;
 }
 
+static bool pattern_is_focused(struct pattern *pattern) {
+	return pattern && pattern->match_type == PATTERN_FOCUSED;
+}
+
+// Whether criteria compares a view with the focused one
+static bool criteria_matches_focused(struct criteria *criteria) {
+	if (criteria->con_id_focused || pattern_is_focused(criteria->title) ||
+			pattern_is_focused(criteria->shell) ||
+			pattern_is_focused(criteria->app_id) ||
+			pattern_is_focused(criteria->con_mark) ||
+			pattern_is_focused(criteria->workspace) ||
+			pattern_is_focused(criteria->sandbox_engine) ||
+			pattern_is_focused(criteria->sandbox_app_id) ||
+			pattern_is_focused(criteria->sandbox_instance_id)) {
+		return true;
+	}
+#if WLR_HAS_XWAYLAND
+	if (pattern_is_focused(criteria->class) ||
+			pattern_is_focused(criteria->instance) ||
+			pattern_is_focused(criteria->window_role)) {
+		return true;
+	}
+#endif
+	return false;
+}
+
+uint32_t criteria_view_updates(struct criteria *criteria) {
+	uint32_t updates = 0;
+	if (criteria->title) {
+		updates |= VIEW_UPDATE_TITLE;
+	}
+	if (criteria->app_id) {
+		updates |= VIEW_UPDATE_APP_ID;
+	}
+	// Nothing rechecks these when the state they match or the focus changes,
+	// but a title or app_id change always has
+	if (criteria->floating || criteria->tiling || criteria->urgent ||
+			criteria->workspace || criteria->con_mark ||
+			criteria_matches_focused(criteria)) {
+		updates |= VIEW_UPDATE_TITLE | VIEW_UPDATE_APP_ID;
+	}
+	return updates;
+}
+
 list_t *criteria_for_view(struct sway_view *view, enum criteria_type types) {
 	list_t *criterias = config->criteria;
 	list_t *matches = create_list();
@@ -491,6 +535,14 @@ list_t *criteria_get_containers(struct criteria *criteria) {
 		.criteria = criteria,
 		.matches = matches,
 	};
+	if (criteria->con_id) {
+		// At most one container can match, no need to walk the tree
+		struct sway_container *con = root_find_container_by_id(criteria->con_id);
+		if (con) {
+			criteria_get_containers_iterator(con, &data);
+		}
+		return matches;
+	}
 	root_for_each_container(criteria_get_containers_iterator, &data);
 	return matches;
 }
@@ -631,6 +683,7 @@ static bool parse_token(struct criteria *criteria, char *name, char *value) {
 			struct sway_seat *seat = input_manager_current_seat();
 			struct sway_container *focus = seat_get_focused_container(seat);
 			criteria->con_id = focus ? focus->node.id : 0;
+			criteria->con_id_focused = true;
 		} else {
 			criteria->con_id = strtoul(value, &endptr, 10);
 			if (*endptr != 0) {
@@ -107,16 +107,23 @@ struct sway_animation_path {
 };
 
 struct sway_animation {
-	uint32_t nsteps;
-	uint32_t step;
 	struct wl_event_source *timer;
+	bool ticking;
+	struct wl_list timelines; // struct sway_animation_timeline::link
+	struct wl_list tick; // timelines still to step in this tick
 
 	struct sway_animation_path *path;
 	struct sway_animation_callbacks callbacks;
+	// Timeline of the scripted animation
+	struct sway_animation_timeline scripted;
+	// A timeline started with the current key
+	bool keyed;
 };
 
 static struct sway_animation animation = {
 	.timer = NULL,
+	.timelines = { &animation.timelines, &animation.timelines },
+	.tick = { &animation.tick, &animation.tick },
 	.path = NULL,
 };
 
@@ -132,6 +139,13 @@ void animation_path_destroy(struct sway_animation_path *path) {
 	if (path) {
 		for (int i = 0; i < path->curves->length; ++i) {
 			struct sway_animation_curve *curve = path->curves->items[i];
+			// Timelines using it jump to their end on the next step
+			struct sway_animation_timeline *timeline;
+			wl_list_for_each(timeline, &animation.timelines, link) {
+				if (timeline->curve == curve) {
+					timeline->curve = NULL;
+				}
+			}
 			destroy_animation_curve(curve);
 		}
 		list_free(path->curves);
@@ -144,8 +158,21 @@ void animation_path_add_curve(struct sway_animation_path *path,
 	list_add(path->curves, curve);
 }
 
+// Ends the scripted animation. Its callbacks are dropped before callback_end
+// runs, so it may set new ones.
+static void scripted_end() {
+	animation_timeline_stop(&animation.scripted);
+	struct sway_animation_callbacks callbacks = animation.callbacks;
+	animation.callbacks = (struct sway_animation_callbacks){0};
+	if (callbacks.callback_end) {
+		callbacks.callback_end(callbacks.callback_end_data);
+	}
+}
+
 // Set the callbacks for the current animation
 void animation_set_callbacks(struct sway_animation_callbacks *callbacks) {
+	// The old callbacks are done, whether their animation ran or not
+	scripted_end();
 	animation.callbacks.callback_begin = callbacks->callback_begin;
 	animation.callbacks.callback_begin_data = callbacks->callback_begin_data;
 	animation.callbacks.callback_step = callbacks->callback_step;
@@ -158,6 +185,11 @@ struct sway_animation_callbacks *animation_get_callbacks() {
 	return &animation.callbacks;
 }
 
+void animation_set_default_callbacks() {
+	struct sway_animation_callbacks callbacks = {0};
+	animation_set_callbacks(&callbacks);
+}
+
 // Set the active path for the animation
 void animation_set_path(struct sway_animation_path *path) {
 	animation.path = path;
@@ -193,30 +225,76 @@ static struct sway_animation_curve *get_curve() {
 }
 
 static int timer_callback(void *data) {
-	struct sway_animation *animation = data;
-	++animation->step;
-	if (animation->step <= animation->nsteps) {
-		if (animation->callbacks.callback_step) {
-			animation->callbacks.callback_step(animation->callbacks.callback_step_data);
-		}
-		wl_event_source_timer_update(animation->timer, config->animations.frequency_ms);
-	} else {
-		// This is where we set the one in config if disabled or if not, default
-		struct sway_animation_path *path = get_path();
-		if (path) {
-			path->idx++;
-			if (path->idx >= path->curves->length) {
-				path->idx = 0;
-			}
-		}
-		animation->path = config->animations.anim_default;
-		if (animation->callbacks.callback_end) {
-			animation->callbacks.callback_end(animation->callbacks.callback_end_data);
+	animation.ticking = false;
+	int64_t now = get_current_time_msec();
+	// Steps may start or stop timelines, including the ones still to step
+	wl_list_insert_list(&animation.tick, &animation.timelines);
+	wl_list_init(&animation.timelines);
+	while (!wl_list_empty(&animation.tick)) {
+		struct sway_animation_timeline *timeline =
+			wl_container_of(animation.tick.next, timeline, link);
+		wl_list_remove(&timeline->link);
+		if (!timeline->curve ||
+				now - timeline->start_ms >= timeline->curve->duration_ms) {
+			// Last step, at the end of the curve
+			timeline->running = false;
+			wl_list_init(&timeline->link);
+		} else {
+			wl_list_insert(animation.timelines.prev, &timeline->link);
 		}
+		timeline->step(timeline->data);
+	}
+	if (!wl_list_empty(&animation.timelines) && !animation.ticking) {
+		wl_event_source_timer_update(animation.timer, config->animations.frequency_ms);
+		animation.ticking = true;
 	}
 	return 0;
 }
 
+bool animation_timeline_start(struct sway_animation_timeline *timeline,
+		sway_animation_callback_func_t step, void *data) {
+	struct sway_animation_curve *curve = get_curve();
+	if (!curve || curve->duration_ms == 0) {
+		animation_timeline_stop(timeline);
+		return false;
+	}
+	if (!animation.timer) {
+		animation.timer = wl_event_loop_add_timer(server.wl_event_loop,
+			timer_callback, NULL);
+		if (!animation.timer) {
+			sway_log_errno(SWAY_ERROR, "Unable to create animation timer");
+			animation_timeline_stop(timeline);
+			return false;
+		}
+	}
+	timeline->curve = curve;
+	timeline->start_ms = get_current_time_msec();
+	timeline->step = step;
+	timeline->data = data;
+	if (!timeline->running) {
+		timeline->running = true;
+		wl_list_insert(animation.timelines.prev, &timeline->link);
+	}
+	animation.keyed = true;
+	if (!animation.ticking) {
+		wl_event_source_timer_update(animation.timer, config->animations.frequency_ms);
+		animation.ticking = true;
+	}
+	return true;
+}
+
+void animation_timeline_stop(struct sway_animation_timeline *timeline) {
+	if (timeline->running) {
+		timeline->running = false;
+		wl_list_remove(&timeline->link);
+	}
+}
+
+bool animation_running() {
+	return !wl_list_empty(&animation.timelines) ||
+		!wl_list_empty(&animation.tick);
+}
+
 // Is an animation enabled?
 bool animation_enabled() {
 	struct sway_animation_path *path = get_path();
@@ -227,41 +305,42 @@ bool animation_enabled() {
 	}
 }
 
-static uint32_t animation_get_duration_ms() {
-	struct sway_animation_curve *curve = get_curve();
-	if (!curve) {
-		return 0;
-	} else {
-		return curve->duration_ms;
+static void scripted_step(void *data) {
+	struct sway_animation_callbacks *callbacks = &animation.callbacks;
+	if (callbacks->callback_step) {
+		callbacks->callback_step(callbacks->callback_step_data);
+	}
+	if (!animation.scripted.running) {
+		scripted_end();
 	}
 }
 
 // Select the next key
 void animation_next_key() {
 	struct sway_animation_path *path = get_path();
-	if (path) {
-		animation.nsteps = max(1, animation_get_duration_ms() / config->animations.frequency_ms);
-		if (animation.nsteps > 0) {
-			animation.step = 1;
-			if (animation.callbacks.callback_begin) {
-				animation.callbacks.callback_begin(animation.callbacks.callback_begin_data);
+	struct sway_animation_callbacks *callbacks = &animation.callbacks;
+	if (callbacks->callback_step) {
+		if (animation_timeline_start(&animation.scripted, scripted_step, NULL)) {
+			if (callbacks->callback_begin) {
+				callbacks->callback_begin(callbacks->callback_begin_data);
 			}
-			animation.callbacks.callback_step(animation.callbacks.callback_step_data);
-			if (animation.timer) {
-				wl_event_source_remove(animation.timer);
-				path->idx = 0;
-			}
-			animation.timer = wl_event_loop_add_timer(server.wl_event_loop,
-				timer_callback, &animation);
-			if (animation.timer) {
-				wl_event_source_timer_update(animation.timer, config->animations.frequency_ms);
-			} else {
-				sway_log_errno(SWAY_ERROR, "Unable to create animation timer");
-			}
-			return;
+		}
+		if (callbacks->callback_step) {
+			callbacks->callback_step(callbacks->callback_step_data);
+		}
+		// Not restarted, e.g. animations got disabled while it ran
+		if (!animation.scripted.running) {
+			scripted_end();
+		}
+	}
+	if (path && animation.keyed) {
+		path->idx++;
+		if (path->idx >= path->curves->length) {
+			path->idx = 0;
 		}
 	}
-	animation.callbacks.callback_step(animation.callbacks.callback_step_data);
+	animation.keyed = false;
+	animation.path = config->animations.anim_default;
 }
 
 static void lookup_xy(struct bezier_curve *curve, double t, double *x, double *y) {
@@ -313,16 +392,21 @@ static void animation_curve_get_values(struct sway_animation_curve *curve, doubl
 	}
 }
 
-// Get the current parameters for the active animation
-void animation_get_values(double *t, double *x, double *y,
-		double *offset_scale) {
-	struct sway_animation_curve *curve = get_curve();
-	if (!curve) {
+void animation_timeline_get_values(struct sway_animation_timeline *timeline,
+		double *t, double *x, double *y, double *offset_scale) {
+	if (!timeline->running || !timeline->curve) {
 		*t = 1.0; *x = 1.0, *y = 0.0, *offset_scale = 0.0;
 		return;
 	}
-	double u = animation.step / (double)animation.nsteps;
-	animation_curve_get_values(curve, u, t, x, y, offset_scale);
+	double u = (get_current_time_msec() - timeline->start_ms) /
+		(double)timeline->curve->duration_ms;
+	animation_curve_get_values(timeline->curve, u, t, x, y, offset_scale);
+}
+
+// Get the current parameters for the scripted animation
+void animation_get_values(double *t, double *x, double *y,
+		double *offset_scale) {
+	animation_timeline_get_values(&animation.scripted, t, x, y, offset_scale);
 }
 
 static void create_bezier(struct bezier_curve *curve, uint32_t order, list_t *points,
@@ -71,6 +71,54 @@ static void layer_parse_criteria(struct sway_layer_surface *surface) {
 	layer_apply_criteria(surface, criteria);
 }
 
+static void arrange_layer_surface(struct sway_layer_surface *surface,
+		const struct wlr_box *full_area, struct wlr_box *usable_area) {
+	sway_scene_layer_surface_v1_configure(surface->scene, full_area, usable_area);
+
+	// Configure shadow if enabled
+	if (!surface->shadow_node) {
+		return;
+	}
+	wlr_scene_node_set_enabled(&surface->shadow_node->node,
+		surface->shadow_enabled);
+
+	if (surface->shadow_enabled && surface->layer_surface->surface->mapped) {
+		struct wlr_layer_surface_v1 *layer_surface = surface->layer_surface;
+		int width = layer_surface->surface->current.width;
+		int height = layer_surface->surface->current.height;
+
+		// Get shadow offset and position from config
+		int shadow_width = width + config->shadow_blur_sigma * 2;
+		int shadow_height = height + config->shadow_blur_sigma * 2;
+
+		wlr_scene_shadow_set_size(surface->shadow_node,
+			shadow_width, shadow_height);
+
+		// Calculate position offset for shadow positioning
+		double x = 0, y = 0;
+		sway_scene_node_coords(&surface->tree->node, &x, &y);
+
+		// Set shadow clipped region for proper corner radius
+		wlr_scene_shadow_set_clipped_region(surface->shadow_node,
+			(struct clipped_region) {
+				.corner_radius = surface->corner_radius,
+				.corners = CORNER_LOCATION_ALL,
+				.area = {
+					.x = (int)(-x),
+					.y = (int)(-y),
+					.width = width,
+					.height = height,
+				},
+			});
+
+		// Update shadow blur sigma and corner radius
+		wlr_scene_shadow_set_blur_sigma(surface->shadow_node,
+			config->shadow_blur_sigma);
+		wlr_scene_shadow_set_corner_radius(surface->shadow_node,
+			surface->corner_radius);
+	}
+}
+
 static void arrange_surface(struct sway_output *output, const struct wlr_box *full_area,
 		struct wlr_box *usable_area, struct sway_scene_tree *tree, bool exclusive) {
 	struct sway_scene_node *node;
@@ -90,76 +138,11 @@ static void arrange_surface(struct sway_output *output, const struct wlr_box *fu
 			continue;
 		}
 
-		sway_scene_layer_surface_v1_configure(surface->scene, full_area, usable_area);
-
-		// Configure shadow if enabled
-		if (surface->shadow_node) {
-			wlr_scene_node_set_enabled(&surface->shadow_node->node,
-				surface->shadow_enabled);
-
-			if (surface->shadow_enabled && surface->layer_surface->surface->mapped) {
-				struct wlr_layer_surface_v1 *layer_surface = surface->layer_surface;
-				int width = layer_surface->surface->current.width;
-				int height = layer_surface->surface->current.height;
-
-				// Get shadow offset and position from config
-				int shadow_width = width + config->shadow_blur_sigma * 2;
-				int shadow_height = height + config->shadow_blur_sigma * 2;
-
-				wlr_scene_shadow_set_size(surface->shadow_node,
-					shadow_width, shadow_height);
-
-				// Calculate position offset for shadow positioning
-				double x = 0, y = 0;
-				sway_scene_node_coords(&surface->tree->node, &x, &y);
-
-				// Set shadow clipped region for proper corner radius
-				wlr_scene_shadow_set_clipped_region(surface->shadow_node,
-					(struct clipped_region) {
-						.corner_radius = surface->corner_radius,
-						.corners = CORNER_LOCATION_ALL,
-						.area = {
-							.x = (int)(-x),
-							.y = (int)(-y),
-							.width = width,
-							.height = height,
-						},
-					});
-
-				// Update shadow blur sigma and corner radius
-				wlr_scene_shadow_set_blur_sigma(surface->shadow_node,
-					config->shadow_blur_sigma);
-				wlr_scene_shadow_set_corner_radius(surface->shadow_node,
-					surface->corner_radius);
-			}
-		}
+		arrange_layer_surface(surface, full_area, usable_area);
 	}
 }
 
-void arrange_layers(struct sway_output *output) {
-	struct wlr_box usable_area = { 0 };
-	wlr_output_effective_resolution(output->wlr_output,
-			&usable_area.width, &usable_area.height);
-	const struct wlr_box full_area = usable_area;
-
-	arrange_surface(output, &full_area, &usable_area, output->layers.shell_overlay, true);
-	arrange_surface(output, &full_area, &usable_area, output->layers.shell_top, true);
-	arrange_surface(output, &full_area, &usable_area, output->layers.shell_bottom, true);
-	arrange_surface(output, &full_area, &usable_area, output->layers.shell_background, true);
-
-	arrange_surface(output, &full_area, &usable_area, output->layers.shell_overlay, false);
-	arrange_surface(output, &full_area, &usable_area, output->layers.shell_top, false);
-	arrange_surface(output, &full_area, &usable_area, output->layers.shell_bottom, false);
-	arrange_surface(output, &full_area, &usable_area, output->layers.shell_background, false);
-
-	if (!wlr_box_equal(&usable_area, &output->usable_area)) {
-		sway_log(SWAY_DEBUG, "Usable area changed, rearranging output");
-		output->usable_area = usable_area;
-		arrange_output(output);
-	} else {
-		arrange_popups(root->layers.popup);
-	}
-
+static void arrange_layers_focus(struct sway_output *output) {
 	// Find topmost keyboard interactive layer, if such a layer exists
 	struct sway_scene_tree *layers_above_shell[] = {
 		output->layers.shell_overlay,
@@ -198,6 +181,70 @@ void arrange_layers(struct sway_output *output) {
 	}
 }
 
+void arrange_layers(struct sway_output *output) {
+	struct wlr_box usable_area = { 0 };
+	wlr_output_effective_resolution(output->wlr_output,
+			&usable_area.width, &usable_area.height);
+	const struct wlr_box full_area = usable_area;
+
+	arrange_surface(output, &full_area, &usable_area, output->layers.shell_overlay, true);
+	arrange_surface(output, &full_area, &usable_area, output->layers.shell_top, true);
+	arrange_surface(output, &full_area, &usable_area, output->layers.shell_bottom, true);
+	arrange_surface(output, &full_area, &usable_area, output->layers.shell_background, true);
+
+	arrange_surface(output, &full_area, &usable_area, output->layers.shell_overlay, false);
+	arrange_surface(output, &full_area, &usable_area, output->layers.shell_top, false);
+	arrange_surface(output, &full_area, &usable_area, output->layers.shell_bottom, false);
+	arrange_surface(output, &full_area, &usable_area, output->layers.shell_background, false);
+
+	if (!wlr_box_equal(&usable_area, &output->usable_area)) {
+		sway_log(SWAY_DEBUG, "Usable area changed, rearranging output");
+		output->usable_area = usable_area;
+		arrange_output(output);
+	} else {
+		arrange_popups(root->layers.popup);
+	}
+
+	arrange_layers_focus(output);
+}
+
+// What a layer surface commit needs to re-arrange
+enum layer_change {
+	// The geometry of this surface only
+	LAYER_CHANGE_SURFACE = 1 << 0,
+	// Other surfaces of the output, and possibly its usable area
+	LAYER_CHANGE_LAYOUT = 1 << 1,
+	// The keyboard focus of the layers
+	LAYER_CHANGE_FOCUS = 1 << 2,
+};
+
+static uint32_t layer_surface_classify_commit(struct sway_layer_surface *surface) {
+	struct wlr_layer_surface_v1 *layer_surface = surface->layer_surface;
+	if (layer_surface->initial_commit ||
+			layer_surface->surface->mapped != surface->mapped) {
+		return LAYER_CHANGE_LAYOUT | LAYER_CHANGE_FOCUS;
+	}
+
+	const uint32_t geometry = WLR_LAYER_SURFACE_V1_STATE_DESIRED_SIZE |
+		WLR_LAYER_SURFACE_V1_STATE_ANCHOR | WLR_LAYER_SURFACE_V1_STATE_MARGIN;
+	uint32_t committed = layer_surface->current.committed;
+	uint32_t changes = 0;
+	if (committed & geometry) {
+		// A surface without an exclusive zone is placed in the usable area
+		// left by the others, without changing it
+		changes |= layer_surface->current.exclusive_zone > 0 ?
+			LAYER_CHANGE_LAYOUT : LAYER_CHANGE_SURFACE;
+	}
+	if (committed & WLR_LAYER_SURFACE_V1_STATE_KEYBOARD_INTERACTIVITY) {
+		changes |= LAYER_CHANGE_FOCUS;
+	}
+	// Anything else (exclusive zone, layer, ...) can move other surfaces
+	if (committed & ~(geometry | WLR_LAYER_SURFACE_V1_STATE_KEYBOARD_INTERACTIVITY)) {
+		changes |= LAYER_CHANGE_LAYOUT | LAYER_CHANGE_FOCUS;
+	}
+	return changes;
+}
+
 static struct sway_scene_tree *sway_layer_get_scene(struct sway_output *output,
 		enum zwlr_layer_shell_v1_layer type) {
 	switch (type) {
@@ -358,10 +405,24 @@ static void handle_surface_commit(struct wl_listener *listener, void *data) {
 		sway_scene_node_reparent(&surface->scene->tree->node, output_layer);
 	}
 
-	if (layer_surface->initial_commit || committed || layer_surface->surface->mapped != surface->mapped) {
-		surface->mapped = layer_surface->surface->mapped;
+	uint32_t changes = layer_surface_classify_commit(surface);
+	surface->mapped = layer_surface->surface->mapped;
+	if (changes & LAYER_CHANGE_LAYOUT) {
+		// Only re-arranges the output if its usable area changes
 		arrange_layers(surface->output);
 		transaction_commit_dirty();
+		return;
+	}
+	if ((changes & LAYER_CHANGE_SURFACE) && layer_surface->initialized) {
+		struct wlr_box full_area = { 0 };
+		wlr_output_effective_resolution(surface->output->wlr_output,
+				&full_area.width, &full_area.height);
+		struct wlr_box usable_area = surface->output->usable_area;
+		arrange_layer_surface(surface, &full_area, &usable_area);
+		arrange_popups(root->layers.popup);
+	}
+	if (changes & LAYER_CHANGE_FOCUS) {
+		arrange_layers_focus(surface->output);
 	}
 }
 
@@ -24,6 +24,7 @@
 #include <scenefx/types/wlr_scene.h>
 #include <scenefx/types/fx/corner_location.h>
 #include "sway/config.h"
+#include "sway/desktop/stats.h"
 #include "sway/desktop/transaction.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/seat.h"
@@ -329,11 +330,18 @@ static int output_repaint_timer_handler(void *data) {
 		return 0;
 	}
 
+	// Apply title changes received since the last frame
+	view_flush_pending_updates();
+
+	layout_scroll_frame(output);
+
 	output_configure_scene(output, (struct wlr_scene_node *)&root->root_scene->tree.node, 1.0f,
 		0, false, false, NULL);
 
 	struct sway_scene_output_state_options opts = {
 		.color_transform = output->color_transform,
+		.timer = stats_output_render_timer(&output->stats,
+			output->wlr_output->renderer),
 	};
 
 	struct sway_scene_output *scene_output = output->scene_output;
@@ -344,11 +352,14 @@ static int output_repaint_timer_handler(void *data) {
 	struct wlr_output_state pending;
 	wlr_output_state_init(&pending);
 
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
 	bool ret = render_workspace_build_state(output, &pending, &opts);
 	if (!ret) {
 		wlr_output_state_finish(&pending);
 		return 0;
 	}
+	stats_output_frame_built(&output->stats, &start);
 
 	if (output_can_tear(output)) {
 		pending.tearing_page_flip = true;
@@ -362,6 +373,8 @@ static int output_repaint_timer_handler(void *data) {
 
 	if (!wlr_output_commit_state(output->wlr_output, &pending)) {
 		sway_log(SWAY_ERROR, "Page-flip failed on output %s", output->wlr_output->name);
+	} else {
+		stats_output_frame_committed(&output->stats);
 	}
 	wlr_output_state_finish(&pending);
 	return 0;
@@ -510,6 +523,8 @@ static void begin_destroy(struct sway_output *output) {
 	wl_event_source_remove(output->repaint_timer);
 	output->repaint_timer = NULL;
 
+	stats_output_finish(&output->stats);
+
 	request_modeset();
 }
 
@@ -527,6 +542,8 @@ static void handle_present(struct wl_listener *listener, void *data) {
 	struct sway_output *output = wl_container_of(listener, output, present);
 	struct wlr_output_event_present *output_event = data;
 
+	stats_output_frame_presented(&output->stats, output_event);
+
 	if (!output->enabled || !output_event->presented) {
 		return;
 	}
@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include <string.h>
+#include <wlr/render/wlr_renderer.h>
+#include <wlr/types/wlr_output.h>
+#include "sway/desktop/stats.h"
+#include "sway/desktop/transaction.h"
+#include "sway/ipc-server.h"
+#include "sway/server.h"
+#include "util.h"
+
+struct sway_transaction_stats transaction_stats = {0};
+
+static struct wl_listener transaction_applied;
+
+static void handle_transaction_applied(struct wl_listener *listener,
+		void *data) {
+	struct sway_transaction_timings *timings = data;
+	++transaction_stats.count;
+	if (timings->timed_out) {
+		++transaction_stats.timed_out;
+	}
+	stats_series_add(&transaction_stats.wait, timings->wait_ns);
+}
+
+void stats_init(void) {
+	transaction_applied.notify = handle_transaction_applied;
+	wl_signal_add(&server.events.transaction_applied, &transaction_applied);
+}
+
+void stats_series_add(struct sway_stats_series *series, int64_t ns) {
+	series->samples[series->count % STATS_WINDOW] = ns < 0 ? 0 : ns;
+	++series->count;
+}
+
+static int cmp_samples(const void *a, const void *b) {
+	int64_t sa = *(const int64_t *)a, sb = *(const int64_t *)b;
+	return (sa > sb) - (sa < sb);
+}
+
+void stats_series_summarize(const struct sway_stats_series *series,
+		struct sway_stats_summary *summary) {
+	memset(summary, 0, sizeof(*summary));
+	size_t n = series->count < STATS_WINDOW ? series->count : STATS_WINDOW;
+	summary->samples = n;
+	if (n == 0) {
+		return;
+	}
+
+	int64_t sorted[STATS_WINDOW];
+	memcpy(sorted, series->samples, n * sizeof(int64_t));
+	qsort(sorted, n, sizeof(int64_t), cmp_samples);
+
+	int64_t total = 0;
+	for (size_t i = 0; i < n; ++i) {
+		int64_t us = sorted[i] / 1000;
+		total += us;
+		int bucket = 0;
+		while (us > 1 && bucket < STATS_BUCKETS - 1) {
+			us >>= 1;
+			++bucket;
+		}
+		++summary->buckets[bucket];
+	}
+	summary->min = sorted[0] / 1000;
+	summary->avg = total / (int64_t)n;
+	summary->p50 = sorted[(n - 1) * 50 / 100] / 1000;
+	summary->p90 = sorted[(n - 1) * 90 / 100] / 1000;
+	summary->p99 = sorted[(n - 1) * 99 / 100] / 1000;
+	summary->max = sorted[n - 1] / 1000;
+}
+
+struct sway_scene_timer *stats_output_render_timer(struct sway_output_stats *stats,
+		struct wlr_renderer *renderer) {
+	bool subscribed = ipc_stats_subscribed();
+	if (subscribed && !stats->render_timer_checked) {
+		// Renderers without timer queries complain on every attempt
+		struct wlr_render_timer *timer = wlr_render_timer_create(renderer);
+		stats->render_timer_supported = timer != NULL;
+		stats->render_timer_checked = true;
+		if (timer) {
+			wlr_render_timer_destroy(timer);
+		}
+	}
+	if (!subscribed || !stats->render_timer_supported) {
+		// Do not read the timer of an older frame once presented
+		sway_scene_timer_finish(&stats->timer);
+		stats->timer = (struct sway_scene_timer){0};
+		return NULL;
+	}
+	return &stats->timer;
+}
+
+void stats_output_frame_built(struct sway_output_stats *stats,
+		const struct timespec *start) {
+	struct timespec now, diff;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	timespec_sub(&diff, &now, start);
+	stats_series_add(&stats->build_state, timespec_to_nsec(&diff));
+}
+
+void stats_output_frame_committed(struct sway_output_stats *stats) {
+	clock_gettime(CLOCK_MONOTONIC, &stats->commit_time);
+	stats->frame_pending = true;
+	++stats->frames;
+}
+
+void stats_output_frame_presented(struct sway_output_stats *stats,
+		const struct wlr_output_event_present *event) {
+	if (!stats->frame_pending) {
+		return;
+	}
+	stats->frame_pending = false;
+
+	if (!event->presented) {
+		++stats->dropped_frames;
+		return;
+	}
+
+	struct timespec diff;
+	timespec_sub(&diff, &event->when, &stats->commit_time);
+	int64_t latency = timespec_to_nsec(&diff);
+	stats_series_add(&stats->present, latency);
+
+	// The frame was meant for the first vblank after its commit, count the
+	// ones it was presented after
+	if (stats->presented && event->refresh > 0 &&
+			event->seq != stats->last_seq) {
+		timespec_sub(&diff, &stats->commit_time, &stats->last_present);
+		int64_t since = timespec_to_nsec(&diff);
+		unsigned target = stats->last_seq +
+			(since > 0 ? since / event->refresh : 0) + 1;
+		int missed = (int)(event->seq - target);
+		if (missed > 0) {
+			stats->missed_vblanks += missed;
+		}
+	}
+	stats->presented = true;
+	stats->last_seq = event->seq;
+	stats->last_present = event->when;
+
+	// The GPU is done with the frame once it is presented
+	if (stats->timer.render_timer) {
+		int64_t duration = sway_scene_timer_get_duration_ns(&stats->timer);
+		if (duration >= 0) {
+			stats_series_add(&stats->render,
+					duration - stats->timer.pre_render_duration);
+		}
+	}
+}
+
+void stats_output_finish(struct sway_output_stats *stats) {
+	sway_scene_timer_finish(&stats->timer);
+	stats->timer = (struct sway_scene_timer){0};
+	stats->frame_pending = false;
+	stats->presented = false;
+}
@@ -29,6 +29,8 @@ struct sway_transaction {
 	size_t num_waiting;
 	size_t num_configures;
 	struct timespec commit_time;
+	int64_t commit_ns;
+	bool timed_out;
 };
 
 struct sway_transaction_instruction {
@@ -667,6 +669,99 @@ static double compute_active_offset(struct sway_workspace *workspace,
 	}
 }
 
+// Computes where a container is now on its timeline
+static void container_animation_update(struct sway_container *con,
+		struct sway_workspace *workspace) {
+	double t, x, y, anim_scale;
+	animation_timeline_get_values(&con->animation.timeline, &t, &x, &y, &anim_scale);
+	con->animation.wt = fmax(1, linear_scale(con->animation.w0, con->animation.w1, t));
+	con->animation.ht = fmax(1, linear_scale(con->animation.h0, con->animation.h1, t));
+	double tx = con->animation.target.x, ty = con->animation.target.y;
+	if (con->animation.layout == L_VERT) {
+		if (fabs(ty - con->animation.y0) > 0.0) {
+			con->animation.yt = linear_scale(con->animation.y0, ty, x);
+		} else if (fabs(tx - con->animation.x0) > 0.0) {
+			con->animation.yt = con->animation.y0 + y * anim_scale * workspace->height;
+		} else {
+			con->animation.yt = con->animation.y0;
+		}
+	} else {
+		if (fabs(tx - con->animation.x0) > 0.0) {
+			con->animation.xt = linear_scale(con->animation.x0, tx, x);
+		} else if (fabs(ty - con->animation.y0) > 0.0) {
+			con->animation.xt = con->animation.x0 + y * anim_scale * workspace->width;
+		} else {
+			con->animation.xt = con->animation.x0;
+		}
+	}
+}
+
+// Steps a single container, nothing else is arranged
+static void container_animation_step(void *data) {
+	struct sway_container *con = data;
+	struct sway_workspace *workspace = con->current.workspace;
+	if (!workspace || container_is_floating(con) ||
+			container_is_fullscreen_or_child(con) ||
+			!con->scene_tree->node.enabled) {
+		// No longer tiled where it was arranged
+		animation_timeline_stop(&con->animation.timeline);
+		return;
+	}
+	container_animation_update(con, workspace);
+	if (con->animation.layout == L_VERT) {
+		sway_scene_node_set_position(&con->scene_tree->node, 0, con->animation.yt - workspace->y);
+	} else {
+		sway_scene_node_set_position(&con->scene_tree->node, con->animation.xt - workspace->x, 0);
+	}
+	arrange_container(con, con->animation.wt, con->animation.ht, true,
+		con->animation.gaps, workspace);
+	if (!con->animation.timeline.running) {
+		// The next timeline starts from here
+		con->animation.x0 = con->animation.target.x;
+		con->animation.y0 = con->animation.target.y;
+		con->animation.w0 = con->animation.w1;
+		con->animation.h0 = con->animation.h1;
+		if (!animation_running()) {
+			cursor_rebase_all();
+		}
+	}
+}
+
+// Moves a tiled container towards where it is arranged: off along the layout
+// axis and cross along the other one. A new target retargets its timeline
+// from where the container is now, other containers are left alone.
+static void container_animate(struct sway_container *con,
+		struct sway_workspace *workspace, enum sway_container_layout layout,
+		double off, double cross, int gaps) {
+	double x1 = layout == L_VERT ? cross : off;
+	double y1 = layout == L_VERT ? off : cross;
+	if (x1 != con->animation.target.x || y1 != con->animation.target.y ||
+			con->pending.width != con->animation.target.width ||
+			con->pending.height != con->animation.target.height) {
+		if (con->animation.timeline.running) {
+			// Only the layout axis is animated, the other starts from the
+			// old target
+			con->animation.x0 = con->animation.layout == L_VERT ?
+				con->animation.target.x : con->animation.xt;
+			con->animation.y0 = con->animation.layout == L_VERT ?
+				con->animation.yt : con->animation.target.y;
+			con->animation.w0 = con->animation.wt;
+			con->animation.h0 = con->animation.ht;
+			con->animation.w1 = con->pending.width;
+			con->animation.h1 = con->pending.height;
+		}
+		con->animation.target.x = x1;
+		con->animation.target.y = y1;
+		con->animation.target.width = con->pending.width;
+		con->animation.target.height = con->pending.height;
+		animation_timeline_start(&con->animation.timeline,
+			container_animation_step, con);
+	}
+	con->animation.layout = layout;
+	con->animation.gaps = gaps;
+	container_animation_update(con, workspace);
+}
+
 static void default_arrange_children(struct sway_workspace *workspace,
 		enum sway_container_layout layout, list_t *children,
 		struct sway_container *active, struct sway_scene_tree *content,
@@ -706,8 +801,6 @@ static void default_arrange_children(struct sway_workspace *workspace,
 		}
 	}
 
-	double t, x, y, anim_scale;
-	animation_get_values(&t, &x, &y, &anim_scale);
 	if (layout == L_VERT) {
 		double off = offset;
 		for (int i = active_idx; i < children->length; ++i) {
@@ -716,16 +809,9 @@ static void default_arrange_children(struct sway_workspace *workspace,
 			if (parent && parent->jump.jumping) {
 				off = child->pending.y;
 			}
-			child->animation.ht = fmax(1, linear_scale(child->animation.h0, child->animation.h1, t));
+			double cross = parent ? parent->pending.x : workspace->x + scale * gaps;
+			container_animate(child, workspace, layout, off, cross, gaps);
 			sway_scene_node_set_enabled(&child->border.tree->node, true);
-			double movement = fabs(off - child->animation.y0);
-			if (movement > 0.0) {
-				child->animation.yt = linear_scale(child->animation.y0, off, x);
-			} else if (fabs(child->pending.x - child->animation.x0) > 0.0) {
-				child->animation.yt = child->animation.y0 + y * anim_scale * workspace->height;
-			} else {
-				child->animation.yt = child->animation.y0;
-			}
 			sway_scene_node_set_position(&child->scene_tree->node, 0, child->animation.yt - workspace->y);
 			child->current.y = off;
 			child->pending.y = off;
@@ -737,7 +823,6 @@ static void default_arrange_children(struct sway_workspace *workspace,
 				child->pending.x = workspace->x + scale * gaps;
 			}
 			sway_scene_node_reparent(&child->scene_tree->node, content);
-			child->animation.wt = fmax(1, linear_scale(child->animation.w0, child->animation.w1, t));
 			arrange_container(child, child->animation.wt, child->animation.ht, true, gaps, workspace);
 			off += scale * (child->pending.height + 2 * gaps);
 		}
@@ -745,11 +830,12 @@ static void default_arrange_children(struct sway_workspace *workspace,
 		for (int i = active_idx - 1; i >= 0; i--) {
 			struct sway_container *child = children->items[i];
 			struct sway_container *parent = child->pending.parent;
-			child->animation.ht = fmax(1, linear_scale(child->animation.h0, child->animation.h1, t));
 			off -= scale * (child->pending.height + 2 * gaps);
 			if (parent && parent->jump.jumping) {
 				off = child->pending.y;
 			}
+			double cross = parent ? parent->pending.x : workspace->x + scale * gaps;
+			container_animate(child, workspace, layout, off, cross, gaps);
 			child->current.y = off;
 			child->pending.y = off;
 			if (parent) {
@@ -760,17 +846,8 @@ static void default_arrange_children(struct sway_workspace *workspace,
 				child->pending.x = workspace->x + scale * gaps;
 			}
 			sway_scene_node_set_enabled(&child->border.tree->node, true);
-			double movement = fabs(off - child->animation.y0);
-			if (movement > 0.0) {
-				child->animation.yt = linear_scale(child->animation.y0, off, x);
-			} else if (fabs(child->pending.x - child->animation.x0) > 0.0) {
-				child->animation.yt = child->animation.y0 + y * anim_scale * workspace->height;
-			} else {
-				child->animation.yt = child->animation.y0;
-			}
 			sway_scene_node_set_position(&child->scene_tree->node, 0, child->animation.yt - workspace->y);
 			sway_scene_node_reparent(&child->scene_tree->node, content);
-			child->animation.wt = fmax(1, linear_scale(child->animation.w0, child->animation.w1, t));
 			arrange_container(child, child->animation.wt, child->animation.ht, true, gaps, workspace);
 		}
 	} else if (layout == L_HORIZ) {
@@ -781,15 +858,8 @@ static void default_arrange_children(struct sway_workspace *workspace,
 			if (parent && parent->jump.jumping) {
 				off = child->pending.x;
 			}
-			child->animation.wt = fmax(1, linear_scale(child->animation.w0, child->animation.w1, t));
-			double movement = fabs(off - child->animation.x0);
-			if (movement > 0.0) {
-				child->animation.xt = linear_scale(child->animation.x0, off, x);
-			} else if (fabs(child->pending.y - child->animation.y0) > 0.0) {
-				child->animation.xt = child->animation.x0 + y * anim_scale * workspace->width;
-			} else {
-				child->animation.xt = child->animation.x0;
-			}
+			double cross = parent ? parent->pending.y : workspace->y + scale * gaps;
+			container_animate(child, workspace, layout, off, cross, gaps);
 			sway_scene_node_set_enabled(&child->border.tree->node, true);
 			sway_scene_node_set_position(&child->scene_tree->node, child->animation.xt - workspace->x, 0);
 			// Update child for next iteration. Transactions don't re-arrange
@@ -806,7 +876,6 @@ static void default_arrange_children(struct sway_workspace *workspace,
 				child->pending.y = workspace->y + scale * gaps;
 			}
 			sway_scene_node_reparent(&child->scene_tree->node, content);
-			child->animation.ht = fmax(1, linear_scale(child->animation.h0, child->animation.h1, t));
 			arrange_container(child, child->animation.wt, child->animation.ht, true, gaps, workspace);
 			off += scale * (child->pending.width + 2 * gaps);
 		}
@@ -814,11 +883,12 @@ static void default_arrange_children(struct sway_workspace *workspace,
 		for (int i = active_idx - 1; i >= 0; i--) {
 			struct sway_container *child = children->items[i];
 			struct sway_container *parent = child->pending.parent;
-			child->animation.wt = fmax(1, linear_scale(child->animation.w0, child->animation.w1, t));
 			off -= scale * (child->pending.width + 2 * gaps);
 			if (parent && parent->jump.jumping) {
 				off = child->pending.x;
 			}
+			double cross = parent ? parent->pending.y : workspace->y + scale * gaps;
+			container_animate(child, workspace, layout, off, cross, gaps);
 			child->current.x = off;
 			child->pending.x = off;
 			if (parent) {
@@ -829,17 +899,8 @@ static void default_arrange_children(struct sway_workspace *workspace,
 				child->pending.y = workspace->y + scale * gaps;
 			}
 			sway_scene_node_set_enabled(&child->border.tree->node, true);
-			double movement = fabs(off - child->animation.x0);
-			if (movement > 0.0) {
-				child->animation.xt = linear_scale(child->animation.x0, off, x);
-			} else if (fabs(child->pending.y - child->animation.y0) > 0.0) {
-				child->animation.xt = child->animation.x0 + y * anim_scale * workspace->width;
-			} else {
-				child->animation.xt = child->animation.x0;
-			}
 			sway_scene_node_set_position(&child->scene_tree->node, child->animation.xt - workspace->x, 0);
 			sway_scene_node_reparent(&child->scene_tree->node, content);
-			child->animation.ht = fmax(1, linear_scale(child->animation.h0, child->animation.h1, t));
 			arrange_container(child, child->animation.wt, child->animation.ht, true, gaps, workspace);
 		}
 	} else {
@@ -873,11 +934,10 @@ static void arrange_container(struct sway_container *con,
 		double width = scale * dwidth;
 		double height = scale * dheight;
 
-		if (title_bar && con->current.border != B_NORMAL) {
+		// The top border is only drawn when there is no title bar in its place
+		bool draw_top = title_bar && con->current.border != B_NORMAL;
+		if (draw_top) {
 			sway_scene_node_set_enabled(&con->title_bar.tree->node, false);
-			sway_scene_node_set_enabled(&con->border.top->node, true);
-		} else {
-			sway_scene_node_set_enabled(&con->border.top->node, false);
 		}
 
 		if (con->current.border == B_NORMAL) {
@@ -904,22 +964,17 @@ static void arrange_container(struct sway_container *con,
 		double border_bottom = con->current.border_bottom ? border_width : 0;
 		double border_left = con->current.border_left ? border_width : 0;
 		double border_right = con->current.border_right ? border_width : 0;
-		double vert_border_height = MAX(0, height - border_top - border_bottom);
-
-		sway_scene_rect_set_size(con->border.top, width, border_top);
-		sway_scene_rect_set_size(con->border.bottom, width, border_bottom);
-		sway_scene_rect_set_size(con->border.left,
-			border_left, vert_border_height);
-		sway_scene_rect_set_size(con->border.right,
-			border_right, vert_border_height);
-
-		sway_scene_node_set_position(&con->border.top->node, 0, 0);
-		sway_scene_node_set_position(&con->border.bottom->node,
-			0, height - border_bottom);
-		sway_scene_node_set_position(&con->border.left->node,
-			0, border_top);
-		sway_scene_node_set_position(&con->border.right->node,
-			width - border_right, border_top);
+		double top_offset = draw_top ? 0 : border_top;
+
+		struct sway_scene_decoration *decoration = con->border.decoration;
+		sway_scene_node_set_position(&decoration->node, 0, top_offset);
+		sway_scene_decoration_set_size(decoration,
+			width, MAX(0, height - top_offset));
+		sway_scene_decoration_set_border(decoration, draw_top ? border_top : 0,
+			border_bottom, border_left, border_right);
+		int radius = container_has_corner_radius(con) ? con->corner_radius : 0;
+		sway_scene_decoration_set_corner_radius(decoration, radius,
+			draw_top ? CORNER_LOCATION_ALL : CORNER_LOCATION_BOTTOM);
 
 		// make sure to reparent, it's possible that the client just came out of
 		// fullscreen mode where the parent of the surface is not the container
@@ -940,9 +995,7 @@ static void arrange_container(struct sway_container *con,
 		// Here we configure any view that has changed position.
 		if(con->view->type == SWAY_VIEW_XWAYLAND) {
 			// Only update the view at the end of the animation to avoid stress
-			double t, x, y, off;
-			animation_get_values(&t, &x, &y, &off);
-			if (t >= 1.0 &&
+			if (!con->animation.timeline.running &&
 				(con->pending.content_x != con->current.content_x ||
 				con->pending.content_y != con->current.content_y ||
 				con->pending.content_width != con->current.content_width ||
@@ -995,6 +1048,15 @@ static void arrange_container(struct sway_container *con,
 			sway_scene_node_set_enabled(&con->title_bar.tree->node, false);
 		}
 
+		// An ongoing scroll gesture across this container
+		double offset = workspace && workspace->gesture.column == con ?
+			workspace->gesture.column_offset : 0.0;
+		if (con->current.layout == L_HORIZ) {
+			sway_scene_node_set_position(&con->content_tree->node, offset, 0);
+		} else {
+			sway_scene_node_set_position(&con->content_tree->node, 0, offset);
+		}
+
 		if (!root->filters.free_animation_activation_filter(workspace, root->filters.free_animation_activation_filter_data)) {
 			default_arrange_children(workspace, con->current.layout,
 				con->current.children, con->current.focused_inactive_child,
@@ -1141,11 +1203,14 @@ static void arrange_output(struct sway_output *output, int width, int height) {
 
 		bool floating = root->filters.workspace_floating_filter(child, root->filters.workspace_floating_filter_data);
 		bool tiling = root->filters.workspace_tiling_filter(child, root->filters.workspace_tiling_filter_data);
+		// Arranged as usual, but shown from a snapshot until the switch ends
+		bool hidden = child->switching;
 
 		for (int i = 0; i < child->current.floating->length; i++) {
 			struct sway_container *floater = child->current.floating->items[i];
 			sway_scene_node_reparent(&floater->scene_tree->node, root->layers.floating);
-			sway_scene_node_set_enabled(&floater->scene_tree->node, activated && floating);
+			sway_scene_node_set_enabled(&floater->scene_tree->node,
+				activated && floating && !hidden);
 		}
 
 		if (activated) {
@@ -1153,14 +1218,14 @@ static void arrange_output(struct sway_output *output, int width, int height) {
 			// Check if workspace is scaled (overview mode)
 			bool scaled = layout_scale_enabled(child) && layout_scale_get(child) != 1.0;
 
-			sway_scene_node_set_enabled(&child->layers.tiling->node, !fs && tiling);
-			sway_scene_node_set_enabled(&child->layers.fullscreen->node, fs);
+			sway_scene_node_set_enabled(&child->layers.tiling->node, !fs && tiling && !hidden);
+			sway_scene_node_set_enabled(&child->layers.fullscreen->node, fs && !hidden);
 
-			sway_scene_node_set_enabled(&output->layers.shell_background->node, !fs);
-			sway_scene_node_set_enabled(&output->layers.shell_bottom->node, !fs);
+			sway_scene_node_set_enabled(&output->layers.shell_background->node, !fs || hidden);
+			sway_scene_node_set_enabled(&output->layers.shell_bottom->node, !fs || hidden);
 			// Disable blur during fullscreen OR scaling
 			wlr_scene_node_set_enabled(&output->layers.blur_layer->node, !fs && !scaled);
-			sway_scene_node_set_enabled(&output->layers.fullscreen->node, fs);
+			sway_scene_node_set_enabled(&output->layers.fullscreen->node, fs && !hidden);
 
 			if (fs) {
 				disable_workspace(child);
@@ -1177,7 +1242,8 @@ static void arrange_output(struct sway_output *output, int width, int height) {
 				struct side_gaps *gaps = &child->current_gaps;
 
 				sway_scene_node_set_position(&child->layers.tiling->node,
-					gaps->left + area->x, gaps->top + area->y);
+					gaps->left + area->x + child->gesture.offset_x,
+					gaps->top + area->y + child->gesture.offset_y);
 
 				if (tiling) {
 					arrange_workspace_tiling(child,
@@ -1363,23 +1429,14 @@ static void animation_arrange_children(struct sway_workspace *workspace,
 		return;
 	}
 
-	double t, x, y, anim_scale;
-	animation_get_values(&t, &x, &y, &anim_scale);
 	if (layout == L_VERT) {
 		for (int i = 0; i < children->length; ++i) {
 			struct sway_container *child = children->items[i];
 			const double off = child->pending.y;
 			struct sway_container *parent = child->pending.parent;
-			child->animation.ht = fmax(1, linear_scale(child->animation.h0, child->animation.h1, t));
+			double cross = parent ? parent->pending.x : child->pending.x;
+			container_animate(child, workspace, layout, off, cross, 0);
 			sway_scene_node_set_enabled(&child->border.tree->node, true);
-			double movement = fabs(off - child->animation.y0);
-			if (movement > 0.0) {
-				child->animation.yt = linear_scale(child->animation.y0, off, x);
-			} else if (fabs(child->pending.x - child->animation.x0) > 0.0) {
-				child->animation.yt = child->animation.y0 + y * anim_scale * workspace->height;
-			} else {
-				child->animation.yt = child->animation.y0;
-			}
 			sway_scene_node_set_position(&child->scene_tree->node, 0, child->animation.yt - workspace->y);
 			child->current.y = off;
 			child->pending.y = off;
@@ -1388,7 +1445,6 @@ static void animation_arrange_children(struct sway_workspace *workspace,
 				child->pending.x = parent->pending.x;
 			}
 			sway_scene_node_reparent(&child->scene_tree->node, content);
-			child->animation.wt = fmax(1, linear_scale(child->animation.w0, child->animation.w1, t));
 			arrange_container(child, child->animation.wt, child->animation.ht, true, 0, workspace);
 		}
 	} else if (layout == L_HORIZ) {
@@ -1396,15 +1452,8 @@ static void animation_arrange_children(struct sway_workspace *workspace,
 			struct sway_container *child = children->items[i];
 			const double off = child->pending.x;
 			struct sway_container *parent = child->pending.parent;
-			child->animation.wt = fmax(1, linear_scale(child->animation.w0, child->animation.w1, t));
-			double movement = fabs(off - child->animation.x0);
-			if (movement > 0.0) {
-				child->animation.xt = linear_scale(child->animation.x0, off, x);
-			} else if (fabs(child->pending.y - child->animation.y0) > 0.0) {
-				child->animation.xt = child->animation.x0 + y * anim_scale * workspace->width;
-			} else {
-				child->animation.xt = child->animation.x0;
-			}
+			double cross = parent ? parent->pending.y : child->pending.y;
+			container_animate(child, workspace, layout, off, cross, 0);
 			sway_scene_node_set_enabled(&child->border.tree->node, true);
 			sway_scene_node_set_position(&child->scene_tree->node, child->animation.xt - workspace->x, 0);
 			// Update child for next iteration. Transactions don't re-arrange
@@ -1418,7 +1467,6 @@ static void animation_arrange_children(struct sway_workspace *workspace,
 				child->pending.y = parent->pending.y;
 			}
 			sway_scene_node_reparent(&child->scene_tree->node, content);
-			child->animation.ht = fmax(1, linear_scale(child->animation.h0, child->animation.h1, t));
 			arrange_container(child, child->animation.wt, child->animation.ht, true, 0, workspace);
 		}
 	} else {
@@ -1426,25 +1474,6 @@ static void animation_arrange_children(struct sway_workspace *workspace,
 	}
 }
 
-static void animation_callback(void *data) {
-	arrange_root(root);
-}
-
-static void animation_callback_end(void *data) {
-	cursor_rebase_all();
-}
-
-void animation_set_default_callbacks() {
-	struct sway_animation_callbacks callbacks;
-	callbacks.callback_begin = NULL;
-	callbacks.callback_begin_data = NULL;
-	callbacks.callback_step = animation_callback;
-	callbacks.callback_step_data = NULL;
-	callbacks.callback_end = animation_callback_end;
-	callbacks.callback_end_data = NULL;
-	animation_set_callbacks(&callbacks);
-}
-
 static void transaction_commit_pending(void);
 
 static void transaction_progress(void) {
@@ -1454,7 +1483,25 @@ static void transaction_progress(void) {
 	if (server.queued_transaction->num_waiting > 0) {
 		return;
 	}
-	transaction_apply(server.queued_transaction);
+	struct sway_transaction *transaction = server.queued_transaction;
+	struct timespec apply_start, apply_end, diff;
+	clock_gettime(CLOCK_MONOTONIC, &apply_start);
+	transaction_apply(transaction);
+	clock_gettime(CLOCK_MONOTONIC, &apply_end);
+
+	struct sway_transaction_timings timings = {
+		.instructions = transaction->instructions->length,
+		.configures = transaction->num_configures,
+		.commit_ns = transaction->commit_ns,
+		.timed_out = transaction->timed_out,
+	};
+	timespec_sub(&diff, &apply_start, &transaction->commit_time);
+	timings.wait_ns = timespec_to_nsec(&diff);
+	timespec_sub(&diff, &apply_end, &apply_start);
+	timings.apply_ns = timespec_to_nsec(&diff);
+	wl_signal_emit_mutable(&server.events.transaction_applied, &timings);
+
+	arrange_root(root);
 	animation_next_key();
 	cursor_rebase_all();
 	transaction_destroy(server.queued_transaction);
@@ -1489,6 +1536,7 @@ static int handle_timeout(void *data) {
 	sway_log(SWAY_DEBUG, "Transaction %p timed out (%zi waiting)",
 			transaction, transaction->num_waiting);
 	transaction->num_waiting = 0;
+	transaction->timed_out = true;
 	transaction_progress();
 	return 0;
 }
@@ -1530,6 +1578,8 @@ static bool should_configure(struct sway_node *node,
 static void transaction_commit(struct sway_transaction *transaction) {
 	sway_log(SWAY_DEBUG, "Transaction %p committing with %i instructions",
 			transaction, transaction->instructions->length);
+	struct timespec start, diff;
+	clock_gettime(CLOCK_MONOTONIC, &start);
 	transaction->num_waiting = 0;
 	for (int i = 0; i < transaction->instructions->length; ++i) {
 		struct sway_transaction_instruction *instruction =
@@ -1557,9 +1607,9 @@ static void transaction_commit(struct sway_transaction *transaction) {
 		node->instruction = instruction;
 	}
 	transaction->num_configures = transaction->num_waiting;
-	if (debug.txn_timings) {
-		clock_gettime(CLOCK_MONOTONIC, &transaction->commit_time);
-	}
+	clock_gettime(CLOCK_MONOTONIC, &transaction->commit_time);
+	timespec_sub(&diff, &transaction->commit_time, &start);
+	transaction->commit_ns = timespec_to_nsec(&diff);
 	if (debug.noatomic) {
 		transaction->num_waiting = 0;
 	} else if (debug.txn_wait) {
@@ -1654,13 +1704,21 @@ static void children_save_animation_variables(list_t *children) {
 	}
 	for (int i = 0; i < children->length; ++i) {
 		struct sway_container *child = children->items[i];
+		children_save_animation_variables(child->pending.children);
+		if (child->animation.timeline.running) {
+			if (child->pending.fullscreen_mode == FULLSCREEN_NONE &&
+					!container_is_floating(child)) {
+				// Retargeted from where it is when arranged
+				continue;
+			}
+			animation_timeline_stop(&child->animation.timeline);
+		}
 		child->animation.x0 = child->current.x;
 		child->animation.y0 = child->current.y;
 		child->animation.w0 = child->current.width;
 		child->animation.h0 = child->current.height;
 		child->animation.w1 = child->pending.width;
 		child->animation.h1 = child->pending.height;
-		children_save_animation_variables(child->pending.children);
 	}
 }
 
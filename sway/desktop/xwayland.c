@@ -777,8 +777,7 @@ static void handle_set_title(struct wl_listener *listener, void *data) {
 	if (xsurface->surface == NULL || !xsurface->surface->mapped) {
 		return;
 	}
-	view_update_title(view, false);
-	view_execute_criteria(view);
+	view_queue_update(view, VIEW_UPDATE_TITLE);
 }
 
 static void handle_set_class(struct wl_listener *listener, void *data) {
@@ -789,7 +788,7 @@ static void handle_set_class(struct wl_listener *listener, void *data) {
 	if (xsurface->surface == NULL || !xsurface->surface->mapped) {
 		return;
 	}
-	view_execute_criteria(view);
+	view_queue_update(view, VIEW_UPDATE_CRITERIA);
 }
 
 static void handle_set_role(struct wl_listener *listener, void *data) {
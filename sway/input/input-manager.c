@@ -499,6 +499,7 @@ void input_manager_finish(struct sway_input_manager *input) {
 	wl_list_remove(&input->virtual_pointer_new.link);
 	wl_list_remove(&input->keyboard_shortcuts_inhibit_new_inhibitor.link);
 	wl_list_remove(&input->transient_seat_create.link);
+	sway_keyboard_keymap_cache_clear();
 }
 
 bool input_manager_has_focus(struct sway_node *node) {
@@ -549,6 +550,19 @@ static void retranslate_keysyms(struct input_config *input_config) {
 	}
 }
 
+void input_manager_retranslate_keysyms(void) {
+	list_t *lists[] = { config->input_configs, config->input_type_configs };
+	for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); ++i) {
+		for (int j = 0; j < lists[i]->length; ++j) {
+			struct input_config *ic = lists[i]->items[j];
+			if (ic->xkb_layout || ic->xkb_file) {
+				translate_keysyms(ic);
+				return;
+			}
+		}
+	}
+}
+
 static void input_manager_configure_input(
 		struct sway_input_device *input_device) {
 #if WLR_HAS_LIBINPUT_BACKEND
@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <limits.h>
 #include <strings.h>
+#include <sys/stat.h>
 #include <wlr/config.h>
 #include <wlr/backend/multi.h>
 #include <wlr/interfaces/wlr_keyboard.h>
@@ -15,7 +16,9 @@
 #include "sway/input/cursor.h"
 #include "sway/ipc-server.h"
 #include "sway/server.h"
+#include "list.h"
 #include "log.h"
+#include "stringop.h"
 
 #if WLR_HAS_SESSION
 #include <wlr/backend/session.h>
@@ -791,7 +794,95 @@ static void handle_xkb_context_log(struct xkb_context *context,
 	}
 }
 
-struct xkb_keymap *sway_keyboard_compile_keymap(struct input_config *ic,
+/**
+ * Compiled keymaps, shared by all keyboards and config validation. Keyboards
+ * with the same RMLVO names or keymap file get the same keymap, so comparing
+ * keymaps is usually a pointer comparison.
+ */
+#define KEYMAP_CACHE_MAX_ENTRIES 16
+
+struct keymap_cache_entry {
+	char *key;
+	struct xkb_keymap *keymap;
+};
+
+static list_t *keymap_cache = NULL; // struct keymap_cache_entry, most recent first
+
+static char *keymap_cache_key(struct input_config *ic) {
+	if (ic && ic->xkb_file) {
+		// An edited file has to be compiled again
+		struct stat sb;
+		if (stat(ic->xkb_file, &sb) != 0) {
+			return NULL;
+		}
+		return format_str("file\n%s\n%lld.%09ld\n%lld", ic->xkb_file,
+			(long long)sb.st_mtim.tv_sec, sb.st_mtim.tv_nsec,
+			(long long)sb.st_size);
+	}
+	// xkbcommon treats NULL and empty names the same, both mean the default
+	struct xkb_rule_names rules = {0};
+	if (ic) {
+		input_config_fill_rule_names(ic, &rules);
+	}
+	return format_str("names\n%s\n%s\n%s\n%s\n%s",
+		rules.rules ? rules.rules : "", rules.model ? rules.model : "",
+		rules.layout ? rules.layout : "", rules.variant ? rules.variant : "",
+		rules.options ? rules.options : "");
+}
+
+static void keymap_cache_entry_destroy(struct keymap_cache_entry *entry) {
+	xkb_keymap_unref(entry->keymap);
+	free(entry->key);
+	free(entry);
+}
+
+static struct xkb_keymap *keymap_cache_get(const char *key) {
+	if (!keymap_cache || !key) {
+		return NULL;
+	}
+	for (int i = 0; i < keymap_cache->length; ++i) {
+		struct keymap_cache_entry *entry = keymap_cache->items[i];
+		if (strcmp(entry->key, key) == 0) {
+			if (i > 0) {
+				list_del(keymap_cache, i);
+				list_insert(keymap_cache, 0, entry);
+			}
+			return xkb_keymap_ref(entry->keymap);
+		}
+	}
+	return NULL;
+}
+
+static void keymap_cache_add(char *key, struct xkb_keymap *keymap) {
+	if (!keymap_cache) {
+		keymap_cache = create_list();
+	}
+	struct keymap_cache_entry *entry = calloc(1, sizeof(*entry));
+	if (!entry) {
+		free(key);
+		return;
+	}
+	entry->key = key;
+	entry->keymap = xkb_keymap_ref(keymap);
+	list_insert(keymap_cache, 0, entry);
+	while (keymap_cache->length > KEYMAP_CACHE_MAX_ENTRIES) {
+		keymap_cache_entry_destroy(keymap_cache->items[keymap_cache->length - 1]);
+		list_del(keymap_cache, keymap_cache->length - 1);
+	}
+}
+
+void sway_keyboard_keymap_cache_clear(void) {
+	if (!keymap_cache) {
+		return;
+	}
+	for (int i = 0; i < keymap_cache->length; ++i) {
+		keymap_cache_entry_destroy(keymap_cache->items[i]);
+	}
+	list_free(keymap_cache);
+	keymap_cache = NULL;
+}
+
+static struct xkb_keymap *compile_keymap(struct input_config *ic,
 		char **error) {
 	struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_SECURE_GETENV);
 	if (!sway_assert(context, "cannot create XKB context")) {
@@ -835,6 +926,30 @@ cleanup:
 	return keymap;
 }
 
+struct xkb_keymap *sway_keyboard_compile_keymap(struct input_config *ic,
+		char **error) {
+	char *key = keymap_cache_key(ic);
+	struct xkb_keymap *keymap = keymap_cache_get(key);
+	if (keymap) {
+		free(key);
+		return keymap;
+	}
+
+	// Failures are not cached, so the error is reported every time
+	keymap = compile_keymap(ic, error);
+	if (keymap && key) {
+		keymap_cache_add(key, keymap);
+	} else {
+		free(key);
+	}
+	return keymap;
+}
+
+static bool keymaps_match(struct xkb_keymap *a, struct xkb_keymap *b) {
+	// Keymaps from the cache are shared, only compare the text otherwise
+	return a == b || wlr_keyboard_keymaps_match(a, b);
+}
+
 static bool repeat_info_match(struct sway_keyboard *a, struct wlr_keyboard *b) {
 	return a->repeat_rate == b->repeat_info.rate &&
 		a->repeat_delay == b->repeat_info.delay;
@@ -893,7 +1008,7 @@ static void sway_keyboard_group_remove_invalid(struct sway_keyboard *keyboard) {
 	case KEYBOARD_GROUP_DEFAULT: /* fallthrough */
 	case KEYBOARD_GROUP_SMART:;
 		struct wlr_keyboard_group *group = keyboard->wlr->group;
-		if (!wlr_keyboard_keymaps_match(keyboard->keymap, group->keyboard.keymap) ||
+		if (!keymaps_match(keyboard->keymap, group->keyboard.keymap) ||
 				!repeat_info_match(keyboard, &group->keyboard)) {
 			sway_keyboard_group_remove(keyboard);
 		}
@@ -929,7 +1044,7 @@ static void sway_keyboard_group_add(struct sway_keyboard *keyboard) {
 		case KEYBOARD_GROUP_DEFAULT: /* fallthrough */
 		case KEYBOARD_GROUP_SMART:;
 			struct wlr_keyboard_group *wlr_group = group->wlr_group;
-			if (wlr_keyboard_keymaps_match(keyboard->keymap,
+			if (keymaps_match(keyboard->keymap,
 						wlr_group->keyboard.keymap) &&
 					repeat_info_match(keyboard, &wlr_group->keyboard)) {
 				sway_log(SWAY_DEBUG, "Adding keyboard %s to group %p",
@@ -1025,13 +1140,21 @@ static void sway_keyboard_set_layout(struct sway_keyboard *keyboard,
 	}
 
 	bool keymap_changed = keyboard->keymap ?
-		!wlr_keyboard_keymaps_match(keyboard->keymap, keymap) : true;
+		!keymaps_match(keyboard->keymap, keymap) : true;
 	bool effective_layout_changed = keyboard->effective_layout != 0;
-
-	if (keymap_changed || config->reloading) {
+	bool numlock = input_config && input_config->xkb_numlock > 0;
+	bool capslock = input_config && input_config->xkb_capslock > 0;
+	// A reload or another device's input command leaves this keyboard as it
+	// is, down to its locked modifiers, unless its own settings changed
+	bool locks_changed = keyboard->xkb_numlock != numlock ||
+		keyboard->xkb_capslock != capslock;
+
+	if (keymap_changed || locks_changed) {
 		xkb_keymap_unref(keyboard->keymap);
 		keyboard->keymap = keymap;
 		keyboard->effective_layout = 0;
+		keyboard->xkb_numlock = numlock;
+		keyboard->xkb_capslock = capslock;
 
 		sway_keyboard_group_remove_invalid(keyboard);
 		wlr_keyboard_set_keymap(keyboard->wlr, keyboard->keymap);
@@ -1040,14 +1163,14 @@ static void sway_keyboard_set_layout(struct sway_keyboard *keyboard,
 		}
 
 		xkb_mod_mask_t locked_mods = 0;
-		if (input_config && input_config->xkb_numlock > 0) {
+		if (numlock) {
 			xkb_mod_index_t mod_index = xkb_map_mod_get_index(keymap,
 					XKB_MOD_NAME_NUM);
 			if (mod_index != XKB_MOD_INVALID) {
 				locked_mods |= (uint32_t)1 << mod_index;
 			}
 		}
-		if (input_config && input_config->xkb_capslock > 0) {
+		if (capslock) {
 			xkb_mod_index_t mod_index = xkb_map_mod_get_index(keymap,
 					XKB_MOD_NAME_CAPS);
 			if (mod_index != XKB_MOD_INVALID) {
@@ -1109,7 +1232,7 @@ void sway_keyboard_configure(struct sway_keyboard *keyboard) {
 	bool repeat_info_changed = keyboard->repeat_rate != repeat_rate ||
 		keyboard->repeat_delay != repeat_delay;
 
-	if (repeat_info_changed || config->reloading) {
+	if (repeat_info_changed) {
 		keyboard->repeat_rate = repeat_rate;
 		keyboard->repeat_delay = repeat_delay;
 
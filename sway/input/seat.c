@@ -77,6 +77,7 @@ static void handle_seat_destroy(struct wl_listener *listener, void *data) {
 	if (seat == config->handler_context.seat) {
 		config->handler_context.seat = input_manager_get_default_seat();
 	}
+	layout_scroll_forget_seat(seat);
 	struct sway_seat_device *seat_device, *next;
 	wl_list_for_each_safe(seat_device, next, &seat->devices, link) {
 		seat_device_destroy(seat_device);
@@ -1128,17 +1129,6 @@ void seat_set_raw_focus(struct sway_seat *seat, struct sway_node *node) {
 	}
 }
 
-static void view_focus_run_lua_callbacks(struct sway_container *container) {
-	// Lua callbacks
-	for (int i = 0; i < config->lua.cbs_view_focus->length; ++i) {
-		struct sway_lua_closure *closure = config->lua.cbs_view_focus->items[i];
-		lua_rawgeti(config->lua.state, LUA_REGISTRYINDEX, closure->cb_function);
-		lua_pushlightuserdata(config->lua.state, container->view);
-		lua_rawgeti(config->lua.state, LUA_REGISTRYINDEX, closure->cb_data);
-		lua_call(config->lua.state, 2, 0);
-	}
-}
-
 static void seat_set_workspace_focus(struct sway_seat *seat, struct sway_node *node) {
 	struct sway_node *last_focus = seat_get_focus(seat);
 	if (last_focus == node) {
@@ -1214,7 +1204,7 @@ static void seat_set_workspace_focus(struct sway_seat *seat, struct sway_node *n
 	// emit ipc events
 	set_workspace(seat, new_workspace);
 	if (container && container->view) {
-		view_focus_run_lua_callbacks(container);
+		sway_lua_event_view(LUA_EVENT_VIEW_FOCUS, container->view);
 		ipc_event_window(container, "focus");
 	}
 
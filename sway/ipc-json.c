@@ -11,6 +11,7 @@
 #include "config.h"
 #include "log.h"
 #include "sway/config.h"
+#include "sway/desktop/stats.h"
 #include "sway/ipc-json.h"
 #include "sway/server.h"
 #include "sway/tree/container.h"
@@ -1523,6 +1524,73 @@ json_object *ipc_json_describe_scroller(struct sway_workspace *workspace) {
 	return object;
 }
 
+static json_object *describe_stats_series(
+		const struct sway_stats_series *series) {
+	struct sway_stats_summary summary;
+	stats_series_summarize(series, &summary);
+
+	json_object *object = json_object_new_object();
+	json_object_object_add(object, "samples",
+			json_object_new_int64(summary.samples));
+	json_object_object_add(object, "min", json_object_new_int64(summary.min));
+	json_object_object_add(object, "avg", json_object_new_int64(summary.avg));
+	json_object_object_add(object, "p50", json_object_new_int64(summary.p50));
+	json_object_object_add(object, "p90", json_object_new_int64(summary.p90));
+	json_object_object_add(object, "p99", json_object_new_int64(summary.p99));
+	json_object_object_add(object, "max", json_object_new_int64(summary.max));
+
+	// Drop the empty buckets at the end
+	int last = STATS_BUCKETS - 1;
+	while (last > 0 && summary.buckets[last] == 0) {
+		--last;
+	}
+	json_object *histogram = json_object_new_array();
+	for (int i = 0; i <= last; ++i) {
+		json_object_array_add(histogram,
+				json_object_new_int64(summary.buckets[i]));
+	}
+	json_object_object_add(object, "histogram", histogram);
+	return object;
+}
+
+json_object *ipc_json_describe_stats(void) {
+	json_object *object = json_object_new_object();
+
+	json_object *transactions = json_object_new_object();
+	json_object_object_add(transactions, "count",
+			json_object_new_int64(transaction_stats.count));
+	json_object_object_add(transactions, "timed_out",
+			json_object_new_int64(transaction_stats.timed_out));
+	json_object_object_add(transactions, "wait",
+			describe_stats_series(&transaction_stats.wait));
+	json_object_object_add(object, "transactions", transactions);
+
+	json_object *outputs = json_object_new_array();
+	for (int i = 0; i < root->outputs->length; ++i) {
+		struct sway_output *output = root->outputs->items[i];
+		struct sway_output_stats *stats = &output->stats;
+		json_object *o = json_object_new_object();
+		json_object_object_add(o, "name",
+				json_object_new_string(output->wlr_output->name));
+		json_object_object_add(o, "frames",
+				json_object_new_int64(stats->frames));
+		json_object_object_add(o, "dropped_frames",
+				json_object_new_int64(stats->dropped_frames));
+		json_object_object_add(o, "missed_vblanks",
+				json_object_new_int64(stats->missed_vblanks));
+		json_object_object_add(o, "build_state",
+				describe_stats_series(&stats->build_state));
+		json_object_object_add(o, "render",
+				describe_stats_series(&stats->render));
+		json_object_object_add(o, "present_latency",
+				describe_stats_series(&stats->present));
+		json_object_array_add(outputs, o);
+	}
+	json_object_object_add(object, "outputs", outputs);
+
+	return object;
+}
+
 json_object *ipc_json_describe_trails() {
 	json_object *object = json_object_new_object();
 
@@ -20,6 +20,7 @@
 #include "sway/ipc-json.h"
 #include "sway/ipc-server.h"
 #include "sway/output.h"
+#include "sway/recorder.h"
 #include "sway/server.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/keyboard.h"
@@ -37,6 +38,10 @@ static struct wl_event_source *ipc_event_source =  NULL;
 static struct sockaddr_un *ipc_sockaddr = NULL;
 static list_t *ipc_client_list = NULL;
 static struct wl_listener ipc_display_destroy;
+static struct wl_event_source *ipc_stats_timer = NULL;
+
+// How often the stats event is sent to subscribers
+#define IPC_STATS_INTERVAL_MS 1000
 
 static const char ipc_magic[] = {'i', '3', '-', 'i', 'p', 'c'};
 
@@ -69,6 +74,9 @@ static void handle_display_destroy(struct wl_listener *listener, void *data) {
 	if (ipc_event_source) {
 		wl_event_source_remove(ipc_event_source);
 	}
+	if (ipc_stats_timer) {
+		wl_event_source_remove(ipc_stats_timer);
+	}
 	close(ipc_socket);
 	unlink(ipc_sockaddr->sun_path);
 
@@ -276,6 +284,10 @@ static bool ipc_has_event_listeners(enum ipc_command_type event) {
 	return false;
 }
 
+bool ipc_stats_subscribed(void) {
+	return ipc_client_list && ipc_has_event_listeners(IPC_EVENT_STATS);
+}
+
 static void ipc_send_event(const char *json_string, enum ipc_command_type event) {
 	struct ipc_client *client;
 	for (int i = 0; i < ipc_client_list->length; i++) {
@@ -296,6 +308,7 @@ static void ipc_send_event(const char *json_string, enum ipc_command_type event)
 
 void ipc_event_workspace(struct sway_workspace *old,
 		struct sway_workspace *new, const char *change) {
+	sway_lua_event_workspace(LUA_EVENT_WORKSPACE, new, change);
 	if (!ipc_has_event_listeners(IPC_EVENT_WORKSPACE)) {
 		return;
 	}
@@ -322,6 +335,7 @@ void ipc_event_workspace(struct sway_workspace *old,
 }
 
 void ipc_event_window(struct sway_container *window, const char *change) {
+	sway_lua_event_container(LUA_EVENT_WINDOW, window, change);
 	if (!ipc_has_event_listeners(IPC_EVENT_WINDOW)) {
 		return;
 	}
@@ -365,6 +379,7 @@ void ipc_event_bar_state_update(struct bar_config *bar) {
 }
 
 void ipc_event_mode(const char *mode, bool pango) {
+	sway_lua_event_string(LUA_EVENT_MODE, NULL, mode);
 	if (!ipc_has_event_listeners(IPC_EVENT_MODE)) {
 		return;
 	}
@@ -380,6 +395,7 @@ void ipc_event_mode(const char *mode, bool pango) {
 }
 
 void ipc_event_shutdown(const char *reason) {
+	sway_lua_event_string(LUA_EVENT_SHUTDOWN, NULL, reason);
 	if (!ipc_has_event_listeners(IPC_EVENT_SHUTDOWN)) {
 		return;
 	}
@@ -394,6 +410,7 @@ void ipc_event_shutdown(const char *reason) {
 }
 
 void ipc_event_binding(struct sway_binding *binding) {
+	sway_lua_event_string(LUA_EVENT_BINDING, binding->command, "run");
 	if (!ipc_has_event_listeners(IPC_EVENT_BINDING)) {
 		return;
 	}
@@ -495,6 +512,7 @@ static void ipc_event_tick(const char *payload) {
 }
 
 void ipc_event_input(const char *change, struct sway_input_device *device) {
+	sway_lua_event_string(LUA_EVENT_INPUT, device->identifier, change);
 	if (!ipc_has_event_listeners(IPC_EVENT_INPUT)) {
 		return;
 	}
@@ -510,6 +528,7 @@ void ipc_event_input(const char *change, struct sway_input_device *device) {
 }
 
 void ipc_event_output(void) {
+	sway_lua_event_string(LUA_EVENT_OUTPUT, NULL, "unspecified");
 	if (!ipc_has_event_listeners(IPC_EVENT_OUTPUT)) {
 		return;
 	}
@@ -524,6 +543,7 @@ void ipc_event_output(void) {
 }
 
 void ipc_event_scroller(const char *change, struct sway_workspace *workspace) {
+	sway_lua_event_workspace(LUA_EVENT_SCROLLER, workspace, change);
 	if (!ipc_has_event_listeners(IPC_EVENT_SCROLLER)) {
 		return;
 	}
@@ -552,6 +572,54 @@ void ipc_event_trails() {
 	json_object_put(json);
 }
 
+void ipc_event_stats(void) {
+	if (!ipc_has_event_listeners(IPC_EVENT_STATS)) {
+		return;
+	}
+	sway_log(SWAY_DEBUG, "Sending stats event");
+
+	json_object *json = ipc_json_describe_stats();
+	const char *json_string = json_object_to_json_string(json);
+	ipc_send_event(json_string, IPC_EVENT_STATS);
+	json_object_put(json);
+}
+
+void ipc_event_config_reload(bool success) {
+	if (!ipc_has_event_listeners(IPC_EVENT_CONFIG)) {
+		return;
+	}
+	sway_log(SWAY_DEBUG, "Sending config event");
+
+	json_object *json = json_object_new_object();
+	json_object_object_add(json, "change", json_object_new_string("reload"));
+	json_object_object_add(json, "success", json_object_new_boolean(success));
+
+	const char *json_string = json_object_to_json_string(json);
+	ipc_send_event(json_string, IPC_EVENT_CONFIG);
+	json_object_put(json);
+}
+
+static int handle_stats_timer(void *data) {
+	// Stop ticking once the last subscriber is gone
+	if (ipc_has_event_listeners(IPC_EVENT_STATS)) {
+		ipc_event_stats();
+		wl_event_source_timer_update(ipc_stats_timer, IPC_STATS_INTERVAL_MS);
+	}
+	return 0;
+}
+
+static void ipc_schedule_stats_event(void) {
+	if (!ipc_stats_timer) {
+		ipc_stats_timer = wl_event_loop_add_timer(server.wl_event_loop,
+				handle_stats_timer, NULL);
+		if (!ipc_stats_timer) {
+			sway_log(SWAY_ERROR, "Unable to create stats timer");
+			return;
+		}
+	}
+	wl_event_source_timer_update(ipc_stats_timer, IPC_STATS_INTERVAL_MS);
+}
+
 int ipc_client_handle_writable(int client_fd, uint32_t mask, void *data) {
 	struct ipc_client *client = data;
 
@@ -678,6 +746,7 @@ void ipc_client_handle_command(struct ipc_client *client, uint32_t payload_lengt
 			line = strtok(NULL, "\n");
 		}
 
+		recorder_command(buf);
 		list_t *res_list = execute_command(buf, NULL, NULL);
 		if (modeset_is_pending()) {
 			// IPC expects commands to have taken immediate effect, so we need
@@ -798,6 +867,11 @@ void ipc_client_handle_command(struct ipc_client *client, uint32_t payload_lengt
 				client->subscribed_events |= event_mask(IPC_EVENT_SCROLLER);
 			} else if (strcmp(event_type, "trails") == 0) {
 				client->subscribed_events |= event_mask(IPC_EVENT_TRAILS);
+			} else if (strcmp(event_type, "config") == 0) {
+				client->subscribed_events |= event_mask(IPC_EVENT_CONFIG);
+			} else if (strcmp(event_type, "stats") == 0) {
+				client->subscribed_events |= event_mask(IPC_EVENT_STATS);
+				ipc_schedule_stats_event();
 			} else {
 				const char msg[] = "{\"success\": false}";
 				ipc_send_reply(client, payload_type, msg, strlen(msg));
@@ -996,6 +1070,16 @@ void ipc_client_handle_command(struct ipc_client *client, uint32_t payload_lengt
 		goto exit_cleanup;
 	}
 
+	case IPC_GET_STATS:
+	{
+		json_object *json = ipc_json_describe_stats();
+		const char *json_string = json_object_to_json_string(json);
+		ipc_send_reply(client, payload_type, json_string,
+			(uint32_t)strlen(json_string));
+		json_object_put(json);
+		goto exit_cleanup;
+	}
+
 	default:
 		sway_log(SWAY_INFO, "Unknown IPC command type %x", payload_type);
 		goto exit_cleanup;
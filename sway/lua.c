@@ -1,5 +1,8 @@
 #include <lua.h>
 #include <lauxlib.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "log.h"
 #include "sway/lua.h"
 #include "sway/commands.h"
@@ -92,19 +95,143 @@ static int scroll_state_set_value(lua_State *L) {
 	return 0;
 }
 
-static bool find_view(struct sway_container *container, void *data) {
-	struct sway_view *view = data;
-	return container->view == view;
+// Views, containers, workspaces and outputs are given to Lua as integer
+// handles: the index of a slot in this table in the low 32 bits and the
+// generation of the slot in the high ones. A slot is taken when the object is
+// created and released when it is freed, bumping its generation, so a handle
+// kept by a script after the object is gone never resolves to anything, even
+// if the memory is reused for a new object.
+struct sway_lua_slot {
+	void *object; // NULL when free
+	enum sway_lua_handle_type type;
+	uint32_t generation;
+	uint32_t next_free;
+};
+
+static struct {
+	struct sway_lua_slot *slots;
+	uint32_t length, capacity;
+	uint32_t free_head;
+} handles = { .free_head = UINT32_MAX };
+
+uint64_t sway_lua_handle_create(enum sway_lua_handle_type type, void *object) {
+	uint32_t index;
+	if (handles.free_head != UINT32_MAX) {
+		index = handles.free_head;
+		handles.free_head = handles.slots[index].next_free;
+	} else {
+		if (handles.length == handles.capacity) {
+			uint32_t capacity = handles.capacity ? handles.capacity * 2 : 64;
+			struct sway_lua_slot *slots = realloc(handles.slots,
+				capacity * sizeof(struct sway_lua_slot));
+			if (!slots) {
+				sway_log(SWAY_ERROR, "Unable to allocate Lua handle");
+				return 0;
+			}
+			handles.slots = slots;
+			handles.capacity = capacity;
+		}
+		index = handles.length++;
+		handles.slots[index].generation = 1;
+	}
+	struct sway_lua_slot *slot = &handles.slots[index];
+	slot->object = object;
+	slot->type = type;
+	return (uint64_t)slot->generation << 32 | index;
 }
 
-static bool find_container(struct sway_container *container, void *data) {
-	struct sway_container *con = data;
-	return container == con;
+void sway_lua_handle_release(uint64_t handle) {
+	uint32_t index = handle & UINT32_MAX;
+	if (handle == 0 || index >= handles.length) {
+		return;
+	}
+	struct sway_lua_slot *slot = &handles.slots[index];
+	if (slot->generation != handle >> 32) {
+		return;
+	}
+	slot->object = NULL;
+	// Generation 0 is never handed out, so handle 0 is always invalid
+	if (++slot->generation == 0) {
+		slot->generation = 1;
+	}
+	slot->next_free = handles.free_head;
+	handles.free_head = index;
 }
 
-static bool find_workspace(struct sway_workspace *workspace, void *data) {
-	struct sway_workspace *ws = data;
-	return workspace == ws;
+static struct sway_lua_slot *handle_to_slot(lua_State *L, int idx) {
+	if (!lua_isinteger(L, idx)) {
+		return NULL;
+	}
+	uint64_t handle = (uint64_t)lua_tointeger(L, idx);
+	uint32_t index = handle & UINT32_MAX;
+	if (index >= handles.length) {
+		return NULL;
+	}
+	struct sway_lua_slot *slot = &handles.slots[index];
+	if (slot->generation != handle >> 32 || !slot->object) {
+		return NULL;
+	}
+	return slot;
+}
+
+static struct sway_view *handle_to_view(lua_State *L, int idx) {
+	struct sway_lua_slot *slot = handle_to_slot(L, idx);
+	if (!slot || slot->type != LUA_HANDLE_VIEW) {
+		return NULL;
+	}
+	struct sway_view *view = slot->object;
+	return view->destroying ? NULL : view;
+}
+
+static struct sway_container *handle_to_container(lua_State *L, int idx) {
+	struct sway_lua_slot *slot = handle_to_slot(L, idx);
+	if (!slot || slot->type != LUA_HANDLE_CONTAINER) {
+		return NULL;
+	}
+	struct sway_container *container = slot->object;
+	return container->node.destroying ? NULL : container;
+}
+
+static struct sway_workspace *handle_to_workspace(lua_State *L, int idx) {
+	struct sway_lua_slot *slot = handle_to_slot(L, idx);
+	if (!slot || slot->type != LUA_HANDLE_WORKSPACE) {
+		return NULL;
+	}
+	struct sway_workspace *workspace = slot->object;
+	return workspace->node.destroying ? NULL : workspace;
+}
+
+static struct sway_output *handle_to_output(lua_State *L, int idx) {
+	struct sway_lua_slot *slot = handle_to_slot(L, idx);
+	if (!slot || slot->type != LUA_HANDLE_OUTPUT) {
+		return NULL;
+	}
+	struct sway_output *output = slot->object;
+	return output->node.destroying ? NULL : output;
+}
+
+static void push_handle(lua_State *L, uint64_t handle) {
+	if (handle) {
+		lua_pushinteger(L, (lua_Integer)handle);
+	} else {
+		lua_pushnil(L);
+	}
+}
+
+void sway_lua_push_view(lua_State *L, struct sway_view *view) {
+	push_handle(L, view ? view->lua_handle : 0);
+}
+
+void sway_lua_push_container(lua_State *L, struct sway_container *container) {
+	push_handle(L, container ? container->node.lua_handle : 0);
+}
+
+void sway_lua_push_workspace(lua_State *L, struct sway_workspace *workspace) {
+	push_handle(L, workspace ? workspace->node.lua_handle : 0);
+}
+
+void sway_lua_push_output(lua_State *L, struct sway_output *output) {
+	push_handle(L, output ? output->node.lua_handle : 0);
 }
 
 static int scroll_command_error(lua_State *L, const char *error) {
@@ -120,30 +247,28 @@ static int scroll_command(lua_State *L) {
 	if (argc < 2) {
 		return scroll_command_error(L, "Error: scroll_command() received a wrong number of parameters");
 	}
-	void *node = lua_isnil(L, 1) ? NULL : lua_touserdata(L, 1);
 	struct sway_seat *seat = input_manager_current_seat();
-	struct sway_container *container = node;
-	if (container && container->node.type == N_CONTAINER) {
-		struct sway_container *found = root_find_container(find_container, container);
-		if (!found) {
+	struct sway_container *container = NULL;
+	struct sway_lua_slot *slot = lua_isnil(L, 1) ? NULL : handle_to_slot(L, 1);
+	if (lua_isnil(L, 1)) {
+		seat = NULL;
+	} else if (!slot) {
+		return scroll_command_error(L, "Error: scroll_command() received a parameter that does not exist");
+	} else if (slot->type == LUA_HANDLE_CONTAINER) {
+		container = handle_to_container(L, 1);
+		if (!container) {
 			return scroll_command_error(L, "Error: scroll_command() received a container parameter that does not exist");
 		}
 		seat_set_raw_focus(seat, &container->node);
 		seat = NULL;
-	} else {
-		container = NULL;
-		struct sway_workspace *workspace = node;
-		if (workspace && workspace->node.type == N_WORKSPACE) {
-			struct sway_workspace *found = root_find_workspace(find_workspace, workspace);
-			if (!found) {
-				return scroll_command_error(L, "Error: scroll_command() received a workspace parameter that does not exist");
-			}
-			seat_set_raw_focus(seat, &workspace->node);
-		} else if (node == NULL) {
-			seat = NULL;
-		} else {
-			return scroll_command_error(L, "Error: scroll_command() received a parameter that is neither a container nor a workspace");
+	} else if (slot->type == LUA_HANDLE_WORKSPACE) {
+		struct sway_workspace *workspace = handle_to_workspace(L, 1);
+		if (!workspace) {
+			return scroll_command_error(L, "Error: scroll_command() received a workspace parameter that does not exist");
 		}
+		seat_set_raw_focus(seat, &workspace->node);
+	} else {
+		return scroll_command_error(L, "Error: scroll_command() received a parameter that is neither a container nor a workspace");
 	}
 	const char *lua_cmd = luaL_checkstring(L, 2);
 	char *cmd = strdup(lua_cmd);
@@ -179,7 +304,7 @@ static int scroll_focused_view(lua_State *L) {
 		node->sway_container : NULL;
 
 	if (container && container->view) {
-		lua_pushlightuserdata(L, container->view);
+		sway_lua_push_view(L, container->view);
 	} else {
 		lua_pushnil(L);
 	}
@@ -196,7 +321,7 @@ static int scroll_focused_container(lua_State *L) {
 		node->sway_container : NULL;
 
 	if (container) {
-		lua_pushlightuserdata(L, container);
+		sway_lua_push_container(L, container);
 	} else {
 		lua_pushnil(L);
 	}
@@ -219,7 +344,7 @@ static int scroll_focused_workspace(lua_State *L) {
 	}
 
 	if (workspace) {
-		lua_pushlightuserdata(L, workspace);
+		sway_lua_push_workspace(L, workspace);
 	} else {
 		lua_pushnil(L);
 	}
@@ -233,7 +358,7 @@ static bool find_urgent(struct sway_container *container, void *data) {
 static int scroll_urgent_view(lua_State *L) {
 	struct sway_container *container = root_find_container(find_urgent, NULL);
 	if (container && container->view) {
-		lua_pushlightuserdata(L, container->view);
+		sway_lua_push_view(L, container->view);
 	} else {
 		lua_pushnil(L);
 	}
@@ -246,15 +371,9 @@ static int scroll_view_mapped(lua_State *L) {
 		lua_pushboolean(L, 0);
 		return 1;
 	}
-	struct sway_view *view = lua_touserdata(L, -1);
-	if (view) {
-		struct sway_container *found = root_find_container(find_view, view);
-		if (found) {
-			lua_pushboolean(L, 1);
-			return 1;
-		}
-	}
-	lua_pushboolean(L, 0);
+	struct sway_view *view = handle_to_view(L, -1);
+	lua_pushboolean(L, view && view->container &&
+		!view->container->node.destroying);
 	return 1;
 }
 
@@ -264,8 +383,8 @@ static int scroll_view_get_container(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_view *view = lua_touserdata(L, -1);
-	lua_pushlightuserdata(L, view ? view->container : NULL);
+	struct sway_view *view = handle_to_view(L, -1);
+	sway_lua_push_container(L, view ? view->container : NULL);
 	return 1;
 }
 
@@ -275,7 +394,7 @@ static int scroll_view_get_app_id(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_view *view = lua_touserdata(L, -1);
+	struct sway_view *view = handle_to_view(L, -1);
 	if (!view) {
 		lua_pushnil(L);
 		return 1;
@@ -291,7 +410,7 @@ static int scroll_view_get_title(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_view *view = lua_touserdata(L, -1);
+	struct sway_view *view = handle_to_view(L, -1);
 	if (!view) {
 		lua_pushnil(L);
 		return 1;
@@ -307,7 +426,7 @@ static int scroll_view_get_pid(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_view *view = lua_touserdata(L, -1);
+	struct sway_view *view = handle_to_view(L, -1);
 	if (!view) {
 		lua_pushnil(L);
 		return 1;
@@ -339,7 +458,7 @@ static int scroll_view_get_parent_view(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_view *view = lua_touserdata(L, -1);
+	struct sway_view *view = handle_to_view(L, -1);
 	if (!view) {
 		lua_pushnil(L);
 		return 1;
@@ -358,7 +477,7 @@ static int scroll_view_get_parent_view(lua_State *L) {
 		}
 	};
 	if (container && container->view) {
-		lua_pushlightuserdata(L, container->view);
+		sway_lua_push_view(L, container->view);
 	} else {
 		lua_pushnil(L);
 	}
@@ -371,7 +490,7 @@ static int scroll_view_get_urgent(lua_State *L) {
 		lua_pushboolean(L, 0);
 		return 1;
 	}
-	struct sway_view *view = lua_touserdata(L, -1);
+	struct sway_view *view = handle_to_view(L, -1);
 	if (!view) {
 		lua_pushnil(L);
 		return 1;
@@ -386,7 +505,7 @@ static int scroll_view_set_urgent(lua_State *L) {
 		return 0;
 	}
 	bool urgent = lua_toboolean(L, 2);
-	struct sway_view *view = lua_touserdata(L, 1);
+	struct sway_view *view = handle_to_view(L, 1);
 	if (view) {
 		view_set_urgent(view, urgent);
 	}
@@ -399,7 +518,7 @@ static int scroll_view_get_shell(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_view *view = lua_touserdata(L, -1);
+	struct sway_view *view = handle_to_view(L, -1);
 	if (!view) {
 		lua_pushnil(L);
 		return 1;
@@ -414,7 +533,7 @@ static int scroll_view_close(lua_State *L) {
 	if (argc == 0) {
 		return 0;
 	}
-	struct sway_view *view = lua_touserdata(L, -1);
+	struct sway_view *view = handle_to_view(L, -1);
 	if (view) {
 		view_close(view);
 	}
@@ -427,12 +546,12 @@ static int scroll_container_get_workspace(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushnil(L);
 		return 1;
 	}
-	lua_pushlightuserdata(L, container->pending.workspace);
+	sway_lua_push_workspace(L, container->pending.workspace);
 	return 1;
 }
 
@@ -442,8 +561,8 @@ static int scroll_container_get_marks(lua_State *L) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
@@ -463,8 +582,8 @@ static int scroll_container_get_floating(lua_State *L) {
 		lua_pushboolean(L, 0);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushboolean(L, 0);
 		return 1;
 	}
@@ -478,8 +597,8 @@ static int scroll_container_get_opacity(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushnil(L);
 		return 1;
 	}
@@ -493,8 +612,8 @@ static int scroll_container_get_sticky(lua_State *L) {
 		lua_pushboolean(L, 0);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushboolean(L, 0);
 		return 1;
 	}
@@ -508,8 +627,8 @@ static int scroll_container_get_width_fraction(lua_State *L) {
 		lua_pushnumber(L, 0.0);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushnumber(L, 0.0);
 		return 1;
 	}
@@ -523,8 +642,8 @@ static int scroll_container_get_height_fraction(lua_State *L) {
 		lua_pushnumber(L, 0.0);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushnumber(L, 0.0);
 		return 1;
 	}
@@ -538,8 +657,8 @@ static int scroll_container_get_width(lua_State *L) {
 		lua_pushnumber(L, 0.0);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushnumber(L, 0.0);
 		return 1;
 	}
@@ -553,8 +672,8 @@ static int scroll_container_get_height(lua_State *L) {
 		lua_pushnumber(L, 0.0);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushnumber(L, 0.0);
 		return 1;
 	}
@@ -562,28 +681,30 @@ static int scroll_container_get_height(lua_State *L) {
 	return 1;
 }
 
+static const char *fullscreen_mode_to_str(enum sway_fullscreen_mode mode) {
+	switch (mode) {
+	case FULLSCREEN_NONE:
+		return "none";
+	case FULLSCREEN_WORKSPACE:
+		return "workspace";
+	case FULLSCREEN_GLOBAL:
+		return "global";
+	}
+	return "none";
+}
+
 static int scroll_container_get_fullscreen_mode(lua_State *L) {
 	int argc = lua_gettop(L);
 	if (argc == 0) {
 		lua_pushstring(L, "none");
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushstring(L, "none");
 		return 1;
 	}
-	switch (container->pending.fullscreen_mode) {
-	case FULLSCREEN_NONE:
-		lua_pushstring(L, "none");
-		break;
-	case FULLSCREEN_WORKSPACE:
-		lua_pushstring(L, "workspace");
-		break;
-	case FULLSCREEN_GLOBAL:
-		lua_pushstring(L, "global");
-		break;
-	}
+	lua_pushstring(L, fullscreen_mode_to_str(container->pending.fullscreen_mode));
 	return 1;
 }
 
@@ -593,8 +714,8 @@ static int scroll_container_get_fullscreen_app_mode(lua_State *L) {
 		lua_pushstring(L, "default");
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushstring(L, "default");
 		return 1;
 	}
@@ -618,13 +739,13 @@ static int scroll_container_get_parent(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER ||
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container ||
 		container->pending.parent == NULL) {
 		lua_pushnil(L);
 		return 1;
 	}
-	lua_pushlightuserdata(L, container->pending.parent);
+	sway_lua_push_container(L, container->pending.parent);
 	return 1;
 }
 
@@ -634,8 +755,8 @@ static int scroll_container_get_children(lua_State *L) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER ||
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container ||
 		container->pending.children == NULL) {
 		lua_createtable(L, 0, 0);
 		return 1;
@@ -645,7 +766,7 @@ static int scroll_container_get_children(lua_State *L) {
 	lua_createtable(L, len, 0);
 	for (int i = 0; i < len; ++i) {
 		struct sway_container *con = container->pending.children->items[i];
-		lua_pushlightuserdata(L, con);
+		sway_lua_push_container(L, con);
 		lua_rawseti(L, -2, i + 1);
 	}
 	return 1;
@@ -657,14 +778,14 @@ static int scroll_container_get_views(lua_State *L) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
 	if (container->view) {
 		lua_createtable(L, 1, 0);
-		lua_pushlightuserdata(L, container->view);
+		sway_lua_push_view(L, container->view);
 		lua_rawseti(L, -2, 1);
 	} else {
 		int len = container->pending.children->length;
@@ -672,7 +793,7 @@ static int scroll_container_get_views(lua_State *L) {
 		lua_createtable(L, len, 0);
 		for (int i = 0; i < len; ++i) {
 			struct sway_container *con = container->pending.children->items[i];
-			lua_pushlightuserdata(L, con->view);
+			sway_lua_push_view(L, con->view);
 			lua_rawseti(L, -2, i + 1);
 		}
 	}
@@ -685,8 +806,8 @@ static int scroll_container_get_id(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_container *container = lua_touserdata(L, -1);
-	if (!container || container->node.type != N_CONTAINER) {
+	struct sway_container *container = handle_to_container(L, -1);
+	if (!container) {
 		lua_pushnil(L);
 		return 1;
 	}
@@ -700,8 +821,8 @@ static int scroll_workspace_get_name(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_workspace *workspace = lua_touserdata(L, -1);
-	if (!workspace || workspace->node.type != N_WORKSPACE) {
+	struct sway_workspace *workspace = handle_to_workspace(L, -1);
+	if (!workspace) {
 		lua_pushnil(L);
 		return 1;
 	}
@@ -715,8 +836,8 @@ static int scroll_workspace_get_tiling(lua_State *L) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
-	struct sway_workspace *workspace = lua_touserdata(L, -1);
-	if (!workspace || workspace->node.type != N_WORKSPACE ||
+	struct sway_workspace *workspace = handle_to_workspace(L, -1);
+	if (!workspace ||
 		workspace->tiling->length == 0) {
 		lua_createtable(L, 0, 0);
 		return 1;
@@ -725,7 +846,7 @@ static int scroll_workspace_get_tiling(lua_State *L) {
 	lua_createtable(L, workspace->tiling->length, 0);
 	for (int i = 0; i < workspace->tiling->length; ++i) {
 		struct sway_container *container = workspace->tiling->items[i];
-		lua_pushlightuserdata(L, container);
+		sway_lua_push_container(L, container);
 		lua_rawseti(L, -2, i + 1);
 	}
 	return 1;
@@ -737,8 +858,8 @@ static int scroll_workspace_get_floating(lua_State *L) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
-	struct sway_workspace *workspace = lua_touserdata(L, -1);
-	if (!workspace || workspace->node.type != N_WORKSPACE ||
+	struct sway_workspace *workspace = handle_to_workspace(L, -1);
+	if (!workspace ||
 		workspace->floating->length == 0) {
 		lua_createtable(L, 0, 0);
 		return 1;
@@ -747,7 +868,7 @@ static int scroll_workspace_get_floating(lua_State *L) {
 	lua_createtable(L, workspace->floating->length, 0);
 	for (int i = 0; i < workspace->floating->length; ++i) {
 		struct sway_container *container = workspace->floating->items[i];
-		lua_pushlightuserdata(L, container);
+		sway_lua_push_container(L, container);
 		lua_rawseti(L, -2, i + 1);
 	}
 	return 1;
@@ -759,8 +880,8 @@ static int scroll_workspace_get_mode(lua_State *L) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
-	struct sway_workspace *workspace = lua_touserdata(L, -1);
-	if (!workspace || workspace->node.type != N_WORKSPACE) {
+	struct sway_workspace *workspace = handle_to_workspace(L, -1);
+	if (!workspace) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
@@ -824,8 +945,8 @@ static int scroll_workspace_set_mode(lua_State *L) {
 	if (argc < 2) {
 		return 0;
 	}
-	struct sway_workspace *workspace = lua_touserdata(L, 1);
-	if (!workspace || workspace->node.type != N_WORKSPACE) {
+	struct sway_workspace *workspace = handle_to_workspace(L, 1);
+	if (!workspace) {
 		return 0;
 	}
 	if (lua_getfield(L, 2, "mode") == LUA_TSTRING) {
@@ -886,8 +1007,8 @@ static int scroll_workspace_get_layout_type(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_workspace *workspace = lua_touserdata(L, -1);
-	if (!workspace || workspace->node.type != N_WORKSPACE) {
+	struct sway_workspace *workspace = handle_to_workspace(L, -1);
+	if (!workspace) {
 		lua_pushnil(L);
 		return 1;
 	}
@@ -911,8 +1032,8 @@ static int scroll_workspace_set_layout_type(lua_State *L) {
 	if (argc < 2) {
 		return 0;
 	}
-	struct sway_workspace *workspace = lua_touserdata(L, 1);
-	if (!workspace || workspace->node.type != N_WORKSPACE) {
+	struct sway_workspace *workspace = handle_to_workspace(L, 1);
+	if (!workspace) {
 		return 0;
 	}
 	const char *layout = luaL_checkstring(L, 2);
@@ -930,8 +1051,8 @@ static int scroll_workspace_get_width(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_workspace *workspace = lua_touserdata(L, -1);
-	if (!workspace || workspace->node.type != N_WORKSPACE) {
+	struct sway_workspace *workspace = handle_to_workspace(L, -1);
+	if (!workspace) {
 		lua_pushnil(L);
 		return 1;
 	}
@@ -945,8 +1066,8 @@ static int scroll_workspace_get_height(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_workspace *workspace = lua_touserdata(L, -1);
-	if (!workspace || workspace->node.type != N_WORKSPACE) {
+	struct sway_workspace *workspace = handle_to_workspace(L, -1);
+	if (!workspace) {
 		lua_pushnil(L);
 		return 1;
 	}
@@ -959,7 +1080,7 @@ static int scroll_scratchpad_get_containers(lua_State *L) {
 	lua_createtable(L, root->scratchpad->length, 0);
 	for (int i = 0; i < root->scratchpad->length; ++i) {
 		struct sway_container *container = root->scratchpad->items[i];
-		lua_pushlightuserdata(L, container);
+		sway_lua_push_container(L, container);
 		lua_rawseti(L, -2, i + 1);
 	}
 	return 1;
@@ -971,12 +1092,12 @@ static int scroll_output_get_active_workspace(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_output *output = lua_touserdata(L, -1);
-	if (!output || output->node.type != N_OUTPUT) {
+	struct sway_output *output = handle_to_output(L, -1);
+	if (!output) {
 		lua_pushnil(L);
 		return 1;
 	}
-	lua_pushlightuserdata(L, output->current.active_workspace);
+	sway_lua_push_workspace(L, output->current.active_workspace);
 	return 1;
 }
 
@@ -986,8 +1107,8 @@ static int scroll_output_get_enabled(lua_State *L) {
 		lua_pushboolean(L, 0);
 		return 1;
 	}
-	struct sway_output *output = lua_touserdata(L, -1);
-	if (!output || output->node.type != N_OUTPUT) {
+	struct sway_output *output = handle_to_output(L, -1);
+	if (!output) {
 		lua_pushboolean(L, 0);
 		return 1;
 	}
@@ -1001,8 +1122,8 @@ static int scroll_output_get_name(lua_State *L) {
 		lua_pushnil(L);
 		return 1;
 	}
-	struct sway_output *output = lua_touserdata(L, -1);
-	if (!output || output->node.type != N_OUTPUT) {
+	struct sway_output *output = handle_to_output(L, -1);
+	if (!output) {
 		lua_pushnil(L);
 		return 1;
 	}
@@ -1016,8 +1137,8 @@ static int scroll_output_get_workspaces(lua_State *L) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
-	struct sway_output *output = lua_touserdata(L, -1);
-	if (!output || output->node.type != N_OUTPUT) {
+	struct sway_output *output = handle_to_output(L, -1);
+	if (!output) {
 		lua_createtable(L, 0, 0);
 		return 1;
 	}
@@ -1025,7 +1146,7 @@ static int scroll_output_get_workspaces(lua_State *L) {
 	lua_createtable(L, output->workspaces->length, 0);
 	for (int i = 0; i < output->workspaces->length; ++i) {
 		struct sway_workspace *workspace = output->workspaces->items[i];
-		lua_pushlightuserdata(L, workspace);
+		sway_lua_push_workspace(L, workspace);
 		lua_rawseti(L, -2, i + 1);
 	}
 	return 1;
@@ -1036,94 +1157,452 @@ static int scroll_root_get_outputs(lua_State *L) {
 	lua_createtable(L, root->outputs->length, 0);
 	for (int i = 0; i < root->outputs->length; ++i) {
 		struct sway_output *output = root->outputs->items[i];
-		lua_pushlightuserdata(L, output);
+		sway_lua_push_output(L, output);
 		lua_rawseti(L, -2, i + 1);
 	}
 	return 1;
 }
 
-// local id = scroll.add_callback(event, on_create, data)
-static int scroll_add_callback(lua_State *L) {
-	int argc = lua_gettop(L);
-	if (argc < 3) {
+// Batched queries: one call returns the requested fields of every container
+// of a workspace, an output or all outputs, instead of one call per field and
+// container.
+
+struct query_context {
+	struct sway_node *focus;
+};
+
+typedef void (*query_push_func_t)(lua_State *L, struct sway_container *con,
+	struct query_context *ctx);
+
+static void query_push_container(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	sway_lua_push_container(L, con);
+}
+
+static void query_push_view(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	sway_lua_push_view(L, con->view);
+}
+
+static void query_push_id(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushinteger(L, con->node.id);
+}
+
+static void query_push_parent(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	sway_lua_push_container(L, con->pending.parent);
+}
+
+static void query_push_workspace(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	sway_lua_push_workspace(L, con->pending.workspace);
+}
+
+static void query_push_app_id(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	if (con->view) {
+		lua_pushstring(L, view_get_app_id(con->view));
+	} else {
 		lua_pushnil(L);
-		return 1;
 	}
-	struct sway_lua_closure *closure = malloc(sizeof(struct sway_lua_closure));
-	closure->cb_data = luaL_ref(L, LUA_REGISTRYINDEX);
-	closure->cb_function = luaL_ref(L, LUA_REGISTRYINDEX);
-	const char *event = luaL_checkstring(L, 1);
-	if (strcmp(event, "view_map") == 0) {
-		list_add(config->lua.cbs_view_map, closure);
-	} else if (strcmp(event, "view_unmap") == 0) {
-		list_add(config->lua.cbs_view_unmap, closure);
-	} else if (strcmp(event, "view_urgent") == 0) {
-		list_add(config->lua.cbs_view_urgent, closure);
-	} else if (strcmp(event, "view_focus") == 0) {
-		list_add(config->lua.cbs_view_focus, closure);
-	} else if (strcmp(event, "workspace_create") == 0) {
-		list_add(config->lua.cbs_workspace_create, closure);
+}
+
+static void query_push_title(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	if (con->view) {
+		lua_pushstring(L, view_get_title(con->view));
 	} else {
-		free(closure);
 		lua_pushnil(L);
-		return 1;
 	}
-	lua_pushlightuserdata(L, closure);
-	return 1;
 }
 
-//scroll.remove_callback(id)
-static int scroll_remove_callback(lua_State *L) {
-	int argc = lua_gettop(L);
-	if (argc < 1) {
-		return 0;
+static void query_push_pid(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	if (con->view) {
+		lua_pushinteger(L, con->view->pid);
+	} else {
+		lua_pushnil(L);
 	}
-	struct sway_lua_closure *closure = lua_touserdata(L, 1);
-	for (int i = 0; i < config->lua.cbs_view_map->length; ++i) {
-		if (config->lua.cbs_view_map->items[i] == closure) {
-			list_del(config->lua.cbs_view_map, i);
-			luaL_unref(config->lua.state, LUA_REGISTRYINDEX, closure->cb_function);
-			luaL_unref(config->lua.state, LUA_REGISTRYINDEX, closure->cb_data);
-			free(closure);
-			return 0;
+}
+
+static void query_push_shell(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	if (con->view) {
+		lua_pushstring(L, view_get_shell(con->view));
+	} else {
+		lua_pushnil(L);
+	}
+}
+
+static void query_push_urgent(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushboolean(L, con->view && view_is_urgent(con->view));
+}
+
+static void query_push_focused(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushboolean(L, ctx->focus == &con->node);
+}
+
+static void query_push_marks(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_createtable(L, con->marks->length, 0);
+	for (int i = 0; i < con->marks->length; ++i) {
+		lua_pushstring(L, con->marks->items[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+}
+
+static void query_push_floating(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushboolean(L, container_is_floating(con));
+}
+
+static void query_push_sticky(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushboolean(L, con->is_sticky);
+}
+
+static void query_push_opacity(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushnumber(L, con->alpha);
+}
+
+static void query_push_x(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushnumber(L, con->pending.x);
+}
+
+static void query_push_y(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushnumber(L, con->pending.y);
+}
+
+static void query_push_width(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushnumber(L, con->pending.width);
+}
+
+static void query_push_height(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushnumber(L, con->pending.height);
+}
+
+static void query_push_width_fraction(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushnumber(L, con->width_fraction);
+}
+
+static void query_push_height_fraction(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushnumber(L, con->height_fraction);
+}
+
+static void query_push_fullscreen_mode(lua_State *L, struct sway_container *con,
+		struct query_context *ctx) {
+	lua_pushstring(L, fullscreen_mode_to_str(con->pending.fullscreen_mode));
+}
+
+static const struct {
+	const char *name;
+	query_push_func_t push;
+} query_fields[] = {
+	{ "container", query_push_container },
+	{ "view", query_push_view },
+	{ "id", query_push_id },
+	{ "parent", query_push_parent },
+	{ "workspace", query_push_workspace },
+	{ "app_id", query_push_app_id },
+	{ "title", query_push_title },
+	{ "pid", query_push_pid },
+	{ "shell", query_push_shell },
+	{ "urgent", query_push_urgent },
+	{ "focused", query_push_focused },
+	{ "marks", query_push_marks },
+	{ "floating", query_push_floating },
+	{ "sticky", query_push_sticky },
+	{ "opacity", query_push_opacity },
+	{ "x", query_push_x },
+	{ "y", query_push_y },
+	{ "width", query_push_width },
+	{ "height", query_push_height },
+	{ "width_fraction", query_push_width_fraction },
+	{ "height_fraction", query_push_height_fraction },
+	{ "fullscreen_mode", query_push_fullscreen_mode },
+};
+
+#define QUERY_FIELDS_MAX (sizeof(query_fields) / sizeof(query_fields[0]))
+
+struct query {
+	struct query_context ctx;
+	size_t fields[QUERY_FIELDS_MAX];
+	size_t nfields;
+	lua_Integer length;
+};
+
+static void query_add_container(lua_State *L, struct query *query,
+		struct sway_container *con) {
+	lua_createtable(L, 0, query->nfields);
+	for (size_t i = 0; i < query->nfields; ++i) {
+		size_t field = query->fields[i];
+		query_fields[field].push(L, con, &query->ctx);
+		lua_setfield(L, -2, query_fields[field].name);
+	}
+	lua_rawseti(L, -2, ++query->length);
+
+	if (con->pending.children) {
+		for (int i = 0; i < con->pending.children->length; ++i) {
+			query_add_container(L, query, con->pending.children->items[i]);
 		}
 	}
-	for (int i = 0; i < config->lua.cbs_view_unmap->length; ++i) {
-		if (config->lua.cbs_view_unmap->items[i] == closure) {
-			list_del(config->lua.cbs_view_unmap, i);
-			luaL_unref(config->lua.state, LUA_REGISTRYINDEX, closure->cb_function);
-			luaL_unref(config->lua.state, LUA_REGISTRYINDEX, closure->cb_data);
-			free(closure);
-			return 0;
+}
+
+static void query_add_workspace(lua_State *L, struct query *query,
+		struct sway_workspace *workspace) {
+	for (int i = 0; i < workspace->tiling->length; ++i) {
+		query_add_container(L, query, workspace->tiling->items[i]);
+	}
+	for (int i = 0; i < workspace->floating->length; ++i) {
+		query_add_container(L, query, workspace->floating->items[i]);
+	}
+}
+
+static void query_add_output(lua_State *L, struct query *query,
+		struct sway_output *output) {
+	for (int i = 0; i < output->workspaces->length; ++i) {
+		query_add_workspace(L, query, output->workspaces->items[i]);
+	}
+}
+
+// scroll.query(workspace|output|nil, { field, ... })
+static int scroll_query(lua_State *L) {
+	luaL_checktype(L, 2, LUA_TTABLE);
+	struct query query = {
+		.ctx.focus = get_focused_node(),
+	};
+	lua_Integer len = luaL_len(L, 2);
+	for (lua_Integer i = 1; i <= len; ++i) {
+		lua_rawgeti(L, 2, i);
+		const char *name = lua_tostring(L, -1);
+		size_t field = 0;
+		while (field < QUERY_FIELDS_MAX &&
+				(!name || strcmp(name, query_fields[field].name) != 0)) {
+			++field;
+		}
+		if (field == QUERY_FIELDS_MAX) {
+			return luaL_error(L, "scroll.query(): unknown field '%s'",
+				name ? name : "?");
+		}
+		lua_pop(L, 1);
+		if (query.nfields < QUERY_FIELDS_MAX) {
+			query.fields[query.nfields++] = field;
 		}
 	}
-	for (int i = 0; i < config->lua.cbs_view_urgent->length; ++i) {
-		if (config->lua.cbs_view_urgent->items[i] == closure) {
-			list_del(config->lua.cbs_view_urgent, i);
-			luaL_unref(config->lua.state, LUA_REGISTRYINDEX, closure->cb_function);
-			luaL_unref(config->lua.state, LUA_REGISTRYINDEX, closure->cb_data);
-			free(closure);
-			return 0;
+
+	struct sway_workspace *workspace = NULL;
+	struct sway_output *output = NULL;
+	if (!lua_isnil(L, 1)) {
+		workspace = handle_to_workspace(L, 1);
+		output = handle_to_output(L, 1);
+		if (!workspace && !output) {
+			return luaL_error(L, "scroll.query(): the workspace or output does not exist");
 		}
 	}
-	for (int i = 0; i < config->lua.cbs_view_focus->length; ++i) {
-		if (config->lua.cbs_view_focus->items[i] == closure) {
-			list_del(config->lua.cbs_view_focus, i);
-			luaL_unref(config->lua.state, LUA_REGISTRYINDEX, closure->cb_function);
-			luaL_unref(config->lua.state, LUA_REGISTRYINDEX, closure->cb_data);
-			free(closure);
-			return 0;
+
+	lua_checkstack(L, 2 * STACK_MIN);
+	lua_newtable(L);
+	if (lua_isnil(L, 1)) {
+		for (int i = 0; i < root->outputs->length; ++i) {
+			query_add_output(L, &query, root->outputs->items[i]);
 		}
+	} else if (workspace) {
+		query_add_workspace(L, &query, workspace);
+	} else if (output) {
+		query_add_output(L, &query, output);
+	}
+	return 1;
+}
+
+static const char *event_names[LUA_EVENT_COUNT] = {
+	[LUA_EVENT_VIEW_MAP] = "view_map",
+	[LUA_EVENT_VIEW_UNMAP] = "view_unmap",
+	[LUA_EVENT_VIEW_URGENT] = "view_urgent",
+	[LUA_EVENT_VIEW_FOCUS] = "view_focus",
+	[LUA_EVENT_WORKSPACE_CREATE] = "workspace_create",
+	[LUA_EVENT_WINDOW] = "window",
+	[LUA_EVENT_WORKSPACE] = "workspace",
+	[LUA_EVENT_OUTPUT] = "output",
+	[LUA_EVENT_MODE] = "mode",
+	[LUA_EVENT_BINDING] = "binding",
+	[LUA_EVENT_INPUT] = "input",
+	[LUA_EVENT_SCROLLER] = "scroller",
+	[LUA_EVENT_SHUTDOWN] = "shutdown",
+};
+
+void sway_lua_callbacks_init(struct sway_lua *lua) {
+	for (int i = 0; i < LUA_EVENT_COUNT; ++i) {
+		wl_list_init(&lua->callbacks[i]);
 	}
-	for (int i = 0; i < config->lua.cbs_workspace_create->length; ++i) {
-		if (config->lua.cbs_workspace_create->items[i] == closure) {
-			list_del(config->lua.cbs_workspace_create, i);
-			luaL_unref(config->lua.state, LUA_REGISTRYINDEX, closure->cb_function);
-			luaL_unref(config->lua.state, LUA_REGISTRYINDEX, closure->cb_data);
+	lua->dispatching = 0;
+	lua->sweep = false;
+}
+
+void sway_lua_callbacks_finish(struct sway_lua *lua) {
+	// The registry references go away with the Lua state
+	for (int i = 0; i < LUA_EVENT_COUNT; ++i) {
+		struct sway_lua_closure *closure, *tmp;
+		wl_list_for_each_safe(closure, tmp, &lua->callbacks[i], link) {
+			wl_list_remove(&closure->link);
+			sway_lua_handle_release(closure->handle);
 			free(closure);
-			return 0;
 		}
 	}
+}
+
+static void closure_remove(struct sway_lua *lua, struct sway_lua_closure *closure) {
+	luaL_unref(lua->state, LUA_REGISTRYINDEX, closure->cb_function);
+	luaL_unref(lua->state, LUA_REGISTRYINDEX, closure->cb_data);
+	sway_lua_handle_release(closure->handle);
+	closure->handle = 0;
+	if (lua->dispatching) {
+		// The dispatch loop may be holding it, unlink it once it is done
+		closure->removed = true;
+		lua->sweep = true;
+		return;
+	}
+	wl_list_remove(&closure->link);
+	free(closure);
+}
+
+static void sweep_callbacks(struct sway_lua *lua) {
+	for (int i = 0; i < LUA_EVENT_COUNT; ++i) {
+		struct sway_lua_closure *closure, *tmp;
+		wl_list_for_each_safe(closure, tmp, &lua->callbacks[i], link) {
+			if (closure->removed) {
+				wl_list_remove(&closure->link);
+				free(closure);
+			}
+		}
+	}
+	lua->sweep = false;
+}
+
+static bool has_callbacks(enum sway_lua_event event) {
+	return config && config->lua.state &&
+		!wl_list_empty(&config->lua.callbacks[event]);
+}
+
+static void dispatch(enum sway_lua_event event, uint64_t handle,
+		const char *string, const char *change) {
+	struct sway_lua *lua = &config->lua;
+	lua_State *L = lua->state;
+	struct wl_list *list = &lua->callbacks[event];
+	// Callbacks added while dispatching only run on the next event
+	struct wl_list *last = list->prev;
+	++lua->dispatching;
+	for (struct wl_list *link = list->next; link != list; link = link->next) {
+		struct sway_lua_closure *closure =
+			wl_container_of(link, closure, link);
+		if (!closure->removed) {
+			lua_rawgeti(L, LUA_REGISTRYINDEX, closure->cb_function);
+			if (string) {
+				lua_pushstring(L, string);
+			} else {
+				push_handle(L, handle);
+			}
+			int nargs = 2;
+			if (change) {
+				lua_pushstring(L, change);
+				++nargs;
+			}
+			lua_rawgeti(L, LUA_REGISTRYINDEX, closure->cb_data);
+			if (lua_pcall(L, nargs, 0, 0) != LUA_OK) {
+				sway_log(SWAY_ERROR, "Lua %s callback failed: %s",
+					event_names[event], lua_tostring(L, -1));
+				lua_pop(L, 1);
+			}
+		}
+		if (link == last) {
+			break;
+		}
+	}
+	if (--lua->dispatching == 0 && lua->sweep) {
+		sweep_callbacks(lua);
+	}
+}
+
+void sway_lua_event_view(enum sway_lua_event event, struct sway_view *view) {
+	if (has_callbacks(event)) {
+		dispatch(event, view ? view->lua_handle : 0, NULL, NULL);
+	}
+}
+
+void sway_lua_event_container(enum sway_lua_event event,
+		struct sway_container *container, const char *change) {
+	if (has_callbacks(event)) {
+		dispatch(event, container ? container->node.lua_handle : 0, NULL,
+			change);
+	}
+}
+
+void sway_lua_event_workspace(enum sway_lua_event event,
+		struct sway_workspace *workspace, const char *change) {
+	if (has_callbacks(event)) {
+		dispatch(event, workspace ? workspace->node.lua_handle : 0, NULL,
+			change);
+	}
+}
+
+void sway_lua_event_string(enum sway_lua_event event, const char *object,
+		const char *change) {
+	if (has_callbacks(event)) {
+		dispatch(event, 0, object, change);
+	}
+}
+
+// local id = scroll.add_callback(event, on_create, data)
+static int scroll_add_callback(lua_State *L) {
+	int argc = lua_gettop(L);
+	if (argc < 3) {
+		lua_pushnil(L);
+		return 1;
+	}
+	const char *name = luaL_checkstring(L, 1);
+	int event = 0;
+	while (event < LUA_EVENT_COUNT && strcmp(name, event_names[event]) != 0) {
+		++event;
+	}
+	if (event == LUA_EVENT_COUNT) {
+		lua_pushnil(L);
+		return 1;
+	}
+	struct sway_lua_closure *closure = calloc(1, sizeof(struct sway_lua_closure));
+	if (!closure) {
+		lua_pushnil(L);
+		return 1;
+	}
+	closure->handle = sway_lua_handle_create(LUA_HANDLE_CALLBACK, closure);
+	if (!closure->handle) {
+		free(closure);
+		lua_pushnil(L);
+		return 1;
+	}
+	lua_settop(L, 3);
+	closure->cb_data = luaL_ref(L, LUA_REGISTRYINDEX);
+	closure->cb_function = luaL_ref(L, LUA_REGISTRYINDEX);
+	wl_list_insert(config->lua.callbacks[event].prev, &closure->link);
+	push_handle(L, closure->handle);
+	return 1;
+}
+
+//scroll.remove_callback(id)
+static int scroll_remove_callback(lua_State *L) {
+	struct sway_lua_slot *slot = handle_to_slot(L, 1);
+	if (!slot || slot->type != LUA_HANDLE_CALLBACK) {
+		return 0;
+	}
+	closure_remove(&config->lua, slot->object);
 	return 0;
 }
 
@@ -1177,6 +1656,7 @@ static luaL_Reg const scroll_lib[] = {
 	{ "output_get_workspaces", scroll_output_get_workspaces },
 	{ "root_get_outputs", scroll_root_get_outputs },
 	{ "scratchpad_get_containers", scroll_scratchpad_get_containers },
+	{ "query", scroll_query },
 	{ "add_callback", scroll_add_callback },
 	{ "remove_callback", scroll_remove_callback },
 	{ NULL, NULL }
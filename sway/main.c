@@ -17,6 +17,7 @@
 #include "sway/commands.h"
 #include "sway/config.h"
 #include "sway/server.h"
+#include "sway/recorder.h"
 #include "sway/swaynag.h"
 #include "sway/desktop/transaction.h"
 #include "sway/tree/root.h"
@@ -189,6 +190,9 @@ void enable_debug_flag(const char *flag) {
 		debug.txn_timings = true;
 	} else if (has_prefix(flag, "txn-timeout=")) {
 		server.txn_timeout_ms = atoi(&flag[strlen("txn-timeout=")]);
+	} else if (has_prefix(flag, "record=")) {
+		free(debug.record_path);
+		debug.record_path = strdup(&flag[strlen("record=")]);
 	} else {
 		sway_log(SWAY_ERROR, "Unknown debug flag: %s", flag);
 	}
@@ -368,6 +372,10 @@ int main(int argc, char **argv) {
 
 	ipc_init(&server);
 
+	if (debug.record_path) {
+		recorder_init(debug.record_path);
+	}
+
 	setenv("WAYLAND_DISPLAY", server.socket, true);
 	if (!load_main_config(config_path, false, false)) {
 		sway_terminate(EXIT_FAILURE);
@@ -397,6 +405,9 @@ int main(int argc, char **argv) {
 shutdown:
 	sway_log(SWAY_INFO, "Shutting down scroll");
 
+	recorder_finish();
+	free(debug.record_path);
+
 	server_fini(&server);
 	root_destroy(root);
 	root = NULL;
@@ -0,0 +1,86 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "log.h"
+#include "util.h"
+#include "sway/recorder.h"
+#include "sway/tree/container.h"
+#include "sway/tree/view.h"
+
+static FILE *record_file = NULL;
+static struct timespec record_start;
+
+bool recorder_init(const char *path) {
+	record_file = fopen(path, "w");
+	if (!record_file) {
+		sway_log_errno(SWAY_ERROR, "Unable to open recording file %s", path);
+		return false;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &record_start);
+	fprintf(record_file, "# scroll recording v1\n");
+	fflush(record_file);
+	sway_log(SWAY_INFO, "Recording IPC commands and views to %s", path);
+	return true;
+}
+
+void recorder_finish(void) {
+	if (record_file) {
+		fclose(record_file);
+		record_file = NULL;
+	}
+}
+
+static void record_begin(const char *event) {
+	struct timespec now, diff;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	timespec_sub(&diff, &now, &record_start);
+	fprintf(record_file, "%" PRId64 "\t%s", timespec_to_msec(&diff), event);
+}
+
+static void record_field(const char *value) {
+	fputc('\t', record_file);
+	for (const char *c = value ? value : ""; *c; ++c) {
+		fputc(*c == '\t' || *c == '\n' ? ' ' : *c, record_file);
+	}
+}
+
+static void record_end(void) {
+	fputc('\n', record_file);
+	// Flush every event so the recording survives a crash, which is often
+	// exactly the session one wants to replay
+	fflush(record_file);
+}
+
+void recorder_command(const char *command) {
+	if (!record_file) {
+		return;
+	}
+	record_begin("command");
+	record_field(command);
+	record_end();
+}
+
+void recorder_view_map(struct sway_view *view) {
+	if (!record_file) {
+		return;
+	}
+	char id[16];
+	snprintf(id, sizeof(id), "%zu", view->container->node.id);
+	record_begin("map");
+	record_field(id);
+	record_field(view_get_app_id(view));
+	record_field(view_get_title(view));
+	record_end();
+}
+
+void recorder_view_unmap(struct sway_view *view) {
+	if (!record_file || !view->container) {
+		return;
+	}
+	char id[16];
+	snprintf(id, sizeof(id), "%zu", view->container->node.id);
+	record_begin("unmap");
+	record_field(id);
+	record_end();
+}
@@ -52,11 +52,14 @@
 #include "config.h"
 #include "list.h"
 #include "log.h"
+#include "sway/commands.h"
 #include "sway/config.h"
 #include "sway/desktop/idle_inhibit_v1.h"
+#include "sway/desktop/stats.h"
 #include "sway/input/input-manager.h"
 #include "sway/output.h"
 #include "sway/server.h"
+#include "sway/sway_text_node.h"
 #include "sway/input/cursor.h"
 #include "sway/tree/root.h"
 
@@ -460,6 +463,8 @@ bool server_init(struct sway_server *server) {
 	}
 
 	server->dirty_nodes = create_list();
+	wl_signal_init(&server->events.transaction_applied);
+	stats_init();
 
 	server->input = input_manager_create(server);
 	input_manager_get_default_seat(); // create seat0
@@ -468,6 +473,9 @@ bool server_init(struct sway_server *server) {
 }
 
 void server_fini(struct sway_server *server) {
+	reload_cancel();
+	sway_text_node_finish();
+
 	// remove listeners
 	wl_list_remove(&server->renderer_lost.link);
 	wl_list_remove(&server->new_output.link);
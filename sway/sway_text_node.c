@@ -1,14 +1,22 @@
 #include <drm_fourcc.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <wlr/render/wlr_renderer.h>
+#include <wlr/render/wlr_texture.h>
 #include <wlr/types/wlr_buffer.h>
 #include <wlr/interfaces/wlr_buffer.h>
 #include "cairo_util.h"
+#include "list.h"
 #include "log.h"
 #include "pango.h"
 #include "sway/config.h"
+#include "sway/output.h"
+#include "sway/server.h"
 #include "sway/sway_text_node.h"
+#include "sway/tree/root.h"
+#include "unicode.h"
 
 struct cairo_buffer {
 	struct wlr_buffer base;
@@ -53,10 +61,25 @@ struct text_buffer {
 	double content_scale;
 	enum wl_output_subpixel subpixel;
 
+	// Pixels per unit of the current backing buffer, 0 if there is none
+	double rendered_scale;
+	int rendered_width, rendered_height;
+	struct wl_list stale_link; // stale_buffers
+
 	struct wl_listener outputs_update;
 	struct wl_listener destroy;
 };
 
+// While the content scale keeps changing (animations, overview gestures), the
+// existing backing buffer is stretched by the GPU. It is rasterised again at
+// the final scale once no scale change happened for this long.
+#define TEXT_SETTLE_MS 100
+// Text wider than this many pixels is only rendered up to max_width
+#define TEXT_MAX_BUFFER_WIDTH 4096
+
+static struct wl_list stale_buffers;
+static struct wl_event_source *settle_timer = NULL;
+
 static int get_text_width(struct sway_text_node *props) {
 	int width = props->width;
 	if (props->max_width >= 0) {
@@ -65,18 +88,51 @@ static int get_text_width(struct sway_text_node *props) {
 	return MAX(width, 0);
 }
 
+// Places the backing buffer: the full text is rendered, max_width only crops it
+static void update_geometry(struct text_buffer *buffer) {
+	double width = get_text_width(&buffer->props) * buffer->content_scale;
+	double height = buffer->props.height * buffer->content_scale;
+	sway_scene_buffer_set_dest_size(buffer->buffer_node, width, height);
+	if (buffer->rendered_scale <= 0) {
+		return;
+	}
+
+	struct wlr_fbox src = {
+		.width = MIN(get_text_width(&buffer->props) * buffer->rendered_scale,
+			buffer->rendered_width),
+		.height = MIN(buffer->props.height * buffer->rendered_scale,
+			buffer->rendered_height),
+	};
+	sway_scene_buffer_set_source_box(buffer->buffer_node, &src);
+
+	pixman_region32_t opaque;
+	pixman_region32_init(&opaque);
+	if (buffer->props.background[3] == 1) {
+		pixman_region32_union_rect(&opaque, &opaque, 0, 0, width, height);
+	}
+	sway_scene_buffer_set_opaque_region(buffer->buffer_node, &opaque);
+	pixman_region32_fini(&opaque);
+}
+
 static void render_backing_buffer(struct text_buffer *buffer) {
 	if (!buffer->visible) {
 		return;
 	}
 
+	wl_list_remove(&buffer->stale_link);
+	wl_list_init(&buffer->stale_link);
+
 	if (buffer->props.max_width == 0) {
 		sway_scene_buffer_set_buffer(buffer->buffer_node, NULL);
+		buffer->rendered_scale = 0;
 		return;
 	}
 
 	double scale = buffer->scale * buffer->content_scale;
-	int width = ceil(get_text_width(&buffer->props) * scale);
+	int width = ceil(MAX(buffer->props.width, 1) * scale);
+	if (width > TEXT_MAX_BUFFER_WIDTH) {
+		width = ceil(MAX(get_text_width(&buffer->props), 1) * scale);
+	}
 	int height = ceil(buffer->props.height * scale);
 	float *color = (float *)&buffer->props.color;
 	float *background = (float *)&buffer->props.background;
@@ -137,20 +193,56 @@ static void render_backing_buffer(struct text_buffer *buffer) {
 	sway_scene_buffer_set_buffer(buffer->buffer_node, &cairo_buffer->base);
 	wlr_buffer_drop(&cairo_buffer->base);
 
-	pixman_region32_t opaque;
-	pixman_region32_init(&opaque);
-	if (background[3] == 1) {
-		pixman_region32_union_rect(&opaque, &opaque, 0, 0,
-			get_text_width(&buffer->props), buffer->props.height);
-	}
-	sway_scene_buffer_set_opaque_region(buffer->buffer_node, &opaque);
-	pixman_region32_fini(&opaque);
+	buffer->rendered_scale = scale;
+	buffer->rendered_width = width;
+	buffer->rendered_height = height;
+	update_geometry(buffer);
 
 err:
 	if (pango) g_object_unref(pango);
 	cairo_font_options_destroy(fo);
 }
 
+static int handle_settle_timer(void *data) {
+	struct text_buffer *buffer, *tmp;
+	wl_list_for_each_safe(buffer, tmp, &stale_buffers, stale_link) {
+		render_backing_buffer(buffer);
+		// Invisible buffers are rendered when they show up again
+		wl_list_remove(&buffer->stale_link);
+		wl_list_init(&buffer->stale_link);
+	}
+	return 0;
+}
+
+static void schedule_render(struct text_buffer *buffer) {
+	if (!settle_timer) {
+		wl_list_init(&stale_buffers);
+		settle_timer = wl_event_loop_add_timer(server.wl_event_loop,
+			handle_settle_timer, NULL);
+		if (!settle_timer) {
+			sway_log_errno(SWAY_ERROR, "Unable to create text settle timer");
+			render_backing_buffer(buffer);
+			return;
+		}
+	}
+	wl_list_remove(&buffer->stale_link);
+	wl_list_insert(&stale_buffers, &buffer->stale_link);
+	wl_event_source_timer_update(settle_timer, TEXT_SETTLE_MS);
+}
+
+void sway_text_node_finish(void) {
+	if (!settle_timer) {
+		return;
+	}
+	struct text_buffer *buffer, *tmp;
+	wl_list_for_each_safe(buffer, tmp, &stale_buffers, stale_link) {
+		wl_list_remove(&buffer->stale_link);
+		wl_list_init(&buffer->stale_link);
+	}
+	wl_event_source_remove(settle_timer);
+	settle_timer = NULL;
+}
+
 static void handle_outputs_update(struct wl_listener *listener, void *data) {
 	struct text_buffer *buffer = wl_container_of(listener, buffer, outputs_update);
 	struct sway_scene_outputs_update_event *event = data;
@@ -191,6 +283,7 @@ static void handle_destroy(struct wl_listener *listener, void *data) {
 
 	wl_list_remove(&buffer->outputs_update.link);
 	wl_list_remove(&buffer->destroy.link);
+	wl_list_remove(&buffer->stale_link);
 
 	free(buffer->text);
 	free(buffer);
@@ -210,8 +303,7 @@ static void text_calc_size(struct text_buffer *buffer) {
 		&props->baseline, 1, props->pango_markup, "%s", buffer->text);
 	cairo_destroy(c);
 
-	sway_scene_buffer_set_dest_size(buffer->buffer_node,
-		get_text_width(props), props->height);
+	update_geometry(buffer);
 }
 
 struct sway_text_node *sway_text_node_create(struct sway_scene_tree *parent,
@@ -247,6 +339,7 @@ struct sway_text_node *sway_text_node_create(struct sway_scene_tree *parent,
 	wl_signal_add(&node->events.outputs_update, &buffer->outputs_update);
 
 	buffer->content_scale = 1.0;
+	wl_list_init(&buffer->stale_link);
 
 	text_calc_size(buffer);
 
@@ -287,10 +380,15 @@ void sway_text_node_set_max_width(struct sway_text_node *node, int max_width) {
 	if (max_width == buffer->props.max_width) {
 		return;
 	}
+	bool was_empty = buffer->props.max_width == 0;
 	buffer->props.max_width = max_width;
-	sway_scene_buffer_set_dest_size(buffer->buffer_node,
-		get_text_width(&buffer->props), buffer->props.height);
-	render_backing_buffer(buffer);
+	update_geometry(buffer);
+	// The backing buffer holds the whole text, so other widths only crop it
+	if (max_width == 0 || was_empty || buffer->rendered_scale <= 0 ||
+			get_text_width(&buffer->props) * buffer->rendered_scale >
+			buffer->rendered_width + 1) {
+		render_backing_buffer(buffer);
+	}
 }
 
 void sway_text_node_set_background(struct sway_text_node *node, float background[4]) {
@@ -304,9 +402,399 @@ void sway_text_node_set_background(struct sway_text_node *node, float background
 
 void sway_text_node_scale(struct sway_text_node *node, double scale) {
 	struct text_buffer *buffer = wl_container_of(node, buffer, props);
+	if (scale == buffer->content_scale) {
+		return;
+	}
 	buffer->content_scale = scale;
-	sway_scene_buffer_set_dest_size(buffer->buffer_node,
-		get_text_width(&buffer->props) * scale, buffer->props.height * scale);
-	render_backing_buffer(buffer);
+	update_geometry(buffer);
+	if (buffer->rendered_scale <= 0) {
+		render_backing_buffer(buffer);
+	} else {
+		schedule_render(buffer);
+	}
+}
+
+
+// Height of the atlas glyphs in logical pixels. Labels are usually drawn much
+// larger than the font, so they are rasterised big and scaled down.
+#define LABEL_ATLAS_HEIGHT 256
+#define LABEL_ATLAS_MAX_WIDTH 4096
+// Transparent gap between glyphs, so linear filtering does not bleed
+#define LABEL_ATLAS_PADDING 2
+
+struct label_glyph {
+	uint32_t codepoint;
+	struct wlr_fbox box; // in texture pixels
+	int width;
+	int baseline;
+};
+
+struct label_atlas {
+	float output_scale;
+	int height;
+	int refs; // the atlas list and every label using it
+	struct wlr_texture *texture;
+	struct label_glyph *glyphs; // one per label key
+	size_t glyphs_len;
+
+	struct wl_listener renderer_destroy;
+};
+
+static list_t *label_atlases = NULL;
+
+static void label_atlas_unref(struct label_atlas *atlas) {
+	if (--atlas->refs > 0) {
+		return;
+	}
+	wl_list_remove(&atlas->renderer_destroy.link);
+	wlr_texture_destroy(atlas->texture);
+	free(atlas->glyphs);
+	free(atlas);
+}
+
+static struct label_glyph *label_atlas_find(struct label_atlas *atlas,
+		uint32_t codepoint) {
+	for (size_t i = 0; i < atlas->glyphs_len; ++i) {
+		if (atlas->glyphs[i].codepoint == codepoint) {
+			return &atlas->glyphs[i];
+		}
+	}
+	return NULL;
+}
+
+static void label_atlas_remove(struct label_atlas *atlas) {
+	int index = list_find(label_atlases, atlas);
+	if (index >= 0) {
+		list_del(label_atlases, index);
+		label_atlas_unref(atlas);
+	}
+}
+
+static void label_atlas_handle_renderer_destroy(struct wl_listener *listener,
+		void *data) {
+	struct label_atlas *atlas = wl_container_of(listener, atlas, renderer_destroy);
+	wl_list_remove(&atlas->renderer_destroy.link);
+	wl_list_init(&atlas->renderer_destroy.link);
+	wlr_texture_destroy(atlas->texture);
+	atlas->texture = NULL;
+	label_atlas_remove(atlas);
+}
+
+static struct label_atlas *label_atlas_create(float output_scale) {
+	const char *keys = config->jump_labels_keys;
+	if (!server.renderer || !keys || !*keys || config->font_height <= 0) {
+		return NULL;
+	}
+
+	struct label_atlas *atlas = calloc(1, sizeof(*atlas));
+	if (!atlas) {
+		sway_log(SWAY_ERROR, "label_atlas allocation failed");
+		return NULL;
+	}
+	atlas->output_scale = output_scale;
+	atlas->height = config->font_height;
+	atlas->refs = 1;
+	wl_list_init(&atlas->renderer_destroy.link);
+	// Every key takes at least a byte
+	atlas->glyphs = calloc(strlen(keys), sizeof(*atlas->glyphs));
+	if (!atlas->glyphs) {
+		sway_log(SWAY_ERROR, "label_atlas allocation failed");
+		free(atlas);
+		return NULL;
+	}
+
+	cairo_t *c = cairo_create(NULL);
+	if (!c) {
+		sway_log(SWAY_ERROR, "cairo_t allocation failed");
+		free(atlas->glyphs);
+		free(atlas);
+		return NULL;
+	}
+	cairo_set_antialias(c, CAIRO_ANTIALIAS_BEST);
+
+	// Lay the glyphs out in rows, measuring them at the font size
+	double scale = output_scale * LABEL_ATLAS_HEIGHT / config->font_height;
+	int row_height = ceil(config->font_height * scale) + LABEL_ATLAS_PADDING;
+	int x = 0, y = 0, width = 0;
+	for (const char *key = keys; *key;) {
+		const char *start = key;
+		uint32_t codepoint = utf8_decode(&key);
+		if (codepoint == UTF8_INVALID ||
+				label_atlas_find(atlas, codepoint)) {
+			continue;
+		}
+		int glyph_width = 0, baseline = 0;
+		get_text_size(c, config->font_description, &glyph_width, NULL,
+			&baseline, 1, false, "%.*s", (int)(key - start), start);
+		if (glyph_width <= 0) {
+			continue;
+		}
+		int pixels = ceil(glyph_width * scale);
+		if (x > 0 && x + pixels > LABEL_ATLAS_MAX_WIDTH) {
+			x = 0;
+			y += row_height;
+		}
+		atlas->glyphs[atlas->glyphs_len++] = (struct label_glyph){
+			.codepoint = codepoint,
+			.box = {
+				.x = x,
+				.y = y,
+				.width = pixels,
+				.height = row_height - LABEL_ATLAS_PADDING,
+			},
+			.width = glyph_width,
+			.baseline = baseline,
+		};
+		x += pixels + LABEL_ATLAS_PADDING;
+		width = MAX(width, x);
+	}
+	cairo_destroy(c);
+	int height = y + row_height;
+	if (width == 0) {
+		free(atlas->glyphs);
+		free(atlas);
+		return NULL;
+	}
+
+	cairo_surface_t *surface = cairo_image_surface_create(
+			CAIRO_FORMAT_ARGB32, width, height);
+	cairo_status_t status = cairo_surface_status(surface);
+	if (status != CAIRO_STATUS_SUCCESS) {
+		sway_log(SWAY_ERROR, "cairo_image_surface_create failed: %s",
+			cairo_status_to_string(status));
+		cairo_surface_destroy(surface);
+		free(atlas->glyphs);
+		free(atlas);
+		return NULL;
+	}
+
+	// Glyphs are scaled when drawn, so subpixel antialiasing would not survive
+	cairo_font_options_t *fo = cairo_font_options_create();
+	cairo_font_options_set_hint_style(fo, CAIRO_HINT_STYLE_FULL);
+	cairo_font_options_set_antialias(fo, CAIRO_ANTIALIAS_GRAY);
+	cairo_t *cairo = cairo_create(surface);
+	cairo_set_antialias(cairo, CAIRO_ANTIALIAS_BEST);
+	cairo_set_font_options(cairo, fo);
+	float *color = config->jump_labels_color;
+	cairo_set_source_rgba(cairo, color[0], color[1], color[2], color[3]);
+	for (size_t i = 0; i < atlas->glyphs_len; ++i) {
+		struct label_glyph *glyph = &atlas->glyphs[i];
+		char text[UTF8_MAX_SIZE + 1] = {0};
+		utf8_encode(text, glyph->codepoint);
+		cairo_move_to(cairo, glyph->box.x,
+			glyph->box.y + (config->font_baseline - glyph->baseline) * scale);
+		render_text(cairo, config->font_description, scale, false, "%s", text);
+	}
+	cairo_surface_flush(surface);
+	cairo_destroy(cairo);
+	cairo_font_options_destroy(fo);
+
+	atlas->texture = wlr_texture_from_pixels(server.renderer,
+		DRM_FORMAT_ARGB8888, cairo_image_surface_get_stride(surface),
+		width, height, cairo_image_surface_get_data(surface));
+	cairo_surface_destroy(surface);
+	if (!atlas->texture) {
+		sway_log(SWAY_ERROR, "Unable to upload jump label atlas");
+		free(atlas->glyphs);
+		free(atlas);
+		return NULL;
+	}
+	atlas->renderer_destroy.notify = label_atlas_handle_renderer_destroy;
+	wl_signal_add(&server.renderer->events.destroy, &atlas->renderer_destroy);
+
+	sway_log(SWAY_DEBUG, "Rendered %dx%d jump label atlas for scale %f",
+		width, height, output_scale);
+	return atlas;
+}
+
+static struct label_atlas *label_atlas_get(float output_scale) {
+	if (!label_atlases) {
+		label_atlases = create_list();
+	}
+	for (int i = 0; i < label_atlases->length; ++i) {
+		struct label_atlas *atlas = label_atlases->items[i];
+		if (atlas->output_scale == output_scale) {
+			return atlas;
+		}
+	}
+	struct label_atlas *atlas = label_atlas_create(output_scale);
+	if (atlas) {
+		list_add(label_atlases, atlas);
+	}
+	return atlas;
+}
+
+void sway_label_atlas_prepare(float output_scale) {
+	label_atlas_get(output_scale);
+}
+
+void sway_label_atlas_rebuild(void) {
+	if (label_atlases) {
+		while (label_atlases->length) {
+			label_atlas_remove(label_atlases->items[label_atlases->length - 1]);
+		}
+	}
+	if (!root) {
+		return;
+	}
+	for (int i = 0; i < root->outputs->length; ++i) {
+		struct sway_output *output = root->outputs->items[i];
+		if (output->enabled) {
+			label_atlas_get(output->wlr_output->scale);
+		}
+	}
+}
+
+struct label_node {
+	struct sway_label_node props;
+	struct sway_scene_tree *tree;
+	struct sway_scene_rect *background;
+	struct label_atlas *atlas;
+	float output_scale;
+	double scale;
+
+	struct sway_scene_buffer **glyphs;
+	int *advances;
+	size_t glyphs_len;
+
+	struct wl_listener destroy;
+};
+
+static void label_node_clear(struct label_node *label) {
+	for (size_t i = 0; i < label->glyphs_len; ++i) {
+		sway_scene_node_destroy(&label->glyphs[i]->node);
+	}
+	free(label->glyphs);
+	free(label->advances);
+	label->glyphs = NULL;
+	label->advances = NULL;
+	label->glyphs_len = 0;
+}
+
+static void label_node_layout(struct label_node *label) {
+	double scale = label->scale;
+	int x = 0;
+	for (size_t i = 0; i < label->glyphs_len; ++i) {
+		int left = round(x * scale);
+		x += label->advances[i];
+		sway_scene_node_set_position(&label->glyphs[i]->node, left, 0);
+		sway_scene_buffer_set_dest_size(label->glyphs[i],
+			round(x * scale) - left, label->props.height * scale);
+	}
+	sway_scene_rect_set_size(label->background,
+		label->props.width * scale, label->props.height * scale);
+}
+
+static void label_node_update_background(struct label_node *label) {
+	// scene rect wants premultiplied colors
+	float *background = config->jump_labels_background;
+	const float premultiplied[] = {
+		background[0] * background[3],
+		background[1] * background[3],
+		background[2] * background[3],
+		background[3],
+	};
+	sway_scene_rect_set_color(label->background, premultiplied);
+	sway_scene_node_set_enabled(&label->background->node, background[3] > 0);
 }
 
+static void label_node_handle_destroy(struct wl_listener *listener, void *data) {
+	struct label_node *label = wl_container_of(listener, label, destroy);
+
+	wl_list_remove(&label->destroy.link);
+	// The glyph nodes are children of the tree and go away with it
+	free(label->glyphs);
+	free(label->advances);
+	if (label->atlas) {
+		label_atlas_unref(label->atlas);
+	}
+	free(label);
+}
+
+void sway_label_node_set_text(struct sway_label_node *node, const char *text) {
+	struct label_node *label = wl_container_of(node, label, props);
+	label_node_clear(label);
+	label_node_update_background(label);
+
+	// Pick up an atlas rendered since, e.g. after jump_labels_color changed
+	struct label_atlas *atlas = label_atlas_get(label->output_scale);
+	if (atlas != label->atlas) {
+		if (label->atlas) {
+			label_atlas_unref(label->atlas);
+		}
+		label->atlas = atlas;
+		if (atlas) {
+			++atlas->refs;
+		}
+	}
+
+	label->props.width = 0;
+	label->props.height = atlas ? atlas->height : config->font_height;
+	size_t len = strlen(text);
+	label->glyphs = calloc(len, sizeof(*label->glyphs));
+	label->advances = calloc(len, sizeof(*label->advances));
+	if (!atlas || !label->glyphs || !label->advances) {
+		label_node_clear(label);
+		label_node_layout(label);
+		return;
+	}
+
+	for (const char *c = text; *c;) {
+		struct label_glyph *atlas_glyph = label_atlas_find(atlas, utf8_decode(&c));
+		if (!atlas_glyph) {
+			continue;
+		}
+		struct sway_scene_buffer *glyph =
+			sway_scene_buffer_create(label->tree, NULL);
+		if (!glyph) {
+			continue;
+		}
+		sway_scene_buffer_set_texture(glyph, atlas->texture);
+		sway_scene_buffer_set_source_box(glyph, &atlas_glyph->box);
+		label->glyphs[label->glyphs_len] = glyph;
+		label->advances[label->glyphs_len] = atlas_glyph->width;
+		label->props.width += atlas_glyph->width;
+		++label->glyphs_len;
+	}
+	label_node_layout(label);
+}
+
+struct sway_label_node *sway_label_node_create(struct sway_scene_tree *parent,
+		const char *text, float output_scale) {
+	struct label_node *label = calloc(1, sizeof(*label));
+	if (!label) {
+		return NULL;
+	}
+
+	label->tree = sway_scene_tree_create(parent);
+	if (!label->tree) {
+		free(label);
+		return NULL;
+	}
+	label->background = sway_scene_rect_create(label->tree, 0, 0,
+		(float[4]){0, 0, 0, 0});
+	if (!label->background) {
+		sway_scene_node_destroy(&label->tree->node);
+		free(label);
+		return NULL;
+	}
+
+	label->props.node = &label->tree->node;
+	label->output_scale = output_scale;
+	label->scale = 1.0;
+
+	label->destroy.notify = label_node_handle_destroy;
+	wl_signal_add(&label->tree->node.events.destroy, &label->destroy);
+
+	sway_label_node_set_text(&label->props, text);
+	return &label->props;
+}
+
+void sway_label_node_scale(struct sway_label_node *node, double scale) {
+	struct label_node *label = wl_container_of(node, label, props);
+	if (scale == label->scale) {
+		return;
+	}
+	label->scale = scale;
+	label_node_layout(label);
+}
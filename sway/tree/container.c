@@ -64,22 +64,20 @@ static bool handle_point_accepts_input(
 	return false;
 }
 
-static struct sway_scene_rect *alloc_rect_node(struct sway_scene_tree *parent,
-		bool *failed) {
+static struct sway_scene_decoration *alloc_decoration_node(
+		struct sway_scene_tree *parent, bool *failed) {
 	if (*failed) {
 		return NULL;
 	}
 
-	// just pass in random values. These will be overwritten when
-	// they need to be used.
-	struct sway_scene_rect *rect = sway_scene_rect_create(
-		parent, 0, 0, (float[4]){0.f, 0.f, 0.f, 1.f});
-	if (!rect) {
-		sway_log(SWAY_ERROR, "Failed to allocate a sway_scene_rect");
+	struct sway_scene_decoration *decoration =
+		sway_scene_decoration_create(parent);
+	if (!decoration) {
+		sway_log(SWAY_ERROR, "Failed to allocate a sway_scene_decoration");
 		*failed = true;
 	}
 
-	return rect;
+	return decoration;
 }
 
 struct sway_container *container_create(struct sway_view *view) {
@@ -93,12 +91,11 @@ struct sway_container *container_create(struct sway_view *view) {
 	// Container tree structure
 	// - scene tree
 	//   - title bar
-	//     - border
-	//     - background
+	//     - decoration (border and background)
 	//     - title text
 	//     - marks text
 	//   - border
-	//     - border top/bottom/left/right
+	//     - decoration (border top/bottom/left/right)
 	//     - content_tree (we put the content node here so when we disable the
 	//       border everything gets disabled. We only render the content iff there
 	//       is a border as well)
@@ -109,33 +106,24 @@ struct sway_container *container_create(struct sway_view *view) {
 	c->scene_tree = alloc_scene_tree(root->staging, &failed);
 
 	c->title_bar.tree = alloc_scene_tree(c->scene_tree, &failed);
-	c->title_bar.border = alloc_scene_tree(c->title_bar.tree, &failed);
-	c->title_bar.background = alloc_scene_tree(c->title_bar.tree, &failed);
-
-	// for opacity purposes we need to carfully create the scene such that
-	// none of our rect nodes as well as text buffers don't overlap. To do
-	// this we have to create rects such that they go around text buffers
-	for (int i = 0; i < 4; i++) {
-		alloc_rect_node(c->title_bar.border, &failed);
-	}
-
-	for (int i = 0; i < 5; i++) {
-		alloc_rect_node(c->title_bar.background, &failed);
-	}
+	// for opacity purposes the decoration must not overlap the text buffers,
+	// so the background leaves holes where the text goes
+	c->title_bar.decoration = alloc_decoration_node(c->title_bar.tree, &failed);
 
 	c->border.tree = alloc_scene_tree(c->scene_tree, &failed);
 	c->content_tree = alloc_scene_tree(c->border.tree, &failed);
 
-	c->jump.text = NULL;
+	c->jump.label = NULL;
 	c->jump.tree = alloc_scene_tree(c->scene_tree, &failed);
 	sway_scene_node_set_enabled(&c->jump.tree->node, false);
 
 	if (view) {
-		// only containers with views can have borders
-		c->border.top = alloc_rect_node(c->border.tree, &failed);
-		c->border.bottom = alloc_rect_node(c->border.tree, &failed);
-		c->border.left = alloc_rect_node(c->border.tree, &failed);
-		c->border.right = alloc_rect_node(c->border.tree, &failed);
+		// only containers with views can have borders, kept below the content
+		// so they never take its input
+		c->border.decoration = alloc_decoration_node(c->border.tree, &failed);
+		if (c->border.decoration) {
+			sway_scene_node_lower_to_bottom(&c->border.decoration->node);
+		}
 
 		c->output_handler = sway_scene_buffer_create(c->border.tree, NULL);
 		if (!c->output_handler) {
@@ -197,6 +185,8 @@ struct sway_container *container_create(struct sway_view *view) {
 	}
 
 	wl_signal_init(&c->events.destroy);
+	root_index_add_container(c);
+	c->node.lua_handle = sway_lua_handle_create(LUA_HANDLE_CONTAINER, c);
 	wl_signal_emit_mutable(&root->events.new_node, &c->node);
 
 	container_update(c);
@@ -288,19 +278,42 @@ static bool container_is_current_floating(struct sway_container *container) {
 	return false;
 }
 
-// scene rect wants premultiplied colors
-static void scene_rect_set_color(struct sway_scene_rect *rect,
+// scene rects and decorations want premultiplied colors
+static void premultiply_color(float premultiplied[static 4],
 		const float color[4], float opacity) {
-	const float premultiplied[] = {
-		color[0] * color[3] * opacity,
-		color[1] * color[3] * opacity,
-		color[2] * color[3] * opacity,
-		color[3] * opacity,
-	};
+	premultiplied[0] = color[0] * color[3] * opacity;
+	premultiplied[1] = color[1] * color[3] * opacity;
+	premultiplied[2] = color[2] * color[3] * opacity;
+	premultiplied[3] = color[3] * opacity;
+}
 
+static void scene_rect_set_color(struct sway_scene_rect *rect,
+		const float color[4], float opacity) {
+	float premultiplied[4];
+	premultiply_color(premultiplied, color, opacity);
 	sway_scene_rect_set_color(rect, premultiplied);
 }
 
+static void scene_decoration_set_colors(struct sway_scene_decoration *decoration,
+		const float top[4], const float bottom[4], const float left[4],
+		const float right[4], const float background[4], float opacity) {
+	float premultiplied[4];
+	premultiply_color(premultiplied, top, opacity);
+	sway_scene_decoration_set_border_color(decoration,
+		SWAY_SCENE_DECORATION_TOP, premultiplied);
+	premultiply_color(premultiplied, bottom, opacity);
+	sway_scene_decoration_set_border_color(decoration,
+		SWAY_SCENE_DECORATION_BOTTOM, premultiplied);
+	premultiply_color(premultiplied, left, opacity);
+	sway_scene_decoration_set_border_color(decoration,
+		SWAY_SCENE_DECORATION_LEFT, premultiplied);
+	premultiply_color(premultiplied, right, opacity);
+	sway_scene_decoration_set_border_color(decoration,
+		SWAY_SCENE_DECORATION_RIGHT, premultiplied);
+	premultiply_color(premultiplied, background, opacity);
+	sway_scene_decoration_set_background(decoration, premultiplied);
+}
+
 void container_update(struct sway_container *con) {
 	struct border_colors *colors = container_get_current_colors(con);
 	float alpha = con->alpha;
@@ -340,22 +353,13 @@ void container_update(struct sway_container *con) {
 		}
 	}
 
-	struct sway_scene_node *node;
-	wl_list_for_each(node, &con->title_bar.border->children, link) {
-		struct sway_scene_rect *rect = sway_scene_rect_from_node(node);
-		scene_rect_set_color(rect, title_border, alpha);
-	}
-
-	wl_list_for_each(node, &con->title_bar.background->children, link) {
-		struct sway_scene_rect *rect = sway_scene_rect_from_node(node);
-		scene_rect_set_color(rect, colors->background, alpha);
-	}
+	scene_decoration_set_colors(con->title_bar.decoration, title_border,
+		title_border, title_border, title_border, colors->background, alpha);
 
 	if (con->view) {
-		scene_rect_set_color(con->border.top, top, alpha);
-		scene_rect_set_color(con->border.bottom, bottom, alpha);
-		scene_rect_set_color(con->border.left, left, alpha);
-		scene_rect_set_color(con->border.right, right, alpha);
+		const float none[4] = {0.f, 0.f, 0.f, 0.f};
+		scene_decoration_set_colors(con->border.decoration,
+			top, bottom, left, right, none, alpha);
 	}
 
 	if (con->title_bar.title_text) {
@@ -387,37 +391,14 @@ void container_update_itself_and_parents(struct sway_container *con) {
 	}
 }
 
-static void update_rect_list(struct sway_scene_tree *tree, pixman_region64f_t *region) {
-	int len;
-	const pixman_box64f_t *rects = pixman_region64f_rectangles(region, &len);
-
-	sway_scene_node_set_enabled(&tree->node, len > 0);
-	if (len == 0) {
-		return;
-	}
-
-	int i = 0;
-	struct sway_scene_node *node;
-	wl_list_for_each(node, &tree->children, link) {
-		struct sway_scene_rect *rect = sway_scene_rect_from_node(node);
-		sway_scene_node_set_enabled(&rect->node, i < len);
-
-		if (i < len) {
-			const pixman_box64f_t *box = &rects[i++];
-			sway_scene_node_set_position(&rect->node, box->x1, box->y1);
-			sway_scene_rect_set_size(rect, box->x2 - box->x1, box->y2 - box->y1);
-		}
-	}
-}
-
 void container_arrange_title_bar(struct sway_container *con) {
 	enum alignment title_align = config->title_align;
 	int marks_buffer_width = 0;
 	double width = con->title_width;
 	int height = container_titlebar_height();
 
-	pixman_region64f_t text_area;
-	pixman_region64f_init(&text_area);
+	pixman_region32_t text_area;
+	pixman_region32_init(&text_area);
 
 	struct sway_workspace *workspace = con->pending.workspace;
 	double scale = workspace ? (layout_scale_enabled(workspace) ? layout_scale_get(workspace) : 1.0) : 1.0;
@@ -444,8 +425,9 @@ void container_arrange_title_bar(struct sway_container *con) {
 			scale * h_padding, scale * (height - node->height) * 0.5);
 		sway_text_node_scale(node, scale);
 
-		pixman_region64f_union_rectf(&text_area, &text_area,
-			node->node->x, node->node->y, round(scale * alloc_width), scale * node->height);
+		pixman_region32_union_rect(&text_area, &text_area,
+			node->node->x, node->node->y, round(scale * alloc_width),
+			round(scale * node->height));
 	}
 
 	if (con->title_bar.title_text) {
@@ -471,33 +453,24 @@ void container_arrange_title_bar(struct sway_container *con) {
 			scale * h_padding, scale * (height - node->height) * 0.5);
 		sway_text_node_scale(node, scale);
 
-		pixman_region64f_union_rectf(&text_area, &text_area,
-			node->node->x, node->node->y, round(scale * alloc_width), scale * node->height);
+		pixman_region32_union_rect(&text_area, &text_area,
+			node->node->x, node->node->y, round(scale * alloc_width),
+			round(scale * node->height));
 	}
 
 	// silence pixman errors
 	if (width <= 0 || height <= 0) {
-		pixman_region64f_fini(&text_area);
+		pixman_region32_fini(&text_area);
 		return;
 	}
 
-	pixman_region64f_t background, border;
-
 	int thickness = max(1, round(scale * config->titlebar_border_thickness));
-	pixman_region64f_init_rectf(&background,
-		thickness, thickness,
-		scale * width - thickness * 2, scale * height - thickness * 2);
-	pixman_region64f_init_rectf(&border, 0, 0, scale * width, scale * height);
-	pixman_region64f_subtract(&border, &border, &background);
-
-	pixman_region64f_subtract(&background, &background, &text_area);
-	pixman_region64f_fini(&text_area);
-
-	update_rect_list(con->title_bar.background, &background);
-	pixman_region64f_fini(&background);
-
-	update_rect_list(con->title_bar.border, &border);
-	pixman_region64f_fini(&border);
+	struct sway_scene_decoration *decoration = con->title_bar.decoration;
+	sway_scene_decoration_set_size(decoration, scale * width, scale * height);
+	sway_scene_decoration_set_border(decoration,
+		thickness, thickness, thickness, thickness);
+	sway_scene_decoration_set_holes(decoration, &text_area);
+	pixman_region32_fini(&text_area);
 
 	container_update(con);
 }
@@ -590,6 +563,8 @@ void container_destroy(struct sway_container *con) {
 	list_free(con->pending.children);
 	list_free(con->current.children);
 
+	root_index_remove_container(con);
+	sway_lua_handle_release(con->node.lua_handle);
 	list_free_items_and_destroy(con->marks);
 
 	if (con->view && con->view->container == con) {
@@ -600,6 +575,7 @@ void container_destroy(struct sway_container *con) {
 		}
 	}
 
+	animation_timeline_stop(&con->animation.timeline);
 	scene_node_disown_children(con->content_tree);
 	sway_scene_node_destroy(&con->scene_tree->node);
 	free(con);
@@ -621,6 +597,7 @@ void container_begin_destroy(struct sway_container *con) {
 	wl_signal_emit_mutable(&con->node.events.destroy, &con->node);
 
 	container_end_mouse_operation(con);
+	layout_scroll_forget_container(con);
 
 	node_set_dirty(&con->node);
 	con->node.destroying = true;
@@ -1071,6 +1048,22 @@ void container_set_resizing(struct sway_container *con, bool resizing) {
 	}
 }
 
+void container_floating_setup_view(struct sway_container *container) {
+	if (!container->view) {
+		return;
+	}
+	view_set_tiled(container->view, false);
+	if (container->view->using_csd) {
+		container->saved_border = container->pending.border;
+		container->pending.border = B_CSD;
+		if (container->view->xdg_decoration) {
+			struct sway_xdg_decoration *deco = container->view->xdg_decoration;
+			wlr_xdg_toplevel_decoration_v1_set_mode(deco->wlr_xdg_decoration,
+					WLR_XDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE);
+		}
+	}
+}
+
 void container_set_floating(struct sway_container *container, bool enable) {
 	if (container_is_floating(container) == enable) {
 		return;
@@ -1088,18 +1081,7 @@ void container_set_floating(struct sway_container *container, bool enable) {
 		}
 		container_detach(container);
 		workspace_add_floating(workspace, container);
-		if (container->view) {
-			view_set_tiled(container->view, false);
-			if (container->view->using_csd) {
-				container->saved_border = container->pending.border;
-				container->pending.border = B_CSD;
-				if (container->view->xdg_decoration) {
-					struct sway_xdg_decoration *deco = container->view->xdg_decoration;
-					wlr_xdg_toplevel_decoration_v1_set_mode(deco->wlr_xdg_decoration,
-							WLR_XDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE);
-				}
-			}
-		}
+		container_floating_setup_view(container);
 		container_floating_set_default_size(container);
 		container_floating_resize_and_center(container);
 		if (old_parent) {
@@ -1668,6 +1650,8 @@ void container_detach(struct sway_container *child) {
 		root->fullscreen_global = NULL;
 	}
 
+	layout_scroll_forget_container(child);
+
 	struct sway_container *old_parent = child->pending.parent;
 	struct sway_workspace *old_workspace = child->pending.workspace;
 	list_t *siblings = container_get_siblings(child);
@@ -1794,18 +1778,12 @@ bool container_is_transient_for(struct sway_container *child,
 		view_is_transient_for(child->view, ancestor->view);
 }
 
-static bool find_by_mark_iterator(struct sway_container *con, void *data) {
-	char *mark = data;
-	return container_has_mark(con, mark);
-}
-
 struct sway_container *container_find_mark(char *mark) {
-	return root_find_container(find_by_mark_iterator, mark);
+	return root_find_container_by_mark(mark);
 }
 
 bool container_find_and_unmark(char *mark) {
-	struct sway_container *con = root_find_container(
-		find_by_mark_iterator, mark);
+	struct sway_container *con = root_find_container_by_mark(mark);
 	if (!con) {
 		return false;
 	}
@@ -1813,6 +1791,7 @@ bool container_find_and_unmark(char *mark) {
 	for (int i = 0; i < con->marks->length; ++i) {
 		char *con_mark = con->marks->items[i];
 		if (strcmp(con_mark, mark) == 0) {
+			root_index_remove_mark(con, con_mark);
 			free(con_mark);
 			list_del(con->marks, i);
 			container_update_marks(con);
@@ -1825,6 +1804,7 @@ bool container_find_and_unmark(char *mark) {
 
 void container_clear_marks(struct sway_container *con) {
 	for (int i = 0; i < con->marks->length; ++i) {
+		root_index_remove_mark(con, con->marks->items[i]);
 		free(con->marks->items[i]);
 	}
 	con->marks->length = 0;
@@ -1842,7 +1822,9 @@ bool container_has_mark(struct sway_container *con, char *mark) {
 }
 
 void container_add_mark(struct sway_container *con, char *mark) {
-	list_add(con->marks, strdup(mark));
+	char *con_mark = strdup(mark);
+	list_add(con->marks, con_mark);
+	root_index_add_mark(con, con_mark);
 	ipc_event_window(con, "mark");
 }
 
@@ -13,6 +13,9 @@
 #include "wlr/types/wlr_cursor.h"
 #include "sway/ipc-server.h"
 #include <libevdev/libevdev.h>
+#include <wlr/render/wlr_texture.h>
+#include <wlr/types/wlr_buffer.h>
+#include <math.h>
 
 struct sway_trails {
 	list_t *trails;
@@ -82,7 +85,7 @@ void layout_init(struct sway_workspace *workspace) {
 	layout_modifiers_init(workspace);
 	workspace->layout.overview = OVERVIEW_DISABLED;
 	workspace->layout.mem_scale = -1.0f;  // disabled
-	workspace->layout.workspaces.text = NULL;
+	workspace->layout.workspaces.label = NULL;
 	layout_toggle_size_init(workspace);
 	bool failed = false;
 	workspace->layout.workspaces.tree = alloc_scene_tree(workspace->output->layers.shell_overlay, &failed);
@@ -276,6 +279,17 @@ static void output_damage_whole(struct sway_output *output) {
 }
 
 
+void layout_overview_thumbnail_release(struct sway_workspace *workspace) {
+	if (workspace->layout.workspaces.thumbnail_texture) {
+		wlr_texture_destroy(workspace->layout.workspaces.thumbnail_texture);
+		workspace->layout.workspaces.thumbnail_texture = NULL;
+	}
+	if (workspace->layout.workspaces.thumbnail) {
+		wlr_buffer_drop(workspace->layout.workspaces.thumbnail);
+		workspace->layout.workspaces.thumbnail = NULL;
+	}
+}
+
 static const int workspaces_gap = 20;
 
 void layout_overview_workspaces_toggle() {
@@ -314,6 +328,7 @@ void layout_overview_workspaces_toggle() {
 					child->layout.workspaces.width = ceil(scale * width);
 					child->layout.workspaces.height = ceil(scale * height);
 					child->layout.workspaces.scale = scale;
+					child->layout.workspaces.thumbnail_dirty = true;
 					child->layers.tiling->node.info.workspace = child;
 					node_set_dirty(&child->node);
 					if (child->fullscreen) {
@@ -330,6 +345,7 @@ void layout_overview_workspaces_toggle() {
 			for (int j = 0; j < output->current.workspaces->length; ++j) {
 				struct sway_workspace *child = output->current.workspaces->items[j];
 				child->layers.tiling->node.info.workspace = NULL;
+				layout_overview_thumbnail_release(child);
 				node_set_dirty(&child->node);
 				if (child->layout.fullscreen) {
 					container_set_fullscreen(child->layout.fullscreen, FULLSCREEN_WORKSPACE);
@@ -343,6 +359,7 @@ void layout_overview_workspaces_toggle() {
 		}
 		output_damage_whole(output);
 	}
+	sway_scene_update_visibility(root->root_scene);
 }
 
 void layout_scale_set(struct sway_workspace *workspace, double scale) {
@@ -1258,24 +1275,27 @@ static void switch_workspace(struct sway_workspace *workspace) {
 static void container_toggle_jump_decoration(struct sway_workspace *workspace,
 		struct sway_container *con, char *text,	double width, double height) {
 	if (!text) {
-		if (con->jump.text) {
-			sway_scene_node_destroy(con->jump.text->node);
-			con->jump.text = NULL;
+		if (con->jump.label) {
+			sway_scene_node_destroy(con->jump.label->node);
+			con->jump.label = NULL;
 		}
 		return;
-	} else if (!con->jump.text) {
-		con->jump.text = sway_text_node_create(con->jump.tree,
-			text, config->jump_labels_color, false);
+	} else if (!con->jump.label) {
+		float oscale = workspace && workspace->output ?
+			workspace->output->wlr_output->scale : 1.0f;
+		con->jump.label = sway_label_node_create(con->jump.tree, text, oscale);
+		if (!con->jump.label) {
+			return;
+		}
 	} else {
-		sway_text_node_set_text(con->jump.text, text);
+		sway_label_node_set_text(con->jump.label, text);
 	}
-	sway_text_node_set_background(con->jump.text, config->jump_labels_background);
 	double jscale = config->jump_labels_scale;
 	double wscale = workspace && layout_scale_enabled(workspace) ? layout_scale_get(workspace) : 1.0;
-	double scale = fmin(width / con->jump.text->width, height / con->jump.text->height);
-	sway_text_node_scale(con->jump.text, jscale * scale * wscale);
-	int x = 0.5 * wscale * (width - con->jump.text->width * jscale * scale);
-	int y = 0.5 * wscale * (height - con->jump.text->height * jscale * scale);
+	double scale = fmin(width / con->jump.label->width, height / con->jump.label->height);
+	sway_label_node_scale(con->jump.label, jscale * scale * wscale);
+	int x = 0.5 * wscale * (width - con->jump.label->width * jscale * scale);
+	int y = 0.5 * wscale * (height - con->jump.label->height * jscale * scale);
 	sway_scene_node_set_position(&con->jump.tree->node, x, y);
 	sway_scene_node_set_enabled(&con->jump.tree->node, true);
 	node_set_dirty(&con->node);
@@ -2032,26 +2052,28 @@ void layout_jump_trailmark(struct sway_workspace *workspace) {
 
 static void workspace_toggle_jump_decoration(struct sway_workspace *ws, char *text) {
 	if (!text) {
-		if (ws->layout.workspaces.text) {
-			sway_scene_node_destroy(ws->layout.workspaces.text->node);
-			ws->layout.workspaces.text = NULL;
+		if (ws->layout.workspaces.label) {
+			sway_scene_node_destroy(ws->layout.workspaces.label->node);
+			ws->layout.workspaces.label = NULL;
 		}
 		return;
-	} else if (!ws->layout.workspaces.text) {
-		ws->layout.workspaces.text = sway_text_node_create(ws->layout.workspaces.tree,
-			text, config->jump_labels_color, false);
+	} else if (!ws->layout.workspaces.label) {
+		ws->layout.workspaces.label = sway_label_node_create(ws->layout.workspaces.tree,
+			text, ws->output->wlr_output->scale);
+		if (!ws->layout.workspaces.label) {
+			return;
+		}
 	} else {
-		sway_text_node_set_text(ws->layout.workspaces.text, text);
+		sway_label_node_set_text(ws->layout.workspaces.label, text);
 	}
-	sway_text_node_set_background(ws->layout.workspaces.text, config->jump_labels_background);
 	double jscale = config->jump_labels_scale;
-	double scale = fmin((double) ws->width / ws->layout.workspaces.text->width,
-		(double) ws->height / ws->layout.workspaces.text->height);
+	double scale = fmin((double) ws->width / ws->layout.workspaces.label->width,
+		(double) ws->height / ws->layout.workspaces.label->height);
 	const double oscale = ws->output->wlr_output->scale;
 	const double wscale = ws->layout.workspaces.scale;
-	sway_text_node_scale(ws->layout.workspaces.text, jscale * scale * wscale);
-	int x = ws->layout.workspaces.x + 0.5 * (ws->layout.workspaces.width - ws->layout.workspaces.text->width * jscale * scale * wscale * oscale);
-	int y = ws->layout.workspaces.y + 0.5 * (ws->layout.workspaces.height - ws->layout.workspaces.text->height * jscale * scale * wscale * oscale);
+	sway_label_node_scale(ws->layout.workspaces.label, jscale * scale * wscale);
+	int x = ws->layout.workspaces.x + 0.5 * (ws->layout.workspaces.width - ws->layout.workspaces.label->width * jscale * scale * wscale * oscale);
+	int y = ws->layout.workspaces.y + 0.5 * (ws->layout.workspaces.height - ws->layout.workspaces.label->height * jscale * scale * wscale * oscale);
 	x /= oscale;
 	y /= oscale;
 	sway_scene_node_set_position(&ws->layout.workspaces.tree->node, x, y);
@@ -2327,7 +2349,7 @@ static struct sway_container *get_mouse_container(struct sway_seat *seat) {
 	enum sway_container_layout layout = layout_get_type(workspace);
 	int active_idx = list_find(workspace->tiling, container);
 	if (layout == L_HORIZ) {
-		double offset = container->pending.x;
+		double offset = container->pending.x + workspace->gesture.offset_x;
 		for (int i = active_idx; i < workspace->tiling->length; ++i) {
 			struct sway_container *con = workspace->tiling->items[i];
 			double x0 = offset - scale * workspace->gaps_inner;
@@ -2337,7 +2359,7 @@ static struct sway_container *get_mouse_container(struct sway_seat *seat) {
 			}
 			offset = x1;
 		}
-		offset = container->pending.x;
+		offset = container->pending.x + workspace->gesture.offset_x;
 		for (int i = active_idx - 1; i >= 0; i--) {
 			struct sway_container *con = workspace->tiling->items[i];
 			double x1 = offset - scale * workspace->gaps_inner;
@@ -2348,7 +2370,7 @@ static struct sway_container *get_mouse_container(struct sway_seat *seat) {
 			offset = x0;
 		}
 	} else {
-		double offset = container->pending.y;
+		double offset = container->pending.y + workspace->gesture.offset_y;
 		for (int i = active_idx; i < workspace->tiling->length; ++i) {
 			struct sway_container *con = workspace->tiling->items[i];
 			double y0 = offset - scale * workspace->gaps_inner;
@@ -2358,7 +2380,7 @@ static struct sway_container *get_mouse_container(struct sway_seat *seat) {
 			}
 			offset = y1;
 		}
-		offset = container->pending.y;
+		offset = container->pending.y + workspace->gesture.offset_y;
 		for (int i = active_idx - 1; i >= 0; i--) {
 			struct sway_container *con = workspace->tiling->items[i];
 			double y1 = offset - scale * workspace->gaps_inner;
@@ -2372,40 +2394,118 @@ static struct sway_container *get_mouse_container(struct sway_seat *seat) {
 	return container;
 }
 
+// During a gesture, scrolling only moves scene nodes: no transaction is
+// committed and no client is configured until layout_scroll_end() folds the
+// accumulated offsets into the layout with scroll_apply().
 static void scroll_workspace(struct sway_workspace *workspace, double dx, double dy) {
 	if (layout_get_type(workspace) == L_HORIZ) {
-		for (int i = 0; i < workspace->tiling->length; ++i) {
-			struct sway_container *con = workspace->tiling->items[i];
-			con->pending.x += dx;
-		}
+		workspace->gesture.offset_x += dx;
 	} else {
-		for (int i = 0; i < workspace->tiling->length; ++i) {
-			struct sway_container *con = workspace->tiling->items[i];
-			con->pending.y += dy;
+		workspace->gesture.offset_y += dy;
+	}
+	struct sway_output *output = workspace->output;
+	if (!output || !workspace->layers.tiling->node.enabled) {
+		return;
+	}
+	// Same as arrange_output() in transaction.c
+	struct wlr_box *area = &output->usable_area;
+	struct side_gaps *gaps = &workspace->current_gaps;
+	sway_scene_node_set_position(&workspace->layers.tiling->node,
+		gaps->left + area->x + workspace->gesture.offset_x,
+		gaps->top + area->y + workspace->gesture.offset_y);
+}
+
+static void scroll_apply_column(struct sway_workspace *workspace) {
+	struct sway_container *container = workspace->gesture.column;
+	if (!container) {
+		return;
+	}
+	double offset = workspace->gesture.column_offset;
+	list_t *children = container->pending.children;
+	for (int i = 0; i < children->length; ++i) {
+		struct sway_container *con = children->items[i];
+		if (container->pending.layout == L_HORIZ) {
+			con->current.x += offset;
+			con->pending.x += offset;
+		} else {
+			con->current.y += offset;
+			con->pending.y += offset;
 		}
 	}
-	node_set_dirty(&workspace->node);
-	transaction_commit_dirty();
+	// The content keeps its translation until the container is arranged
+	// again with the new positions
+	workspace->gesture.column = NULL;
+	workspace->gesture.column_offset = 0.0;
+	node_set_dirty(&container->node);
 }
 
 static void scroll_container(struct sway_container *container, double dx, double dy) {
+	struct sway_workspace *workspace = container->pending.workspace;
+	if (workspace->gesture.column != container) {
+		scroll_apply_column(workspace);
+		workspace->gesture.column = container;
+	}
 	if (container->pending.layout == L_HORIZ) {
-		list_t *children = container->pending.children;
-		for (int i = 0; i < children->length; ++i) {
-			struct sway_container *con = children->items[i];
-			con->current.x += dx;
-			con->pending.x += dx;
-		}
+		workspace->gesture.column_offset += dx;
+		sway_scene_node_set_position(&container->content_tree->node,
+			workspace->gesture.column_offset, 0);
 	} else {
-		list_t *children = container->pending.children;
-		for (int i = 0; i < children->length; ++i) {
-			struct sway_container *con = children->items[i];
-			con->current.y += dy;
-			con->pending.y += dy;
+		workspace->gesture.column_offset += dy;
+		sway_scene_node_set_position(&container->content_tree->node,
+			0, workspace->gesture.column_offset);
+	}
+}
+
+static void scroll_forget_column(struct sway_workspace *workspace, void *data) {
+	struct sway_container *container = data;
+	if (workspace->gesture.column != container) {
+		return;
+	}
+	workspace->gesture.column = NULL;
+	workspace->gesture.column_offset = 0.0;
+	sway_scene_node_set_position(&container->content_tree->node, 0, 0);
+	if (workspace->gesture.kinetic) {
+		// Nothing left to fling: the next kinetic step finishes the scroll
+		workspace->gesture.vx = 0.0;
+		workspace->gesture.vy = 0.0;
+	}
+}
+
+void layout_scroll_forget_container(struct sway_container *container) {
+	// A gesture only scrolls columns of its own workspace, and detaching
+	// already forgot the container if it has none
+	if (container->pending.workspace) {
+		scroll_forget_column(container->pending.workspace, container);
+	}
+}
+
+static void scroll_forget_seat(struct sway_workspace *workspace, void *data) {
+	if (workspace->gesture.seat == data) {
+		workspace->gesture.seat = NULL;
+	}
+}
+
+void layout_scroll_forget_seat(struct sway_seat *seat) {
+	root_for_each_workspace(scroll_forget_seat, seat);
+}
+
+// Moves the layout to where the gesture has scrolled it
+static void scroll_apply(struct sway_workspace *workspace) {
+	if (workspace->gesture.offset_x != 0.0 || workspace->gesture.offset_y != 0.0) {
+		// current too, so an animation starts from where the gesture left
+		// the layout instead of jumping back
+		for (int i = 0; i < workspace->tiling->length; ++i) {
+			struct sway_container *con = workspace->tiling->items[i];
+			con->current.x += workspace->gesture.offset_x;
+			con->current.y += workspace->gesture.offset_y;
+			con->pending.x += workspace->gesture.offset_x;
+			con->pending.y += workspace->gesture.offset_y;
 		}
+		workspace->gesture.offset_x = 0.0;
+		workspace->gesture.offset_y = 0.0;
+		node_set_dirty(&workspace->node);
 	}
-	node_set_dirty(&container->node);
-	transaction_commit_dirty();
+	scroll_apply_column(workspace);
 }
 
 static void layout_scroll_float_pinned_container(struct sway_workspace *workspace) {
@@ -2527,9 +2627,25 @@ static void layout_scroll_unfloat_pinned_container(struct sway_workspace *worksp
 	workspace->gesture.scrolling = false;
 }
 
+static double seconds_since(const struct timespec *now, const struct timespec *then) {
+	struct timespec diff;
+	timespec_sub(&diff, now, then);
+	return timespec_to_nsec(&diff) / 1e9;
+}
+
 // Gestures
 bool layout_scroll_begin(struct sway_seat *seat) {
 	struct sway_workspace *workspace = seat->workspace;
+	clock_gettime(CLOCK_MONOTONIC, &workspace->gesture.last_event);
+	workspace->gesture.seat = seat;
+	workspace->gesture.vx = 0.0;
+	workspace->gesture.vy = 0.0;
+	if (workspace->gesture.kinetic) {
+		// A new touch stops kinetic scrolling: the gesture goes on from
+		// wherever the layout is now, with the pin still floating
+		workspace->gesture.kinetic = false;
+		return true;
+	}
 	// Check if we can scroll
 	double scale = layout_scale_enabled(workspace) ? layout_scale_get(workspace) : 1.0;
 	double total_width = 0.0, max_height = 0.0;
@@ -2570,6 +2686,28 @@ bool layout_scroll_begin(struct sway_seat *seat) {
 	return true;
 }
 
+// Scrolls the workspace or a column, depending on the layout and the main
+// axis of (dx, dy). While kinetic scrolling, the column is the one the gesture
+// was scrolling, regardless of where the cursor is now.
+static void scroll_motion(struct sway_seat *seat, struct sway_workspace *workspace,
+		double dx, double dy) {
+	bool horizontal = fabs(dx) > fabs(dy);
+	if (horizontal) {
+		workspace->gesture.dx += dx;
+	} else {
+		workspace->gesture.dy += dy;
+	}
+	if (horizontal == (layout_get_type(workspace) == L_HORIZ)) {
+		scroll_workspace(workspace, dx, dy);
+	} else if (workspace->gesture.kinetic) {
+		if (workspace->gesture.column) {
+			scroll_container(workspace->gesture.column, dx, dy);
+		}
+	} else {
+		scroll_container(get_mouse_container(seat), dx, dy);
+	}
+}
+
 void layout_scroll_update(struct sway_seat *seat, double dx, double dy) {
 	struct sway_workspace *workspace = seat->workspace;
 	if (workspace->tiling->length == 0) {
@@ -2578,36 +2716,26 @@ void layout_scroll_update(struct sway_seat *seat, double dx, double dy) {
 	double scale = layout_scale_enabled(workspace) ? layout_scale_get(workspace) : 1.0;
 	dx *= config->gesture_scroll_sentitivity * scale;
 	dy *= config->gesture_scroll_sentitivity * scale;
-
-	enum sway_layout_direction scrolling_direction;
-	if (fabs(dx) > fabs(dy)) {
-		scrolling_direction = dx > 0.0 ? DIR_RIGHT : DIR_LEFT;
-		workspace->gesture.dx += dx;
-	} else {
-		scrolling_direction = dy > 0.0 ? DIR_DOWN : DIR_UP; 
-		workspace->gesture.dy += dy;
+	if (dx == 0.0 && dy == 0.0) {
+		return;
 	}
 
-	switch (scrolling_direction) {
-	case DIR_UP:
-	case DIR_DOWN:
-		if (layout_get_type(workspace) == L_HORIZ) {
-			scroll_container(get_mouse_container(seat), dx, dy);
-		} else {
-			scroll_workspace(workspace, dx, dy);
-		}
-		break;
-	case DIR_LEFT:
-	case DIR_RIGHT:
-		if (layout_get_type(workspace) == L_HORIZ) {
-			scroll_workspace(workspace, dx, dy);
-		} else {
-			scroll_container(get_mouse_container(seat), dx, dy);
-		}
-		break;
-	default:
-		break;
+	// Exponential moving average of the velocity along the main axis, so a
+	// single jittery event does not decide the fling
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	double dt = seconds_since(&now, &workspace->gesture.last_event);
+	workspace->gesture.last_event = now;
+	if (dt > 0.0) {
+		const double alpha = 0.4;
+		bool horizontal = fabs(dx) > fabs(dy);
+		double vx = horizontal ? dx / dt : 0.0;
+		double vy = horizontal ? 0.0 : dy / dt;
+		workspace->gesture.vx = alpha * vx + (1.0 - alpha) * workspace->gesture.vx;
+		workspace->gesture.vy = alpha * vy + (1.0 - alpha) * workspace->gesture.vy;
 	}
+
+	scroll_motion(seat, workspace, dx, dy);
 }
 
 static void scroll_end_horizontal(struct sway_seat *seat, list_t *children, int active_idx,
@@ -2703,11 +2831,9 @@ static bool scrolling_in_pin_direction(enum sway_container_layout layout,
 	return false;
 }
 
-bool layout_scroll_end(struct sway_seat *seat) {
-	struct sway_workspace *workspace = seat->workspace;
-	if (!workspace->gesture.scrolling) {
-		return false;
-	}
+static void scroll_finish(struct sway_seat *seat, struct sway_workspace *workspace) {
+	workspace->gesture.kinetic = false;
+	scroll_apply(workspace);
 
 	enum sway_layout_direction scrolling_direction;
 	enum sway_container_layout layout = layout_get_type(workspace);
@@ -2720,13 +2846,20 @@ bool layout_scroll_end(struct sway_seat *seat) {
 	if (workspace->gesture.pin) {
 		layout_scroll_unfloat_pinned_container(workspace);
 		if (scrolling_in_pin_direction(layout, scrolling_direction)) {
-			return true;
+			return;
 		}
 	}
 
 	workspace->gesture.scrolling = false;
 	if (workspace->tiling->length == 0) {
-		return true;
+		return;
+	}
+	if (seat->workspace != workspace) {
+		// Kinetic scrolling on a workspace the seat has left: keep the
+		// layout where it stopped without moving the focus
+		arrange_workspace(workspace);
+		transaction_commit_dirty();
+		return;
 	}
 	if (scrolling_direction == DIR_LEFT || scrolling_direction == DIR_RIGHT) {
 		if (layout == L_HORIZ) {
@@ -2753,9 +2886,131 @@ bool layout_scroll_end(struct sway_seat *seat) {
 	}
 	arrange_workspace(workspace);
 	transaction_commit_dirty();
+}
+
+// Below this speed (pixels per second), kinetic scrolling stops
+#define KINETIC_MIN_VELOCITY 60.0
+// A gesture that rested longer than this (seconds) before ending does not fling
+#define KINETIC_MAX_REST 0.05
+
+bool layout_scroll_end(struct sway_seat *seat) {
+	struct sway_workspace *workspace = seat->workspace;
+	if (!workspace->gesture.scrolling) {
+		return false;
+	}
+	if (config->gesture_scroll_kinetic && workspace->output &&
+			workspace->tiling->length > 0) {
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (seconds_since(&now, &workspace->gesture.last_event) > KINETIC_MAX_REST) {
+			workspace->gesture.vx = workspace->gesture.vy = 0.0;
+		}
+		// Only fling along the main axis
+		if (fabs(workspace->gesture.vx) > fabs(workspace->gesture.vy)) {
+			workspace->gesture.vy = 0.0;
+		} else {
+			workspace->gesture.vx = 0.0;
+		}
+		if (hypot(workspace->gesture.vx, workspace->gesture.vy) > KINETIC_MIN_VELOCITY) {
+			workspace->gesture.kinetic = true;
+			workspace->gesture.last_frame = now;
+			wlr_output_schedule_frame(workspace->output->wlr_output);
+			return true;
+		}
+	}
+	scroll_finish(seat, workspace);
 	return true;
 }
 
+// Start and end of children along the layout axis, computed from the active
+// child like get_mouse_container() does.
+static void scroll_get_extent(struct sway_workspace *workspace, list_t *children,
+		struct sway_container *active, bool horizontal, double offset,
+		double *start, double *end) {
+	double scale = layout_scale_enabled(workspace) ? layout_scale_get(workspace) : 1.0;
+	int active_idx = max(list_find(children, active), 0);
+	active = children->items[active_idx];
+	*start = *end = offset + (horizontal ? active->pending.x : active->pending.y);
+	for (int i = 0; i < children->length; ++i) {
+		struct sway_container *con = children->items[i];
+		double size = scale * ((horizontal ? con->pending.width : con->pending.height) +
+			2.0 * workspace->gaps_inner);
+		if (i < active_idx) {
+			*start -= size;
+		} else {
+			*end += size;
+		}
+	}
+}
+
+// True if the kinetic scroll has taken the content past the middle of the
+// viewport, with nothing more to show in the scrolling direction
+static bool scroll_kinetic_at_edge(struct sway_workspace *workspace) {
+	bool horizontal = workspace->gesture.vx != 0.0;
+	double velocity = horizontal ? workspace->gesture.vx : workspace->gesture.vy;
+	double start, end;
+	if (horizontal == (layout_get_type(workspace) == L_HORIZ)) {
+		scroll_get_extent(workspace, workspace->tiling,
+			workspace->current.focused_inactive_child, horizontal,
+			horizontal ? workspace->gesture.offset_x : workspace->gesture.offset_y,
+			&start, &end);
+	} else if (workspace->gesture.column) {
+		struct sway_container *column = workspace->gesture.column;
+		scroll_get_extent(workspace, column->pending.children,
+			column->current.focused_inactive_child, horizontal,
+			workspace->gesture.column_offset, &start, &end);
+	} else {
+		return true;
+	}
+	double center = horizontal ? workspace->x + workspace->width / 2.0 :
+		workspace->y + workspace->height / 2.0;
+	return (velocity > 0.0 && start >= center) || (velocity < 0.0 && end <= center);
+}
+
+static void scroll_kinetic_step(struct sway_workspace *workspace) {
+	struct sway_seat *seat = workspace->gesture.seat ?
+		workspace->gesture.seat : input_manager_current_seat();
+	if (!workspace_is_visible(workspace) || workspace->tiling->length == 0) {
+		scroll_finish(seat, workspace);
+		return;
+	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	// Cap the step, so a stalled output does not make the layout jump
+	double dt = fmin(seconds_since(&now, &workspace->gesture.last_frame), 0.1);
+	workspace->gesture.last_frame = now;
+
+	// v(t) = v0 * e^(-k t), so the distance covered during dt is
+	// v0 * (1 - e^(-k dt)) / k
+	double k = config->gesture_scroll_friction;
+	double decay = exp(-k * dt);
+	double dx = workspace->gesture.vx * (1.0 - decay) / k;
+	double dy = workspace->gesture.vy * (1.0 - decay) / k;
+	workspace->gesture.vx *= decay;
+	workspace->gesture.vy *= decay;
+	if (dx != 0.0 || dy != 0.0) {
+		scroll_motion(seat, workspace, dx, dy);
+	}
+
+	if (hypot(workspace->gesture.vx, workspace->gesture.vy) < KINETIC_MIN_VELOCITY ||
+			scroll_kinetic_at_edge(workspace)) {
+		// Snaps to the nearest column in the scrolling direction
+		scroll_finish(seat, workspace);
+		return;
+	}
+	// Moving the scene nodes damages the output, but a sub-pixel step may not
+	wlr_output_schedule_frame(workspace->output->wlr_output);
+}
+
+void layout_scroll_frame(struct sway_output *output) {
+	for (int i = 0; i < output->workspaces->length; ++i) {
+		struct sway_workspace *workspace = output->workspaces->items[i];
+		if (workspace->gesture.kinetic) {
+			scroll_kinetic_step(workspace);
+		}
+	}
+}
+
 bool layout_pin_enabled(struct sway_workspace *workspace) {
 	if (!workspace->layout.pin.container) {
 		return false;
@@ -3400,7 +3655,8 @@ static struct sway_container *layout_space_container_restore_tiling(struct sway_
 	}
 	if (space_container->view) {
 		// Find view, detach its container
-		struct sway_container *container = find_and_detach_container(space_container->view->view);
+		struct sway_container *container = space_container->view->view ?
+			find_and_detach_container(space_container->view->view) : NULL;
 		if (container) {
 			if (container_is_floating(container)) {
 				struct sway_workspace * ws = container->pending.workspace;
@@ -3436,7 +3692,8 @@ static void layout_space_container_restore_floating(struct sway_workspace *works
 		struct sway_space_container *focused) {
 	if (space_container->view) {
 		// Find view, detach its container
-		struct sway_container *container = find_and_detach_container(space_container->view->view);
+		struct sway_container *container = space_container->view->view ?
+			find_and_detach_container(space_container->view->view) : NULL;
 		if (container) {
 			struct sway_output *old_output = container->pending.workspace->output;
 			struct sway_workspace *old_workspace = container->pending.workspace;
@@ -3536,6 +3793,77 @@ void layout_space_restore(struct sway_space *space, struct sway_workspace *works
 	}
 }
 
+// Return the tiling container of workspace holding a view of space_container,
+// if any of them has been restored there
+static struct sway_container *space_container_find_restored(
+		struct sway_space_container *space_container, struct sway_workspace *workspace) {
+	if (!space_container->children) {
+		return NULL;
+	}
+	for (int i = 0; i < space_container->children->length; ++i) {
+		struct sway_space_container *child = space_container->children->items[i];
+		if (!child->view || !child->view->view) {
+			continue;
+		}
+		struct sway_container *container = child->view->view->container;
+		if (container && container->pending.workspace == workspace &&
+				container->pending.parent &&
+				list_find(workspace->tiling, container->pending.parent) >= 0) {
+			return container->pending.parent;
+		}
+	}
+	return NULL;
+}
+
+void layout_space_place_view(struct sway_space *space, struct sway_space_view *space_view,
+		struct sway_workspace *workspace, struct sway_container *container) {
+	struct sway_space_container *space_container = space_view->container;
+	struct sway_space_container *space_parent = space_container->parent;
+	container->view->content_scale = space_view->content_scale;
+	if (!space_parent) {
+		if (list_find(space->floating, space_container) >= 0) {
+			workspace_add_floating(workspace, container);
+			fill_container(space_container, container);
+		} else {
+			layout_add_view(workspace, NULL, container);
+		}
+		return;
+	}
+
+	// Insert after the closest sibling already in place, so the order of the
+	// space is kept whatever the order the views map in
+	struct sway_container *parent = space_container_find_restored(space_parent, workspace);
+	if (parent) {
+		int idx = 0;
+		for (int i = list_find(space_parent->children, space_container) - 1; i >= 0; --i) {
+			struct sway_space_container *sibling = space_parent->children->items[i];
+			struct sway_container *con = sibling->view && sibling->view->view ?
+				sibling->view->view->container : NULL;
+			if (con && con->pending.parent == parent) {
+				idx = list_find(parent->pending.children, con) + 1;
+				break;
+			}
+		}
+		container_insert_child(parent, container, idx);
+	} else {
+		int idx = 0;
+		for (int i = list_find(space->tiling, space_parent) - 1; i >= 0; --i) {
+			struct sway_container *sibling =
+				space_container_find_restored(space->tiling->items[i], workspace);
+			if (sibling) {
+				idx = list_find(workspace->tiling, sibling) + 1;
+				break;
+			}
+		}
+		parent = layout_wrap_into_container(container, space_parent->layout);
+		fill_container(space_parent, parent);
+		workspace_insert_tiling_direct(workspace, parent, idx);
+	}
+	fill_container(space_container, container);
+	node_set_dirty(&container->node);
+	node_set_dirty(&parent->node);
+}
+
 static void layout_toggle_size_init(struct sway_workspace *workspace) {
 	workspace->layout.toggle_size.mode = TOGGLE_SIZE_NONE;
 	workspace->layout.toggle_size.container = NULL;
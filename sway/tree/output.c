@@ -155,6 +155,7 @@ struct sway_output *output_create(struct wlr_output *wlr_output) {
 	output->workspaces = create_list();
 	output->current.workspaces = create_list();
 
+	output->node.lua_handle = sway_lua_handle_create(LUA_HANDLE_OUTPUT, output);
 	return output;
 }
 
@@ -279,6 +280,7 @@ void output_destroy(struct sway_output *output) {
 		return;
 	}
 
+	sway_lua_handle_release(output->node.lua_handle);
 	destroy_scene_layers(output);
 	list_free(output->workspaces);
 	list_free(output->current.workspaces);
@@ -299,6 +301,7 @@ void output_disable(struct sway_output *output) {
 
 	sway_log(SWAY_DEBUG, "Disabling output '%s'", output->wlr_output->name);
 	wl_signal_emit_mutable(&output->events.disable, output);
+	workspace_switch_cancel_output(output);
 
 	// Remove the output now to avoid interacting with it during e.g.,
 	// transactions, as the output might be physically removed with the scene
@@ -1,4 +1,6 @@
+#include <ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <wlr/types/wlr_output_layout.h>
@@ -19,6 +21,26 @@
 
 struct sway_root *root;
 
+// Workspace numbers are the leading digits of their names, compared as
+// strings like workspace_by_number() does ("01" is not "1")
+static uint32_t hash_workspace_number(const void *key) {
+	uint32_t hash = 2166136261u;
+	for (const char *p = key; isdigit(*p); ++p) {
+		hash ^= (unsigned char)*p;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static bool equal_workspace_number(const void *a, const void *b) {
+	const char *p = a, *q = b;
+	while (isdigit(*p) && *p == *q) {
+		++p;
+		++q;
+	}
+	return !isdigit(*p) && !isdigit(*q);
+}
+
 struct sway_root *root_create(struct wl_display *wl_display) {
 	struct sway_root *root = calloc(1, sizeof(struct sway_root));
 	if (!root) {
@@ -80,12 +102,25 @@ struct sway_root *root_create(struct wl_display *wl_display) {
 
 	root->spaces = create_list();
 
+	root->index.containers_by_id = create_hashtable(
+		hashtable_hash_int, hashtable_equal_int);
+	root->index.containers_by_mark = create_hashtable(
+		hashtable_hash_string, hashtable_equal_string);
+	root->index.workspaces_by_name = create_hashtable(
+		hashtable_hash_string_nocase, hashtable_equal_string_nocase);
+	root->index.workspaces_by_number = create_hashtable(
+		hash_workspace_number, equal_workspace_number);
+
 	root_set_default_filters(root);
 
 	return root;
 }
 
 void root_destroy(struct sway_root *root) {
+	hashtable_free(root->index.containers_by_id);
+	hashtable_free(root->index.containers_by_mark);
+	hashtable_free(root->index.workspaces_by_name);
+	hashtable_free(root->index.workspaces_by_number);
 	list_free(root->spaces);
 	list_free(root->scratchpad);
 	list_free(root->non_desktop_outputs);
@@ -334,6 +369,107 @@ struct sway_container *root_find_container(
 	return NULL;
 }
 
+// The containers root_find_container() walks through: those on a workspace of
+// an output (including the fallback one) and the hidden scratchpad ones
+static bool container_in_tree(void *value, void *data) {
+	struct sway_container *con = value;
+	if (con->node.destroying) {
+		return false;
+	}
+	if (con->pending.workspace) {
+		return con->pending.workspace->output != NULL;
+	}
+	return container_is_scratchpad_hidden(container_toplevel_ancestor(con));
+}
+
+// The workspaces root_find_workspace() walks through: those on enabled outputs
+static bool workspace_in_tree(void *value, void *data) {
+	struct sway_workspace *ws = value;
+	return !ws->node.destroying && ws->output &&
+		list_find(root->outputs, ws->output) != -1;
+}
+
+struct sway_container *root_find_container_by_id(size_t id) {
+	return hashtable_find(root->index.containers_by_id, (void *)(uintptr_t)id,
+		container_in_tree, NULL);
+}
+
+struct sway_container *root_find_container_by_mark(const char *mark) {
+	return hashtable_find(root->index.containers_by_mark, mark,
+		container_in_tree, NULL);
+}
+
+struct sway_workspace *root_find_workspace_by_name(const char *name) {
+	return hashtable_find(root->index.workspaces_by_name, name,
+		workspace_in_tree, NULL);
+}
+
+struct workspace_tree_position {
+	struct sway_workspace *workspace;
+	int output_index, index;
+};
+
+// Keeps the workspace which comes first in tree order, like a walk would find
+static bool workspace_first_in_tree(void *value, void *data) {
+	struct sway_workspace *ws = value;
+	struct workspace_tree_position *first = data;
+	if (!workspace_in_tree(ws, NULL)) {
+		return false;
+	}
+	int output_index = list_find(root->outputs, ws->output);
+	int index = list_find(ws->output->workspaces, ws);
+	if (!first->workspace || output_index < first->output_index ||
+			(output_index == first->output_index && index < first->index)) {
+		first->workspace = ws;
+		first->output_index = output_index;
+		first->index = index;
+	}
+	return false;
+}
+
+struct sway_workspace *root_find_workspace_by_number(const char *name) {
+	// Several workspaces may share a number, e.g. "1" and "1:web"
+	struct workspace_tree_position first = {0};
+	hashtable_find(root->index.workspaces_by_number, name,
+		workspace_first_in_tree, &first);
+	return first.workspace;
+}
+
+void root_index_add_container(struct sway_container *con) {
+	hashtable_insert(root->index.containers_by_id,
+		(void *)(uintptr_t)con->node.id, con);
+}
+
+void root_index_remove_container(struct sway_container *con) {
+	hashtable_remove(root->index.containers_by_id,
+		(void *)(uintptr_t)con->node.id, con);
+	for (int i = 0; i < con->marks->length; ++i) {
+		root_index_remove_mark(con, con->marks->items[i]);
+	}
+}
+
+void root_index_add_mark(struct sway_container *con, const char *mark) {
+	hashtable_insert(root->index.containers_by_mark, mark, con);
+}
+
+void root_index_remove_mark(struct sway_container *con, const char *mark) {
+	hashtable_remove(root->index.containers_by_mark, mark, con);
+}
+
+void root_index_add_workspace(struct sway_workspace *ws) {
+	hashtable_insert(root->index.workspaces_by_name, ws->name, ws);
+	if (isdigit(ws->name[0])) {
+		hashtable_insert(root->index.workspaces_by_number, ws->name, ws);
+	}
+}
+
+void root_index_remove_workspace(struct sway_workspace *ws) {
+	hashtable_remove(root->index.workspaces_by_name, ws->name, ws);
+	if (isdigit(ws->name[0])) {
+		hashtable_remove(root->index.workspaces_by_number, ws->name, ws);
+	}
+}
+
 void root_get_box(struct sway_root *root, struct wlr_box *box) {
 	box->x = root->x;
 	box->y = root->y;
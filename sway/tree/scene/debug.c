@@ -7,7 +7,7 @@
 void scene_node_debug_print_info(struct sway_scene_node *node, int x, int y) {
 	bool enabled = true;
 	if (enabled) {
-		static const char *names[3] = { "TREE", "RECT", "BUFFER" };
+		static const char *names[4] = { "TREE", "RECT", "BUFFER", "DECORATION" };
 		sway_log(SWAY_INFO, "Node type %s %d %d", names[node->type], x, y);
 		// Debug graph
 		if (scene_descriptor_try_get(node, SWAY_SCENE_DESC_BUFFER_TIMER)) {
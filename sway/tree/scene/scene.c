@@ -1,7 +1,11 @@
 #include <assert.h>
+#include <drm_fourcc.h>
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <wlr/backend.h>
+#include <wlr/render/allocator.h>
+#include <wlr/render/drm_format_set.h>
 #include <wlr/render/swapchain.h>
 #include <wlr/render/drm_syncobj.h>
 #include <wlr/render/wlr_renderer.h>
@@ -14,6 +18,7 @@
 #include <wlr/util/transform.h>
 #include "util.h"
 #include "log.h"
+#include "sway/tree/root.h"
 #include "sway/tree/scene.h"
 #include "sway/tree/view.h"
 #include "sway/tree/workspace.h"
@@ -69,6 +74,91 @@ struct sway_scene_buffer *sway_scene_buffer_from_node(
 	return buffer;
 }
 
+struct sway_scene_decoration *sway_scene_decoration_from_node(
+		struct sway_scene_node *node) {
+	assert(node->type == SWAY_SCENE_NODE_DECORATION);
+	struct sway_scene_decoration *decoration =
+		wl_container_of(node, decoration, node);
+	return decoration;
+}
+
+enum decoration_parts {
+	DECORATION_PARTS_INPUT, // the border sides, and the inside if painted
+	DECORATION_PARTS_VISIBLE,
+	DECORATION_PARTS_OPAQUE,
+};
+
+// The node-local boxes of a decoration: the border sides, then the inside.
+// Top and bottom span the whole width, left and right fit between them.
+static void scene_decoration_boxes(struct sway_scene_decoration *decoration,
+		struct wlr_fbox boxes[static SWAY_SCENE_DECORATION_SIDES + 1]) {
+	double width = decoration->width;
+	double height = decoration->height;
+	double *border = decoration->border;
+	double top = fmin(border[SWAY_SCENE_DECORATION_TOP], height);
+	double bottom = fmin(border[SWAY_SCENE_DECORATION_BOTTOM], height - top);
+	double left = fmin(border[SWAY_SCENE_DECORATION_LEFT], width);
+	double right = fmin(border[SWAY_SCENE_DECORATION_RIGHT], width - left);
+	double inner_height = height - top - bottom;
+
+	boxes[SWAY_SCENE_DECORATION_TOP] = (struct wlr_fbox){
+		0, 0, width, top };
+	boxes[SWAY_SCENE_DECORATION_BOTTOM] = (struct wlr_fbox){
+		0, height - bottom, width, bottom };
+	boxes[SWAY_SCENE_DECORATION_LEFT] = (struct wlr_fbox){
+		0, top, left, inner_height };
+	boxes[SWAY_SCENE_DECORATION_RIGHT] = (struct wlr_fbox){
+		width - right, top, right, inner_height };
+	boxes[SWAY_SCENE_DECORATION_SIDES] = (struct wlr_fbox){
+		left, top, width - left - right, inner_height };
+}
+
+static bool scene_decoration_part_included(const float color[static 4],
+		bool inside, enum decoration_parts parts) {
+	switch (parts) {
+	case DECORATION_PARTS_INPUT:
+		return !inside || color[3] != 0.f;
+	case DECORATION_PARTS_VISIBLE:
+		return color[3] != 0.f;
+	case DECORATION_PARTS_OPAQUE:
+		return color[3] == 1.f;
+	}
+	return false;
+}
+
+// Adds the painted parts of a decoration placed at x, y to region
+static void scene_decoration_region(struct sway_scene_decoration *decoration,
+		double x, double y, enum decoration_parts parts, pixman_region32_t *region) {
+	struct wlr_fbox boxes[SWAY_SCENE_DECORATION_SIDES + 1];
+	scene_decoration_boxes(decoration, boxes);
+
+	for (int i = 0; i <= SWAY_SCENE_DECORATION_SIDES; i++) {
+		const float *color = i < SWAY_SCENE_DECORATION_SIDES ?
+			decoration->border_color[i] : decoration->background;
+		struct wlr_fbox *box = &boxes[i];
+		if (box->width <= 0 || box->height <= 0 ||
+				!scene_decoration_part_included(color,
+					i == SWAY_SCENE_DECORATION_SIDES, parts)) {
+			continue;
+		}
+
+		pixman_region32_t part;
+		pixman_region32_init_rect(&part, round(x + box->x), round(y + box->y),
+			round(x + box->x + box->width) - round(x + box->x),
+			round(y + box->y + box->height) - round(y + box->y));
+		if (i == SWAY_SCENE_DECORATION_SIDES) {
+			pixman_region32_t holes;
+			pixman_region32_init(&holes);
+			pixman_region32_copy(&holes, &decoration->holes);
+			pixman_region32_translate(&holes, round(x), round(y));
+			pixman_region32_subtract(&part, &part, &holes);
+			pixman_region32_fini(&holes);
+		}
+		pixman_region32_union(region, region, &part);
+		pixman_region32_fini(&part);
+	}
+}
+
 struct sway_scene *scene_node_get_root(struct sway_scene_node *node) {
 	struct sway_scene_tree *tree;
 	if (node->type == SWAY_SCENE_NODE_TREE) {
@@ -159,6 +249,10 @@ void sway_scene_node_destroy(struct sway_scene_node *node) {
 		assert(wl_list_empty(&scene_buffer->events.outputs_update.listener_list));
 		assert(wl_list_empty(&scene_buffer->events.output_sample.listener_list));
 		assert(wl_list_empty(&scene_buffer->events.frame_done.listener_list));
+	} else if (node->type == SWAY_SCENE_NODE_DECORATION) {
+		struct sway_scene_decoration *decoration =
+			sway_scene_decoration_from_node(node);
+		pixman_region32_fini(&decoration->holes);
 	} else if (node->type == SWAY_SCENE_NODE_TREE) {
 		struct sway_scene_tree *scene_tree = sway_scene_tree_from_node(node);
 
@@ -257,7 +351,8 @@ static bool _scene_nodes_in_box(struct sway_scene_node *node, struct wlr_box *bo
 		}
 		break;
 	case SWAY_SCENE_NODE_RECT:
-	case SWAY_SCENE_NODE_BUFFER:;
+	case SWAY_SCENE_NODE_BUFFER:
+	case SWAY_SCENE_NODE_DECORATION:;
 		double width, height;
 		scene_node_get_size(node, &width, &height);
 		struct wlr_box node_box = {
@@ -295,6 +390,11 @@ static void scene_node_opaque_region(struct sway_scene_node *node, int x, int y,
 		if (scene_rect->color[3] != 1) {
 			return;
 		}
+	} else if (node->type == SWAY_SCENE_NODE_DECORATION) {
+		struct sway_scene_decoration *decoration =
+			sway_scene_decoration_from_node(node);
+		scene_decoration_region(decoration, x, y, DECORATION_PARTS_OPAQUE, opaque);
+		return;
 	} else if (node->type == SWAY_SCENE_NODE_BUFFER) {
 		struct sway_scene_buffer *scene_buffer = sway_scene_buffer_from_node(node);
 
@@ -360,6 +460,12 @@ struct render_data {
 
 	struct wlr_render_pass *render_pass;
 	pixman_region32_t damage;
+
+	// Set when rendering the overview thumbnail of this workspace
+	struct sway_workspace *thumbnail;
+	// Set when capturing nodes off screen: they are rendered whole, with
+	// no regard to what covers them on the output
+	bool capture;
 };
 
 static void logical_to_buffer_coords(pixman_region32_t *region, const struct render_data *data,
@@ -645,21 +751,93 @@ static struct sway_workspace *scene_node_get_workspace(struct sway_scene_node *n
 	return NULL;
 }
 
-static bool scene_node_get_background(struct sway_scene_node *node) {
-	struct sway_scene_tree *tree;
-	if (node->type == SWAY_SCENE_NODE_TREE) {
-		tree = sway_scene_tree_from_node(node);
-	} else {
-		tree = node->parent;
+// In the workspaces overview, each workspace is drawn through a single
+// transform: scaled around the corner of its output, then moved to its
+// mini-workspace. Layout coordinates map to x + lx * scale.
+struct overview_transform {
+	double scale;
+	double x, y;
+	struct wlr_box clip; // the mini-workspace, in layout coordinates
+};
+
+static void workspace_overview_transform(struct sway_workspace *workspace,
+		struct overview_transform *transform) {
+	struct sway_output *output = workspace->output;
+	double oscale = output->wlr_output->scale;
+	double scale = workspace->layout.workspaces.scale;
+	double x = output->lx + workspace->layout.workspaces.x / oscale;
+	double y = output->ly + workspace->layout.workspaces.y / oscale;
+	*transform = (struct overview_transform){
+		.scale = scale,
+		.x = x - output->lx * scale,
+		.y = y - output->ly * scale,
+		.clip = {
+			.x = floor(x),
+			.y = floor(y),
+			.width = ceil(x + workspace->layout.workspaces.width / oscale) - floor(x),
+			.height = ceil(y + workspace->layout.workspaces.height / oscale) - floor(y),
+		},
+	};
+}
+
+// Returns the workspace whose overview transform applies to the node, if any
+static struct sway_workspace *scene_node_overview_transform(
+		struct sway_scene_node *node, struct overview_transform *transform) {
+	if (!layout_overview_workspaces_enabled()) {
+		return NULL;
 	}
+	struct sway_workspace *workspace = scene_node_get_workspace(node);
+	if (!workspace || !workspace->output) {
+		return NULL;
+	}
+	workspace_overview_transform(workspace, transform);
+	return workspace;
+}
+
+// Maps a layout box through the transform. Rounded outwards it covers every
+// pixel the box touches, inwards only the pixels it fills.
+static struct wlr_box overview_transform_box(const struct overview_transform *transform,
+		double x, double y, double width, double height, bool outwards) {
+	double x1 = transform->x + x * transform->scale;
+	double y1 = transform->y + y * transform->scale;
+	double x2 = x1 + width * transform->scale;
+	double y2 = y1 + height * transform->scale;
+	if (outwards) {
+		x1 = floor(x1);
+		y1 = floor(y1);
+		x2 = ceil(x2);
+		y2 = ceil(y2);
+	} else {
+		x1 = ceil(x1);
+		y1 = ceil(y1);
+		x2 = floor(x2);
+		y2 = floor(y2);
+	}
+	return (struct wlr_box){
+		.x = x1,
+		.y = y1,
+		.width = x2 > x1 ? x2 - x1 : 0,
+		.height = y2 > y1 ? y2 - y1 : 0,
+	};
+}
 
-	while (tree != NULL) {
-		if (tree->node.info.background) {
-			return true;
-		}
-		tree = tree->node.parent;
+// Only nodes that are opaque as a whole are culled against through the
+// transform, partial opaque regions are left out rather than scaled
+static void scene_node_overview_opaque_region(struct sway_scene_node *node,
+		const struct overview_transform *transform, double x, double y,
+		pixman_region32_t *opaque) {
+	double width, height;
+	scene_node_get_size(node, &width, &height);
+	pixman_region32_t region;
+	pixman_region32_init(&region);
+	scene_node_opaque_region(node, 0, 0, &region);
+	uint32_t area = region_area(&region);
+	pixman_region32_fini(&region);
+	if (area == 0 || area != (uint32_t)(round(width) * round(height))) {
+		return;
 	}
-	return false;
+	struct wlr_box box = overview_transform_box(transform, x, y, width, height, false);
+	pixman_region32_union_rect(opaque, opaque, box.x, box.y, box.width, box.height);
 }
 
 static void scene_node_apply_tiling_visibility(struct sway_scene_node *node,
@@ -697,17 +875,41 @@ static bool scene_node_update_iterator(struct sway_scene_node *node,
 		.height = round(ly + height) - round(ly)
 	};
 
+	// In the overview, visibility is where the node is drawn
+	struct overview_transform transform;
+	bool transformed = scene_node_overview_transform(node, &transform) != NULL;
+	struct wlr_box drawn_box = box;
+	if (transformed) {
+		drawn_box = overview_transform_box(&transform, lx, ly, width, height, true);
+		if (!wlr_box_intersection(&drawn_box, &drawn_box, &transform.clip)) {
+			drawn_box = (struct wlr_box){0};
+		}
+	}
+
 	pixman_region32_subtract(&node->visible, &node->visible, data->update_region);
 	pixman_region32_union(&node->visible, &node->visible, data->visible);
 	pixman_region32_intersect_rect(&node->visible, &node->visible,
-		box.x, box.y, box.width, box.height);
+		drawn_box.x, drawn_box.y, drawn_box.width, drawn_box.height);
+	if (node->type == SWAY_SCENE_NODE_DECORATION && !transformed) {
+		// Only the frame is visible, not what it surrounds
+		pixman_region32_t painted;
+		pixman_region32_init(&painted);
+		scene_decoration_region(sway_scene_decoration_from_node(node),
+			lx, ly, DECORATION_PARTS_VISIBLE, &painted);
+		pixman_region32_intersect(&node->visible, &node->visible, &painted);
+		pixman_region32_fini(&painted);
+	}
 
 	scene_node_apply_tiling_visibility(node, data->outputs);
 
-	if (data->calculate_visibility && !layout_overview_workspaces_enabled()) {
+	if (data->calculate_visibility) {
 		pixman_region32_t opaque;
 		pixman_region32_init(&opaque);
-		scene_node_opaque_region(node, box.x, box.y, &opaque);
+		if (transformed) {
+			scene_node_overview_opaque_region(node, &transform, lx, ly, &opaque);
+		} else {
+			scene_node_opaque_region(node, box.x, box.y, &opaque);
+		}
 		pixman_region32_intersect(&opaque, &opaque, &node->visible);
 		pixman_region32_subtract(data->visible, data->visible, &opaque);
 		pixman_region32_fini(&opaque);
@@ -756,9 +958,56 @@ static void scene_node_bounds(struct sway_scene_node *node,
 
 	double width, height;
 	scene_node_get_size(node, &width, &height);
+	struct overview_transform transform;
+	if (scene_node_overview_transform(node, &transform)) {
+		struct wlr_box box = overview_transform_box(&transform, x, y, width, height, true);
+		pixman_region32_union_rect(visible, visible, box.x, box.y, box.width, box.height);
+		return;
+	} else if (node->type == SWAY_SCENE_NODE_DECORATION) {
+		scene_decoration_region(sway_scene_decoration_from_node(node),
+			x, y, DECORATION_PARTS_VISIBLE, visible);
+		return;
+	}
+
 	pixman_region32_union_rect(visible, visible, x, y, round(width), round(height));
 }
 
+struct overview_update_data {
+	struct wlr_box region_box; // drawn
+	struct wlr_box *update_box; // laid out
+};
+
+static void overview_update_box(struct sway_workspace *workspace, void *_data) {
+	struct overview_update_data *data = _data;
+	if (!workspace->output) {
+		return;
+	}
+	struct overview_transform transform;
+	workspace_overview_transform(workspace, &transform);
+	struct wlr_box drawn;
+	if (transform.scale <= 0 || !wlr_box_intersection(&drawn,
+			&data->region_box, &transform.clip)) {
+		return;
+	}
+	double x1 = floor((drawn.x - transform.x) / transform.scale);
+	double y1 = floor((drawn.y - transform.y) / transform.scale);
+	double x2 = ceil((drawn.x + drawn.width - transform.x) / transform.scale);
+	double y2 = ceil((drawn.y + drawn.height - transform.y) / transform.scale);
+	struct wlr_box *box = data->update_box;
+	if (!wlr_box_empty(box)) {
+		x1 = fmin(x1, box->x);
+		y1 = fmin(y1, box->y);
+		x2 = fmax(x2, box->x + box->width);
+		y2 = fmax(y2, box->y + box->height);
+	}
+	*box = (struct wlr_box){
+		.x = x1,
+		.y = y1,
+		.width = x2 - x1,
+		.height = y2 - y1,
+	};
+}
+
 static void scene_update_region(struct sway_scene *scene,
 		pixman_region32_t *update_region) {
 	pixman_region32_t visible;
@@ -778,6 +1027,15 @@ static void scene_update_region(struct sway_scene *scene,
 		.outputs = &scene->outputs,
 		.calculate_visibility = scene->calculate_visibility,
 	};
+	if (layout_overview_workspaces_enabled()) {
+		// Nodes of workspaces are not drawn where they are laid out, also look
+		// for them where the region maps back to in each workspace
+		struct overview_update_data overview = {
+			.region_box = data.update_box,
+			.update_box = &data.update_box,
+		};
+		root_for_each_workspace(overview_update_box, &overview);
+	}
 
 	// update node visibility and output enter/leave events
 	scene_nodes_in_box(&scene->tree.node, &data.update_box, scene_node_update_iterator, &data);
@@ -785,9 +1043,22 @@ static void scene_update_region(struct sway_scene *scene,
 	pixman_region32_fini(&visible);
 }
 
+// In the workspaces overview, damage to a node invalidates the thumbnail of
+// its workspace
+static void scene_node_damage_thumbnail(struct sway_scene_node *node) {
+	if (!layout_overview_workspaces_enabled()) {
+		return;
+	}
+	struct sway_workspace *workspace = scene_node_get_workspace(node);
+	if (workspace) {
+		workspace->layout.workspaces.thumbnail_dirty = true;
+	}
+}
+
 static void scene_node_update(struct sway_scene_node *node,
 		pixman_region32_t *damage) {
 	struct sway_scene *scene = scene_node_get_root(node);
+	scene_node_damage_thumbnail(node);
 
 	double x, y;
 	if (!sway_scene_node_coords(node, &x, &y)) {
@@ -823,6 +1094,21 @@ static void scene_node_update(struct sway_scene_node *node,
 	pixman_region32_fini(damage);
 }
 
+void sway_scene_update_visibility(struct sway_scene *scene) {
+	pixman_region32_t region;
+	pixman_region32_init(&region);
+	struct sway_scene_output *scene_output;
+	wl_list_for_each(scene_output, &scene->outputs, link) {
+		int width, height;
+		wlr_output_effective_resolution(scene_output->output, &width, &height);
+		pixman_region32_union_rect(&region, &region,
+			scene_output->x, scene_output->y, width, height);
+	}
+	scene_update_region(scene, &region);
+	scene_damage_outputs(scene, &region);
+	pixman_region32_fini(&region);
+}
+
 struct sway_scene_rect *sway_scene_rect_create(struct sway_scene_tree *parent,
 		double width, double height, const float color[static 4]) {
 	assert(parent);
@@ -886,6 +1172,106 @@ void sway_scene_rect_set_backdrop_blur(struct sway_scene_rect *rect, bool enable
 	scene_node_update(&rect->node, NULL);
 }
 
+struct sway_scene_decoration *sway_scene_decoration_create(
+		struct sway_scene_tree *parent) {
+	assert(parent);
+
+	struct sway_scene_decoration *decoration = calloc(1, sizeof(*decoration));
+	if (decoration == NULL) {
+		return NULL;
+	}
+	scene_node_init(&decoration->node, SWAY_SCENE_NODE_DECORATION, parent);
+	pixman_region32_init(&decoration->holes);
+
+	scene_node_update(&decoration->node, NULL);
+
+	return decoration;
+}
+
+void sway_scene_decoration_set_size(struct sway_scene_decoration *decoration,
+		double width, double height) {
+	if (decoration->width == width && decoration->height == height) {
+		return;
+	}
+
+	assert(width >= 0 && height >= 0);
+
+	decoration->width = width;
+	decoration->height = height;
+	scene_node_update(&decoration->node, NULL);
+}
+
+void sway_scene_decoration_set_border(struct sway_scene_decoration *decoration,
+		double top, double bottom, double left, double right) {
+	double *border = decoration->border;
+	if (border[SWAY_SCENE_DECORATION_TOP] == top &&
+			border[SWAY_SCENE_DECORATION_BOTTOM] == bottom &&
+			border[SWAY_SCENE_DECORATION_LEFT] == left &&
+			border[SWAY_SCENE_DECORATION_RIGHT] == right) {
+		return;
+	}
+
+	assert(top >= 0 && bottom >= 0 && left >= 0 && right >= 0);
+
+	border[SWAY_SCENE_DECORATION_TOP] = top;
+	border[SWAY_SCENE_DECORATION_BOTTOM] = bottom;
+	border[SWAY_SCENE_DECORATION_LEFT] = left;
+	border[SWAY_SCENE_DECORATION_RIGHT] = right;
+	scene_node_update(&decoration->node, NULL);
+}
+
+void sway_scene_decoration_set_border_color(struct sway_scene_decoration *decoration,
+		enum sway_scene_decoration_side side, const float color[static 4]) {
+	assert(side < SWAY_SCENE_DECORATION_SIDES);
+	float *current = decoration->border_color[side];
+	if (memcmp(current, color, sizeof(decoration->border_color[side])) == 0) {
+		return;
+	}
+
+	memcpy(current, color, sizeof(decoration->border_color[side]));
+	scene_node_update(&decoration->node, NULL);
+}
+
+void sway_scene_decoration_set_background(struct sway_scene_decoration *decoration,
+		const float color[static 4]) {
+	if (memcmp(decoration->background, color, sizeof(decoration->background)) == 0) {
+		return;
+	}
+
+	memcpy(decoration->background, color, sizeof(decoration->background));
+	scene_node_update(&decoration->node, NULL);
+}
+
+void sway_scene_decoration_set_holes(struct sway_scene_decoration *decoration,
+		const pixman_region32_t *holes) {
+	if (!holes) {
+		if (pixman_region32_empty(&decoration->holes)) {
+			return;
+		}
+		pixman_region32_clear(&decoration->holes);
+	} else {
+		if (pixman_region32_equal(&decoration->holes, holes)) {
+			return;
+		}
+		pixman_region32_copy(&decoration->holes, holes);
+	}
+	scene_node_update(&decoration->node, NULL);
+}
+
+void sway_scene_decoration_set_corner_radius(struct sway_scene_decoration *decoration,
+		int radius, enum corner_location location) {
+	if (decoration->corner_radius == radius &&
+			decoration->corner_location == location) {
+		return;
+	}
+
+	assert(radius >= 0);
+
+	decoration->corner_radius = radius;
+	decoration->corner_location = location;
+	scene_node_update(&decoration->node, NULL);
+}
+
 static void scene_buffer_handle_buffer_release(struct wl_listener *listener,
 		void *data) {
 	struct sway_scene_buffer *scene_buffer =
@@ -931,7 +1317,10 @@ static void scene_buffer_handle_renderer_destroy(struct wl_listener *listener,
 static void scene_buffer_set_texture(struct sway_scene_buffer *scene_buffer,
 		struct wlr_texture *texture) {
 	wl_list_remove(&scene_buffer->renderer_destroy.link);
-	wlr_texture_destroy(scene_buffer->texture);
+	if (!scene_buffer->borrowed_texture) {
+		wlr_texture_destroy(scene_buffer->texture);
+	}
+	scene_buffer->borrowed_texture = false;
 	scene_buffer->texture = texture;
 
 	if (texture != NULL) {
@@ -1083,6 +1472,14 @@ void sway_scene_buffer_set_buffer_with_options(struct sway_scene_buffer *scene_b
 		box.x, box.y, box.width, box.height);
 	pixman_region32_translate(&trans_damage, -box.x, -box.y);
 
+	scene_node_damage_thumbnail(&scene_buffer->node);
+	struct overview_transform overview;
+	if (scene_node_overview_transform(&scene_buffer->node, &overview)) {
+		lx = overview.x + lx * overview.scale;
+		ly = overview.y + ly * overview.scale;
+		scale_x *= overview.scale;
+		scale_y *= overview.scale;
+	}
 	struct sway_scene *scene = scene_node_get_root(&scene_buffer->node);
 	struct sway_scene_output *scene_output;
 	wl_list_for_each(scene_output, &scene->outputs, link) {
@@ -1146,6 +1543,25 @@ void sway_scene_buffer_set_buffer(struct sway_scene_buffer *scene_buffer,
 	sway_scene_buffer_set_buffer_with_options(scene_buffer, buffer, NULL);
 }
 
+void sway_scene_buffer_set_texture(struct sway_scene_buffer *scene_buffer,
+		struct wlr_texture *texture) {
+	if (!scene_buffer->buffer && texture == scene_buffer->texture) {
+		return;
+	}
+
+	scene_buffer_set_buffer(scene_buffer, NULL);
+	scene_buffer_set_texture(scene_buffer, texture);
+	scene_buffer_set_wait_timeline(scene_buffer, NULL, 0);
+	scene_buffer->is_single_pixel_buffer = false;
+	if (texture) {
+		scene_buffer->borrowed_texture = true;
+		scene_buffer->buffer_width = texture->width;
+		scene_buffer->buffer_height = texture->height;
+	}
+
+	scene_node_update(&scene_buffer->node, NULL);
+}
+
 void sway_scene_buffer_set_opaque_region(struct sway_scene_buffer *scene_buffer,
 		const pixman_region32_t *region) {
 	if (pixman_region32_equal(&scene_buffer->opaque_region, region)) {
@@ -1280,6 +1696,12 @@ void scene_node_get_size(struct sway_scene_node *node,
 			*height = h;
 		}
 		break;
+	case SWAY_SCENE_NODE_DECORATION:;
+		struct sway_scene_decoration *decoration =
+			sway_scene_decoration_from_node(node);
+		*width = decoration->width;
+		*height = decoration->height;
+		break;
 	}
 }
 
@@ -1490,6 +1912,19 @@ static bool scene_node_at_iterator(struct sway_scene_node *node,
 				!scene_buffer->point_accepts_input(scene_buffer, &rx, &ry)) {
 			return false;
 		}
+	} else if (node->type == SWAY_SCENE_NODE_DECORATION) {
+		// Points inside a frame with no background belong to whatever it
+		// surrounds, e.g. the content of a container
+		pixman_region32_t input;
+		pixman_region32_init(&input);
+		scene_decoration_region(sway_scene_decoration_from_node(node),
+			0, 0, DECORATION_PARTS_INPUT, &input);
+		bool inside = pixman_region32_contains_point(&input,
+			floor(rx), floor(ry), NULL);
+		pixman_region32_fini(&input);
+		if (!inside) {
+			return false;
+		}
 	}
 
 	at_data->rx = rx;
@@ -1531,25 +1966,86 @@ struct render_list_entry {
 	double x, y;
 };
 
+// Converts an output-local logical box to the render buffer, through the
+// overview transform of the workspace the node is in (output-local as well)
+static struct wlr_box scene_entry_box(const struct render_data *data,
+		struct wlr_fbox box, const struct overview_transform *overview) {
+	if (overview) {
+		box.x = overview->x + box.x * overview->scale;
+		box.y = overview->y + box.y * overview->scale;
+		box.width *= overview->scale;
+		box.height *= overview->scale;
+	}
+	transform_output_box(&box, data);
+	if (data->thumbnail) {
+		// The thumbnail buffer starts at the corner of the mini-workspace
+		box.x -= data->thumbnail->layout.workspaces.x;
+		box.y -= data->thumbnail->layout.workspaces.y;
+	}
+
+	return (struct wlr_box){
+		.x = round(box.x),
+		.y = round(box.y),
+		.width = round(box.x + box.width) - round(box.x),
+		.height = round(box.y + box.height) - round(box.y)
+	};
+}
+
+static void render_pass_add_color_box(const struct render_data *data,
+		struct wlr_box box, const float color[static 4],
+		const pixman_region32_t *clip) {
+	if (wlr_box_empty(&box)) {
+		return;
+	}
+	wlr_render_pass_add_rect(data->render_pass, &(struct wlr_render_rect_options){
+		.box = box,
+		.color = {
+			.r = color[0],
+			.g = color[1],
+			.b = color[2],
+			.a = color[3],
+		},
+		.clip = clip,
+	});
+}
+
 static void scene_entry_render(struct render_list_entry *entry, const struct render_data *data) {
 	struct sway_scene_node *node = entry->node;
 
-	struct sway_workspace *workspace = scene_node_get_workspace(node);
-	double scale = workspace ? workspace->layout.workspaces.scale : 1.0;
-	double dx = workspace ? workspace->layout.workspaces.x : 0;
-	double dy = workspace ? workspace->layout.workspaces.y : 0;
+	double width, height;
+	scene_node_get_size(node, &width, &height);
+
+	// The visibility of nodes in the overview is already where they are
+	// drawn, only their boxes go through the transform
+	struct overview_transform transform = {0};
+	struct sway_workspace *workspace =
+		data->capture ? NULL : scene_node_overview_transform(node, &transform);
 
 	pixman_region32_t render_region;
 	pixman_region32_init(&render_region);
-	pixman_region32_copy(&render_region, &node->visible);
+	if (data->capture) {
+		pixman_region32_init_rect(&render_region, round(entry->x), round(entry->y),
+			round(entry->x + width) - round(entry->x),
+			round(entry->y + height) - round(entry->y));
+	} else if (data->thumbnail) {
+		// The thumbnail has the whole node, whatever covers it on the output
+		struct wlr_box box = overview_transform_box(&transform,
+			entry->x, entry->y, width, height, true);
+		pixman_region32_init_rect(&render_region, box.x, box.y, box.width, box.height);
+	} else {
+		pixman_region32_copy(&render_region, &node->visible);
+	}
 	pixman_region32_translate(&render_region, -data->logical.x, -data->logical.y);
 	logical_to_buffer_coords(&render_region, data, true);
 	if (workspace) {
-		scale_region(&render_region, scale, false);
-		pixman_region32_translate(&render_region, dx, dy);
 		// Clip against "mini-workspace"
-		pixman_region32_intersect_rect(&render_region, &render_region, dx, dy,
+		pixman_region32_intersect_rect(&render_region, &render_region,
+			workspace->layout.workspaces.x, workspace->layout.workspaces.y,
 			workspace->layout.workspaces.width, workspace->layout.workspaces.height);
+		if (data->thumbnail) {
+			pixman_region32_translate(&render_region,
+				-workspace->layout.workspaces.x, -workspace->layout.workspaces.y);
+		}
 	}
 	pixman_region32_intersect(&render_region, &render_region, &data->damage);
 	if (pixman_region32_empty(&render_region)) {
@@ -1562,35 +2058,33 @@ static void scene_entry_render(struct render_list_entry *entry, const struct ren
 	struct wlr_fbox dst_fbox = {
 		.x = x,
 		.y = y,
+		.width = width,
+		.height = height,
 	};
-	scene_node_get_size(node, &dst_fbox.width, &dst_fbox.height);
-	transform_output_box(&dst_fbox, data);
 
 	pixman_region32_t opaque;
 	pixman_region32_init(&opaque);
-	scene_node_opaque_region(node, x, y, &opaque);
-	logical_to_buffer_coords(&opaque, data, false);
+	const struct overview_transform *overview = NULL;
+	struct overview_transform local;
 	if (workspace) {
-		scale_region(&opaque, scale, false);
-		pixman_region32_translate(&opaque, dx, dy);
-		pixman_region32_intersect_rect(&opaque, &opaque, dx, dy,
-			workspace->layout.workspaces.width, workspace->layout.workspaces.height);
+		scene_node_overview_opaque_region(node, &transform, entry->x, entry->y, &opaque);
+		pixman_region32_translate(&opaque, -data->logical.x, -data->logical.y);
+		// The same transform, from and to output-local coordinates
+		local = transform;
+		local.x += data->logical.x * (transform.scale - 1);
+		local.y += data->logical.y * (transform.scale - 1);
+		overview = &local;
+	} else {
+		scene_node_opaque_region(node, x, y, &opaque);
 	}
-	pixman_region32_subtract(&opaque, &render_region, &opaque);
-
-	if (workspace) {
-		dst_fbox.x = ceil(dst_fbox.x * scale + dx);
-		dst_fbox.y = ceil(dst_fbox.y * scale + dy);
-		dst_fbox.width = ceil(dst_fbox.width * scale);
-		dst_fbox.height = ceil(dst_fbox.height * scale);
+	logical_to_buffer_coords(&opaque, data, false);
+	if (data->thumbnail) {
+		pixman_region32_translate(&opaque, -data->thumbnail->layout.workspaces.x,
+			-data->thumbnail->layout.workspaces.y);
 	}
+	pixman_region32_subtract(&opaque, &render_region, &opaque);
 
-	struct wlr_box dst_box = {
-		.x = round(dst_fbox.x),
-		.y = round(dst_fbox.y),
-		.width = round(dst_fbox.x + dst_fbox.width) - round(dst_fbox.x),
-		.height = round(dst_fbox.y + dst_fbox.height) - round(dst_fbox.y)
-	};
+	struct wlr_box dst_box = scene_entry_box(data, dst_fbox, overview);
 
 	switch (node->type) {
 	case SWAY_SCENE_NODE_TREE:
@@ -1610,6 +2104,57 @@ static void scene_entry_render(struct render_list_entry *entry, const struct ren
 			.clip = &render_region,
 		});
 		break;
+	case SWAY_SCENE_NODE_DECORATION:;
+		struct sway_scene_decoration *decoration = sway_scene_decoration_from_node(node);
+		struct wlr_fbox parts[SWAY_SCENE_DECORATION_SIDES + 1];
+		scene_decoration_boxes(decoration, parts);
+
+		for (int i = 0; i < SWAY_SCENE_DECORATION_SIDES; i++) {
+			if (decoration->border_color[i][3] == 0.f) {
+				continue;
+			}
+			struct wlr_fbox part = parts[i];
+			part.x += x;
+			part.y += y;
+			render_pass_add_color_box(data,
+				scene_entry_box(data, part, overview),
+				decoration->border_color[i], &render_region);
+		}
+
+		struct wlr_fbox *inner = &parts[SWAY_SCENE_DECORATION_SIDES];
+		if (decoration->background[3] == 0.f || inner->width <= 0 || inner->height <= 0) {
+			break;
+		}
+		if (pixman_region32_empty(&decoration->holes)) {
+			struct wlr_fbox part = *inner;
+			part.x += x;
+			part.y += y;
+			render_pass_add_color_box(data,
+				scene_entry_box(data, part, overview),
+				decoration->background, &render_region);
+			break;
+		}
+
+		pixman_region32_t background;
+		pixman_region32_init_rect(&background, round(inner->x), round(inner->y),
+			round(inner->x + inner->width) - round(inner->x),
+			round(inner->y + inner->height) - round(inner->y));
+		pixman_region32_subtract(&background, &background, &decoration->holes);
+		int nrects;
+		const pixman_box32_t *rects = pixman_region32_rectangles(&background, &nrects);
+		for (int i = 0; i < nrects; i++) {
+			struct wlr_fbox part = {
+				.x = x + rects[i].x1,
+				.y = y + rects[i].y1,
+				.width = rects[i].x2 - rects[i].x1,
+				.height = rects[i].y2 - rects[i].y1,
+			};
+			render_pass_add_color_box(data,
+				scene_entry_box(data, part, overview),
+				decoration->background, &render_region);
+		}
+		pixman_region32_fini(&background);
+		break;
 	case SWAY_SCENE_NODE_BUFFER:;
 		struct sway_scene_buffer *scene_buffer = sway_scene_buffer_from_node(node);
 
@@ -1632,7 +2177,9 @@ static void scene_entry_render(struct render_list_entry *entry, const struct ren
 		struct wlr_texture *texture = scene_buffer_get_texture(scene_buffer,
 			data->output->output->renderer);
 		if (texture == NULL) {
-			scene_output_damage(data->output, &render_region);
+			if (!data->capture) {
+				scene_output_damage(data->output, &render_region);
+			}
 			break;
 		}
 
@@ -1655,11 +2202,13 @@ static void scene_entry_render(struct render_list_entry *entry, const struct ren
 			.wait_point = scene_buffer->wait_point,
 		});
 
-		struct sway_scene_output_sample_event sample_event = {
-			.output = data->output,
-			.direct_scanout = false,
-		};
-		wl_signal_emit_mutable(&scene_buffer->events.output_sample, &sample_event);
+		if (!data->capture) {
+			struct sway_scene_output_sample_event sample_event = {
+				.output = data->output,
+				.direct_scanout = false,
+			};
+			wl_signal_emit_mutable(&scene_buffer->events.output_sample, &sample_event);
+		}
 
 		if (entry->highlight_transparent_region) {
 			wlr_render_pass_add_rect(data->render_pass, &(struct wlr_render_rect_options){
@@ -1676,6 +2225,165 @@ static void scene_entry_render(struct render_list_entry *entry, const struct ren
 	pixman_region32_fini(&render_region);
 }
 
+// Creates a buffer to render into off screen
+static struct wlr_buffer *offscreen_buffer_create(struct wlr_output *output,
+		int width, int height) {
+	if (width <= 0 || height <= 0) {
+		return NULL;
+	}
+	// Offscreen buffers are only ever sampled, the implicit modifier will do
+	struct wlr_drm_format_set formats = {0};
+	if (!wlr_drm_format_set_add(&formats, DRM_FORMAT_ARGB8888,
+			DRM_FORMAT_MOD_INVALID)) {
+		return NULL;
+	}
+	struct wlr_buffer *buffer = wlr_allocator_create_buffer(output->allocator,
+		width, height, wlr_drm_format_set_get(&formats, DRM_FORMAT_ARGB8888));
+	wlr_drm_format_set_finish(&formats);
+	return buffer;
+}
+
+// In the workspaces overview, only the active workspace of each output is
+// rendered live. The others are rendered into a thumbnail the size of their
+// mini-workspace, redrawn only when something in them was damaged.
+static bool overview_thumbnail_cached(struct sway_workspace *workspace,
+		struct sway_scene_output *scene_output) {
+	return workspace->output &&
+		workspace->output->wlr_output == scene_output->output &&
+		workspace != workspace->output->current.active_workspace;
+}
+
+static bool overview_thumbnail_ensure(struct sway_workspace *workspace,
+		struct wlr_output *output) {
+	int width = workspace->layout.workspaces.width;
+	int height = workspace->layout.workspaces.height;
+	struct wlr_buffer *buffer = workspace->layout.workspaces.thumbnail;
+	if (buffer && buffer->width == width && buffer->height == height) {
+		return true;
+	}
+	layout_overview_thumbnail_release(workspace);
+	workspace->layout.workspaces.thumbnail =
+		offscreen_buffer_create(output, width, height);
+	return workspace->layout.workspaces.thumbnail != NULL;
+}
+
+static void overview_thumbnail_render(struct sway_workspace *workspace,
+		const struct render_data *output_data,
+		struct render_list_entry *list_data, int list_len) {
+	struct wlr_output *output = output_data->output->output;
+	if (!overview_thumbnail_ensure(workspace, output)) {
+		return;
+	}
+	struct wlr_buffer *buffer = workspace->layout.workspaces.thumbnail;
+	struct wlr_render_pass *render_pass =
+		wlr_renderer_begin_buffer_pass(output->renderer, buffer, NULL);
+	if (!render_pass) {
+		layout_overview_thumbnail_release(workspace);
+		return;
+	}
+
+	struct render_data data = *output_data;
+	data.render_pass = render_pass;
+	data.thumbnail = workspace;
+	pixman_region32_init_rect(&data.damage, 0, 0, buffer->width, buffer->height);
+
+	wlr_render_pass_add_rect(render_pass, &(struct wlr_render_rect_options){
+		.box = { .width = buffer->width, .height = buffer->height },
+		.color = { .r = 0, .g = 0, .b = 0, .a = 0 },
+		.blend_mode = WLR_RENDER_BLEND_MODE_NONE,
+	});
+	for (int i = list_len - 1; i >= 0; i--) {
+		struct render_list_entry *entry = &list_data[i];
+		if (scene_node_get_workspace(entry->node) == workspace) {
+			scene_entry_render(entry, &data);
+		}
+	}
+	pixman_region32_fini(&data.damage);
+
+	bool rendered = wlr_render_pass_submit(render_pass);
+	if (workspace->layout.workspaces.thumbnail_texture) {
+		wlr_texture_destroy(workspace->layout.workspaces.thumbnail_texture);
+		workspace->layout.workspaces.thumbnail_texture = NULL;
+	}
+	if (!rendered) {
+		layout_overview_thumbnail_release(workspace);
+		return;
+	}
+	workspace->layout.workspaces.thumbnail_texture =
+		wlr_texture_from_buffer(output->renderer, buffer);
+	workspace->layout.workspaces.thumbnail_dirty = false;
+}
+
+// Damage the mini-workspaces whose thumbnail is going to be redrawn. Must be
+// called before the output damage is used.
+static void overview_thumbnails_damage(struct sway_scene_output *scene_output) {
+	struct sway_output *output = scene_output->output->data;
+	if (!output) {
+		return;
+	}
+	for (int i = 0; i < output->current.workspaces->length; ++i) {
+		struct sway_workspace *workspace = output->current.workspaces->items[i];
+		workspace->layout.workspaces.thumbnail_drawn = false;
+		if (!overview_thumbnail_cached(workspace, scene_output)) {
+			// Rendered live, so its thumbnail is stale by the time it is used
+			workspace->layout.workspaces.thumbnail_dirty = true;
+			continue;
+		}
+		if (workspace->layout.workspaces.thumbnail_dirty ||
+				!workspace->layout.workspaces.thumbnail_texture) {
+			pixman_region32_t damage;
+			pixman_region32_init_rect(&damage,
+				workspace->layout.workspaces.x, workspace->layout.workspaces.y,
+				workspace->layout.workspaces.width, workspace->layout.workspaces.height);
+			scene_output_damage(scene_output, &damage);
+			pixman_region32_fini(&damage);
+		}
+	}
+}
+
+// Redraw the thumbnails that need it. Must be called outside of the output
+// render pass.
+static void overview_thumbnails_render(struct sway_scene_output *scene_output,
+		const struct render_data *data, struct render_list_entry *list_data,
+		int list_len) {
+	struct sway_output *output = scene_output->output->data;
+	if (!output) {
+		return;
+	}
+	for (int i = 0; i < output->current.workspaces->length; ++i) {
+		struct sway_workspace *workspace = output->current.workspaces->items[i];
+		if (overview_thumbnail_cached(workspace, scene_output) &&
+				(workspace->layout.workspaces.thumbnail_dirty ||
+				!workspace->layout.workspaces.thumbnail_texture)) {
+			overview_thumbnail_render(workspace, data, list_data, list_len);
+		}
+	}
+}
+
+static void overview_thumbnail_draw(struct sway_workspace *workspace,
+		const struct render_data *data) {
+	struct wlr_texture *texture = workspace->layout.workspaces.thumbnail_texture;
+	struct wlr_box box = {
+		.x = workspace->layout.workspaces.x,
+		.y = workspace->layout.workspaces.y,
+		.width = texture->width,
+		.height = texture->height,
+	};
+	pixman_region32_t clip;
+	pixman_region32_init_rect(&clip, box.x, box.y, box.width, box.height);
+	pixman_region32_intersect(&clip, &clip, &data->damage);
+	if (!pixman_region32_empty(&clip)) {
+		wlr_render_pass_add_texture(data->render_pass, &(struct wlr_render_texture_options) {
+			.texture = texture,
+			.dst_box = box,
+			.clip = &clip,
+			.blend_mode = WLR_RENDER_BLEND_MODE_PREMULTIPLIED,
+		});
+	}
+	pixman_region32_fini(&clip);
+	workspace->layout.workspaces.thumbnail_drawn = true;
+}
+
 static void scene_handle_linux_dmabuf_v1_destroy(struct wl_listener *listener,
 		void *data) {
 	struct sway_scene *scene =
@@ -1966,6 +2674,16 @@ static bool scene_node_invisible(struct sway_scene_node *node) {
 		struct sway_scene_buffer *buffer = sway_scene_buffer_from_node(node);
 
 		return buffer->buffer == NULL && buffer->texture == NULL;
+	} else if (node->type == SWAY_SCENE_NODE_DECORATION) {
+		struct sway_scene_decoration *decoration =
+			sway_scene_decoration_from_node(node);
+		for (int i = 0; i < SWAY_SCENE_DECORATION_SIDES; i++) {
+			if (decoration->border[i] > 0 &&
+					decoration->border_color[i][3] != 0.f) {
+				return false;
+			}
+		}
+		return decoration->background[3] == 0.f;
 	}
 
 	return false;
@@ -2047,6 +2765,86 @@ static bool construct_render_list_iterator(struct sway_scene_node *node,
 	return false;
 }
 
+static bool capture_list_iterator(struct sway_scene_node *node,
+		double lx, double ly, void *data) {
+	struct wl_array *render_list = data;
+	if (scene_node_invisible(node)) {
+		return false;
+	}
+	struct render_list_entry *entry = wl_array_add(render_list, sizeof(*entry));
+	if (entry) {
+		*entry = (struct render_list_entry){ .node = node, .x = lx, .y = ly };
+	}
+	return false;
+}
+
+struct wlr_buffer *sway_scene_output_capture(struct sway_scene_output *scene_output,
+		struct sway_scene_tree **trees, size_t trees_len) {
+	struct wlr_output *output = scene_output->output;
+	int width, height;
+	wlr_output_transformed_resolution(output, &width, &height);
+	struct render_data data = {
+		.transform = WL_OUTPUT_TRANSFORM_NORMAL,
+		.scale = output->scale,
+		.logical = {
+			.x = scene_output->x,
+			.y = scene_output->y,
+			.width = width / output->scale,
+			.height = height / output->scale,
+		},
+		.trans_width = width,
+		.trans_height = height,
+		.output = scene_output,
+		.capture = true,
+	};
+
+	// Topmost first, like the output render list. The trees themselves may
+	// be disabled, what is enabled below them is captured.
+	struct wl_array render_list;
+	wl_array_init(&render_list);
+	for (size_t i = trees_len; i-- > 0;) {
+		double x, y;
+		sway_scene_node_coords(&trees[i]->node, &x, &y);
+		struct sway_scene_node *child;
+		wl_list_for_each_reverse(child, &trees[i]->children, link) {
+			_scene_nodes_in_box(child, &data.logical, capture_list_iterator,
+				&render_list, x + child->x, y + child->y);
+		}
+	}
+
+	struct wlr_buffer *buffer = offscreen_buffer_create(output, width, height);
+	struct wlr_render_pass *render_pass = buffer ?
+		wlr_renderer_begin_buffer_pass(output->renderer, buffer, NULL) : NULL;
+	if (!render_pass) {
+		if (buffer) {
+			wlr_buffer_drop(buffer);
+		}
+		wl_array_release(&render_list);
+		return NULL;
+	}
+	data.render_pass = render_pass;
+	pixman_region32_init_rect(&data.damage, 0, 0, width, height);
+
+	wlr_render_pass_add_rect(render_pass, &(struct wlr_render_rect_options){
+		.box = { .width = width, .height = height },
+		.color = { .r = 0, .g = 0, .b = 0, .a = 0 },
+		.blend_mode = WLR_RENDER_BLEND_MODE_NONE,
+	});
+	struct render_list_entry *list_data = render_list.data;
+	int list_len = render_list.size / sizeof(*list_data);
+	for (int i = list_len - 1; i >= 0; i--) {
+		scene_entry_render(&list_data[i], &data);
+	}
+	pixman_region32_fini(&data.damage);
+	wl_array_release(&render_list);
+
+	if (!wlr_render_pass_submit(render_pass)) {
+		wlr_buffer_drop(buffer);
+		return NULL;
+	}
+	return buffer;
+}
+
 static void scene_buffer_send_dmabuf_feedback(const struct sway_scene *scene,
 		struct sway_scene_buffer *scene_buffer,
 		const struct wlr_linux_dmabuf_feedback_v1_init_options *options) {
@@ -2332,6 +3130,11 @@ bool sway_scene_output_build_state(struct sway_scene_output *scene_output,
 	struct render_list_entry *list_data = list_con.render_list->data;
 	int list_len = list_con.render_list->size / sizeof(*list_data);
 
+	bool overview = layout_overview_workspaces_enabled();
+	if (overview) {
+		overview_thumbnails_damage(scene_output);
+	}
+
 	if (debug_damage == SWAY_SCENE_DEBUG_DAMAGE_RERENDER) {
 		scene_output_damage_whole(scene_output);
 	}
@@ -2441,6 +3244,10 @@ bool sway_scene_output_build_state(struct sway_scene_output *scene_output,
 		timer->pre_render_duration = timespec_to_nsec(&duration);
 	}
 
+	if (overview) {
+		overview_thumbnails_render(scene_output, &render_data, list_data, list_len);
+	}
+
 	scene_output->in_point++;
 	struct wlr_render_pass *render_pass = wlr_renderer_begin_buffer_pass(output->renderer, buffer,
 			&(struct wlr_buffer_pass_options){
@@ -2471,31 +3278,26 @@ bool sway_scene_output_build_state(struct sway_scene_output *scene_output,
 		for (int i = list_len - 1; i >= 0; i--) {
 			struct render_list_entry *entry = &list_data[i];
 
-			if (layout_overview_workspaces_enabled() && scene_node_get_background(entry->node)) {
-				// If we are in workspaces overview and the node is the wallpaper
-				// (layer_shell ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND), we want to
-				// reset the calculated visibility to avoid having remains of the
-				// un-scaled nodes that are part of the workspace.
-				pixman_region32_fini(&entry->node->visible);
-				pixman_region32_init_rect(&entry->node->visible, render_data.logical.x,
-					render_data.logical.y, render_data.logical.width, render_data.logical.height);
-			}
-			if (!layout_overview_workspaces_enabled()) {
-				// We must only cull opaque regions that are visible by the node.
-				// The node's visibility will have the knowledge of a black rect
-				// that may have been omitted from the render list via the black
-				// rect optimization. In order to ensure we don't cull background
-				// rendering in that black rect region, consider the node's visibility.
-				pixman_region32_t opaque;
-				pixman_region32_init(&opaque);
+			// We must only cull opaque regions that are visible by the node.
+			// The node's visibility will have the knowledge of a black rect
+			// that may have been omitted from the render list via the black
+			// rect optimization. In order to ensure we don't cull background
+			// rendering in that black rect region, consider the node's visibility.
+			pixman_region32_t opaque;
+			pixman_region32_init(&opaque);
+			struct overview_transform transform;
+			if (overview && scene_node_overview_transform(entry->node, &transform)) {
+				scene_node_overview_opaque_region(entry->node, &transform,
+					entry->x, entry->y, &opaque);
+			} else {
 				scene_node_opaque_region(entry->node, entry->x, entry->y, &opaque);
-				pixman_region32_intersect(&opaque, &opaque, &entry->node->visible);
-
-				pixman_region32_translate(&opaque, -scene_output->x, -scene_output->y);
-				logical_to_buffer_coords(&opaque, &render_data, false);
-				pixman_region32_subtract(&background, &background, &opaque);
-				pixman_region32_fini(&opaque);
 			}
+			pixman_region32_intersect(&opaque, &opaque, &entry->node->visible);
+
+			pixman_region32_translate(&opaque, -scene_output->x, -scene_output->y);
+			logical_to_buffer_coords(&opaque, &render_data, false);
+			pixman_region32_subtract(&background, &background, &opaque);
+			pixman_region32_fini(&opaque);
 		}
 
 		if (floor(render_data.scale) != render_data.scale) {
@@ -2516,11 +3318,32 @@ bool sway_scene_output_build_state(struct sway_scene_output *scene_output,
 
 	for (int i = list_len - 1; i >= 0; i--) {
 		struct render_list_entry *entry = &list_data[i];
-		scene_entry_render(entry, &render_data);
+		struct sway_workspace *workspace = overview ?
+			scene_node_get_workspace(entry->node) : NULL;
+		bool thumbnail = workspace &&
+			workspace->layout.workspaces.thumbnail_texture &&
+			overview_thumbnail_cached(workspace, scene_output);
+		if (thumbnail) {
+			if (!workspace->layout.workspaces.thumbnail_drawn) {
+				overview_thumbnail_draw(workspace, &render_data);
+			}
+		} else {
+			scene_entry_render(entry, &render_data);
+		}
 
 		if (entry->node->type == SWAY_SCENE_NODE_BUFFER) {
 			struct sway_scene_buffer *buffer = sway_scene_buffer_from_node(entry->node);
 
+			// The thumbnail stands in for the buffer, so clients still
+			// need to hear that they were presented on this output
+			if (thumbnail && !render_data.capture) {
+				struct sway_scene_output_sample_event sample_event = {
+					.output = scene_output,
+					.direct_scanout = false,
+				};
+				wl_signal_emit_mutable(&buffer->events.output_sample, &sample_event);
+			}
+
 			// Direct scanout counts up to DMABUF_FEEDBACK_DEBOUNCE_FRAMES before sending new dmabuf
 			// feedback, and on composition we wait until it hits zero again. If we knew that an
 			// entry could never be a scanout candidate, we could send feedback to it
@@ -1,29 +1,51 @@
+#include <json.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sway/config.h"
 #include "sway/tree/space.h"
 #include "sway/tree/workspace.h"
 #include "sway/tree/layout.h"
+#include "log.h"
+#include "util.h"
+
+static char *strdup_or_null(const char *str) {
+	return str ? strdup(str) : NULL;
+}
 
 static struct sway_space_view *space_view_create(struct sway_view *sway_view,
 		struct sway_space_container *container, float content_scale) {
-	struct sway_space_view *view = malloc(sizeof(struct sway_space_view));
+	struct sway_space_view *view = calloc(1, sizeof(struct sway_space_view));
 	view->view = sway_view;
 	view->container = container;
 	view->content_scale = content_scale;
+	if (sway_view) {
+		view->app_id = strdup_or_null(view_get_app_id(sway_view));
+		view->class = strdup_or_null(view_get_class(sway_view));
+		view->title = strdup_or_null(view_get_title(sway_view));
+	}
 	return view;
 }
 
 static void space_view_destroy(struct sway_space_view *view) {
+	free(view->app_id);
+	free(view->class);
+	free(view->title);
 	free(view);
 }
 
 static struct sway_space_container *space_container_create(struct sway_container *container,
-			struct sway_container *focused, struct sway_space *space) {
+			struct sway_container *focused, struct sway_space *space,
+			struct sway_space_container *parent) {
 	struct sway_space_container *space_container = malloc(sizeof(struct sway_space_container));
+	space_container->parent = parent;
 	if (container->pending.children) {
 		space_container->children = create_list();
 		space_container->focused_inactive = NULL;
 		for (int i = 0; i < container->pending.children->length; ++i) {
 			struct sway_container *con = container->pending.children->items[i];
-			struct sway_space_container *space_con = space_container_create(con, focused, space);
+			struct sway_space_container *space_con = space_container_create(con, focused, space,
+				space_container);
 			if (con == container->current.focused_inactive_child) {
 				space_container->focused_inactive = space_con;
 			}
@@ -66,7 +88,7 @@ static void space_container_destroy(struct sway_space_container *container) {
 }
 
 static struct sway_space *space_create(const char *name) {
-	struct sway_space *space = malloc(sizeof(struct sway_space));
+	struct sway_space *space = calloc(1, sizeof(struct sway_space));
 	space->name = strdup(name);
 	space->tiling = create_list();
 	space->floating = create_list();
@@ -80,6 +102,7 @@ static void space_destroy(struct sway_space *space) {
 		list_del(root->spaces, idx);
 	}
 	free(space->name);
+	free(space->workspace);
 	for (int i = 0; i < space->tiling->length; ++i) {
 		struct sway_space_container *con = space->tiling->items[i];
 		space_container_destroy(con);
@@ -103,6 +126,212 @@ static struct sway_space *find_space(const char *name) {
 	return NULL;
 }
 
+// On disk, a space is a JSON object; containers keep their geometry and
+// views only the criteria used to find them again after a restart.
+static json_object *space_container_to_json(struct sway_space_container *container,
+		struct sway_space *space) {
+	json_object *obj = json_object_new_object();
+	json_object_object_add(obj, "layout", json_object_new_int(container->layout));
+	json_object_object_add(obj, "width_fraction",
+		json_object_new_double(container->width_fraction));
+	json_object_object_add(obj, "height_fraction",
+		json_object_new_double(container->height_fraction));
+	json_object_object_add(obj, "x", json_object_new_double(container->x));
+	json_object_object_add(obj, "y", json_object_new_double(container->y));
+	json_object_object_add(obj, "width", json_object_new_double(container->width));
+	json_object_object_add(obj, "height", json_object_new_double(container->height));
+	if (container == space->focused) {
+		json_object_object_add(obj, "focused", json_object_new_boolean(true));
+	}
+	if (container->children) {
+		json_object *children = json_object_new_array();
+		for (int i = 0; i < container->children->length; ++i) {
+			struct sway_space_container *con = container->children->items[i];
+			json_object_array_add(children, space_container_to_json(con, space));
+			if (con == container->focused_inactive) {
+				json_object_object_add(obj, "focused_inactive", json_object_new_int(i));
+			}
+		}
+		json_object_object_add(obj, "children", children);
+	}
+	if (container->view) {
+		struct sway_space_view *view = container->view;
+		json_object *json_view = json_object_new_object();
+		if (view->app_id) {
+			json_object_object_add(json_view, "app_id",
+				json_object_new_string(view->app_id));
+		}
+		if (view->class) {
+			json_object_object_add(json_view, "class",
+				json_object_new_string(view->class));
+		}
+		if (view->title) {
+			json_object_object_add(json_view, "title",
+				json_object_new_string(view->title));
+		}
+		json_object_object_add(json_view, "content_scale",
+			json_object_new_double(view->content_scale));
+		json_object_object_add(obj, "view", json_view);
+	}
+	return obj;
+}
+
+static json_object *space_to_json(struct sway_space *space) {
+	json_object *obj = json_object_new_object();
+	json_object_object_add(obj, "name", json_object_new_string(space->name));
+	if (space->workspace) {
+		json_object_object_add(obj, "workspace",
+			json_object_new_string(space->workspace));
+	}
+	json_object *tiling = json_object_new_array();
+	for (int i = 0; i < space->tiling->length; ++i) {
+		json_object_array_add(tiling,
+			space_container_to_json(space->tiling->items[i], space));
+	}
+	json_object_object_add(obj, "tiling", tiling);
+	json_object *floating = json_object_new_array();
+	for (int i = 0; i < space->floating->length; ++i) {
+		json_object_array_add(floating,
+			space_container_to_json(space->floating->items[i], space));
+	}
+	json_object_object_add(obj, "floating", floating);
+	return obj;
+}
+
+static double json_get_double(json_object *obj, const char *key, double def) {
+	json_object *value;
+	return json_object_object_get_ex(obj, key, &value) ?
+		json_object_get_double(value) : def;
+}
+
+static char *json_get_string(json_object *obj, const char *key) {
+	json_object *value;
+	if (!json_object_object_get_ex(obj, key, &value) ||
+			!json_object_is_type(value, json_type_string)) {
+		return NULL;
+	}
+	return strdup(json_object_get_string(value));
+}
+
+static struct sway_space_container *space_container_from_json(json_object *obj,
+		struct sway_space *space, struct sway_space_container *parent) {
+	json_object *children, *json_view, *value;
+	bool has_children = json_object_object_get_ex(obj, "children", &children) &&
+		json_object_is_type(children, json_type_array);
+	bool has_view = json_object_object_get_ex(obj, "view", &json_view) &&
+		json_object_is_type(json_view, json_type_object);
+	if (!has_children && !has_view) {
+		return NULL;
+	}
+
+	struct sway_space_container *container = calloc(1, sizeof(struct sway_space_container));
+	container->parent = parent;
+	container->layout = json_object_object_get_ex(obj, "layout", &value) ?
+		json_object_get_int(value) : L_NONE;
+	container->width_fraction = json_get_double(obj, "width_fraction", 0.0);
+	container->height_fraction = json_get_double(obj, "height_fraction", 0.0);
+	container->x = json_get_double(obj, "x", 0.0);
+	container->y = json_get_double(obj, "y", 0.0);
+	container->width = json_get_double(obj, "width", 0.0);
+	container->height = json_get_double(obj, "height", 0.0);
+	if (json_object_object_get_ex(obj, "focused", &value) &&
+			json_object_get_boolean(value)) {
+		space->focused = container;
+	}
+	if (has_children) {
+		container->children = create_list();
+		int focused_inactive = json_object_object_get_ex(obj, "focused_inactive", &value) ?
+			json_object_get_int(value) : -1;
+		size_t length = json_object_array_length(children);
+		for (size_t i = 0; i < length; ++i) {
+			struct sway_space_container *con = space_container_from_json(
+				json_object_array_get_idx(children, i), space, container);
+			if (!con) {
+				continue;
+			}
+			if ((int)i == focused_inactive) {
+				container->focused_inactive = con;
+			}
+			list_add(container->children, con);
+		}
+	}
+	if (has_view) {
+		struct sway_space_view *view = space_view_create(NULL, container,
+			json_get_double(json_view, "content_scale", 1.0));
+		view->app_id = json_get_string(json_view, "app_id");
+		view->class = json_get_string(json_view, "class");
+		view->title = json_get_string(json_view, "title");
+		container->view = view;
+	}
+	return container;
+}
+
+static void space_list_from_json(json_object *array, struct sway_space *space,
+		list_t *list) {
+	if (!array || !json_object_is_type(array, json_type_array)) {
+		return;
+	}
+	size_t length = json_object_array_length(array);
+	for (size_t i = 0; i < length; ++i) {
+		struct sway_space_container *con = space_container_from_json(
+			json_object_array_get_idx(array, i), space, NULL);
+		if (con) {
+			list_add(list, con);
+		}
+	}
+}
+
+static void space_write_file(const char *path) {
+	json_object *obj = json_object_new_object();
+	json_object *spaces = json_object_new_array();
+	for (int i = 0; i < root->spaces->length; ++i) {
+		json_object_array_add(spaces, space_to_json(root->spaces->items[i]));
+	}
+	json_object_object_add(obj, "spaces", spaces);
+
+	size_t len;
+	const char *data = json_object_to_json_string_length(obj,
+		JSON_C_TO_STRING_PLAIN, &len);
+	write_file_atomic(path, data, len);
+	json_object_put(obj);
+}
+
+void space_read_file(const char *path) {
+	json_object *obj = json_object_from_file(path);
+	if (!obj) {
+		sway_log(SWAY_DEBUG, "No spaces read from %s", path);
+		return;
+	}
+	json_object *spaces;
+	if (!json_object_object_get_ex(obj, "spaces", &spaces) ||
+			!json_object_is_type(spaces, json_type_array)) {
+		sway_log(SWAY_ERROR, "Invalid spaces file %s", path);
+		json_object_put(obj);
+		return;
+	}
+	size_t length = json_object_array_length(spaces);
+	for (size_t i = 0; i < length; ++i) {
+		json_object *json_space = json_object_array_get_idx(spaces, i);
+		json_object *value;
+		if (!json_object_object_get_ex(json_space, "name", &value) ||
+				!json_object_is_type(value, json_type_string)) {
+			continue;
+		}
+		const char *name = json_object_get_string(value);
+		if (find_space(name)) {
+			continue;
+		}
+		struct sway_space *space = space_create(name);
+		space->workspace = json_get_string(json_space, "workspace");
+		json_object *tiling = NULL, *floating = NULL;
+		json_object_object_get_ex(json_space, "tiling", &tiling);
+		json_object_object_get_ex(json_space, "floating", &floating);
+		space_list_from_json(tiling, space, space->tiling);
+		space_list_from_json(floating, space, space->floating);
+	}
+	json_object_put(obj);
+}
+
 // Save the current workspace configuration into a space with name
 void space_save(struct sway_workspace *workspace, const char *name) {
 	struct sway_space *space = find_space(name);
@@ -110,6 +339,7 @@ void space_save(struct sway_workspace *workspace, const char *name) {
 		space_destroy(space);
 	}
 	space = space_create(name);
+	space->workspace = strdup(workspace->name);
 
 	struct sway_seat *seat = input_manager_current_seat();
 	struct sway_container *focused = seat_get_focused_container(seat);
@@ -119,17 +349,138 @@ void space_save(struct sway_workspace *workspace, const char *name) {
 
 	for (int i = 0; i < workspace->tiling->length; ++i) {
 		struct sway_container *container = workspace->tiling->items[i];
-		struct sway_space_container *space_container = space_container_create(container, focused, space);
+		struct sway_space_container *space_container = space_container_create(container, focused,
+			space, NULL);
 		list_add(space->tiling, space_container);
 	}
 	for (int i = 0; i < workspace->floating->length; ++i) {
 		struct sway_container *container = workspace->floating->items[i];
-		struct sway_space_container *space_container = space_container_create(container, focused, space);
+		struct sway_space_container *space_container = space_container_create(container, focused,
+			space, NULL);
 		list_add(space->floating, space_container);
 		if (container == focused) {
 			space->focused = space_container;
 		}
 	}
+
+	if (config->space_file) {
+		space_write_file(config->space_file);
+	}
+}
+
+static bool space_view_matches(struct sway_space_view *space_view,
+		struct sway_view *view, bool match_title) {
+	if (!space_view->app_id && !space_view->class) {
+		return false;
+	}
+	const char *app_id = view_get_app_id(view);
+	if (space_view->app_id && (!app_id || strcmp(space_view->app_id, app_id) != 0)) {
+		return false;
+	}
+	const char *class = view_get_class(view);
+	if (space_view->class && (!class || strcmp(space_view->class, class) != 0)) {
+		return false;
+	}
+	if (match_title) {
+		const char *title = view_get_title(view);
+		return space_view->title && title && strcmp(space_view->title, title) == 0;
+	}
+	return true;
+}
+
+static struct sway_space_view *container_find_free(struct sway_space_container *container,
+		struct sway_view *view, bool match_title) {
+	if (container->children) {
+		for (int i = 0; i < container->children->length; ++i) {
+			struct sway_space_view *space_view = container_find_free(
+				container->children->items[i], view, match_title);
+			if (space_view) {
+				return space_view;
+			}
+		}
+	} else if (container->view && !container->view->view &&
+			space_view_matches(container->view, view, match_title)) {
+		return container->view;
+	}
+	return NULL;
+}
+
+// Find a view in the space that is not matched yet and fits view, preferring
+// the ones with the same title
+static struct sway_space_view *space_find_free(struct sway_space *space,
+		struct sway_view *view) {
+	for (int pass = 0; pass < 2; ++pass) {
+		bool match_title = pass == 0;
+		for (int i = 0; i < space->tiling->length; ++i) {
+			struct sway_space_view *space_view = container_find_free(
+				space->tiling->items[i], view, match_title);
+			if (space_view) {
+				return space_view;
+			}
+		}
+		for (int i = 0; i < space->floating->length; ++i) {
+			struct sway_space_view *space_view = container_find_free(
+				space->floating->items[i], view, match_title);
+			if (space_view) {
+				return space_view;
+			}
+		}
+	}
+	return NULL;
+}
+
+static bool container_has_view(struct sway_space_container *container,
+		struct sway_view *view, bool unmatched) {
+	if (container->children) {
+		for (int i = 0; i < container->children->length; ++i) {
+			if (container_has_view(container->children->items[i], view, unmatched)) {
+				return true;
+			}
+		}
+		return false;
+	}
+	if (!container->view) {
+		return false;
+	}
+	return unmatched ? container->view->view == NULL : container->view->view == view;
+}
+
+// Whether view is in the space or, if view is NULL, if any view of the space
+// is not matched yet
+static bool space_has_view(struct sway_space *space, struct sway_view *view) {
+	for (int i = 0; i < space->tiling->length; ++i) {
+		if (container_has_view(space->tiling->items[i], view, view == NULL)) {
+			return true;
+		}
+	}
+	for (int i = 0; i < space->floating->length; ++i) {
+		if (container_has_view(space->floating->items[i], view, view == NULL)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// How long after loading a space views that map are still placed into it
+#define SPACE_PENDING_MSEC 10000
+
+// Whether views that map now are placed into space
+static bool space_update_pending(struct sway_space *space) {
+	space->pending = space->pending &&
+		get_current_time_msec() < space->pending_until &&
+		space_has_view(space, NULL);
+	return space->pending;
+}
+
+static void claim_mapped_view(struct sway_container *container, void *data) {
+	struct sway_space *space = data;
+	if (!container->view || space_has_view(space, container->view)) {
+		return;
+	}
+	struct sway_space_view *space_view = space_find_free(space, container->view);
+	if (space_view) {
+		space_view->view = container->view;
+	}
 }
 
 // Load the space with name into the current workspace.
@@ -140,5 +491,61 @@ void space_load(struct sway_workspace *workspace, const char *name, bool reset)
 	if (!space) {
 		return;
 	}
+	// Views read from disk are only known by their criteria
+	root_for_each_container(claim_mapped_view, space);
 	layout_space_restore(space, workspace, reset);
+	free(space->workspace);
+	space->workspace = strdup(workspace->name);
+	space->pending = true;
+	space->pending_until = get_current_time_msec() + SPACE_PENDING_MSEC;
+	space_update_pending(space);
+}
+
+bool space_place_view(struct sway_view *view) {
+	for (int i = 0; i < root->spaces->length; ++i) {
+		struct sway_space *space = root->spaces->items[i];
+		if (!space_update_pending(space)) {
+			continue;
+		}
+		struct sway_space_view *space_view = space_find_free(space, view);
+		if (!space_view) {
+			continue;
+		}
+		struct sway_workspace *workspace = workspace_by_name(space->workspace);
+		if (!workspace) {
+			workspace = workspace_create(NULL, space->workspace);
+		}
+		if (!workspace) {
+			return false;
+		}
+		space_view->view = view;
+		space_update_pending(space);
+		layout_space_place_view(space, space_view, workspace, view->container);
+		return true;
+	}
+	return false;
+}
+
+static void container_view_unmap(struct sway_space_container *container,
+		struct sway_view *view) {
+	if (container->children) {
+		for (int i = 0; i < container->children->length; ++i) {
+			container_view_unmap(container->children->items[i], view);
+		}
+	} else if (container->view && container->view->view == view) {
+		container->view->view = NULL;
+	}
+}
+
+void space_view_unmap(struct sway_view *view) {
+	for (int i = 0; i < root->spaces->length; ++i) {
+		struct sway_space *space = root->spaces->items[i];
+		for (int j = 0; j < space->tiling->length; ++j) {
+			container_view_unmap(space->tiling->items[j], view);
+		}
+		for (int j = 0; j < space->floating->length; ++j) {
+			container_view_unmap(space->floating->items[j], view);
+		}
+		space_update_pending(space);
+	}
 }
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <wayland-server-core.h>
 #include <wlr/config.h>
@@ -28,6 +29,7 @@
 #include "sway/output.h"
 #include "sway/input/seat.h"
 #include "sway/scene_descriptor.h"
+#include "sway/recorder.h"
 #include "sway/server.h"
 #include "sway/sway_text_node.h"
 #include "sway/tree/arrange.h"
@@ -35,10 +37,12 @@
 #include "sway/tree/view.h"
 #include "sway/tree/workspace.h"
 #include "sway/tree/scene.h"
+#include "sway/tree/space.h"
 #include "sway/config.h"
 #include "sway/xdg_decoration.h"
 #include <scenefx/types/wlr_scene.h>
 #include "stringop.h"
+#include "util.h"
 
 bool view_init(struct sway_view *view, enum sway_view_type type,
 		const struct sway_view_impl *impl) {
@@ -58,11 +62,12 @@ bool view_init(struct sway_view *view, enum sway_view_type type,
 
 	view->type = type;
 	view->impl = impl;
-	view->executed_criteria = create_list();
+	wl_list_init(&view->pending_link);
 	view->allow_request_urgent = true;
 	view->shortcuts_inhibit = SHORTCUTS_INHIBIT_DEFAULT;
 	view->tearing_mode = TEARING_WINDOW_HINT;
 	wl_signal_init(&view->events.unmap);
+	view->lua_handle = sway_lua_handle_create(LUA_HANDLE_VIEW, view);
 	return true;
 }
 
@@ -80,7 +85,8 @@ void view_destroy(struct sway_view *view) {
 		return;
 	}
 	wl_list_remove(&view->events.unmap.listener_list);
-	list_free(view->executed_criteria);
+	free(view->executed_criteria);
+	sway_lua_handle_release(view->lua_handle);
 
 	view_assign_ctx(view, NULL);
 	sway_scene_node_destroy(&view->scene_tree->node);
@@ -488,29 +494,58 @@ void view_close_popups(struct sway_view *view) {
 	}
 }
 
-static bool view_has_executed_criteria(struct sway_view *view,
+bool view_has_executed_criteria(struct sway_view *view,
 		struct criteria *criteria) {
-	for (int i = 0; i < view->executed_criteria->length; ++i) {
-		struct criteria *item = view->executed_criteria->items[i];
-		if (item == criteria) {
-			return true;
+	int word = criteria->index / 32;
+	return word < view->executed_criteria_words &&
+		(view->executed_criteria[word] & (1u << (criteria->index % 32)));
+}
+
+void view_set_executed_criteria(struct sway_view *view,
+		struct criteria *criteria) {
+	int word = criteria->index / 32;
+	if (word >= view->executed_criteria_words) {
+		int words = config->command_criteria_count / 32 + 1;
+		if (words <= word) {
+			words = word + 1;
 		}
+		uint32_t *executed = realloc(view->executed_criteria,
+			words * sizeof(*executed));
+		if (!executed) {
+			sway_log(SWAY_ERROR, "Unable to allocate executed criteria");
+			return;
+		}
+		memset(executed + view->executed_criteria_words, 0,
+			(words - view->executed_criteria_words) * sizeof(*executed));
+		view->executed_criteria = executed;
+		view->executed_criteria_words = words;
+	}
+	view->executed_criteria[word] |= 1u << (criteria->index % 32);
+}
+
+void view_clear_executed_criteria(struct sway_view *view) {
+	if (view->executed_criteria) {
+		memset(view->executed_criteria, 0,
+			view->executed_criteria_words * sizeof(*view->executed_criteria));
 	}
-	return false;
 }
 
 void view_execute_criteria(struct sway_view *view) {
-	list_t *criterias = criteria_for_view(view, CT_COMMAND);
+	// Rules already run are skipped before matching, they cost no regex
+	list_t *criterias = create_list();
+	for (int i = 0; i < config->criteria->length; ++i) {
+		struct criteria *criteria = config->criteria->items[i];
+		if (criteria->type == CT_COMMAND &&
+				!view_has_executed_criteria(view, criteria) &&
+				criteria_matches_view(criteria, view)) {
+			list_add(criterias, criteria);
+		}
+	}
 	for (int i = 0; i < criterias->length; i++) {
 		struct criteria *criteria = criterias->items[i];
-		sway_log(SWAY_DEBUG, "Checking criteria %s", criteria->raw);
-		if (view_has_executed_criteria(view, criteria)) {
-			sway_log(SWAY_DEBUG, "Criteria already executed");
-			continue;
-		}
 		sway_log(SWAY_DEBUG, "for_window '%s' matches view %p, cmd: '%s'",
 				criteria->raw, view, criteria->cmdlist);
-		list_add(view->executed_criteria, criteria);
+		view_set_executed_criteria(view, criteria);
 		list_t *res_list = execute_command(criteria->cmdlist, NULL, view->container);
 		while (res_list->length) {
 			struct cmd_results *res = res_list->items[0];
@@ -831,17 +866,28 @@ void view_map(struct sway_view *view, struct wlr_surface *wlr_surface,
 			&view->foreign_destroy);
 
 	struct sway_container *container = view->container;
-	layout_add_view(ws, target_sibling, container);
+	if (space_place_view(view)) {
+		ws = container->pending.workspace;
+	} else {
+		layout_add_view(ws, target_sibling, container);
+	}
 	ipc_event_window(view->container, "new");
 
 	if (decoration) {
 		view_update_csd_from_client(view, decoration);
 	}
 
-	if (view->impl->wants_floating && view->impl->wants_floating(view)) {
+	if (container_is_floating(view->container) ||
+			(view->impl->wants_floating && view->impl->wants_floating(view))) {
 		view->container->pending.border = config->floating_border;
 		view->container->pending.border_thickness = config->floating_border_thickness;
-		container_set_floating(view->container, true);
+		if (container_is_floating(view->container)) {
+			// Placed floating by a space, container_set_floating() has
+			// nothing to do
+			container_floating_setup_view(view->container);
+		} else {
+			container_set_floating(view->container, true);
+		}
 	} else {
 		view->container->pending.border = config->border;
 		view->container->pending.border_thickness = config->border_thickness;
@@ -911,31 +957,31 @@ void view_map(struct sway_view *view, struct wlr_surface *wlr_surface,
 		wlr_foreign_toplevel_handle_v1_set_app_id(view->foreign_toplevel, class);
 	}
 
-	// Lua callbacks
-	for (int i = 0; i < config->lua.cbs_view_map->length; ++i) {
-		struct sway_lua_closure *closure = config->lua.cbs_view_map->items[i];
-		lua_rawgeti(config->lua.state, LUA_REGISTRYINDEX, closure->cb_function);
-		lua_pushlightuserdata(config->lua.state, view);
-		lua_rawgeti(config->lua.state, LUA_REGISTRYINDEX, closure->cb_data);
-		lua_call(config->lua.state, 2, 0);
-	}
+	recorder_view_map(view);
+
+	sway_lua_event_view(LUA_EVENT_VIEW_MAP, view);
 
 	animation_set_path(config->animations.window_open);
 }
 
 void view_unmap(struct sway_view *view) {
-	// Lua callbacks
-	for (int i = 0; i < config->lua.cbs_view_unmap->length; ++i) {
-		struct sway_lua_closure *closure = config->lua.cbs_view_unmap->items[i];
-		lua_rawgeti(config->lua.state, LUA_REGISTRYINDEX, closure->cb_function);
-		lua_pushlightuserdata(config->lua.state, view);
-		lua_rawgeti(config->lua.state, LUA_REGISTRYINDEX, closure->cb_data);
-		lua_call(config->lua.state, 2, 0);
-	}
+	recorder_view_unmap(view);
+	space_view_unmap(view);
+
+	sway_lua_event_view(LUA_EVENT_VIEW_UNMAP, view);
 
 	wl_signal_emit_mutable(&view->events.unmap, view);
 
-	view->executed_criteria->length = 0;
+	view_clear_executed_criteria(view);
+
+	// Updates for a window that is going away are of no interest
+	wl_list_remove(&view->pending_link);
+	wl_list_init(&view->pending_link);
+	view->pending_updates = 0;
+	if (view->title_event_timer) {
+		wl_event_source_remove(view->title_event_timer);
+		view->title_event_timer = NULL;
+	}
 
 	if (view->urgent_timer) {
 		wl_event_source_remove(view->urgent_timer);
@@ -1073,6 +1119,41 @@ void view_update_app_id(struct sway_view *view) {
 	}
 }
 
+#define TITLE_EVENT_INTERVAL_MS 100
+
+static int handle_title_event_timeout(void *data) {
+	struct sway_view *view = data;
+	wl_event_source_remove(view->title_event_timer);
+	view->title_event_timer = NULL;
+	view->last_title_event = get_current_time_msec();
+	ipc_event_window(view->container, "title");
+	return 0;
+}
+
+// Sends at most one title event per view and interval. Changes within the
+// interval are folded into a single trailing event carrying the last title.
+static void view_send_title_event(struct sway_view *view) {
+	if (view->title_event_timer) {
+		return;
+	}
+	int64_t now = get_current_time_msec();
+	int64_t wait = view->last_title_event + TITLE_EVENT_INTERVAL_MS - now;
+	if (wait <= 0) {
+		view->last_title_event = now;
+		ipc_event_window(view->container, "title");
+		return;
+	}
+	view->title_event_timer = wl_event_loop_add_timer(server.wl_event_loop,
+		handle_title_event_timeout, view);
+	if (view->title_event_timer) {
+		wl_event_source_timer_update(view->title_event_timer, wait);
+	} else {
+		sway_log(SWAY_ERROR, "Unable to create title event timer");
+		view->last_title_event = now;
+		ipc_event_window(view->container, "title");
+	}
+}
+
 void view_update_title(struct sway_view *view, bool force) {
 	const char *title = view_get_title(view);
 
@@ -1114,7 +1195,7 @@ void view_update_title(struct sway_view *view, bool force) {
 		container_update_title_bar(view->container);
 	}
 
-	ipc_event_window(view->container, "title");
+	view_send_title_event(view);
 
 	if (view->foreign_toplevel && title) {
 		wlr_foreign_toplevel_handle_v1_set_title(view->foreign_toplevel, title);
@@ -1125,6 +1206,60 @@ void view_update_title(struct sway_view *view, bool force) {
 	}
 }
 
+static struct wl_list pending_views = { &pending_views, &pending_views };
+static struct wl_event_source *pending_idle = NULL;
+
+static int handle_pending_idle(void *data) {
+	pending_idle = NULL;
+	view_flush_pending_updates();
+	return 0;
+}
+
+void view_queue_update(struct sway_view *view, uint32_t updates) {
+	if (!view->surface || !view->container) {
+		return;
+	}
+	if (view->pending_updates == 0) {
+		wl_list_insert(pending_views.prev, &view->pending_link);
+	}
+	view->pending_updates |= updates;
+
+	// The next frame of the view's output applies the update. Views that
+	// are not on an enabled output will not get one, use an idle callback.
+	struct sway_workspace *ws = view->container->pending.workspace;
+	struct sway_output *output = ws ? ws->output : NULL;
+	if (output && output->enabled && output->wlr_output->enabled) {
+		wlr_output_schedule_frame(output->wlr_output);
+	} else if (!pending_idle) {
+		pending_idle = wl_event_loop_add_idle(server.wl_event_loop,
+			handle_pending_idle, NULL);
+	}
+}
+
+void view_flush_pending_updates(void) {
+	// Criteria commands may queue further updates, so take one at a time
+	while (!wl_list_empty(&pending_views)) {
+		struct sway_view *view =
+			wl_container_of(pending_views.next, view, pending_link);
+		uint32_t updates = view->pending_updates;
+		wl_list_remove(&view->pending_link);
+		wl_list_init(&view->pending_link);
+		view->pending_updates = 0;
+
+		if (updates & VIEW_UPDATE_TITLE) {
+			view_update_title(view, false);
+		}
+		if (updates & VIEW_UPDATE_APP_ID) {
+			view_update_app_id(view);
+		}
+		// A title change cannot make a rule match unless one looks at titles
+		if ((updates & VIEW_UPDATE_CRITERIA) ||
+				(updates & config->command_criteria_updates)) {
+			view_execute_criteria(view);
+		}
+	}
+}
+
 bool view_is_visible(struct sway_view *view) {
 	if (view->container->node.destroying) {
 		return false;
@@ -1170,14 +1305,7 @@ void view_set_urgent(struct sway_view *view, bool enable) {
 		clock_gettime(CLOCK_MONOTONIC, &view->urgent);
 		container_update_itself_and_parents(view->container);
 
-		// Lua callbacks
-		for (int i = 0; i < config->lua.cbs_view_urgent->length; ++i) {
-			struct sway_lua_closure *closure = config->lua.cbs_view_urgent->items[i];
-			lua_rawgeti(config->lua.state, LUA_REGISTRYINDEX, closure->cb_function);
-			lua_pushlightuserdata(config->lua.state, view);
-			lua_rawgeti(config->lua.state, LUA_REGISTRYINDEX, closure->cb_data);
-			lua_call(config->lua.state, 2, 0);
-		}
+		sway_lua_event_view(LUA_EVENT_VIEW_URGENT, view);
 	} else {
 		view->urgent = (struct timespec){ 0 };
 		if (view->urgent_timer) {
@@ -1,9 +1,11 @@
 #include <ctype.h>
 #include <limits.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <strings.h>
+#include <wlr/types/wlr_buffer.h>
 #include "stringop.h"
 #include "sway/input/input-manager.h"
 #include "sway/input/cursor.h"
@@ -127,18 +129,13 @@ struct sway_workspace *workspace_create(struct sway_output *output,
 	output_sort_workspaces(output);
 
 	ipc_event_workspace(NULL, ws, "init");
+	root_index_add_workspace(ws);
+	ws->node.lua_handle = sway_lua_handle_create(LUA_HANDLE_WORKSPACE, ws);
 	wl_signal_emit_mutable(&root->events.new_node, &ws->node);
 
 	layout_init(ws);
 
-	// Lua callbacks
-	for (int i = 0; i < config->lua.cbs_workspace_create->length; ++i) {
-		struct sway_lua_closure *closure = config->lua.cbs_workspace_create->items[i];
-		lua_rawgeti(config->lua.state, LUA_REGISTRYINDEX, closure->cb_function);
-		lua_pushlightuserdata(config->lua.state, ws);
-		lua_rawgeti(config->lua.state, LUA_REGISTRYINDEX, closure->cb_data);
-		lua_call(config->lua.state, 2, 0);
-	}
+	sway_lua_event_workspace(LUA_EVENT_WORKSPACE_CREATE, ws, NULL);
 
 	return ws;
 }
@@ -158,6 +155,9 @@ void workspace_destroy(struct sway_workspace *workspace) {
 	sway_scene_node_destroy(&workspace->layers.tiling->node);
 	sway_scene_node_destroy(&workspace->layers.fullscreen->node);
 
+	layout_overview_thumbnail_release(workspace);
+	root_index_remove_workspace(workspace);
+	sway_lua_handle_release(workspace->node.lua_handle);
 	free(workspace->name);
 	free(workspace->representation);
 	list_free_items_and_destroy(workspace->output_priority);
@@ -168,8 +168,11 @@ void workspace_destroy(struct sway_workspace *workspace) {
 	free(workspace);
 }
 
+static void workspace_switch_cancel(struct sway_workspace *workspace);
+
 void workspace_begin_destroy(struct sway_workspace *workspace) {
 	sway_log(SWAY_DEBUG, "Destroying workspace '%s'", workspace->name);
+	workspace_switch_cancel(workspace);
 	ipc_event_workspace(NULL, workspace, "empty"); // intentional
 	wl_signal_emit_mutable(&workspace->node.events.destroy, &workspace->node);
 
@@ -365,13 +368,12 @@ static bool _workspace_by_number(struct sway_workspace *ws, void *data) {
 }
 
 struct sway_workspace *workspace_by_number(const char* name) {
+	if (isdigit(name[0])) {
+		return root_find_workspace_by_number(name);
+	}
 	return root_find_workspace(_workspace_by_number, (void *) name);
 }
 
-static bool _workspace_by_name(struct sway_workspace *ws, void *data) {
-	return strcasecmp(ws->name, data) == 0;
-}
-
 struct sway_workspace *workspace_by_name(const char *name) {
 	struct sway_seat *seat = input_manager_current_seat();
 	struct sway_workspace *current = seat_get_focused_workspace(seat);
@@ -391,10 +393,9 @@ struct sway_workspace *workspace_by_name(const char *name) {
 		if (!seat->prev_workspace_name) {
 			return NULL;
 		}
-		return root_find_workspace(_workspace_by_name,
-				(void*)seat->prev_workspace_name);
+		return root_find_workspace_by_name(seat->prev_workspace_name);
 	} else {
-		return root_find_workspace(_workspace_by_name, (void*)name);
+		return root_find_workspace_by_name(name);
 	}
 }
 
@@ -599,209 +600,190 @@ struct sway_workspace *workspace_auto_back_and_forth(
 	return workspace;
 }
 
-struct workspace_switch_container_data {
-	struct sway_container *container;
-	double y;
-};
-
+/**
+ * An animated workspace switch. The live tree is switched at once, but both
+ * workspaces are drawn from snapshots sliding across the output until the
+ * animation ends: the outgoing one is captured as it was on screen, the
+ * incoming one once its transaction is applied. Each step only moves the
+ * two snapshots, the workspaces are not arranged again until the end.
+ */
 struct workspace_switch_data {
-	struct sway_workspace *from;
 	struct sway_workspace *to;
-	list_t *from_containers;
-	list_t *to_containers;
+	struct sway_output *output;
+	bool forward; // the incoming workspace comes from below
+	bool started; // the switch is applied, the animation is running
+	struct sway_scene_tree *tree; // above the workspaces of the output
+	struct sway_scene_buffer *from_snapshot;
+	struct sway_scene_buffer *to_snapshot;
 };
 
-static void workspace_switch_callback_end(void *callback_data) {
-	struct workspace_switch_data *data = callback_data;
-
-	for (int i = 0; i < data->from_containers->length; ++i) {
-		struct workspace_switch_container_data *cdata = data->from_containers->items[i];
-		cdata->container->pending.y = cdata->y;
-		node_set_dirty(&cdata->container->node);
-	}
-	for (int i = 0; i < data->to_containers->length; ++i) {
-		struct workspace_switch_container_data *cdata = data->to_containers->items[i];
-		cdata->container->current.y = cdata->y;
-		node_set_dirty(&cdata->container->node);
-	}
-
-	node_set_dirty(&data->from->node);
-	node_set_dirty(&data->to->node);
-
-	struct sway_workspace *workspace = data->to;
-	struct sway_seat *seat = input_manager_current_seat();
-	struct sway_node *next = seat_get_focus_inactive(seat, &workspace->node);
-	if (next == NULL) {
-		next = &workspace->node;
-	}
-	seat_set_focus(seat, next);
+static struct workspace_switch_data *workspace_switch_data = NULL;
 
-	list_free_items_and_destroy(data->from_containers);
-	list_free_items_and_destroy(data->to_containers);
-	free(data);
-	root_set_default_filters(root);
-	animation_set_default_callbacks();
-
-	transaction_commit_dirty();
-}
-
-static bool switching_output(struct sway_workspace *workspace,
-		struct workspace_switch_data *data) {
-	struct sway_output *output = workspace->output;
-	struct sway_output *from_output = data->from->output;
-	struct sway_output *to_output = data->to->output;
-	if (output == from_output || output == to_output) {
-		return true;
-	}
+static bool workspace_snapshot_accepts_input(struct sway_scene_buffer *buffer,
+		double *sx, double *sy) {
+	// Only a picture of the workspace, input goes through it
 	return false;
 }
 
-static bool workspace_switch_animation_filter(struct sway_workspace *workspace, void *filter_data) {
-	return switching_output(workspace, filter_data);
-}
-
-static bool workspace_switch_workspace_filter(struct sway_workspace *workspace, void *filter_data) {
-	struct sway_output *output = workspace->output;
-	if (!output->wlr_output->enabled) {
-		return false;
-	}
-	if (switching_output(workspace, filter_data)) {
-		struct workspace_switch_data *data = filter_data;
-		return workspace == data->from || workspace == data->to;
+static struct sway_scene_buffer *workspace_snapshot_create(
+		struct workspace_switch_data *data, struct sway_workspace *workspace) {
+	list_t *trees = create_list();
+	list_add(trees, workspace->layers.tiling);
+	for (int i = 0; i < workspace->current.floating->length; ++i) {
+		struct sway_container *floater = workspace->current.floating->items[i];
+		list_add(trees, floater->scene_tree);
+	}
+	list_add(trees, workspace->layers.fullscreen);
+	struct wlr_buffer *buffer = sway_scene_output_capture(
+		data->output->scene_output, (struct sway_scene_tree **)trees->items,
+		trees->length);
+	list_free(trees);
+	if (!buffer) {
+		sway_log(SWAY_ERROR, "Unable to capture workspace %s", workspace->name);
+		return NULL;
 	}
-	if (!layout_overview_workspaces_enabled()) {
-		if (output->current.active_workspace != workspace) {
-			return false;
-		}
+	struct sway_scene_buffer *snapshot =
+		sway_scene_buffer_create(data->tree, buffer);
+	wlr_buffer_drop(buffer);
+	if (snapshot) {
+		snapshot->point_accepts_input = workspace_snapshot_accepts_input;
 	}
-	return true;
+	return snapshot;
 }
 
-static bool workspace_switch_container_filter(struct sway_workspace *workspace,
-		struct sway_container *container, void *filter_data) {
-	if (!switching_output(workspace, filter_data)) {
-		return true;
-	}
-	struct workspace_switch_data *data = filter_data;
-	for (int i = 0; i < data->from_containers->length; ++i) {
-		struct workspace_switch_container_data *container_data = data->from_containers->items[i];
-		if (container == container_data->container) {
-			return true;
-		}
+// Shows the part of the snapshot that is on the output when its top is at y
+static void workspace_snapshot_place(struct workspace_switch_data *data,
+		struct sway_scene_buffer *snapshot, double y) {
+	if (!snapshot) {
+		return;
 	}
-	for (int i = 0; i < data->to_containers->length; ++i) {
-		struct workspace_switch_container_data *container_data = data->to_containers->items[i];
-		if (container == container_data->container) {
-			return true;
-		}
+	double height = data->output->height;
+	double shown = height - fabs(y);
+	sway_scene_node_set_enabled(&snapshot->node, shown > 0);
+	if (shown <= 0) {
+		return;
 	}
-	return false;
+	double scale = snapshot->buffer->height / height;
+	sway_scene_buffer_set_source_box(snapshot, &(struct wlr_fbox){
+		.y = y < 0 ? -y * scale : 0,
+		.width = snapshot->buffer->width,
+		.height = shown * scale,
+	});
+	sway_scene_buffer_set_dest_size(snapshot, data->output->width, shown);
+	sway_scene_node_set_position(&snapshot->node, 0, y < 0 ? 0 : y);
 }
 
-static bool container_visible(struct sway_workspace *workspace,
-		struct sway_container *container) {
-	float scale = layout_scale_enabled(workspace) ? layout_scale_get(workspace) : 1.0f;
-	struct sway_output *output = workspace->output;
-	if (container->pending.x >= output->lx + output->width ||
-		container->pending.x + scale * container->pending.width <= output->lx ||
-		container->pending.y >= output->ly + output->height ||
-		container->pending.y + scale * container->pending.height <= output->ly) {
-		return false;
+static void workspace_switch_finish(struct workspace_switch_data *data) {
+	if (workspace_switch_data == data) {
+		workspace_switch_data = NULL;
 	}
-	return true;
+	// Runs callback_end, which sees the switch is no longer pending
+	animation_set_default_callbacks();
+	sway_scene_node_destroy(&data->tree->node);
+	data->to->switching = false;
+	arrange_workspace(data->to);
+	free(data);
 }
 
-typedef void (*add_delta_to_container_func_t)(struct sway_container *con, double delta);
+static void workspace_switch_cancel(struct sway_workspace *workspace) {
+	if (workspace_switch_data && workspace_switch_data->to == workspace) {
+		workspace_switch_finish(workspace_switch_data);
+	}
+}
 
-static void add_delta_to_current(struct sway_container *con, double delta) {
-	con->current.y += delta;
+void workspace_switch_cancel_output(struct sway_output *output) {
+	if (workspace_switch_data && workspace_switch_data->output == output) {
+		workspace_switch_finish(workspace_switch_data);
+	}
 }
 
-static void add_delta_to_pending(struct sway_container *con, double delta) {
-	con->pending.y += delta;
+static void workspace_switch_callback_begin(void *callback_data) {
+	struct workspace_switch_data *data = callback_data;
+	if (data->to_snapshot) {
+		// Another transaction restarted the animation
+		sway_scene_node_destroy(&data->to_snapshot->node);
+		data->to_snapshot = NULL;
+	}
+	data->started = true;
+	if (data->to->output != data->output || !data->output->enabled) {
+		// Nothing to capture, the step finishes the switch
+		return;
+	}
+	data->to_snapshot = workspace_snapshot_create(data, data->to);
 }
 
-static void select_visible_containers(list_t *containers,
-		struct sway_workspace *workspace, list_t *children,
-		double *min_y, double *max_y) {
-	for (int i = 0; i < children->length; ++i) {
-		struct sway_container *con = children->items[i];
-		if (container_visible(workspace, con)) {
-			struct workspace_switch_container_data *container_data =
-				malloc(sizeof(struct workspace_switch_container_data));
-			container_data->container = con;
-			container_data->y = con->current.y;
-			list_add(containers, container_data);
-			if (con->pending.children) {
-				select_visible_containers(containers, workspace,
-					con->pending.children, min_y, max_y);
-			}
-			node_set_dirty(&con->node);
-			if (con->pending.parent) {
-				float scale = layout_scale_enabled(workspace) ? layout_scale_get(workspace) : 1.0f;
-				int gap = workspace->gaps_inner;
-				const double miny = con->pending.y - gap;
-				const double maxy = con->pending.y + scale * (con->pending.height + gap);
-				if (miny < *min_y) {
-					*min_y = miny;
-				}
-				if (maxy > *max_y) {
-					*max_y = maxy;
-				}
-			}
-		}
+static void workspace_switch_callback_step(void *callback_data) {
+	struct workspace_switch_data *data = callback_data;
+	if (!data->started || !data->to_snapshot ||
+			data->to->output != data->output) {
+		// Animations got disabled, or the switch cannot be shown
+		workspace_switch_finish(data);
+		transaction_commit_dirty();
+		return;
+	}
+	double t, x, y, scale;
+	animation_get_values(&t, &x, &y, &scale);
+	double offset = x * data->output->height;
+	if (data->forward) {
+		workspace_snapshot_place(data, data->from_snapshot, -offset);
+		workspace_snapshot_place(data, data->to_snapshot,
+			data->output->height - offset);
+	} else {
+		workspace_snapshot_place(data, data->from_snapshot, offset);
+		workspace_snapshot_place(data, data->to_snapshot,
+			offset - data->output->height);
 	}
 }
 
-static void add_delta_to_containers(list_t *containers,
-		add_delta_to_container_func_t add_delta, double delta) {
-	for (int i = 0; i < containers->length; ++i) {
-		struct workspace_switch_container_data *data = containers->items[i];
-		add_delta(data->container, delta);
+static void workspace_switch_callback_end(void *callback_data) {
+	if (callback_data != workspace_switch_data) {
+		// Finished already
+		return;
 	}
+	workspace_switch_finish(callback_data);
+	transaction_commit_dirty();
 }
 
 static void animate_workspace_switch(struct sway_workspace *from, struct sway_workspace *to) {
-	struct workspace_switch_data *data = malloc(sizeof(struct workspace_switch_data));
-	data->from = from;
+	if (workspace_switch_data) {
+		workspace_switch_finish(workspace_switch_data);
+	}
+	struct workspace_switch_data *data = calloc(1, sizeof(*data));
+	if (!data) {
+		return;
+	}
 	data->to = to;
-	data->from_containers = create_list();
-	data->to_containers = create_list();
-	root->filters.free_animation_activation_filter = workspace_switch_animation_filter;
-	root->filters.free_animation_activation_filter_data = data;
-	root->filters.workspace_filter = workspace_switch_workspace_filter;
-	root->filters.workspace_filter_data = data;
-	root->filters.container_filter = workspace_switch_container_filter;
-	root->filters.container_filter_data = data;
-
-	int from_idx = list_find(from->output->workspaces, from);
-	int to_idx = list_find(from->output->workspaces, to);
-	double min_y_to = DBL_MAX, max_y_to = -DBL_MAX;
-	select_visible_containers(data->to_containers, to, to->tiling, &min_y_to, &max_y_to);
-	if (max_y_to < min_y_to) {
-		max_y_to = min_y_to = to->y;
-	}
-	double min_y_from = DBL_MAX, max_y_from = -DBL_MAX;
-	select_visible_containers(data->from_containers, from, from->tiling, &min_y_from, &max_y_from);
-	if (max_y_from < min_y_from) {
-		max_y_from = min_y_from = from->y;
-	}
-	double delta;
-	if (from_idx < to_idx) {
-		delta = from->output->height + max_y_from - (from->y + from->height)
-			+ (from->y - min_y_to);
-	} else {
-		delta = from->output->height + max_y_to - (from->y + from->height)
-			+ (from->y - min_y_from);
-		delta = -delta;
+	data->output = from->output;
+	data->forward = list_find(from->output->workspaces, from) <
+		list_find(from->output->workspaces, to);
+	data->tree = sway_scene_tree_create(root->layers.floating);
+	if (!data->tree) {
+		free(data);
+		return;
 	}
-	add_delta_to_containers(data->to_containers, add_delta_to_current, delta);
-	add_delta_to_containers(data->from_containers, add_delta_to_pending, -delta);
+	sway_scene_node_set_position(&data->tree->node,
+		data->output->lx, data->output->ly);
 
-	struct sway_animation_callbacks *callbacks = animation_get_callbacks();
-	callbacks->callback_end = workspace_switch_callback_end;
-	callbacks->callback_end_data = data;
-	animation_set_callbacks(callbacks);
+	// Covers the live workspace until the switch is applied
+	data->from_snapshot = workspace_snapshot_create(data, from);
+	if (!data->from_snapshot) {
+		sway_scene_node_destroy(&data->tree->node);
+		free(data);
+		return;
+	}
+	workspace_snapshot_place(data, data->from_snapshot, 0);
+	to->switching = true;
+	workspace_switch_data = data;
+
+	struct sway_animation_callbacks callbacks = {
+		.callback_begin = workspace_switch_callback_begin,
+		.callback_begin_data = data,
+		.callback_step = workspace_switch_callback_step,
+		.callback_step_data = data,
+		.callback_end = workspace_switch_callback_end,
+		.callback_end_data = data,
+	};
+	animation_set_callbacks(&callbacks);
 }
 
 bool workspace_switch(struct sway_workspace *workspace) {
@@ -812,16 +794,15 @@ bool workspace_switch(struct sway_workspace *workspace) {
 	struct sway_workspace *old_ws = seat_get_focused_workspace(seat);
 	animation_set_path(config->animations.workspace_switch);
 	if (old_ws != workspace && old_ws->output == workspace->output &&
-		animation_enabled()) {
+			!layout_overview_workspaces_enabled() && animation_enabled()) {
 		animate_workspace_switch(old_ws, workspace);
-	} else {
-		struct sway_node *next = seat_get_focus_inactive(seat, &workspace->node);
-		if (next == NULL) {
-			next = &workspace->node;
-		}
-		seat_set_focus(seat, next);
-		arrange_workspace(workspace);
 	}
+	struct sway_node *next = seat_get_focus_inactive(seat, &workspace->node);
+	if (next == NULL) {
+		next = &workspace->node;
+	}
+	seat_set_focus(seat, next);
+	arrange_workspace(workspace);
 	return true;
 }
 
@@ -18,6 +18,7 @@
 #include "swaybar/ipc.h"
 #include "swaybar/status_line.h"
 #include "swaybar/render.h"
+#include "swaybar/text_cache.h"
 #if HAVE_TRAY
 #include "swaybar/tray/tray.h"
 #endif
@@ -55,13 +56,15 @@ static void swaybar_output_free(struct swaybar_output *output) {
 	destroy_buffer(&output->buffers[1]);
 	free_hotspots(&output->hotspots);
 	free_workspaces(&output->workspaces);
+	text_cache_finish(output);
+	wl_array_release(&output->status_blocks);
 	wl_list_remove(&output->link);
 	free(output->name);
 	free(output->identifier);
 	free(output);
 }
 
-static void set_output_dirty(struct swaybar_output *output) {
+static void schedule_output_frame(struct swaybar_output *output) {
 	if (output->frame_scheduled) {
 		output->dirty = true;
 	} else if (output->surface) {
@@ -69,6 +72,11 @@ static void set_output_dirty(struct swaybar_output *output) {
 	}
 }
 
+static void set_output_dirty(struct swaybar_output *output) {
+	output->damage_full = true;
+	schedule_output_frame(output);
+}
+
 static void layer_surface_configure(void *data,
 		struct zwlr_layer_surface_v1 *surface,
 		uint32_t serial, uint32_t width, uint32_t height) {
@@ -129,6 +137,7 @@ void destroy_layer_surface(struct swaybar_output *output) {
 	output->layer_surface = NULL;
 	output->width = 0;
 	output->frame_scheduled = false;
+	output->damage_full = true;
 }
 
 void set_bar_dirty(struct swaybar *bar) {
@@ -138,6 +147,16 @@ void set_bar_dirty(struct swaybar *bar) {
 	}
 }
 
+void set_bar_status_dirty(struct swaybar *bar) {
+	struct swaybar_output *output;
+	wl_list_for_each(output, &bar->outputs, link) {
+		if (bar->status->protocol != PROTOCOL_I3BAR) {
+			output->damage_full = true;
+		}
+		schedule_output_frame(output);
+	}
+}
+
 bool determine_bar_visibility(struct swaybar *bar, bool moving_layer) {
 	struct swaybar_config *config = bar->config;
 	bool visible = !(strcmp(config->mode, "invisible") == 0 ||
@@ -351,6 +370,9 @@ static void handle_global(void *data, struct wl_registry *registry,
 		output->wl_name = name;
 		wl_list_init(&output->workspaces);
 		wl_list_init(&output->hotspots);
+		wl_list_init(&output->text_cache);
+		wl_array_init(&output->status_blocks);
+		output->damage_full = true;
 		wl_list_init(&output->link);
 		if (bar->xdg_output_manager != NULL) {
 			add_xdg_output(output);
@@ -501,7 +523,7 @@ void status_in(int fd, short mask, void *data) {
 		set_bar_dirty(bar);
 		loop_remove_fd(bar->eventloop, fd);
 	} else if (status_handle_readable(bar->status)) {
-		set_bar_dirty(bar);
+		set_bar_status_dirty(bar);
 	}
 }
 
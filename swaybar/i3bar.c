@@ -5,6 +5,7 @@
 #include <string.h>
 #include <unistd.h>
 #include "log.h"
+#include "stringop.h"
 #include "swaybar/bar.h"
 #include "swaybar/config.h"
 #include "swaybar/i3bar.h"
@@ -40,82 +41,186 @@ static bool i3bar_parse_json_color(json_object *json, uint32_t *color) {
 	return color_set;
 }
 
-static void i3bar_parse_json(struct status_line *status,
-		struct json_object *json_array) {
-	struct i3bar_block *block, *tmp;
-	wl_list_for_each_safe(block, tmp, &status->blocks, link) {
-		wl_list_remove(&block->link);
-		i3bar_block_unref(block);
+static struct i3bar_block *i3bar_parse_json_block(json_object *json) {
+	json_object *full_text, *short_text, *color, *min_width, *align, *urgent;
+	json_object *name, *instance, *separator, *separator_block_width;
+	json_object *background, *border, *border_top, *border_bottom;
+	json_object *border_left, *border_right, *markup;
+	json_object_object_get_ex(json, "full_text", &full_text);
+	json_object_object_get_ex(json, "short_text", &short_text);
+	json_object_object_get_ex(json, "color", &color);
+	json_object_object_get_ex(json, "min_width", &min_width);
+	json_object_object_get_ex(json, "align", &align);
+	json_object_object_get_ex(json, "urgent", &urgent);
+	json_object_object_get_ex(json, "name", &name);
+	json_object_object_get_ex(json, "instance", &instance);
+	json_object_object_get_ex(json, "markup", &markup);
+	json_object_object_get_ex(json, "separator", &separator);
+	json_object_object_get_ex(json, "separator_block_width", &separator_block_width);
+	json_object_object_get_ex(json, "background", &background);
+	json_object_object_get_ex(json, "border", &border);
+	json_object_object_get_ex(json, "border_top", &border_top);
+	json_object_object_get_ex(json, "border_bottom", &border_bottom);
+	json_object_object_get_ex(json, "border_left", &border_left);
+	json_object_object_get_ex(json, "border_right", &border_right);
+
+	struct i3bar_block *block = calloc(1, sizeof(struct i3bar_block));
+	block->ref_count = 1;
+	block->full_text = full_text ?
+		strdup(json_object_get_string(full_text)) : NULL;
+	block->short_text = short_text ?
+		strdup(json_object_get_string(short_text)) : NULL;
+	block->color_set = i3bar_parse_json_color(color, &block->color);
+	if (min_width) {
+		json_type type = json_object_get_type(min_width);
+		if (type == json_type_int) {
+			block->min_width = json_object_get_int(min_width);
+		} else if (type == json_type_string) {
+			/* the width will be calculated when rendering */
+			block->min_width_str = strdup(json_object_get_string(min_width));
+		}
+	}
+	block->align = strdup(align ? json_object_get_string(align) : "left");
+	block->urgent = urgent ? json_object_get_int(urgent) : false;
+	block->name = name ? strdup(json_object_get_string(name)) : NULL;
+	block->instance = instance ?
+		strdup(json_object_get_string(instance)) : NULL;
+	if (markup) {
+		block->markup = false;
+		const char *markup_str = json_object_get_string(markup);
+		if (strcmp(markup_str, "pango") == 0) {
+			block->markup = true;
+		}
 	}
+	block->separator = separator ? json_object_get_int(separator) : true;
+	block->separator_block_width = separator_block_width ?
+		json_object_get_int(separator_block_width) : 9;
+	// Airblader features
+	i3bar_parse_json_color(background, &block->background);
+	block->border_set = i3bar_parse_json_color(border, &block->border);
+	block->border_top = border_top ? json_object_get_int(border_top) : 1;
+	block->border_bottom = border_bottom ?
+		json_object_get_int(border_bottom) : 1;
+	block->border_left = border_left ? json_object_get_int(border_left) : 1;
+	block->border_right = border_right ?
+		json_object_get_int(border_right) : 1;
+	return block;
+}
+
+static bool i3bar_block_content_equal(struct i3bar_block *a,
+		struct i3bar_block *b) {
+	// min_width is only compared when it was given as a number, otherwise it
+	// is derived from min_width_str while rendering
+	return lenient_strcmp(a->full_text, b->full_text) == 0 &&
+		lenient_strcmp(a->short_text, b->short_text) == 0 &&
+		lenient_strcmp(a->align, b->align) == 0 &&
+		lenient_strcmp(a->min_width_str, b->min_width_str) == 0 &&
+		(a->min_width_str || a->min_width == b->min_width) &&
+		a->urgent == b->urgent &&
+		a->color_set == b->color_set &&
+		(!a->color_set || a->color == b->color) &&
+		a->separator == b->separator &&
+		a->separator_block_width == b->separator_block_width &&
+		a->markup == b->markup &&
+		a->background == b->background &&
+		a->border_set == b->border_set &&
+		(!a->border_set || a->border == b->border) &&
+		a->border_top == b->border_top &&
+		a->border_bottom == b->border_bottom &&
+		a->border_left == b->border_left &&
+		a->border_right == b->border_right;
+}
+
+/**
+ * Moves the content of src into dst, keeping dst's identity (and thus the
+ * references held by hotspots). src is freed.
+ */
+static void i3bar_block_update(struct i3bar_block *dst, struct i3bar_block *src) {
+	free(dst->full_text);
+	free(dst->short_text);
+	free(dst->align);
+	free(dst->min_width_str);
+	free(dst->name);
+	free(dst->instance);
+
+	struct wl_list link = dst->link;
+	int ref_count = dst->ref_count;
+	*dst = *src;
+	dst->link = link;
+	dst->ref_count = ref_count;
+	free(src);
+}
+
+/**
+ * Finds the block a status update refers to. Named blocks are matched by
+ * name and instance, unnamed blocks by their order among unnamed blocks.
+ */
+static struct i3bar_block *i3bar_find_block(struct wl_list *blocks,
+		struct i3bar_block *needle) {
+	struct i3bar_block *block;
+	wl_list_for_each_reverse(block, blocks, link) {
+		if (!needle->name) {
+			if (!block->name) {
+				return block;
+			}
+		} else if (block->name && strcmp(block->name, needle->name) == 0 &&
+				lenient_strcmp(block->instance, needle->instance) == 0) {
+			return block;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Applies a status update to the current blocks. Blocks which are resent
+ * unchanged keep their identity and serial, so the renderer can tell that
+ * their region does not need to be redrawn.
+ *
+ * Returns true if anything visible changed.
+ */
+static bool i3bar_parse_json(struct status_line *status,
+		struct json_object *json_array) {
+	bool changed = false;
+	struct wl_list blocks;
+	wl_list_init(&blocks);
 	for (size_t i = 0; i < json_object_array_length(json_array); ++i) {
-		json_object *full_text, *short_text, *color, *min_width, *align, *urgent;
-		json_object *name, *instance, *separator, *separator_block_width;
-		json_object *background, *border, *border_top, *border_bottom;
-		json_object *border_left, *border_right, *markup;
 		json_object *json = json_object_array_get_idx(json_array, i);
 		if (!json) {
 			continue;
 		}
-		json_object_object_get_ex(json, "full_text", &full_text);
-		json_object_object_get_ex(json, "short_text", &short_text);
-		json_object_object_get_ex(json, "color", &color);
-		json_object_object_get_ex(json, "min_width", &min_width);
-		json_object_object_get_ex(json, "align", &align);
-		json_object_object_get_ex(json, "urgent", &urgent);
-		json_object_object_get_ex(json, "name", &name);
-		json_object_object_get_ex(json, "instance", &instance);
-		json_object_object_get_ex(json, "markup", &markup);
-		json_object_object_get_ex(json, "separator", &separator);
-		json_object_object_get_ex(json, "separator_block_width", &separator_block_width);
-		json_object_object_get_ex(json, "background", &background);
-		json_object_object_get_ex(json, "border", &border);
-		json_object_object_get_ex(json, "border_top", &border_top);
-		json_object_object_get_ex(json, "border_bottom", &border_bottom);
-		json_object_object_get_ex(json, "border_left", &border_left);
-		json_object_object_get_ex(json, "border_right", &border_right);
-
-		struct i3bar_block *block = calloc(1, sizeof(struct i3bar_block));
-		block->ref_count = 1;
-		block->full_text = full_text ?
-			strdup(json_object_get_string(full_text)) : NULL;
-		block->short_text = short_text ?
-			strdup(json_object_get_string(short_text)) : NULL;
-		block->color_set = i3bar_parse_json_color(color, &block->color);
-		if (min_width) {
-			json_type type = json_object_get_type(min_width);
-			if (type == json_type_int) {
-				block->min_width = json_object_get_int(min_width);
-			} else if (type == json_type_string) {
-				/* the width will be calculated when rendering */
-				block->min_width_str = strdup(json_object_get_string(min_width));
+		struct i3bar_block *block = i3bar_parse_json_block(json);
+		struct i3bar_block *old = i3bar_find_block(&status->blocks, block);
+		if (old) {
+			// Blocks are stored right to left, so the next block in order is
+			// the last one. Matching any other means blocks were reordered.
+			if (&old->link != status->blocks.prev) {
+				changed = true;
 			}
-		}
-		block->align = strdup(align ? json_object_get_string(align) : "left");
-		block->urgent = urgent ? json_object_get_int(urgent) : false;
-		block->name = name ? strdup(json_object_get_string(name)) : NULL;
-		block->instance = instance ?
-			strdup(json_object_get_string(instance)) : NULL;
-		if (markup) {
-			block->markup = false;
-			const char *markup_str = json_object_get_string(markup);
-			if (strcmp(markup_str, "pango") == 0) {
-				block->markup = true;
+			wl_list_remove(&old->link);
+			if (i3bar_block_content_equal(old, block)) {
+				i3bar_block_unref(block);
+			} else {
+				i3bar_block_update(old, block);
+				old->serial = ++status->block_serial;
+				changed = true;
 			}
+			block = old;
+		} else {
+			block->serial = ++status->block_serial;
+			changed = true;
 		}
-		block->separator = separator ? json_object_get_int(separator) : true;
-		block->separator_block_width = separator_block_width ?
-			json_object_get_int(separator_block_width) : 9;
-		// Airblader features
-		i3bar_parse_json_color(background, &block->background);
-		block->border_set = i3bar_parse_json_color(border, &block->border);
-		block->border_top = border_top ? json_object_get_int(border_top) : 1;
-		block->border_bottom = border_bottom ?
-			json_object_get_int(border_bottom) : 1;
-		block->border_left = border_left ? json_object_get_int(border_left) : 1;
-		block->border_right = border_right ?
-			json_object_get_int(border_right) : 1;
-		wl_list_insert(&status->blocks, &block->link);
+		wl_list_insert(&blocks, &block->link);
+	}
+
+	// Whatever is left was not part of this update
+	struct i3bar_block *block, *tmp;
+	wl_list_for_each_safe(block, tmp, &status->blocks, link) {
+		wl_list_remove(&block->link);
+		i3bar_block_unref(block);
+		changed = true;
 	}
+	wl_list_insert_list(&status->blocks, &blocks);
+	return changed;
 }
 
 bool i3bar_handle_readable(struct status_line *status) {
@@ -257,10 +362,12 @@ bool i3bar_handle_readable(struct status_line *status) {
 	}
 
 	if (last_object) {
-		sway_log(SWAY_DEBUG, "Rendering last received json");
-		i3bar_parse_json(status, last_object);
+		bool changed = i3bar_parse_json(status, last_object);
 		json_object_put(last_object);
-		return true;
+		if (changed) {
+			sway_log(SWAY_DEBUG, "Rendering last received json");
+		}
+		return changed;
 	} else {
 		return false;
 	}
@@ -13,6 +13,7 @@
 #include "swaybar/ipc.h"
 #include "swaybar/render.h"
 #include "swaybar/status_line.h"
+#include "swaybar/text_cache.h"
 #if HAVE_TRAY
 #include "swaybar/tray/tray.h"
 #endif
@@ -29,6 +30,7 @@ struct render_context {
 	cairo_font_options_t *textaa_safe;
 	uint32_t background_color;
 	bool has_transparency;
+	struct wl_array status_blocks; // struct status_block_state
 };
 
 static void choose_text_aa_mode(struct render_context *ctx, uint32_t fontcolor) {
@@ -63,8 +65,8 @@ static uint32_t render_status_line_error(struct render_context *ctx, double *x)
 
 	PangoFontDescription *font = output->bar->config->font_description;
 	int text_width, text_height;
-	get_text_size(cairo, font, &text_width, &text_height, NULL,
-			1, false, "%s", error);
+	text_cache_get_size(output, cairo, font, &text_width, &text_height, NULL,
+			false, error);
 
 	uint32_t ideal_height = text_height + ws_vertical_padding * 2;
 	uint32_t ideal_surface_height = ideal_height;
@@ -77,7 +79,7 @@ static uint32_t render_status_line_error(struct render_context *ctx, double *x)
 	double text_y = height / 2.0 - text_height / 2.0;
 	cairo_move_to(cairo, *x, (int)floor(text_y));
 	choose_text_aa_mode(ctx, 0xFF0000FF);
-	render_text(cairo, font, 1, false, "%s", error);
+	text_cache_render(output, cairo, font, false, error);
 	*x -= margin;
 	return output->height;
 }
@@ -96,8 +98,8 @@ static uint32_t render_status_line_text(struct render_context *ctx, double *x) {
 	cairo_set_source_u32(cairo, fontcolor);
 
 	int text_width, text_height;
-	get_text_size(cairo, config->font_description, &text_width, &text_height, NULL,
-			1, config->pango_markup, "%s", text);
+	text_cache_get_size(output, cairo, config->font_description,
+			&text_width, &text_height, NULL, config->pango_markup, text);
 
 	double ws_vertical_padding = config->status_padding;
 	int margin = 3;
@@ -114,7 +116,8 @@ static uint32_t render_status_line_text(struct render_context *ctx, double *x) {
 	double text_y = height / 2.0 - text_height / 2.0;
 	cairo_move_to(cairo, *x, (int)floor(text_y));
 	choose_text_aa_mode(ctx, fontcolor);
-	render_text(cairo, config->font_description, 1, config->pango_markup, "%s", text);
+	text_cache_render(output, cairo, config->font_description,
+			config->pango_markup, text);
 	*x -= margin;
 	return output->height;
 }
@@ -189,8 +192,8 @@ static uint32_t render_status_block(struct render_context *ctx,
 	struct swaybar_output *output = ctx->output;
 	struct swaybar_config *config = output->bar->config;
 	int text_width, text_height;
-	get_text_size(cairo, config->font_description, &text_width, &text_height, NULL, 1,
-			block->markup, "%s", text);
+	text_cache_get_size(output, cairo, config->font_description,
+			&text_width, &text_height, NULL, block->markup, text);
 
 	int margin = 3;
 	double ws_vertical_padding = config->status_padding;
@@ -198,8 +201,8 @@ static uint32_t render_status_block(struct render_context *ctx,
 	int width = text_width;
 	if (block->min_width_str) {
 		int w;
-		get_text_size(cairo, config->font_description, &w, NULL, NULL, 1, block->markup,
-				"%s", block->min_width_str);
+		text_cache_get_size(output, cairo, config->font_description,
+				&w, NULL, NULL, block->markup, block->min_width_str);
 		block->min_width = w;
 	}
 	if (width < block->min_width) {
@@ -228,8 +231,8 @@ static uint32_t render_status_block(struct render_context *ctx,
 	int sep_block_width = block->separator_block_width;
 	if (!edge) {
 		if (config->sep_symbol) {
-			get_text_size(cairo, config->font_description, &sep_width, &sep_height, NULL,
-					1, false, "%s", config->sep_symbol);
+			text_cache_get_size(output, cairo, config->font_description,
+					&sep_width, &sep_height, NULL, false, config->sep_symbol);
 			uint32_t _ideal_height = sep_height + ws_vertical_padding * 2;
 			uint32_t _ideal_surface_height = _ideal_height;
 			if (!output->bar->config->height &&
@@ -307,7 +310,8 @@ static uint32_t render_status_block(struct render_context *ctx,
 	color = block->urgent ? config->colors.urgent_workspace.text : color;
 	cairo_set_source_u32(cairo, color);
 	choose_text_aa_mode(ctx, color);
-	render_text(cairo, config->font_description, 1, block->markup, "%s", text);
+	text_cache_render(output, cairo, config->font_description,
+			block->markup, text);
 	x_pos += width;
 
 	if (block->border_set || block->urgent) {
@@ -331,8 +335,8 @@ static uint32_t render_status_block(struct render_context *ctx,
 			double sep_y = height / 2.0 - sep_height / 2.0;
 			cairo_move_to(cairo, offset, (int)floor(sep_y));
 			choose_text_aa_mode(ctx, color);
-			render_text(cairo, config->font_description, 1, false,
-					"%s", config->sep_symbol);
+			text_cache_render(output, cairo, config->font_description,
+					false, config->sep_symbol);
 		} else {
 			cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
 			cairo_set_line_width(cairo, 1);
@@ -354,8 +358,8 @@ static void predict_status_block_pos(cairo_t *cairo,
 	struct swaybar_config *config = output->bar->config;
 
 	int text_width, text_height;
-	get_text_size(cairo, config->font_description, &text_width, &text_height, NULL, 1,
-			block->markup, "%s", block->full_text);
+	text_cache_get_size(output, cairo, config->font_description,
+			&text_width, &text_height, NULL, block->markup, block->full_text);
 
 	int margin = 3;
 	double ws_vertical_padding = config->status_padding;
@@ -364,8 +368,8 @@ static void predict_status_block_pos(cairo_t *cairo,
 
 	if (block->min_width_str) {
 		int w;
-		get_text_size(cairo, config->font_description, &w, NULL, NULL,
-				1, block->markup, "%s", block->min_width_str);
+		text_cache_get_size(output, cairo, config->font_description,
+				&w, NULL, NULL, block->markup, block->min_width_str);
 		block->min_width = w;
 	}
 	if (width < block->min_width) {
@@ -391,8 +395,8 @@ static void predict_status_block_pos(cairo_t *cairo,
 	int sep_block_width = block->separator_block_width;
 	if (!edge) {
 		if (config->sep_symbol) {
-			get_text_size(cairo, config->font_description, &sep_width, &sep_height, NULL,
-					1, false, "%s", config->sep_symbol);
+			text_cache_get_size(output, cairo, config->font_description,
+					&sep_width, &sep_height, NULL, false, config->sep_symbol);
 			uint32_t _ideal_height = sep_height + ws_vertical_padding * 2;
 			uint32_t _ideal_surface_height = _ideal_height;
 			if (!output->bar->config->height &&
@@ -426,8 +430,8 @@ static uint32_t predict_workspace_button_length(cairo_t *cairo,
 	struct swaybar_config *config = output->bar->config;
 
 	int text_width, text_height;
-	get_text_size(cairo, config->font_description, &text_width, &text_height, NULL, 1,
-			config->pango_markup, "%s", ws->label);
+	text_cache_get_size(output, cairo, config->font_description,
+			&text_width, &text_height, NULL, config->pango_markup, ws->label);
 
 	int ws_vertical_padding = WS_VERTICAL_PADDING;
 	int ws_horizontal_padding = WS_HORIZONTAL_PADDING;
@@ -474,9 +478,9 @@ static uint32_t predict_binding_mode_indicator_length(cairo_t *cairo,
 	}
 
 	int text_width, text_height;
-	get_text_size(cairo, config->font_description, &text_width, &text_height, NULL,
-			1, output->bar->mode_pango_markup,
-			"%s", mode);
+	text_cache_get_size(output, cairo, config->font_description,
+			&text_width, &text_height, NULL, output->bar->mode_pango_markup,
+			mode);
 
 	int ws_vertical_padding = WS_VERTICAL_PADDING;
 	int ws_horizontal_padding = WS_HORIZONTAL_PADDING;
@@ -500,9 +504,9 @@ static uint32_t predict_scroller_item_length(cairo_t *cairo,
 		struct swaybar_output *output, const char *str) {
 	struct swaybar_config *config = output->bar->config;
 	int text_width, text_height;
-	get_text_size(cairo, config->font_description, &text_width, &text_height, NULL,
-			1, output->bar->mode_pango_markup,
-			"%s", str);
+	text_cache_get_size(output, cairo, config->font_description,
+			&text_width, &text_height, NULL, output->bar->mode_pango_markup,
+			str);
 
 	int ws_vertical_padding = WS_VERTICAL_PADDING;
 	int ws_horizontal_padding = WS_HORIZONTAL_PADDING;
@@ -584,10 +588,22 @@ static uint32_t render_status_line_i3bar(struct render_context *ctx, double *x)
 	}
 
 	wl_list_for_each(block, &output->bar->status->blocks, link) {
+		double block_end = *x;
 		uint32_t h = render_status_block(ctx, block, x, edge,
 					use_short_text);
 		max_height = h > max_height ? h : max_height;
 		edge = false;
+
+		struct status_block_state *state =
+			wl_array_add(&ctx->status_blocks, sizeof(*state));
+		if (state) {
+			*state = (struct status_block_state){
+				.block = block,
+				.serial = block->serial,
+				.x = *x,
+				.width = block_end - *x,
+			};
+		}
 	}
 	return max_height;
 }
@@ -614,8 +630,8 @@ static struct box_size render_box(struct render_context *ctx, double x,
 	cairo_t *cairo = ctx->cairo;
 
 	int text_width, text_height;
-	get_text_size(cairo, config->font_description, &text_width, &text_height, NULL,
-			1, pango_markup, "%s", label);
+	text_cache_get_size(output, cairo, config->font_description,
+			&text_width, &text_height, NULL, pango_markup, label);
 
 	uint32_t width = text_width + WS_HORIZONTAL_PADDING * 2 + BORDER_WIDTH * 2;
 	if (width < config->workspace_min_width) {
@@ -655,8 +671,8 @@ static struct box_size render_box(struct render_context *ctx, double x,
 	cairo_set_source_u32(cairo, colors.text);
 	cairo_move_to(cairo, x + width / 2 - text_width / 2, (int)floor(text_y));
 	choose_text_aa_mode(ctx, colors.text);
-	render_text(cairo, config->font_description, 1, pango_markup,
-			"%s", label);
+	text_cache_render(output, cairo, config->font_description,
+			pango_markup, label);
 
 	return (struct box_size) {
 		.width = width,
@@ -731,9 +747,9 @@ static uint32_t render_scroller_item(struct render_context *ctx,
 	cairo_t *cairo = ctx->cairo;
 	struct swaybar_config *config = output->bar->config;
 	int text_width, text_height;
-	get_text_size(cairo, config->font_description, &text_width, &text_height, NULL,
-			1, output->bar->mode_pango_markup,
-			"%s", str);
+	text_cache_get_size(output, cairo, config->font_description,
+			&text_width, &text_height, NULL, output->bar->mode_pango_markup,
+			str);
 
 	int ws_vertical_padding = WS_VERTICAL_PADDING;
 	int ws_horizontal_padding = WS_HORIZONTAL_PADDING;
@@ -773,8 +789,8 @@ static uint32_t render_scroller_item(struct render_context *ctx,
 	cairo_set_source_u32(cairo, config->colors.scroller.text);
 	cairo_move_to(cairo, *x + width / 2 - text_width / 2, (int)floor(text_y));
 	choose_text_aa_mode(ctx, config->colors.scroller.text);
-	render_text(cairo, config->font_description, 1, output->bar->mode_pango_markup,
-			"%s", str);
+	text_cache_render(output, cairo, config->font_description,
+			output->bar->mode_pango_markup, str);
 	*x += width;
 	return output->height;
 }
@@ -828,7 +844,8 @@ static uint32_t render_to_cairo(struct render_context *ctx) {
 	struct swaybar_config *config = bar->config;
 
 	int th;
-	get_text_size(cairo, config->font_description, NULL, &th, NULL, 1, false, "");
+	text_cache_get_size(output, cairo, config->font_description, NULL, &th, NULL,
+			false, "");
 	uint32_t max_height = (th + WS_VERTICAL_PADDING * 4);
 	/*
 	 * Each render_* function takes the actual height of the bar, and returns
@@ -872,6 +889,56 @@ static uint32_t render_to_cairo(struct render_context *ctx) {
 	return max_height > output->height ? max_height : output->height;
 }
 
+static bool status_block_state_equal(struct status_block_state *a,
+		struct status_block_state *b) {
+	return a->block == b->block && a->serial == b->serial &&
+		a->x == b->x && a->width == b->width;
+}
+
+static void damage_status_block(struct swaybar_output *output,
+		struct status_block_state *state, cairo_t *shm) {
+	int32_t x = floor(state->x);
+	int32_t width = ceil(state->x + state->width) - x;
+	if (width > 0) {
+		wl_surface_damage(output->surface, x, 0, width, output->height);
+		cairo_rectangle(shm, x * output->scale, 0,
+				width * output->scale, output->height * output->scale);
+	}
+}
+
+/**
+ * Damages the surface for the frame about to be committed. Unless something
+ * other than the status line changed, only the status blocks whose content
+ * or position differ from the last committed frame are damaged; their
+ * rectangles are then added to the path of shm and true is returned.
+ */
+static bool damage_output(struct swaybar_output *output,
+		struct render_context *ctx, cairo_t *shm) {
+	struct wl_array *prev = &output->status_blocks;
+	struct wl_array *cur = &ctx->status_blocks;
+	bool partial = !output->damage_full && prev->size == cur->size;
+	if (!partial) {
+		wl_surface_damage(output->surface, 0, 0,
+				output->width, output->height);
+	} else {
+		struct status_block_state *prev_states = prev->data;
+		struct status_block_state *cur_states = cur->data;
+		size_t len = cur->size / sizeof(struct status_block_state);
+		for (size_t i = 0; i < len; ++i) {
+			if (!status_block_state_equal(&prev_states[i], &cur_states[i])) {
+				damage_status_block(output, &prev_states[i], shm);
+				damage_status_block(output, &cur_states[i], shm);
+			}
+		}
+	}
+	output->damage_full = false;
+
+	wl_array_release(prev);
+	*prev = *cur;
+	wl_array_init(cur);
+	return partial;
+}
+
 static void output_frame_handle_done(void *data, struct wl_callback *callback,
 		uint32_t time) {
 	wl_callback_destroy(callback);
@@ -908,6 +975,7 @@ void render_frame(struct swaybar_output *output) {
 		.background_color = background_color,
 		.has_transparency = (background_color & 0xFF) != 0xFF,
 	};
+	wl_array_init(&ctx.status_blocks);
 
 	cairo_surface_t *recorder = cairo_recording_surface_create(
 			CAIRO_CONTENT_COLOR_ALPHA, NULL);
@@ -935,6 +1003,7 @@ void render_frame(struct swaybar_output *output) {
 	cairo_paint(cairo);
 
 	uint32_t height = render_to_cairo(&ctx);
+	text_cache_prune(output);
 	int config_height = output->bar->config->height;
 	if (config_height > 0) {
 		height = config_height;
@@ -953,16 +1022,45 @@ void render_frame(struct swaybar_output *output) {
 		// TODO: this could infinite loop if the compositor assigns us a
 		// different height than what we asked for
 		wl_surface_commit(output->surface);
+		output->damage_full = true;
 	} else if (height > 0) {
 		// Replay recording into shm and send it off
+		uint32_t buffer_width = output->width * output->scale;
+		uint32_t buffer_height = output->height * output->scale;
+		struct pool_buffer *prev_buffer = output->current_buffer;
+		// The last committed buffer is built upon, unless there is none or
+		// it has another size: get_next_buffer() reallocates buffers of
+		// another size, possibly this very one, so nothing would be left of it
+		if (!prev_buffer || !prev_buffer->buffer ||
+				prev_buffer->width != buffer_width ||
+				prev_buffer->height != buffer_height) {
+			output->damage_full = true;
+		}
 		output->current_buffer = get_next_buffer(output->bar->shm,
-				output->buffers,
-				output->width * output->scale,
-				output->height * output->scale);
+				output->buffers, buffer_width, buffer_height);
 		if (!output->current_buffer) {
 			goto cleanup;
 		}
-		cairo_t *shm = output->current_buffer->cairo;
+		struct pool_buffer *buffer = output->current_buffer;
+		cairo_t *shm = buffer->cairo;
+
+		wl_surface_set_buffer_scale(output->surface, output->scale);
+		wl_surface_attach(output->surface, buffer->buffer, 0, 0);
+
+		cairo_save(shm);
+		cairo_new_path(shm);
+		if (damage_output(output, &ctx, shm)) {
+			if (prev_buffer != buffer) {
+				// This buffer holds an older frame, start from the last one
+				cairo_save(shm);
+				cairo_set_operator(shm, CAIRO_OPERATOR_SOURCE);
+				cairo_set_source_surface(shm, prev_buffer->surface, 0.0, 0.0);
+				cairo_paint(shm);
+				cairo_restore(shm);
+			}
+			// Only the damaged status blocks are replayed
+			cairo_clip(shm);
+		}
 
 		cairo_save(shm);
 		cairo_set_operator(shm, CAIRO_OPERATOR_CLEAR);
@@ -971,12 +1069,7 @@ void render_frame(struct swaybar_output *output) {
 
 		cairo_set_source_surface(shm, recorder, 0.0, 0.0);
 		cairo_paint(shm);
-
-		wl_surface_set_buffer_scale(output->surface, output->scale);
-		wl_surface_attach(output->surface,
-				output->current_buffer->buffer, 0, 0);
-		wl_surface_damage(output->surface, 0, 0,
-				output->width, output->height);
+		cairo_restore(shm);
 
 		if (!ctx.has_transparency) {
 			struct wl_region *region =
@@ -1000,6 +1093,7 @@ cleanup:
 		cairo_font_options_destroy(ctx.textaa_sharp);
 	}
 	cairo_font_options_destroy(ctx.textaa_safe);
+	wl_array_release(&ctx.status_blocks);
 	cairo_surface_destroy(recorder);
 	cairo_destroy(cairo);
 }
@@ -0,0 +1,135 @@
+#include <stdlib.h>
+#include <string.h>
+#include "log.h"
+#include "pango.h"
+#include "swaybar/bar.h"
+#include "swaybar/text_cache.h"
+
+static uint32_t text_hash(const char *text) {
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (const unsigned char *p = (const unsigned char *)text; *p; ++p) {
+		hash ^= *p;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static void entry_destroy(struct text_cache_entry *entry) {
+	wl_list_remove(&entry->link);
+	g_object_unref(entry->layout);
+	pango_font_description_free(entry->font);
+	cairo_font_options_destroy(entry->options);
+	free(entry->text);
+	free(entry);
+}
+
+static bool entry_matches(struct text_cache_entry *entry, uint32_t hash,
+		const char *text, bool markup, const PangoFontDescription *desc,
+		int32_t scale, const cairo_font_options_t *options) {
+	return entry->hash == hash && entry->markup == markup &&
+		entry->scale == scale && strcmp(entry->text, text) == 0 &&
+		pango_font_description_equal(entry->font, desc) &&
+		cairo_font_options_equal(entry->options, options);
+}
+
+struct text_cache_entry *text_cache_get(struct swaybar_output *output,
+		cairo_t *cairo, const PangoFontDescription *desc, bool markup,
+		const char *text) {
+	uint32_t hash = text_hash(text);
+	cairo_font_options_t *fo = cairo_font_options_create();
+	cairo_get_font_options(cairo, fo);
+	struct text_cache_entry *entry;
+	wl_list_for_each(entry, &output->text_cache, link) {
+		if (entry_matches(entry, hash, text, markup, desc, output->scale, fo)) {
+			cairo_font_options_destroy(fo);
+			// Keep frequently drawn text at the front
+			wl_list_remove(&entry->link);
+			wl_list_insert(&output->text_cache, &entry->link);
+			entry->used = true;
+			// The font options are part of the key, only the transform
+			// may have changed
+			pango_cairo_update_layout(cairo, entry->layout);
+			return entry;
+		}
+	}
+
+	entry = calloc(1, sizeof(struct text_cache_entry));
+	if (!entry) {
+		sway_log(SWAY_ERROR, "Failed to allocate text cache entry");
+		cairo_font_options_destroy(fo);
+		return NULL;
+	}
+	entry->hash = hash;
+	entry->text = strdup(text);
+	entry->markup = markup;
+	entry->font = pango_font_description_copy(desc);
+	entry->scale = output->scale;
+	entry->options = fo;
+	entry->layout = get_pango_layout(cairo, desc, text, 1, markup);
+	pango_cairo_context_set_font_options(
+		pango_layout_get_context(entry->layout), fo);
+	pango_cairo_update_layout(cairo, entry->layout);
+	entry->used = true;
+	wl_list_insert(&output->text_cache, &entry->link);
+	return entry;
+}
+
+void text_cache_get_size(struct swaybar_output *output, cairo_t *cairo,
+		const PangoFontDescription *desc, int *width, int *height,
+		int *baseline, bool markup, const char *text) {
+	struct text_cache_entry *entry =
+		text_cache_get(output, cairo, desc, markup, text);
+	if (!entry) {
+		get_text_size(cairo, desc, width, height, baseline, 1, markup,
+				"%s", text);
+		return;
+	}
+
+	guint serial = pango_layout_get_serial(entry->layout);
+	if (entry->serial != serial) {
+		pango_layout_get_pixel_size(entry->layout,
+				&entry->width, &entry->height);
+		entry->baseline = pango_layout_get_baseline(entry->layout) / PANGO_SCALE;
+		entry->serial = serial;
+	}
+	if (width) {
+		*width = entry->width;
+	}
+	if (height) {
+		*height = entry->height;
+	}
+	if (baseline) {
+		*baseline = entry->baseline;
+	}
+}
+
+void text_cache_render(struct swaybar_output *output, cairo_t *cairo,
+		const PangoFontDescription *desc, bool markup, const char *text) {
+	struct text_cache_entry *entry =
+		text_cache_get(output, cairo, desc, markup, text);
+	if (!entry) {
+		render_text(cairo, desc, 1, markup,
+				"%s", text);
+		return;
+	}
+	pango_cairo_show_layout(cairo, entry->layout);
+}
+
+void text_cache_prune(struct swaybar_output *output) {
+	struct text_cache_entry *entry, *tmp;
+	wl_list_for_each_safe(entry, tmp, &output->text_cache, link) {
+		if (!entry->used) {
+			entry_destroy(entry);
+		} else {
+			entry->used = false;
+		}
+	}
+}
+
+void text_cache_finish(struct swaybar_output *output) {
+	struct text_cache_entry *entry, *tmp;
+	wl_list_for_each_safe(entry, tmp, &output->text_cache, link) {
+		entry_destroy(entry);
+	}
+}
@@ -620,6 +620,8 @@ int main(int argc, char **argv) {
 		type = IPC_GET_TRAILS;
 	} else if (strcasecmp(cmdtype, "get_spaces") == 0) {
 		type = IPC_GET_SPACES;
+	} else if (strcasecmp(cmdtype, "get_stats") == 0) {
+		type = IPC_GET_STATS;
 	} else {
 		if (quiet) {
 			exit(EXIT_FAILURE);